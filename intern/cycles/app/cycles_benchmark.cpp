@@ -0,0 +1,834 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Headless render benchmark.
+ *
+ * Renders a fixed set of procedurally generated scenes, each one stressing a
+ * different part of the renderer, and reports how long every phase of the
+ * render took. The output is meant to be compared between builds to catch
+ * performance regressions, so the scenes must not change between versions
+ * unless the benchmark version below is increased as well. */
+
+#include <stdio.h>
+
+#include "render/background.h"
+#include "render/buffers.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/graph.h"
+#include "render/hair.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/session.h"
+#include "render/shader.h"
+#include "render/stats.h"
+#include "device/device.h"
+
+#include "util/util_args.h"
+#include "util/util_foreach.h"
+#include "util/util_function.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+#include "util/util_path.h"
+#include "util/util_progress.h"
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_time.h"
+#include "util/util_transform.h"
+#include "util/util_vector.h"
+#include "util/util_version.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Increase when the generated scenes change, so results of different versions
+ * of the benchmark are never compared with each other. */
+#define BENCHMARK_VERSION 1
+
+/* Phases of a render, in the order they are reported. */
+enum BenchmarkPhase {
+  PHASE_KERNEL_LOAD = 0,
+  PHASE_SHADERS,
+  PHASE_GEOMETRY,
+  PHASE_BVH,
+  PHASE_IMAGES,
+  PHASE_LIGHTS,
+  PHASE_SCENE_OTHER,
+  PHASE_RENDER,
+  PHASE_OTHER,
+
+  PHASE_NUM,
+};
+
+static const char *phase_names[PHASE_NUM] = {
+    "kernel_load",
+    "shaders",
+    "geometry",
+    "bvh",
+    "images",
+    "lights",
+    "scene_other",
+    "render",
+    "other",
+};
+
+struct BenchmarkResult {
+  string scene;
+  bool success;
+  double phase_time[PHASE_NUM];
+  double total_time;
+  double render_time;
+  double samples_per_second;
+  size_t mem_peak;
+  RenderStats stats;
+};
+
+struct BenchmarkScene {
+  const char *name;
+  const char *description;
+  void (*create)(Scene *scene);
+  bool use_denoising;
+};
+
+struct Options {
+  SessionParams session_params;
+  SceneParams scene_params;
+  int width, height;
+  int repeat;
+  bool json;
+  bool profile;
+  string output_path;
+  vector<string> scenes;
+} options;
+
+/* Phase Timing
+ *
+ * The session reports what it is doing through the progress status, use
+ * that to attribute wall-clock time to phases without touching the session. */
+
+static struct {
+  thread_mutex mutex;
+  Progress *progress;
+  BenchmarkPhase phase;
+  double phase_start;
+  double phase_time[PHASE_NUM];
+} phase_timer;
+
+static BenchmarkPhase phase_from_status(const string &status)
+{
+  if (string_startswith(status, "Loading render kernels"))
+    return PHASE_KERNEL_LOAD;
+  else if (string_startswith(status, "Updating Shaders"))
+    return PHASE_SHADERS;
+  else if (string_startswith(status, "Updating Geometry BVH") ||
+           string_startswith(status, "Updating Scene BVH"))
+    return PHASE_BVH;
+  else if (string_startswith(status, "Updating Mesh") ||
+           string_startswith(status, "Updating Hair") ||
+           string_startswith(status, "Updating Objects") ||
+           string_startswith(status, "Updating Displacement"))
+    return PHASE_GEOMETRY;
+  else if (string_startswith(status, "Updating Images") ||
+           string_startswith(status, "Updating Volume Images"))
+    return PHASE_IMAGES;
+  else if (string_startswith(status, "Updating Lights"))
+    return PHASE_LIGHTS;
+  else if (string_startswith(status, "Updating"))
+    return PHASE_SCENE_OTHER;
+  else if (string_startswith(status, "Rendered") || string_startswith(status, "Path Tracing") ||
+           string_startswith(status, "Rendering"))
+    return PHASE_RENDER;
+
+  return PHASE_OTHER;
+}
+
+static void phase_timer_switch(BenchmarkPhase phase)
+{
+  const double time = time_dt();
+
+  phase_timer.phase_time[phase_timer.phase] += time - phase_timer.phase_start;
+  phase_timer.phase = phase;
+  phase_timer.phase_start = time;
+}
+
+static void phase_timer_update()
+{
+  thread_scoped_lock lock(phase_timer.mutex);
+
+  string status, substatus;
+  phase_timer.progress->get_status(status, substatus);
+
+  const BenchmarkPhase phase = phase_from_status(status);
+  if (phase != phase_timer.phase) {
+    phase_timer_switch(phase);
+  }
+}
+
+static void phase_timer_begin(Progress *progress)
+{
+  thread_scoped_lock lock(phase_timer.mutex);
+
+  phase_timer.progress = progress;
+  phase_timer.phase = PHASE_OTHER;
+  phase_timer.phase_start = time_dt();
+  for (int i = 0; i < PHASE_NUM; i++) {
+    phase_timer.phase_time[i] = 0.0;
+  }
+}
+
+static void phase_timer_end(double phase_time[PHASE_NUM])
+{
+  thread_scoped_lock lock(phase_timer.mutex);
+
+  phase_timer_switch(PHASE_OTHER);
+  for (int i = 0; i < PHASE_NUM; i++) {
+    phase_time[i] = phase_timer.phase_time[i];
+  }
+}
+
+/* Scene Construction */
+
+static Shader *scene_add_shader(Scene *scene, ShaderGraph *graph, const char *name)
+{
+  Shader *shader = new Shader();
+  shader->name = name;
+  shader->set_graph(graph);
+  shader->tag_update(scene);
+  scene->shaders.push_back(shader);
+
+  return shader;
+}
+
+static Shader *scene_add_surface_shader(Scene *scene, ShaderNode *bsdf, const char *name)
+{
+  ShaderGraph *graph = new ShaderGraph();
+  graph->add(bsdf);
+  graph->connect(bsdf->output("BSDF"), graph->output()->input("Surface"));
+
+  return scene_add_shader(scene, graph, name);
+}
+
+static Object *scene_add_object(Scene *scene, Geometry *geom, const Transform &tfm)
+{
+  scene->geometry.push_back(geom);
+
+  Object *object = new Object();
+  object->geometry = geom;
+  object->tfm = tfm;
+  scene->objects.push_back(object);
+
+  return object;
+}
+
+/* UV sphere centered at the origin, as a separate mesh so instancing does not
+ * hide the cost of building the BVH. */
+static Mesh *scene_add_sphere(
+    Scene *scene, Shader *shader, const Transform &tfm, int segments, int rings)
+{
+  Mesh *mesh = new Mesh();
+  mesh->used_shaders.push_back(shader);
+  mesh->reserve_mesh(segments * (rings - 1) + 2, segments * (rings - 1) * 2);
+
+  mesh->add_vertex(make_float3(0.0f, 1.0f, 0.0f));
+  for (int r = 1; r < rings; r++) {
+    const float theta = M_PI_F * r / rings;
+    for (int s = 0; s < segments; s++) {
+      const float phi = M_2PI_F * s / segments;
+      mesh->add_vertex(
+          make_float3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)));
+    }
+  }
+  mesh->add_vertex(make_float3(0.0f, -1.0f, 0.0f));
+
+  const int bottom = segments * (rings - 1) + 1;
+  for (int s = 0; s < segments; s++) {
+    const int s_next = (s + 1) % segments;
+
+    mesh->add_triangle(0, 1 + s_next, 1 + s, 0, true);
+    for (int r = 0; r < rings - 2; r++) {
+      const int v0 = 1 + r * segments + s;
+      const int v1 = 1 + r * segments + s_next;
+      const int v2 = 1 + (r + 1) * segments + s_next;
+      const int v3 = 1 + (r + 1) * segments + s;
+
+      mesh->add_triangle(v0, v1, v2, 0, true);
+      mesh->add_triangle(v0, v2, v3, 0, true);
+    }
+    const int last_ring = 1 + (rings - 2) * segments;
+    mesh->add_triangle(bottom, last_ring + s, last_ring + s_next, 0, true);
+  }
+
+  scene_add_object(scene, mesh, tfm);
+
+  return mesh;
+}
+
+/* Shared by all scenes: camera, ground plane, a light and a dim world. */
+static void scene_add_environment(Scene *scene)
+{
+  /* Camera looks down the positive Z axis. */
+  Camera *cam = scene->camera;
+  cam->width = options.width;
+  cam->height = options.height;
+  cam->full_width = options.width;
+  cam->full_height = options.height;
+  cam->matrix = transform_translate(0.0f, 1.5f, -9.0f) *
+                transform_rotate(DEG2RADF(10.0f), make_float3(1.0f, 0.0f, 0.0f));
+  cam->compute_auto_viewplane();
+  cam->need_update = true;
+
+  /* Ground plane. */
+  Mesh *ground = new Mesh();
+  ground->used_shaders.push_back(scene->default_surface);
+  ground->reserve_mesh(4, 2);
+  ground->add_vertex(make_float3(-20.0f, -1.0f, -20.0f));
+  ground->add_vertex(make_float3(20.0f, -1.0f, -20.0f));
+  ground->add_vertex(make_float3(20.0f, -1.0f, 20.0f));
+  ground->add_vertex(make_float3(-20.0f, -1.0f, 20.0f));
+  ground->add_triangle(0, 2, 1, 0, false);
+  ground->add_triangle(0, 3, 2, 0, false);
+  scene_add_object(scene, ground, transform_identity());
+
+  /* Soft point light. */
+  Light *light = new Light();
+  light->type = LIGHT_POINT;
+  light->co = make_float3(4.0f, 6.0f, -4.0f);
+  light->size = 0.5f;
+  light->strength = make_float3(800.0f, 800.0f, 800.0f);
+  light->shader = scene->default_light;
+  scene->lights.push_back(light);
+
+  /* World. */
+  ShaderGraph *graph = new ShaderGraph();
+  BackgroundNode *background = new BackgroundNode();
+  background->color = make_float3(0.6f, 0.7f, 0.9f);
+  background->strength = 0.3f;
+  graph->add(background);
+  graph->connect(background->output("Background"), graph->output()->input("Surface"));
+
+  scene->default_background->set_graph(graph);
+  scene->default_background->tag_update(scene);
+}
+
+/* Many dense, non-instanced meshes: dominated by BVH build and traversal. */
+static void scene_create_bvh(Scene *scene)
+{
+  scene_add_environment(scene);
+
+  for (int x = 0; x < 16; x++) {
+    for (int z = 0; z < 16; z++) {
+      const Transform tfm = transform_translate(x * 0.5f - 3.75f, 0.0f, z * 0.5f - 1.0f) *
+                            transform_scale(0.2f, 0.2f, 0.2f);
+      scene_add_sphere(scene, scene->default_surface, tfm, 96, 48);
+    }
+  }
+}
+
+static Shader *scene_add_textured_shader(Scene *scene)
+{
+  ShaderGraph *graph = new ShaderGraph();
+
+  NoiseTextureNode *noise = new NoiseTextureNode();
+  noise->scale = 8.0f;
+  noise->detail = 8.0f;
+  graph->add(noise);
+
+  PrincipledBsdfNode *bsdf = new PrincipledBsdfNode();
+  bsdf->roughness = 0.3f;
+  graph->add(bsdf);
+
+  graph->connect(noise->output("Color"), bsdf->input("Base Color"));
+  graph->connect(noise->output("Fac"), bsdf->input("Roughness"));
+  graph->connect(bsdf->output("BSDF"), graph->output()->input("Surface"));
+
+  return scene_add_shader(scene, graph, "textured");
+}
+
+/* Few objects with an expensive procedural shader: dominated by SVM. */
+static void scene_create_shading(Scene *scene)
+{
+  scene_add_environment(scene);
+
+  Shader *shader = scene_add_textured_shader(scene);
+  for (int i = 0; i < 5; i++) {
+    const Transform tfm = transform_translate(i * 2.2f - 4.4f, 0.0f, 0.0f);
+    scene_add_sphere(scene, shader, tfm, 64, 32);
+  }
+}
+
+/* Homogeneous scattering volume. */
+static void scene_create_volume(Scene *scene)
+{
+  scene_add_environment(scene);
+
+  ShaderGraph *graph = new ShaderGraph();
+  PrincipledVolumeNode *volume = new PrincipledVolumeNode();
+  volume->color = make_float3(0.8f, 0.8f, 0.9f);
+  volume->density = 2.0f;
+  volume->anisotropy = 0.3f;
+  graph->add(volume);
+  graph->connect(volume->output("Volume"), graph->output()->input("Volume"));
+
+  Shader *shader = scene_add_shader(scene, graph, "volume");
+  scene_add_sphere(scene, shader, transform_scale(2.5f, 2.5f, 2.5f), 64, 32);
+}
+
+/* Dense field of curves standing up from the ground. */
+static void scene_create_hair(Scene *scene)
+{
+  scene_add_environment(scene);
+
+  const int num_curves_side = 300;
+  const int num_keys = 6;
+
+  PrincipledHairBsdfNode *bsdf = new PrincipledHairBsdfNode();
+  Shader *shader = scene_add_surface_shader(scene, bsdf, "hair");
+
+  Hair *hair = new Hair();
+  hair->used_shaders.push_back(shader);
+  hair->reserve_curves(num_curves_side * num_curves_side,
+                       num_curves_side * num_curves_side * num_keys);
+
+  /* Simple deterministic hash, so the curves look random but are identical
+   * between runs and platforms. */
+  uint seed = 0x9e3779b9u;
+  for (int x = 0; x < num_curves_side; x++) {
+    for (int z = 0; z < num_curves_side; z++) {
+      seed = seed * 1664525u + 1013904223u;
+      const float jitter_x = (seed >> 8) * (1.0f / 16777216.0f) - 0.5f;
+      seed = seed * 1664525u + 1013904223u;
+      const float jitter_z = (seed >> 8) * (1.0f / 16777216.0f) - 0.5f;
+
+      const float3 root = make_float3((x + jitter_x) * (8.0f / num_curves_side) - 4.0f,
+                                      -1.0f,
+                                      (z + jitter_z) * (8.0f / num_curves_side) - 2.0f);
+      const int first_key = hair->curve_keys.size();
+
+      for (int k = 0; k < num_keys; k++) {
+        const float t = (float)k / (num_keys - 1);
+        const float3 co = root + make_float3(jitter_x * t * t, t * 1.5f, jitter_z * t * t);
+        hair->add_curve_key(co, 0.01f * (1.0f - t) + 0.002f);
+      }
+      hair->add_curve(first_key, 0);
+    }
+  }
+
+  scene_add_object(scene, hair, transform_identity());
+}
+
+/* Subsurface scattering with a fairly large radius. */
+static void scene_create_subsurface(Scene *scene)
+{
+  scene_add_environment(scene);
+
+  PrincipledBsdfNode *bsdf = new PrincipledBsdfNode();
+  bsdf->base_color = make_float3(0.8f, 0.6f, 0.5f);
+  bsdf->subsurface = 1.0f;
+  bsdf->subsurface_color = make_float3(0.9f, 0.5f, 0.4f);
+  bsdf->subsurface_radius = make_float3(0.5f, 0.2f, 0.1f);
+  Shader *shader = scene_add_surface_shader(scene, bsdf, "subsurface");
+
+  for (int i = 0; i < 3; i++) {
+    const Transform tfm = transform_translate(i * 3.0f - 3.0f, 0.0f, 0.0f);
+    scene_add_sphere(scene, shader, tfm, 64, 32);
+  }
+}
+
+/* Same content as the shading scene, with the denoiser enabled. */
+static void scene_create_denoising(Scene *scene)
+{
+  scene_create_shading(scene);
+}
+
+static const BenchmarkScene benchmark_scenes[] = {
+    {"bvh", "256 dense non-instanced meshes, 2.3M triangles", scene_create_bvh, false},
+    {"shading", "Principled BSDF driven by procedural noise", scene_create_shading, false},
+    {"volume", "Homogeneous scattering volume", scene_create_volume, false},
+    {"hair", "90000 curves with the Principled Hair BSDF", scene_create_hair, false},
+    {"subsurface", "Principled BSDF with subsurface scattering", scene_create_subsurface, false},
+    {"denoising", "Shading scene with the denoiser enabled", scene_create_denoising, true},
+};
+
+static const int num_benchmark_scenes = sizeof(benchmark_scenes) / sizeof(*benchmark_scenes);
+
+static const BenchmarkScene *benchmark_scene_find(const string &name)
+{
+  for (int i = 0; i < num_benchmark_scenes; i++) {
+    if (name == benchmark_scenes[i].name) {
+      return &benchmark_scenes[i];
+    }
+  }
+  return NULL;
+}
+
+/* Rendering */
+
+static void benchmark_run(const BenchmarkScene &bscene, BenchmarkResult &result)
+{
+  SessionParams session_params = options.session_params;
+  session_params.run_denoising = bscene.use_denoising;
+  session_params.full_denoising = bscene.use_denoising;
+
+  Session *session = new Session(session_params);
+  session->tile_manager.schedule_denoising = bscene.use_denoising;
+
+  phase_timer_begin(&session->progress);
+  session->progress.set_update_callback(function_bind(&phase_timer_update));
+
+  Scene *scene = new Scene(options.scene_params, session->device);
+  bscene.create(scene);
+
+  scene->film->denoising_data_pass = bscene.use_denoising;
+  scene->film->tag_update(scene);
+
+  session->scene = scene;
+
+  BufferParams buffer_params;
+  buffer_params.width = options.width;
+  buffer_params.height = options.height;
+  buffer_params.full_width = options.width;
+  buffer_params.full_height = options.height;
+  buffer_params.denoising_data_pass = bscene.use_denoising;
+
+  session->reset(buffer_params, session_params.samples);
+  session->start();
+  session->wait();
+
+  phase_timer_end(result.phase_time);
+
+  result.scene = bscene.name;
+  result.success = !session->progress.get_error() && !session->progress.get_cancel();
+
+  session->progress.get_time(result.total_time, result.render_time);
+  const double render_phase_time = result.phase_time[PHASE_RENDER];
+  result.samples_per_second = (render_phase_time > 0.0) ?
+                                  (double)options.width * options.height *
+                                      session_params.samples / render_phase_time :
+                                  0.0;
+  result.mem_peak = session->stats.mem_peak;
+
+  if (options.profile) {
+    session->collect_statistics(&result.stats);
+  }
+
+  if (!result.success) {
+    fprintf(stderr,
+            "Scene %s failed: %s\n",
+            bscene.name,
+            session->progress.get_error_message().c_str());
+  }
+
+  /* The session owns and frees the scene. */
+  delete session;
+}
+
+/* Reporting */
+
+static string report_kernel_json(const NamedNestedSampleStats &stats, int indent_level)
+{
+  const string indent(indent_level * 2, ' ');
+  string str = string_printf("{\"name\": \"%s\", \"samples\": %llu",
+                             stats.name.c_str(),
+                             (unsigned long long)stats.sum_samples);
+
+  if (!stats.entries.empty()) {
+    str += ", \"entries\": [\n";
+    for (size_t i = 0; i < stats.entries.size(); i++) {
+      str += indent + "  " + report_kernel_json(stats.entries[i], indent_level + 1);
+      str += (i + 1 < stats.entries.size()) ? ",\n" : "\n";
+    }
+    str += indent + "]";
+  }
+
+  return str + "}";
+}
+
+static string report_json(const vector<BenchmarkResult> &results)
+{
+  const DeviceInfo &device = options.session_params.device;
+
+  string str = "{\n";
+  str += string_printf("  \"benchmark_version\": %d,\n", BENCHMARK_VERSION);
+  str += string_printf("  \"cycles_version\": \"%s\",\n", CYCLES_VERSION_STRING);
+  str += string_printf("  \"device\": \"%s\",\n", device.description.c_str());
+  str += string_printf("  \"threads\": %d,\n", options.session_params.threads);
+  str += string_printf("  \"samples\": %d,\n", options.session_params.samples);
+  str += string_printf("  \"width\": %d,\n", options.width);
+  str += string_printf("  \"height\": %d,\n", options.height);
+  str += "  \"results\": [\n";
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchmarkResult &result = results[i];
+
+    str += "    {\n";
+    str += string_printf("      \"scene\": \"%s\",\n", result.scene.c_str());
+    str += string_printf("      \"success\": %s,\n", result.success ? "true" : "false");
+    str += string_printf("      \"total_time\": %.6f,\n", result.total_time);
+    str += string_printf("      \"render_time\": %.6f,\n", result.render_time);
+    str += string_printf("      \"samples_per_second\": %.1f,\n", result.samples_per_second);
+    str += string_printf("      \"mem_peak\": %llu,\n", (unsigned long long)result.mem_peak);
+    str += "      \"phases\": {";
+    for (int phase = 0; phase < PHASE_NUM; phase++) {
+      str += string_printf("%s\"%s\": %.6f",
+                           (phase == 0) ? "" : ", ",
+                           phase_names[phase],
+                           result.phase_time[phase]);
+    }
+    str += "}";
+    if (result.stats.has_profiling) {
+      str += ",\n      \"kernel\": " + report_kernel_json(result.stats.kernel, 3);
+    }
+    str += "\n    }";
+    str += (i + 1 < results.size()) ? ",\n" : "\n";
+  }
+
+  str += "  ]\n}\n";
+
+  return str;
+}
+
+static string report_text(const vector<BenchmarkResult> &results)
+{
+  string str = string_printf("Cycles %s benchmark %d, %s, %dx%d, %d samples\n\n",
+                             CYCLES_VERSION_STRING,
+                             BENCHMARK_VERSION,
+                             options.session_params.device.description.c_str(),
+                             options.width,
+                             options.height,
+                             options.session_params.samples);
+
+  foreach (const BenchmarkResult &result, results) {
+    str += string_printf("%s%s\n", result.scene.c_str(), result.success ? "" : " (FAILED)");
+    str += string_printf("  Total time:          %.3f s\n", result.total_time);
+    str += string_printf("  Render time:         %.3f s\n", result.render_time);
+    str += string_printf("  Samples per second:  %.1f\n", result.samples_per_second);
+    str += string_printf("  Peak memory:         %s\n",
+                         string_human_readable_size(result.mem_peak).c_str());
+    for (int phase = 0; phase < PHASE_NUM; phase++) {
+      str += string_printf("  %-20s %.3f s\n",
+                           (string(phase_names[phase]) + ":").c_str(),
+                           result.phase_time[phase]);
+    }
+    if (result.stats.has_profiling) {
+      RenderStats stats = result.stats;
+      str += stats.kernel.full_report(1);
+    }
+    str += "\n";
+  }
+
+  return str;
+}
+
+/* Options */
+
+static int scenes_parse(int argc, const char *argv[])
+{
+  for (int i = 0; i < argc; i++) {
+    options.scenes.push_back(argv[i]);
+  }
+
+  return 0;
+}
+
+static void options_parse(int argc, const char **argv)
+{
+  options.width = 640;
+  options.height = 360;
+  options.repeat = 1;
+  options.json = false;
+  options.profile = false;
+  options.session_params.samples = 32;
+
+  string devicename = "CPU";
+  string format = "text";
+  bool list_scenes = false;
+
+  ArgParse ap;
+  bool help = false, debug = false, version = false;
+  int verbosity = 1;
+
+  ap.options("Usage: cycles_benchmark [options] [scene ...]",
+             "%*",
+             scenes_parse,
+             "",
+             "--device %s",
+             &devicename,
+             "Device to use: CPU, CUDA, OPENCL or OPTIX",
+             "--threads %d",
+             &options.session_params.threads,
+             "CPU rendering threads, 0 uses all cores",
+             "--samples %d",
+             &options.session_params.samples,
+             "Number of samples to render (default 32)",
+             "--width %d",
+             &options.width,
+             "Image width in pixels (default 640)",
+             "--height %d",
+             &options.height,
+             "Image height in pixels (default 360)",
+             "--tile-size %d",
+             &options.session_params.tile_size.x,
+             "Tile size in pixels",
+             "--repeat %d",
+             &options.repeat,
+             "Render every scene this many times",
+             "--profile",
+             &options.profile,
+             "Report time spent in kernel sections (CPU only)",
+             "--format %s",
+             &format,
+             "Report format: text or json",
+             "--output %s",
+             &options.output_path,
+             "Write the report to this file instead of standard output",
+             "--list-scenes",
+             &list_scenes,
+             "List the available scenes",
+#ifdef WITH_CYCLES_LOGGING
+             "--debug",
+             &debug,
+             "Enable debug logging",
+             "--verbose %d",
+             &verbosity,
+             "Set verbosity of the logger",
+#endif
+             "--help",
+             &help,
+             "Print help message",
+             "--version",
+             &version,
+             "Print version number",
+             NULL);
+
+  if (ap.parse(argc, argv) < 0) {
+    fprintf(stderr, "%s\n", ap.geterror().c_str());
+    ap.usage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (debug) {
+    util_logging_start();
+    util_logging_verbosity_set(verbosity);
+  }
+
+  if (help) {
+    ap.usage();
+    exit(EXIT_SUCCESS);
+  }
+  else if (version) {
+    printf("%s\n", CYCLES_VERSION_STRING);
+    exit(EXIT_SUCCESS);
+  }
+  else if (list_scenes) {
+    for (int i = 0; i < num_benchmark_scenes; i++) {
+      printf("    %-12s%s\n", benchmark_scenes[i].name, benchmark_scenes[i].description);
+    }
+    exit(EXIT_SUCCESS);
+  }
+
+  if (format == "json")
+    options.json = true;
+  else if (format != "text") {
+    fprintf(stderr, "Unknown report format: %s\n", format.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  if (options.scenes.empty()) {
+    for (int i = 0; i < num_benchmark_scenes; i++) {
+      options.scenes.push_back(benchmark_scenes[i].name);
+    }
+  }
+  foreach (const string &name, options.scenes) {
+    if (!benchmark_scene_find(name)) {
+      fprintf(stderr, "Unknown scene: %s\n", name.c_str());
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (options.width <= 0 || options.height <= 0 || options.session_params.samples <= 0 ||
+      options.repeat <= 0) {
+    fprintf(stderr, "Width, height, samples and repeat must be positive\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Final frame renders as done on a render farm: tiled, in the background,
+   * with a static BVH. */
+  options.session_params.background = true;
+  options.session_params.progressive = false;
+  options.session_params.use_profiling = options.profile;
+  options.session_params.tile_size.y = options.session_params.tile_size.x;
+
+  options.scene_params.shadingsystem = SHADINGSYSTEM_SVM;
+  options.scene_params.bvh_type = SceneParams::BVH_STATIC;
+
+  /* find matching device */
+  DeviceType device_type = Device::type_from_string(devicename.c_str());
+  vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
+
+  if (devices.empty()) {
+    fprintf(stderr, "Unknown device: %s\n", devicename.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  options.session_params.device = devices.front();
+}
+
+CCL_NAMESPACE_END
+
+using namespace ccl;
+
+int main(int argc, const char **argv)
+{
+  util_logging_init(argv[0]);
+  path_init();
+  options_parse(argc, argv);
+
+  vector<BenchmarkResult> results;
+  bool success = true;
+
+  foreach (const string &name, options.scenes) {
+    const BenchmarkScene *bscene = benchmark_scene_find(name);
+
+    for (int i = 0; i < options.repeat; i++) {
+      if (!options.json) {
+        fprintf(stderr, "Rendering %s (%d/%d)\n", bscene->name, i + 1, options.repeat);
+      }
+
+      results.push_back(BenchmarkResult());
+      benchmark_run(*bscene, results.back());
+      success &= results.back().success;
+    }
+  }
+
+  const string report = (options.json) ? report_json(results) : report_text(results);
+
+  if (options.output_path.empty()) {
+    fputs(report.c_str(), stdout);
+  }
+  else {
+    FILE *f = fopen(options.output_path.c_str(), "w");
+    if (!f) {
+      fprintf(stderr, "Failed to write %s\n", options.output_path.c_str());
+      return EXIT_FAILURE;
+    }
+    fputs(report.c_str(), f);
+    fclose(f);
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
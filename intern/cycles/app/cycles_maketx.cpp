@@ -0,0 +1,100 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Converts image files to tiled and MIP-mapped textures, which are picked up
+ * by the texture cache of the CPU device when stored next to the original. */
+
+#include <stdio.h>
+
+#include "render/image_cache.h"
+
+#include "util/util_args.h"
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+using namespace ccl;
+
+static vector<string> filepaths;
+
+static int files_parse(int argc, const char *argv[])
+{
+  for (int i = 0; i < argc; i++) {
+    filepaths.push_back(argv[i]);
+  }
+  return 0;
+}
+
+int main(int argc, const char **argv)
+{
+  util_logging_init(argv[0]);
+  path_init();
+
+  bool force = false, help = false;
+
+  ArgParse ap;
+  ap.options("Usage: cycles_maketx [options] image ...",
+             "%*",
+             files_parse,
+             "",
+             "--force",
+             &force,
+             "Convert images even if an up to date texture exists",
+             "--help",
+             &help,
+             "Print help message",
+             NULL);
+
+  if (ap.parse(argc, argv) < 0) {
+    fprintf(stderr, "%s\n", ap.geterror().c_str());
+    ap.usage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (help || filepaths.empty()) {
+    ap.usage();
+    exit(EXIT_SUCCESS);
+  }
+
+  int num_failed = 0;
+
+  foreach (const string &filepath, filepaths) {
+    const string output_filepath = ImageTextureCache::texture_filepath(filepath);
+
+    if (output_filepath == filepath) {
+      fprintf(stderr, "Skipping %s, already a texture\n", filepath.c_str());
+      continue;
+    }
+
+    if (!force && path_exists(output_filepath) &&
+        path_modified_time(output_filepath) >= path_modified_time(filepath)) {
+      printf("Skipping %s, texture is up to date\n", filepath.c_str());
+      continue;
+    }
+
+    printf("Converting %s\n", filepath.c_str());
+
+    string error;
+    if (!ImageTextureCache::make_texture(filepath, output_filepath, &error)) {
+      fprintf(stderr, "Failed to convert %s: %s\n", filepath.c_str(), error.c_str());
+      num_failed++;
+    }
+  }
+
+  return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
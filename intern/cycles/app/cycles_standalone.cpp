@@ -431,6 +431,9 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--texture-cache-size %d",
+             &options.scene_params.texture_cache_size,
+             "Load image textures on demand, using at most this many megabytes (CPU only)",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -717,6 +717,15 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    texture_cache_size: IntProperty(
+        name="Texture Cache Size",
+        description="Load image textures on demand during final rendering, keeping at most this many megabytes of "
+        "texture tiles in memory, 0 disables the cache (CPU only)",
+        default=0,
+        min=0, max=1048576,
+        subtype='UNSIGNED',
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
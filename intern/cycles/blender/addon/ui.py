@@ -685,7 +685,12 @@ class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
         col = layout.column()
 
         col.prop(rd, "use_save_buffers")
-        col.prop(rd, "use_persistent_data", text="Persistent Images")
+        col.prop(rd, "use_persistent_data", text="Persistent Data")
+
+        cscene = scene.cycles
+        sub = col.column()
+        sub.active = use_cpu(context) and not cscene.shading_system
+        sub.prop(cscene, "texture_cache_size")
 
 
 class CYCLES_RENDER_PT_performance_viewport(CyclesButtonsPanel, Panel):
@@ -226,7 +226,6 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
   }
 
   session->progress.reset();
-  scene->reset();
 
   session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -235,11 +234,21 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
    */
   session->stats.mem_peak = session->stats.mem_used;
 
-  /* There is no single depsgraph to use for the entire render.
-   * See note on create_session().
-   */
-  /* sync object should be re-created */
-  sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  if (b_engine.is_depsgraph_reused()) {
+    /* Blender kept the dependency graph of the previous render, so the scene
+     * data synchronized from it is still valid. Only update what changed. */
+    sync->sync_recalc(b_depsgraph, b_v3d);
+  }
+  else {
+    scene->reset();
+
+    /* There is no single depsgraph to use for the entire render.
+     * See note on create_session().
+     */
+    /* sync object should be re-created */
+    delete sync;
+    sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  }
 
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
@@ -698,7 +698,14 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   else if (shadingsystem == 1)
     params.shadingsystem = SHADINGSYSTEM_OSL;
 
-  if (background || DebugFlags().viewport_static_bvh)
+  if (background && params.shadingsystem != SHADINGSYSTEM_OSL)
+    params.persistent_data = r.use_persistent_data();
+  else
+    params.persistent_data = false;
+
+  /* With persistent data, objects keep their own BVH so that only the BVHs of
+   * objects which changed since the previous render need to be rebuilt. */
+  if ((background && !params.persistent_data) || DebugFlags().viewport_static_bvh)
     params.bvh_type = SceneParams::BVH_STATIC;
   else
     params.bvh_type = SceneParams::BVH_DYNAMIC;
@@ -707,11 +714,6 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
 
-  if (background && params.shadingsystem != SHADINGSYSTEM_OSL)
-    params.persistent_data = r.use_persistent_data();
-  else
-    params.persistent_data = false;
-
   int texture_limit;
   if (background) {
     texture_limit = RNA_enum_get(&cscene, "texture_limit_render");
@@ -726,6 +728,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  /* On demand texture loading is only used for final renders, viewport renders
+   * keep the textures of the previous update resident in memory. */
+  params.texture_cache_size = background ? RNA_int_get(&cscene, "texture_cache_size") : 0;
+
   /* TODO(sergey): Once OSL supports per-microarchitecture optimization get
    * rid of this.
    */
@@ -37,6 +37,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -103,7 +104,11 @@ int BVHStackEntry::encodeIdx() const
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_),
+      geometry(geometry_),
+      objects(objects_),
+      build_sah_cost(0.0f),
+      refit_sah_cost(0.0f)
 {
 }
 
@@ -175,6 +180,12 @@ void BVH::build(Progress &progress, Stats *)
     return;
   }
 
+  /* Remember quality of the tree, to detect when refitting degraded it. */
+  if (!params.top_level) {
+    build_sah_cost = root->computeSubtreeSAHCost(params);
+    refit_sah_cost = build_sah_cost;
+  }
+
   /* pack triangles */
   progress.set_substatus("Packing BVH triangles and strands");
   pack_primitives();
@@ -206,6 +217,57 @@ void BVH::refit(Progress &progress)
   refit_nodes();
 }
 
+bool BVH::refit_degraded() const
+{
+  return build_sah_cost > 0.0f && refit_sah_cost > build_sah_cost * params.refit_max_sah_cost_ratio;
+}
+
+void BVH::refit_children(const int *child,
+                         int num_children,
+                         BoundBox *child_bbox,
+                         uint *child_visibility,
+                         float *child_sah_cost,
+                         int num_subtrees)
+{
+  num_subtrees *= num_children;
+
+  if (num_subtrees <= BVH_REFIT_PARALLEL_SUBTREES) {
+    /* Subtrees don't share any nodes or primitives, refit them in parallel. */
+    TaskPool pool;
+    for (int i = 0; i < num_children; i++) {
+      if (child[i] != 0) {
+        pool.push(function_bind(&BVH::refit_node_task,
+                                this,
+                                (child[i] < 0) ? -child[i] - 1 : child[i],
+                                (child[i] < 0),
+                                &child_bbox[i],
+                                &child_visibility[i],
+                                &child_sah_cost[i],
+                                num_subtrees));
+      }
+    }
+    pool.wait_work();
+  }
+  else {
+    for (int i = 0; i < num_children; i++) {
+      if (child[i] != 0) {
+        refit_node((child[i] < 0) ? -child[i] - 1 : child[i],
+                   (child[i] < 0),
+                   child_bbox[i],
+                   child_visibility[i],
+                   child_sah_cost[i],
+                   num_subtrees);
+      }
+    }
+  }
+}
+
+void BVH::refit_node_task(
+    int idx, bool leaf, BoundBox *bbox, uint *visibility, float *sah_cost, int num_subtrees)
+{
+  refit_node(idx, leaf, *bbox, *visibility, *sah_cost, num_subtrees);
+}
+
 void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
 {
   /* Refit range of primitives. */
@@ -39,6 +39,8 @@ class Progress;
 
 #define BVH_ALIGN 4096
 #define TRI_NODE_SIZE 3
+/* Refit subtrees in parallel near the root, until there are this many. */
+#define BVH_REFIT_PARALLEL_SUBTREES 64
 /* Packed BVH
  *
  * BVH stored as it will be used for traversal on the rendering device. */
@@ -87,6 +89,13 @@ class BVH {
   vector<Geometry *> geometry;
   vector<Object *> objects;
 
+  /* SAH cost of the tree right after building and after the last refit.
+   * Refitting keeps the tree topology, so its quality degrades as primitives
+   * move away from where they were when it was built. Only tracked for object
+   * level BVHs with the layouts built by Cycles itself, zero otherwise. */
+  float build_sah_cost;
+  float refit_sah_cost;
+
   static BVH *create(const BVHParams &params,
                      const vector<Geometry *> &geometry,
                      const vector<Object *> &objects);
@@ -100,6 +109,8 @@ class BVH {
   }
 
   void refit(Progress &progress);
+  /* Whether the tree degraded enough since building to be worth rebuilding. */
+  bool refit_degraded() const;
 
  protected:
   BVH(const BVHParams &params,
@@ -109,6 +120,17 @@ class BVH {
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
 
+  /* Refit children of an inner node, given as encoded node indices where zero
+   * is an unused child slot. */
+  void refit_children(const int *child,
+                      int num_children,
+                      BoundBox *child_bbox,
+                      uint *child_visibility,
+                      float *child_sah_cost,
+                      int num_subtrees);
+  void refit_node_task(
+      int idx, bool leaf, BoundBox *bbox, uint *visibility, float *sah_cost, int num_subtrees);
+
   /* triangles and strands */
   void pack_primitives();
   void pack_triangle(int idx, float4 storage[3]);
@@ -119,6 +141,16 @@ class BVH {
   /* for subclasses to implement */
   virtual void pack_nodes(const BVHNode *root) = 0;
   virtual void refit_nodes() = 0;
+  /* Refit node and its subtree. The SAH cost of the subtree is not normalized
+   * by the area of the root yet. Only needed for layouts using refit_children(). */
+  virtual void refit_node(int /*idx*/,
+                          bool /*leaf*/,
+                          BoundBox & /*bbox*/,
+                          uint & /*visibility*/,
+                          float & /*sah_cost*/,
+                          int /*num_subtrees*/)
+  {
+  }
 
   virtual BVHNode *widen_children_nodes(const BVHNode *root) = 0;
 };
@@ -241,10 +241,14 @@ void BVH2::refit_nodes()
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah_cost = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, sah_cost, 1);
+
+  refit_sah_cost = sah_cost / bbox.safe_area();
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(
+    int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah_cost, int num_subtrees)
 {
   if (leaf) {
     /* refit leaf node */
@@ -254,6 +258,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c1 = data[0].y;
 
     BVH::refit_primitives(c0, c1, bbox, visibility);
+    sah_cost = bbox.safe_area() * params.primitive_cost(c1 - c0);
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -268,14 +273,18 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
 
     const int4 *data = &pack.nodes[idx];
     const bool is_unaligned = (data[0].x & PATH_RAY_NODE_UNALIGNED) != 0;
-    const int c0 = data[0].z;
-    const int c1 = data[0].w;
+    const int c[2] = {data[0].z, data[0].w};
+    const int c0 = c[0];
+    const int c1 = c[1];
     /* refit inner node, set bbox from children */
-    BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
-    uint visibility0 = 0, visibility1 = 0;
+    BoundBox child_bbox[2] = {BoundBox::empty, BoundBox::empty};
+    uint child_visibility[2] = {0, 0};
+    float child_sah_cost[2] = {0.0f, 0.0f};
+
+    refit_children(c, 2, child_bbox, child_visibility, child_sah_cost, num_subtrees);
 
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    const BoundBox &bbox0 = child_bbox[0], &bbox1 = child_bbox[1];
+    const uint visibility0 = child_visibility[0], visibility1 = child_visibility[1];
 
     if (is_unaligned) {
       Transform aligned_space = transform_identity();
@@ -289,6 +298,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    sah_cost = child_sah_cost[0] + child_sah_cost[1] + bbox.safe_area() * params.node_cost(2);
   }
 }
 
@@ -85,7 +85,12 @@ class BVH2 : public BVH {
 
   /* refit */
   void refit_nodes() override;
-  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+  void refit_node(int idx,
+                  bool leaf,
+                  BoundBox &bbox,
+                  uint &visibility,
+                  float &sah_cost,
+                  int num_subtrees) override;
 };
 
 CCL_NAMESPACE_END
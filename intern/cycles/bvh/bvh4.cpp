@@ -379,10 +379,14 @@ void BVH4::refit_nodes()
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah_cost = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, sah_cost, 1);
+
+  refit_sah_cost = sah_cost / bbox.safe_area();
 }
 
-void BVH4::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH4::refit_node(
+    int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah_cost, int num_subtrees)
 {
   if (leaf) {
     /* Refit leaf node. */
@@ -390,6 +394,7 @@ void BVH4::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     int4 c = data[0];
 
     BVH::refit_primitives(c.x, c.y, bbox, visibility);
+    sah_cost = bbox.safe_area() * params.primitive_cost(c.y - c.x);
 
     /* TODO(sergey): This is actually a copy of pack_leaf(),
      * but this chunk of code only knows actual data and has
@@ -421,16 +426,20 @@ void BVH4::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     /* Refit inner node, set bbox from children. */
     BoundBox child_bbox[4] = {BoundBox::empty, BoundBox::empty, BoundBox::empty, BoundBox::empty};
     uint child_visibility[4] = {0};
+    float child_sah_cost[4] = {0.0f};
     int num_nodes = 0;
 
+    refit_children(&c[0], 4, child_bbox, child_visibility, child_sah_cost, num_subtrees);
+
     for (int i = 0; i < 4; ++i) {
       if (c[i] != 0) {
-        refit_node((c[i] < 0) ? -c[i] - 1 : c[i], (c[i] < 0), child_bbox[i], child_visibility[i]);
         ++num_nodes;
         bbox.grow(child_bbox[i]);
         visibility |= child_visibility[i];
+        sah_cost += child_sah_cost[i];
       }
     }
+    sah_cost += bbox.safe_area() * params.node_cost(num_nodes);
 
     if (is_unaligned) {
       Transform aligned_space[4] = {
@@ -410,80 +410,21 @@ void BVH8::refit_nodes()
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah_cost = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, sah_cost, 1);
+
+  refit_sah_cost = sah_cost / bbox.safe_area();
 }
 
-void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH8::refit_node(
+    int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah_cost, int num_subtrees)
 {
   if (leaf) {
     int4 *data = &pack.leaf_nodes[idx];
     int4 c = data[0];
     /* Refit leaf node. */
-    for (int prim = c.x; prim < c.y; prim++) {
-      int pidx = pack.prim_index[prim];
-      int tob = pack.prim_object[prim];
-      Object *ob = objects[tob];
-
-      if (pidx == -1) {
-        /* Object instance. */
-        bbox.grow(ob->bounds);
-      }
-      else {
-        /* Primitives. */
-        if (pack.prim_type[prim] & PRIMITIVE_ALL_CURVE) {
-          /* Curves. */
-          const Hair *hair = static_cast<const Hair *>(ob->geometry);
-          int prim_offset = (params.top_level) ? hair->prim_offset : 0;
-          Hair::Curve curve = hair->get_curve(pidx - prim_offset);
-          int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
-
-          curve.bounds_grow(k, &hair->curve_keys[0], &hair->curve_radius[0], bbox);
-
-          visibility |= PATH_RAY_CURVE;
-
-          /* Motion curves. */
-          if (hair->use_motion_blur) {
-            Attribute *attr = hair->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-
-            if (attr) {
-              size_t hair_size = hair->curve_keys.size();
-              size_t steps = hair->motion_steps - 1;
-              float3 *key_steps = attr->data_float3();
-
-              for (size_t i = 0; i < steps; i++) {
-                curve.bounds_grow(k, key_steps + i * hair_size, &hair->curve_radius[0], bbox);
-              }
-            }
-          }
-        }
-        else {
-          /* Triangles. */
-          const Mesh *mesh = static_cast<const Mesh *>(ob->geometry);
-          int prim_offset = (params.top_level) ? mesh->prim_offset : 0;
-          Mesh::Triangle triangle = mesh->get_triangle(pidx - prim_offset);
-          const float3 *vpos = &mesh->verts[0];
-
-          triangle.bounds_grow(vpos, bbox);
-
-          /* Motion triangles. */
-          if (mesh->use_motion_blur) {
-            Attribute *attr = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-
-            if (attr) {
-              size_t mesh_size = mesh->verts.size();
-              size_t steps = mesh->motion_steps - 1;
-              float3 *vert_steps = attr->data_float3();
-
-              for (size_t i = 0; i < steps; i++) {
-                triangle.bounds_grow(vert_steps + i * mesh_size, bbox);
-              }
-            }
-          }
-        }
-      }
-
-      visibility |= ob->visibility;
-    }
+    BVH::refit_primitives(c.x, c.y, bbox, visibility);
+    sah_cost = bbox.safe_area() * params.primitive_cost(c.y - c.x);
 
     float4 leaf_data[BVH_ONODE_LEAF_SIZE];
     leaf_data[0].x = __int_as_float(c.x);
@@ -506,21 +447,24 @@ void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
                               BoundBox::empty};
     int child[8];
     uint child_visibility[8] = {0};
+    float child_sah_cost[8] = {0.0f};
     int num_nodes = 0;
 
     for (int i = 0; i < 8; ++i) {
       child[i] = __float_as_int(data[(is_unaligned) ? 13 : 7][i]);
+    }
 
+    refit_children(child, 8, child_bbox, child_visibility, child_sah_cost, num_subtrees);
+
+    for (int i = 0; i < 8; ++i) {
       if (child[i] != 0) {
-        refit_node((child[i] < 0) ? -child[i] - 1 : child[i],
-                   (child[i] < 0),
-                   child_bbox[i],
-                   child_visibility[i]);
         ++num_nodes;
         bbox.grow(child_bbox[i]);
         visibility |= child_visibility[i];
+        sah_cost += child_sah_cost[i];
       }
     }
+    sah_cost += bbox.safe_area() * params.node_cost(num_nodes);
 
     if (is_unaligned) {
       Transform aligned_space[8] = {transform_identity(),
@@ -88,6 +88,10 @@ class BVHParams {
   /* Same as in SceneParams. */
   int bvh_type;
 
+  /* Refitted BVHs are rebuilt once their SAH cost grew by this factor compared
+   * to the cost right after building. */
+  float refit_max_sah_cost_ratio;
+
   /* These are needed for Embree. */
   int curve_flags;
   int curve_subdivisions;
@@ -122,6 +126,8 @@ class BVHParams {
 
     bvh_type = 0;
 
+    refit_max_sah_cost_ratio = 1.5f;
+
     curve_flags = 0;
     curve_subdivisions = 4;
   }
@@ -471,7 +471,14 @@ class CPUDevice : public Device {
       }
 
       TextureInfo &info = texture_info[flat_slot];
-      info.data = (uint64_t)mem.host_pointer;
+      if (mem.texture_cache_image) {
+        info.data = (uint64_t)mem.texture_cache_image;
+        info.use_cache = 1;
+      }
+      else {
+        info.data = (uint64_t)mem.host_pointer;
+        info.use_cache = 0;
+      }
       info.cl_buffer = 0;
       info.interpolation = mem.interpolation;
       info.extension = mem.extension;
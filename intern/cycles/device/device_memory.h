@@ -210,6 +210,8 @@ class device_memory {
   const char *name;
   InterpolationType interpolation;
   ExtensionType extension;
+  /* Image texture looked up through a texture cache on the host, CPU device only. */
+  TextureCacheImage *texture_cache_image;
 
   /* Pointers. */
   Device *device;
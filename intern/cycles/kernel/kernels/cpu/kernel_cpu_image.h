@@ -474,6 +474,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (UNLIKELY(info.use_cache)) {
+    /* Pixels are loaded on demand, without derivatives the most detailed MIP level is used. */
+    float r[4];
+    ((TextureCacheImage *)info.data)->lookup(x, y, 0.0f, 0.0f, 0.0f, 0.0f, r);
+    return make_float4(r[0], r[1], r[2], r[3]);
+  }
+
   switch (kernel_tex_type(id)) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -498,6 +505,22 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Lookup with the derivatives of the coordinates along the ray differentials, which select the
+ * MIP level of images loaded on demand. Images in memory have no MIP levels. */
+ccl_device float4 kernel_tex_image_interp_deriv(
+    KernelGlobals *kg, int id, float x, float y, float dxdx, float dydx, float dxdy, float dydy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (UNLIKELY(info.use_cache)) {
+    float r[4];
+    ((TextureCacheImage *)info.data)->lookup(x, y, dxdx, dydx, dxdy, dydy, r);
+    return make_float4(r[0], r[1], r[2], r[3]);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(
     KernelGlobals *kg, int id, float x, float y, float z, InterpolationType interp)
 {
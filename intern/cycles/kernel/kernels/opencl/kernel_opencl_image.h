@@ -202,6 +202,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Derivatives are only used by images loaded on demand, which are not supported here. */
+ccl_device float4 kernel_tex_image_interp_deriv(
+    KernelGlobals *kg, int id, float x, float y, float dxdx, float dydx, float dxdy, float dydy)
+{
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4
 kernel_tex_image_interp_3d(KernelGlobals *kg, int id, float x, float y, float z, int interp)
 {
@@ -18,14 +18,15 @@ CCL_NAMESPACE_BEGIN
 
 #ifdef __TEXTURES__
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+ccl_device float4 svm_image_texture(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
-  float4 r = kernel_tex_image_interp(kg, id, x, y);
+  float4 r = kernel_tex_image_interp_deriv(kg, id, x, y, dx.x, dx.y, dy.x, dy.y);
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -50,25 +51,64 @@ ccl_device_inline float3 texco_remap_square(float3 co)
   return (co - make_float3(0.5f, 0.5f, 0.5f)) * 2.0f;
 }
 
+ccl_device_inline float2 svm_image_texture_coordinates(float3 co, uint projection)
+{
+  if (projection == NODE_IMAGE_PROJ_SPHERE) {
+    return map_to_sphere(texco_remap_square(co));
+  }
+  else if (projection == NODE_IMAGE_PROJ_TUBE) {
+    return map_to_tube(texco_remap_square(co));
+  }
+  else {
+    return make_float2(co.x, co.y);
+  }
+}
+
+/* Texture coordinates derivative from the coordinates shifted along a ray differential,
+ * taking the shortest way around the seam of the sphere and tube projections. */
+ccl_device_inline float2 svm_image_texture_differential(float2 tex_co_shifted,
+                                                        float2 tex_co,
+                                                        uint projection)
+{
+  float2 d = tex_co_shifted - tex_co;
+  if (projection == NODE_IMAGE_PROJ_SPHERE || projection == NODE_IMAGE_PROJ_TUBE) {
+    if (d.x > 0.5f) {
+      d.x -= 1.0f;
+    }
+    else if (d.x < -0.5f) {
+      d.x += 1.0f;
+    }
+  }
+  return d;
+}
+
 ccl_device void svm_node_tex_image(
     KernelGlobals *kg, ShaderData *sd, float *stack, uint4 node, int *offset)
 {
   uint co_offset, out_offset, alpha_offset, flags;
+  uint projection, center_offset, dx_offset, dy_offset;
 
   svm_unpack_node_uchar4(node.z, &co_offset, &out_offset, &alpha_offset, &flags);
+  svm_unpack_node_uchar4(node.w, &projection, &center_offset, &dx_offset, &dy_offset);
 
   float3 co = stack_load_float3(stack, co_offset);
-  float2 tex_co;
-  if (node.w == NODE_IMAGE_PROJ_SPHERE) {
-    co = texco_remap_square(co);
-    tex_co = map_to_sphere(co);
-  }
-  else if (node.w == NODE_IMAGE_PROJ_TUBE) {
-    co = texco_remap_square(co);
-    tex_co = map_to_tube(co);
-  }
-  else {
-    tex_co = make_float2(co.x, co.y);
+  float2 tex_co = svm_image_texture_coordinates(co, projection);
+
+  /* Coordinates shifted along the ray differentials, only provided for images which may be
+   * loaded on demand (see #ShaderGraph::refine_image_differentials). */
+  float2 tex_dx = make_float2(0.0f, 0.0f);
+  float2 tex_dy = make_float2(0.0f, 0.0f);
+  if (stack_valid(center_offset)) {
+    float2 tex_co_center = svm_image_texture_coordinates(stack_load_float3(stack, center_offset),
+                                                         projection);
+    tex_dx = svm_image_texture_differential(
+        svm_image_texture_coordinates(stack_load_float3(stack, dx_offset), projection),
+        tex_co_center,
+        projection);
+    tex_dy = svm_image_texture_differential(
+        svm_image_texture_coordinates(stack_load_float3(stack, dy_offset), projection),
+        tex_co_center,
+        projection);
   }
 
   /* TODO(lukas): Consider moving tile information out of the SVM node.
@@ -114,7 +154,7 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
-  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, tex_dx, tex_dy, flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -122,8 +162,11 @@ ccl_device void svm_node_tex_image(
     stack_store_float(stack, alpha_offset, f.w);
 }
 
-ccl_device void svm_node_tex_image_box(KernelGlobals *kg, ShaderData *sd, float *stack, uint4 node)
+ccl_device void svm_node_tex_image_box(
+    KernelGlobals *kg, ShaderData *sd, float *stack, uint4 node, int *offset)
 {
+  uint4 data_node = read_node(kg, offset);
+
   /* get object space normal */
   float3 N = sd->N;
 
@@ -199,20 +242,50 @@ ccl_device void svm_node_tex_image_box(KernelGlobals *kg, ShaderData *sd, float
   float3 co = stack_load_float3(stack, co_offset);
   uint id = node.y;
 
+  /* Coordinates shifted along the ray differentials, see #svm_node_tex_image. */
+  float3 dx = make_float3(0.0f, 0.0f, 0.0f);
+  float3 dy = make_float3(0.0f, 0.0f, 0.0f);
+  if (stack_valid(data_node.x)) {
+    float3 co_center = stack_load_float3(stack, data_node.x);
+    dx = stack_load_float3(stack, data_node.y) - co_center;
+    dy = stack_load_float3(stack, data_node.z) - co_center;
+  }
+
   float4 f = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 
   /* Map so that no textures are flipped, rotation is somewhat arbitrary. */
   if (weight.x > 0.0f) {
+    const float sign = (signed_N.x < 0.0f) ? -1.0f : 1.0f;
     float2 uv = make_float2((signed_N.x < 0.0f) ? 1.0f - co.y : co.y, co.z);
-    f += weight.x * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.x * svm_image_texture(kg,
+                                      id,
+                                      uv.x,
+                                      uv.y,
+                                      make_float2(sign * dx.y, dx.z),
+                                      make_float2(sign * dy.y, dy.z),
+                                      flags);
   }
   if (weight.y > 0.0f) {
+    const float sign = (signed_N.y > 0.0f) ? -1.0f : 1.0f;
     float2 uv = make_float2((signed_N.y > 0.0f) ? 1.0f - co.x : co.x, co.z);
-    f += weight.y * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.y * svm_image_texture(kg,
+                                      id,
+                                      uv.x,
+                                      uv.y,
+                                      make_float2(sign * dx.x, dx.z),
+                                      make_float2(sign * dy.x, dy.z),
+                                      flags);
   }
   if (weight.z > 0.0f) {
+    const float sign = (signed_N.z > 0.0f) ? -1.0f : 1.0f;
     float2 uv = make_float2((signed_N.z > 0.0f) ? 1.0f - co.y : co.y, co.x);
-    f += weight.z * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.z * svm_image_texture(kg,
+                                      id,
+                                      uv.x,
+                                      uv.y,
+                                      make_float2(sign * dx.y, dx.x),
+                                      make_float2(sign * dy.y, dy.x),
+                                      flags);
   }
 
   if (stack_valid(out_offset))
@@ -242,7 +315,8 @@ ccl_device void svm_node_tex_environment(KernelGlobals *kg,
   else
     uv = direction_to_mirrorball(co);
 
-  float4 f = svm_image_texture(kg, id, uv.x, uv.y, flags);
+  float4 f = svm_image_texture(
+      kg, id, uv.x, uv.y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f), flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -200,8 +200,17 @@ void Geometry::compute_bvh(
       bvh->objects = objects;
 
       bvh->refit(*progress);
+
+      /* Refitting keeps the topology of the tree, so deformation gradually
+       * makes traversal slower. Rebuild once that outweighs the build time. */
+      if (bvh->refit_degraded()) {
+        VLOG(1) << "Rebuilding degraded BVH of " << name << ", SAH cost grew from "
+                << bvh->build_sah_cost << " to " << bvh->refit_sah_cost << ".";
+        need_update_rebuild = true;
+      }
     }
-    else {
+
+    if (!bvh || need_update_rebuild) {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
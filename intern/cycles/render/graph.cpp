@@ -16,6 +16,7 @@
 
 #include "render/attribute.h"
 #include "render/graph.h"
+#include "render/image.h"
 #include "render/nodes.h"
 #include "render/scene.h"
 #include "render/shader.h"
@@ -383,6 +384,9 @@ void ShaderGraph::finalize(Scene *scene, bool do_bump, bool do_simplify, bool bu
     if (do_bump)
       bump_from_displacement(bump_in_object_space);
 
+    if (scene->image_manager->use_texture_cache(scene))
+      refine_image_differentials();
+
     ShaderInput *surface_in = output()->input("Surface");
     ShaderInput *volume_in = output()->input("Volume");
 
@@ -953,6 +957,65 @@ void ShaderGraph::refine_bump_nodes()
   }
 }
 
+void ShaderGraph::refine_image_differentials()
+{
+  /* images loaded on demand read the MIP level matching the footprint of the lookup. like
+   * for bump mapping, we copy the sub-graph defined from the "vector" input of image texture
+   * nodes, with texture coordinates shifted by the ray differentials, and connect them to the
+   * "VectorX" and "VectorY" inputs. derivatives are taken relative to "VectorCenter".
+   *
+   * image nodes which are themselves a bump sample (shifted by dx or dy) use the unshifted
+   * center and the other direction from extra copies. */
+
+  vector<ShaderNode *> image_nodes;
+  foreach (ShaderNode *node, nodes) {
+    if (node->type == ImageTextureNode::node_type && node->input("Vector")->link) {
+      image_nodes.push_back(node);
+    }
+  }
+
+  foreach (ShaderNode *node, image_nodes) {
+    ShaderInput *vector_in = node->input("Vector");
+    ShaderNodeSet nodes_vector;
+    find_dependencies(nodes_vector, vector_in);
+
+    ShaderOutput *out = vector_in->link;
+    ShaderOutput *out_center = out, *out_x = out, *out_y = out;
+
+    if (node->bump == SHADER_BUMP_DX || node->bump == SHADER_BUMP_DY) {
+      ShaderNodeMap nodes_center;
+      copy_nodes(nodes_vector, nodes_center);
+      foreach (NodePair &pair, nodes_center) {
+        pair.second->bump = SHADER_BUMP_CENTER;
+        add(pair.second);
+      }
+      out_center = nodes_center[out->parent]->output(out->name());
+    }
+    if (node->bump != SHADER_BUMP_DX) {
+      ShaderNodeMap nodes_dx;
+      copy_nodes(nodes_vector, nodes_dx);
+      foreach (NodePair &pair, nodes_dx) {
+        pair.second->bump = SHADER_BUMP_DX;
+        add(pair.second);
+      }
+      out_x = nodes_dx[out->parent]->output(out->name());
+    }
+    if (node->bump != SHADER_BUMP_DY) {
+      ShaderNodeMap nodes_dy;
+      copy_nodes(nodes_vector, nodes_dy);
+      foreach (NodePair &pair, nodes_dy) {
+        pair.second->bump = SHADER_BUMP_DY;
+        add(pair.second);
+      }
+      out_y = nodes_dy[out->parent]->output(out->name());
+    }
+
+    connect(out_center, node->input("VectorCenter"));
+    connect(out_x, node->input("VectorX"));
+    connect(out_y, node->input("VectorY"));
+  }
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
   /* generate bump mapping automatically from displacement. bump mapping is
@@ -17,6 +17,7 @@
 #include "render/image.h"
 #include "device/device.h"
 #include "render/colorspace.h"
+#include "render/image_cache.h"
 #include "render/scene.h"
 #include "render/stats.h"
 
@@ -103,6 +104,7 @@ ImageManager::ImageManager(const DeviceInfo &info)
   /* Set image limits */
   max_num_images = TEX_NUM_MAX;
   has_half_images = info.has_half_images;
+  has_texture_cache = (info.type == DEVICE_CPU);
 
   for (size_t type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
     tex_num_images[type] = 0;
@@ -774,6 +776,59 @@ bool ImageManager::file_load_image(Image *img,
   return true;
 }
 
+bool ImageManager::use_texture_cache(const Scene *scene) const
+{
+  /* OSL looks up images through its own texture system. */
+  return has_texture_cache && scene->params.texture_cache_size > 0 && !osl_texture_system;
+}
+
+bool ImageManager::device_load_image_cached(Device *device, Image *img, int texture_limit)
+{
+  /* Only image files with a colorspace and alpha the cache can reproduce
+   * exactly, everything else is loaded into memory as usual. */
+  if (img->builtin_data || img->metadata.depth > 1) {
+    return false;
+  }
+  if (texture_limit > 0 && max(img->metadata.width, img->metadata.height) > (size_t)texture_limit) {
+    return false;
+  }
+  if (img->metadata.compress_as_srgb && img->metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  const bool has_alpha = (img->metadata.channels == 2 || img->metadata.channels >= 4);
+  if (has_alpha && !image_associate_alpha(img) && img->alpha_type != IMAGE_ALPHA_IGNORE) {
+    return false;
+  }
+
+  TextureCacheImage *cache_image = texture_cache->add_image(img->filename,
+                                                            img->metadata,
+                                                            img->alpha_type == IMAGE_ALPHA_IGNORE,
+                                                            img->interpolation,
+                                                            img->extension);
+  if (cache_image == NULL) {
+    return false;
+  }
+
+  /* The device only needs a texture slot pointing to the cache, keep a single
+   * pixel allocation so the slot is handled like any other image. */
+  device_vector<float4> *tex_img = new device_vector<float4>(
+      device, img->mem_name.c_str(), MEM_TEXTURE);
+
+  thread_scoped_lock device_lock(device_mutex);
+  float4 *pixels = tex_img->alloc(1, 1);
+  pixels[0] = make_float4(
+      TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+
+  img->mem = tex_img;
+  img->mem->interpolation = img->interpolation;
+  img->mem->extension = img->extension;
+  img->mem->texture_cache_image = cache_image;
+
+  tex_img->copy_to_device();
+
+  return true;
+}
+
 void ImageManager::device_load_image(
     Device *device, Scene *scene, ImageDataType type, int slot, Progress *progress)
 {
@@ -797,12 +852,19 @@ void ImageManager::device_load_image(
   /* Free previous texture in slot. */
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
+    TextureCacheImage *cache_image = img->mem->texture_cache_image;
     delete img->mem;
     img->mem = NULL;
+    if (cache_image) {
+      texture_cache->remove_image(cache_image);
+    }
   }
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache && device_load_image_cached(device, img, texture_limit)) {
+    /* Pixels are loaded on demand. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     device_vector<float4> *tex_img = new device_vector<float4>(
         device, img->mem_name.c_str(), MEM_TEXTURE);
 
@@ -983,7 +1045,11 @@ void ImageManager::device_free_image(Device *, ImageDataType type, int slot)
 
     if (img->mem) {
       thread_scoped_lock device_lock(device_mutex);
+      TextureCacheImage *cache_image = img->mem->texture_cache_image;
       delete img->mem;
+      if (cache_image) {
+        texture_cache->remove_image(cache_image);
+      }
     }
 
     delete img;
@@ -998,6 +1064,10 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     return;
   }
 
+  if (use_texture_cache(scene) && !texture_cache) {
+    texture_cache.reset(new ImageTextureCache(scene->params.texture_cache_size));
+  }
+
   TaskPool pool;
   for (int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
     for (size_t slot = 0; slot < images[type].size(); slot++) {
@@ -31,6 +31,7 @@
 CCL_NAMESPACE_BEGIN
 
 class Device;
+class ImageTextureCache;
 class Progress;
 class RenderStats;
 class Scene;
@@ -116,6 +117,9 @@ class ImageManager {
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
+  /* Image files may be loaded on demand instead of being read fully, see #ImageTextureCache. */
+  bool use_texture_cache(const Scene *scene) const;
+
   device_memory *image_memory(int flat_slot);
 
   void collect_statistics(RenderStats *stats);
@@ -169,6 +173,10 @@ class ImageManager {
   int max_num_images;
   bool has_half_images;
 
+  /* On demand loading of image files, only supported by the CPU device. */
+  bool has_texture_cache;
+  unique_ptr<ImageTextureCache> texture_cache;
+
   thread_mutex device_mutex;
   int animation_frame;
 
@@ -185,6 +193,7 @@ class ImageManager {
 
   void metadata_detect_colorspace(ImageMetaData &metadata, const char *file_format);
 
+  bool device_load_image_cached(Device *device, Image *img, int texture_limit);
   void device_load_image(
       Device *device, Scene *scene, ImageDataType type, int slot, Progress *progress);
   void device_free_image(Device *device, ImageDataType type, int slot);
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/image_cache.h"
+#include "render/colorspace.h"
+#include "render/image.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+
+#include <OpenImageIO/imagebufalgo.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Tile size used for textures written by make_texture() and for files that
+ * are not tiled themselves. */
+static const int TEXTURE_CACHE_TILE_SIZE = 64;
+
+class OIIOTextureCacheImage : public TextureCacheImage {
+ public:
+  OIIOTextureCacheImage(OIIO::TextureSystem *ts,
+                        OIIO::TextureSystem::TextureHandle *handle,
+                        int channels,
+                        bool ignore_alpha,
+                        ColorSpaceProcessor *processor,
+                        InterpolationType interpolation,
+                        ExtensionType extension)
+      : ts(ts),
+        handle(handle),
+        channels(channels),
+        ignore_alpha(ignore_alpha),
+        processor(processor)
+  {
+    switch (interpolation) {
+      case INTERPOLATION_CLOSEST:
+        options.interpmode = OIIO::TextureOpt::InterpClosest;
+        break;
+      case INTERPOLATION_LINEAR:
+        options.interpmode = OIIO::TextureOpt::InterpBilinear;
+        break;
+      default:
+        options.interpmode = OIIO::TextureOpt::InterpBicubic;
+        break;
+    }
+
+    switch (extension) {
+      case EXTENSION_EXTEND:
+        options.swrap = options.twrap = OIIO::TextureOpt::WrapClamp;
+        break;
+      case EXTENSION_CLIP:
+        options.swrap = options.twrap = OIIO::TextureOpt::WrapBlack;
+        break;
+      default:
+        options.swrap = options.twrap = OIIO::TextureOpt::WrapPeriodic;
+        break;
+    }
+  }
+
+  void lookup(
+      float x, float y, float dxdx, float dydx, float dxdy, float dydy, float result[4]) override
+  {
+    float pixel[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    /* Options may be modified by the lookup, so use a copy per thread. */
+    OIIO::TextureOpt opt = options;
+
+    /* Texture files are stored top to bottom, flip to match device textures. */
+    if (!ts->texture(
+            handle, NULL, opt, x, 1.0f - y, dxdx, -dydx, dxdy, -dydy, channels, pixel)) {
+      /* Clear the error so messages don't accumulate. */
+      ts->geterror();
+      result[0] = TEX_IMAGE_MISSING_R;
+      result[1] = TEX_IMAGE_MISSING_G;
+      result[2] = TEX_IMAGE_MISSING_B;
+      result[3] = TEX_IMAGE_MISSING_A;
+      return;
+    }
+
+    /* The kernel expects either single channel or RGBA images. */
+    switch (channels) {
+      case 1:
+        result[0] = result[1] = result[2] = pixel[0];
+        result[3] = 1.0f;
+        break;
+      case 2:
+        result[0] = result[1] = result[2] = pixel[0];
+        result[3] = pixel[1];
+        break;
+      default:
+        result[0] = pixel[0];
+        result[1] = pixel[1];
+        result[2] = pixel[2];
+        result[3] = (channels == 4) ? pixel[3] : 1.0f;
+        break;
+    }
+
+    if (ignore_alpha) {
+      result[3] = 1.0f;
+    }
+
+    if (processor) {
+      ColorSpaceManager::to_scene_linear(processor, result, 4);
+    }
+  }
+
+  OIIO::TextureSystem *ts;
+  OIIO::TextureSystem::TextureHandle *handle;
+  OIIO::TextureOpt options;
+  int channels;
+  bool ignore_alpha;
+  ColorSpaceProcessor *processor;
+};
+
+ImageTextureCache::ImageTextureCache(int max_memory_mb)
+{
+  /* Private texture system, so the memory budget only applies to our images. */
+  ts = OIIO::TextureSystem::create(false);
+  ts->attribute("max_memory_MB", (float)max_memory_mb);
+  ts->attribute("autotile", TEXTURE_CACHE_TILE_SIZE);
+  ts->attribute("automip", 1);
+
+  VLOG(1) << "Created image texture cache with a " << max_memory_mb << " MB budget.";
+}
+
+ImageTextureCache::~ImageTextureCache()
+{
+  VLOG(1) << "Image texture cache statistics:\n" << ts->getstats(1);
+
+  foreach (TextureCacheImage *image, images) {
+    delete image;
+  }
+  OIIO::TextureSystem::destroy(ts);
+}
+
+TextureCacheImage *ImageTextureCache::add_image(const string &filepath,
+                                                const ImageMetaData &metadata,
+                                                bool ignore_alpha,
+                                                InterpolationType interpolation,
+                                                ExtensionType extension)
+{
+  /* Prefer a tiled, MIP-mapped texture if one was written next to the image. */
+  string filepath_tx = texture_filepath(filepath);
+  ustring filename(path_exists(filepath_tx) ? filepath_tx : filepath);
+
+  OIIO::TextureSystem::TextureHandle *handle = ts->get_texture_handle(filename);
+  if (handle == NULL) {
+    ts->geterror();
+    return NULL;
+  }
+
+  const OIIO::ImageSpec *spec = ts->imagespec(handle, NULL, 0);
+  if (spec == NULL) {
+    VLOG(1) << "Failed to open " << filename << " through the texture cache: " << ts->geterror();
+    return NULL;
+  }
+
+  /* The images stored colorspace is converted when looking up pixels, sRGB is left
+   * to the kernel which knows about it through ImageMetaData.compress_as_srgb. */
+  ColorSpaceProcessor *processor = NULL;
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    processor = ColorSpaceManager::get_processor(metadata.colorspace);
+  }
+
+  TextureCacheImage *image = new OIIOTextureCacheImage(ts,
+                                                       handle,
+                                                       min(spec->nchannels, 4),
+                                                       ignore_alpha,
+                                                       processor,
+                                                       interpolation,
+                                                       extension);
+
+  VLOG(1) << "Using image texture cache for " << filename << " (" << spec->width << "x"
+          << spec->height << ", " << (spec->tile_width ? "tiled" : "not tiled") << ").";
+
+  thread_scoped_lock lock(images_mutex);
+  images.push_back(image);
+  return image;
+}
+
+void ImageTextureCache::remove_image(TextureCacheImage *image)
+{
+  thread_scoped_lock lock(images_mutex);
+  vector<TextureCacheImage *>::iterator it = std::find(images.begin(), images.end(), image);
+  if (it != images.end()) {
+    images.erase(it);
+    delete image;
+  }
+}
+
+bool ImageTextureCache::make_texture(const string &filepath,
+                                     const string &output_filepath,
+                                     string *error)
+{
+  OIIO::ImageSpec config;
+  config.tile_width = TEXTURE_CACHE_TILE_SIZE;
+  config.tile_height = TEXTURE_CACHE_TILE_SIZE;
+  config.attribute("maketx:filtername", "lanczos3");
+  config.attribute("maketx:updatemode", 1);
+
+  std::stringstream stream;
+  if (!OIIO::ImageBufAlgo::make_texture(
+          OIIO::ImageBufAlgo::MakeTxTexture, filepath, output_filepath, config, &stream)) {
+    if (error) {
+      *error = OIIO::geterror();
+    }
+    return false;
+  }
+
+  VLOG(1) << stream.str();
+  return true;
+}
+
+string ImageTextureCache::texture_filepath(const string &filepath)
+{
+  const size_t pos = filepath.rfind('.');
+  const size_t slash = filepath.find_last_of("/\\");
+  if (pos == string::npos || (slash != string::npos && pos < slash)) {
+    return filepath + ".tx";
+  }
+  return filepath.substr(0, pos) + ".tx";
+}
+
+CCL_NAMESPACE_END
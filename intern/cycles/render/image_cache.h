@@ -0,0 +1,68 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+
+#include <OpenImageIO/texture.h>
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_thread.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class ImageMetaData;
+
+/* Image Texture Cache
+ *
+ * Used by the CPU device to render image textures without loading them into
+ * memory up front. Images are registered with an OpenImageIO texture system,
+ * which reads tiles of the required MIP level on demand and evicts them again
+ * to stay within a memory budget.
+ *
+ * Files are best converted to tiled and MIP-mapped textures beforehand with
+ * make_texture(), otherwise tiles and MIP levels are generated on the fly. */
+
+class ImageTextureCache {
+ public:
+  explicit ImageTextureCache(int max_memory_mb);
+  ~ImageTextureCache();
+
+  /* Register an image file for on demand lookups. Returns NULL when the file
+   * can't be read through the cache, in which case it should be loaded fully. */
+  TextureCacheImage *add_image(const string &filepath,
+                               const ImageMetaData &metadata,
+                               bool ignore_alpha,
+                               InterpolationType interpolation,
+                               ExtensionType extension);
+  void remove_image(TextureCacheImage *image);
+
+  /* Write a tiled, MIP-mapped version of an image for efficient lookups. */
+  static bool make_texture(const string &filepath, const string &output_filepath, string *error);
+  /* Path of the tiled texture next to an image file, as written by make_texture(). */
+  static string texture_filepath(const string &filepath);
+
+ private:
+  OIIO::TextureSystem *ts;
+  thread_mutex images_mutex;
+  vector<TextureCacheImage *> images;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __IMAGE_CACHE_H__ */
@@ -266,6 +266,10 @@ NODE_DEFINE(ImageTextureNode)
   SOCKET_FLOAT(projection_blend, "Projection Blend", 0.0f);
 
   SOCKET_IN_POINT(vector, "Vector", make_float3(0.0f, 0.0f, 0.0f), SocketType::LINK_TEXTURE_UV);
+  SOCKET_IN_POINT(
+      vector_center, "VectorCenter", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
+  SOCKET_IN_POINT(vector_x, "VectorX", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
+  SOCKET_IN_POINT(vector_y, "VectorY", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
 
   SOCKET_OUT_COLOR(color, "Color");
   SOCKET_OUT_FLOAT(alpha, "Alpha");
@@ -415,6 +419,24 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
     int vector_offset = tex_mapping.compile_begin(compiler, vector_in);
     uint flags = 0;
 
+    /* Coordinates along the ray differentials, only linked for images which may be loaded on
+     * demand. The center is usually the vector itself. */
+    ShaderInput *vector_center_in = input("VectorCenter");
+    ShaderInput *vector_x_in = input("VectorX");
+    ShaderInput *vector_y_in = input("VectorY");
+    const bool use_differentials = vector_center_in->link && vector_x_in->link &&
+                                   vector_y_in->link;
+    int vector_center_offset = SVM_STACK_INVALID;
+    int vector_x_offset = SVM_STACK_INVALID;
+    int vector_y_offset = SVM_STACK_INVALID;
+    if (use_differentials) {
+      vector_center_offset = (vector_center_in->link == vector_in->link) ?
+                                 vector_offset :
+                                 tex_mapping.compile_begin(compiler, vector_center_in);
+      vector_x_offset = tex_mapping.compile_begin(compiler, vector_x_in);
+      vector_y_offset = tex_mapping.compile_begin(compiler, vector_y_in);
+    }
+
     if (compress_as_srgb) {
       flags |= NODE_IMAGE_COMPRESS_AS_SRGB;
     }
@@ -444,7 +466,8 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                                compiler.stack_assign_if_linked(color_out),
                                                compiler.stack_assign_if_linked(alpha_out),
                                                flags),
-                        projection);
+                        compiler.encode_uchar4(
+                            projection, vector_center_offset, vector_x_offset, vector_y_offset));
 
       if (num_nodes > 0) {
         for (int i = 0; i < num_nodes; i++) {
@@ -472,8 +495,16 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                                compiler.stack_assign_if_linked(alpha_out),
                                                flags),
                         __float_as_int(projection_blend));
+      compiler.add_node(vector_center_offset, vector_x_offset, vector_y_offset, 0);
     }
 
+    if (use_differentials) {
+      if (vector_center_offset != vector_offset) {
+        tex_mapping.compile_end(compiler, vector_center_in, vector_center_offset);
+      }
+      tex_mapping.compile_end(compiler, vector_x_in, vector_x_offset);
+      tex_mapping.compile_end(compiler, vector_y_in, vector_y_offset);
+    }
     tex_mapping.compile_end(compiler, vector_in, vector_offset);
   }
   else {
@@ -113,6 +113,9 @@ class ImageTextureNode : public ImageSlotTextureNode {
   float projection_blend;
   bool animated;
   float3 vector;
+  /* Coordinates at the center and shifted along the ray differentials, which select the MIP
+   * level of images loaded on demand (see #ShaderGraph::refine_image_differentials). */
+  float3 vector_center, vector_x, vector_y;
   ccl::vector<int> tiles;
 
   /* Runtime. */
@@ -169,6 +169,9 @@ class SceneParams {
   int num_bvh_time_steps;
   bool persistent_data;
   int texture_limit;
+  /* Memory budget in megabytes for loading image files on demand, zero to load
+   * all images fully before rendering. Only supported on the CPU. */
+  int texture_cache_size;
 
   bool background;
 
@@ -182,6 +185,7 @@ class SceneParams {
     num_bvh_time_steps = 0;
     persistent_data = false;
     texture_limit = 0;
+    texture_cache_size = 0;
     background = true;
   }
 
@@ -192,7 +196,8 @@ class SceneParams {
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size);
   }
 };
 
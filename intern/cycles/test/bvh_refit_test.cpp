@@ -0,0 +1,146 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+#include "testing/mock_log.h"
+
+#include "bvh/bvh.h"
+#include "device/device.h"
+#include "render/mesh.h"
+#include "render/scene.h"
+#include "util/util_logging.h"
+#include "util/util_progress.h"
+#include "util/util_stats.h"
+#include "util/util_task.h"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::HasSubstr;
+using testing::ScopedMockLog;
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of quads along each side of the test grid. */
+#define GRID_RES 32
+
+class BVHRefit : public testing::Test {
+ protected:
+  ScopedMockLog log;
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  DeviceScene *dscene;
+  SceneParams scene_params;
+  Progress progress;
+  Mesh mesh;
+
+  virtual void SetUp()
+  {
+    util_logging_start();
+    util_logging_verbosity_set(1);
+    TaskScheduler::init();
+
+    device_cpu = Device::create(device_info, stats, profiler, true);
+    dscene = new DeviceScene(device_cpu);
+
+    /* Flat grid of triangles, which the BVH splits evenly. */
+    mesh.reserve_mesh((GRID_RES + 1) * (GRID_RES + 1), GRID_RES * GRID_RES * 2);
+    for (int y = 0; y <= GRID_RES; y++) {
+      for (int x = 0; x <= GRID_RES; x++) {
+        mesh.add_vertex(make_float3((float)x, (float)y, 0.0f));
+      }
+    }
+    for (int y = 0; y < GRID_RES; y++) {
+      for (int x = 0; x < GRID_RES; x++) {
+        const int v = y * (GRID_RES + 1) + x;
+        mesh.add_triangle(v, v + 1, v + GRID_RES + 2, 0, false);
+        mesh.add_triangle(v, v + GRID_RES + 2, v + GRID_RES + 1, 0, false);
+      }
+    }
+  }
+
+  virtual void TearDown()
+  {
+    delete mesh.bvh;
+    mesh.bvh = NULL;
+    delete dscene;
+    delete device_cpu;
+    TaskScheduler::exit();
+  }
+
+  void compute_bvh()
+  {
+    mesh.need_update = true;
+    mesh.compute_bvh(device_cpu, dscene, &scene_params, &progress, 0, 1);
+  }
+};
+
+#define EXPECT_ANY_MESSAGE(log) EXPECT_CALL(log, Log(_, _, _)).Times(AnyNumber());
+
+#define CORRECT_INFO_MESSAGE(log, message) \
+  EXPECT_CALL(log, Log(google::INFO, _, HasSubstr(message)));
+
+#define INVALID_INFO_MESSAGE(log, message) \
+  EXPECT_CALL(log, Log(google::INFO, _, HasSubstr(message))).Times(0);
+
+/*
+ * Tests:
+ *  - Moving all vertices together keeps the quality of the tree, it is only refitted.
+ */
+TEST_F(BVHRefit, refit_keeps_tree)
+{
+  EXPECT_ANY_MESSAGE(log);
+  INVALID_INFO_MESSAGE(log, "Rebuilding degraded BVH");
+
+  compute_bvh();
+  ASSERT_NE((void *)NULL, mesh.bvh);
+  EXPECT_GT(mesh.bvh->build_sah_cost, 0.0f);
+
+  for (size_t i = 0; i < mesh.verts.size(); i++) {
+    mesh.verts[i] = mesh.verts[i] * 2.0f + make_float3(10.0f, 0.0f, 1.0f);
+  }
+  compute_bvh();
+
+  EXPECT_FALSE(mesh.bvh->refit_degraded());
+}
+
+/*
+ * Tests:
+ *  - Scattering the vertices makes the refitted tree overlap, which triggers a rebuild.
+ */
+TEST_F(BVHRefit, degraded_tree_rebuilds)
+{
+  EXPECT_ANY_MESSAGE(log);
+  CORRECT_INFO_MESSAGE(log, "Rebuilding degraded BVH");
+
+  compute_bvh();
+  ASSERT_NE((void *)NULL, mesh.bvh);
+
+  /* Swap vertices across the grid, so triangles of neighbor leaves end up far apart. */
+  const size_t num_verts = mesh.verts.size();
+  for (size_t i = 0; i < num_verts / 2; i += 2) {
+    std::swap(mesh.verts[i], mesh.verts[num_verts - 1 - i]);
+  }
+  compute_bvh();
+
+  /* The tree was built again for the new positions. */
+  ASSERT_NE((void *)NULL, mesh.bvh);
+  EXPECT_FALSE(mesh.bvh->refit_degraded());
+  EXPECT_EQ(mesh.bvh->refit_sah_cost, mesh.bvh->build_sah_cost);
+}
+
+CCL_NAMESPACE_END
@@ -1528,4 +1528,106 @@ TEST_F(RenderGraph, constant_fold_convert_color_float_color)
   graph.finalize(scene);
 }
 
+/*
+ * Tests:
+ *  - Coordinates shifted by the ray differentials for images loaded on demand.
+ */
+class RenderGraphTextureCache : public RenderGraph {
+ protected:
+  RenderGraphTextureCache() : RenderGraph()
+  {
+    scene_params.texture_cache_size = 64;
+  }
+};
+
+TEST_F(RenderGraphTextureCache, image_differentials)
+{
+  EXPECT_ANY_MESSAGE(log);
+
+  builder.add_node(ShaderNodeBuilder<TextureCoordinateNode>("TextureCoordinate"))
+      .add_node(ShaderNodeBuilder<ImageTextureNode>("ImageTexture"))
+      .add_connection("TextureCoordinate::UV", "ImageTexture::Vector")
+      .output_color("ImageTexture::Color");
+
+  graph.finalize(scene);
+
+  ShaderNode *image = builder.find_node("ImageTexture");
+  ShaderOutput *out = image->input("Vector")->link;
+  ShaderOutput *out_x = image->input("VectorX")->link;
+  ShaderOutput *out_y = image->input("VectorY")->link;
+  ASSERT_NE((void *)NULL, out);
+  ASSERT_NE((void *)NULL, out_x);
+  ASSERT_NE((void *)NULL, out_y);
+
+  EXPECT_EQ(image->input("VectorCenter")->link, out);
+  EXPECT_EQ(out_x->parent->type, TextureCoordinateNode::node_type);
+  EXPECT_EQ(out_y->parent->type, TextureCoordinateNode::node_type);
+  EXPECT_EQ(out_x->name(), out->name());
+  EXPECT_EQ(out_y->name(), out->name());
+  EXPECT_EQ(out_x->parent->bump, SHADER_BUMP_DX);
+  EXPECT_EQ(out_y->parent->bump, SHADER_BUMP_DY);
+}
+
+/*
+ * Tests:
+ *  - Images sampled for bump mapping use the center coordinates for their derivatives.
+ */
+TEST_F(RenderGraphTextureCache, image_differentials_bump)
+{
+  EXPECT_ANY_MESSAGE(log);
+
+  builder.add_node(ShaderNodeBuilder<TextureCoordinateNode>("TextureCoordinate"))
+      .add_node(ShaderNodeBuilder<ImageTextureNode>("ImageTexture"))
+      .add_node(ShaderNodeBuilder<BumpNode>("Bump"))
+      .add_node(ShaderNodeBuilder<DiffuseBsdfNode>("Diffuse"))
+      .add_connection("TextureCoordinate::UV", "ImageTexture::Vector")
+      .add_connection("ImageTexture::Alpha", "Bump::Height")
+      .add_connection("Bump::Normal", "Diffuse::Normal")
+      .output_closure("Diffuse::BSDF");
+
+  graph.finalize(scene);
+
+  int num_images = 0;
+  foreach (ShaderNode *node, graph.nodes) {
+    if (node->type != ImageTextureNode::node_type) {
+      continue;
+    }
+    num_images++;
+
+    ShaderOutput *out_center = node->input("VectorCenter")->link;
+    ShaderOutput *out_x = node->input("VectorX")->link;
+    ShaderOutput *out_y = node->input("VectorY")->link;
+    ASSERT_NE((void *)NULL, out_center);
+    ASSERT_NE((void *)NULL, out_x);
+    ASSERT_NE((void *)NULL, out_y);
+
+    EXPECT_EQ(out_center->parent->bump, SHADER_BUMP_CENTER);
+    EXPECT_EQ(out_x->parent->bump, SHADER_BUMP_DX);
+    EXPECT_EQ(out_y->parent->bump, SHADER_BUMP_DY);
+  }
+  /* Center, dx and dy samples of the bump node. */
+  EXPECT_EQ(num_images, 3);
+}
+
+/*
+ * Tests:
+ *  - No extra coordinates when images are loaded fully.
+ */
+TEST_F(RenderGraph, image_differentials_no_cache)
+{
+  EXPECT_ANY_MESSAGE(log);
+
+  builder.add_node(ShaderNodeBuilder<TextureCoordinateNode>("TextureCoordinate"))
+      .add_node(ShaderNodeBuilder<ImageTextureNode>("ImageTexture"))
+      .add_connection("TextureCoordinate::UV", "ImageTexture::Vector")
+      .output_color("ImageTexture::Color");
+
+  graph.finalize(scene);
+
+  ShaderNode *image = builder.find_node("ImageTexture");
+  EXPECT_EQ(image->input("VectorCenter")->link, (void *)NULL);
+  EXPECT_EQ(image->input("VectorX")->link, (void *)NULL);
+  EXPECT_EQ(image->input("VectorY")->link, (void *)NULL);
+}
+
 CCL_NAMESPACE_END
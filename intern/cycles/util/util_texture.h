@@ -97,8 +97,29 @@ typedef struct TextureInfo {
   uint interpolation, extension;
   /* Dimensions. */
   uint width, height, depth;
+  /* CPU only, data points to a #TextureCacheImage and pixels are loaded on demand. */
+  uint use_cache;
+  /* Padding to keep the size a multiple of 16 bytes, as required by OpenCL. */
+  uint pad[3];
 } TextureInfo;
 
+#ifndef __KERNEL_GPU__
+/* Image texture with pixels loaded on demand by a texture cache on the host,
+ * instead of being stored in device memory. */
+class TextureCacheImage {
+ public:
+  virtual ~TextureCacheImage()
+  {
+  }
+
+  /* Lookup RGBA at normalized coordinates, with (0, 0) at the bottom left like
+   * textures in device memory. Derivatives select the MIP level, zero derivatives
+   * give the most detailed level. */
+  virtual void lookup(
+      float x, float y, float dxdx, float dydx, float dxdy, float dydy, float result[4]) = 0;
+};
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
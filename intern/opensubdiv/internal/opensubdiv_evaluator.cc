@@ -113,6 +113,16 @@ void evaluatePatchesLimit(OpenSubdiv_Evaluator *evaluator,
       patch_coords, num_patch_coords, P, dPdu, dPdv);
 }
 
+void evaluatePatchesFaceVarying(OpenSubdiv_Evaluator *evaluator,
+                                const int face_varying_channel,
+                                const OpenSubdiv_PatchCoord *patch_coords,
+                                const int num_patch_coords,
+                                float *face_varying)
+{
+  evaluator->internal->eval_output->evaluatePatchesFaceVarying(
+      face_varying_channel, patch_coords, num_patch_coords, face_varying);
+}
+
 void evaluateVarying(OpenSubdiv_Evaluator *evaluator,
                      const int ptex_face_index,
                      float face_u,
@@ -150,6 +160,7 @@ void assignFunctionPointers(OpenSubdiv_Evaluator *evaluator)
   evaluator->evaluateFaceVarying = evaluateFaceVarying;
 
   evaluator->evaluatePatchesLimit = evaluatePatchesLimit;
+  evaluator->evaluatePatchesFaceVarying = evaluatePatchesFaceVarying;
 }
 
 }  // namespace
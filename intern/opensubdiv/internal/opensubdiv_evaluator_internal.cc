@@ -496,7 +496,7 @@ class VolatileEvalOutput {
   void evalPatchesFaceVarying(const int face_varying_channel,
                               const PatchCoord *patch_coord,
                               const int num_patch_coords,
-                              float face_varying[2])
+                              float *face_varying)
   {
     assert(face_varying_channel >= 0);
     assert(face_varying_channel < face_varying_evaluators.size());
@@ -732,6 +732,17 @@ void CpuEvalOutputAPI::evaluatePatchesLimit(const OpenSubdiv_PatchCoord *patch_c
   }
 }
 
+void CpuEvalOutputAPI::evaluatePatchesFaceVarying(const int face_varying_channel,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float *face_varying)
+{
+  StackOrHeapPatchCoordArray patch_coords_array;
+  convertPatchCoordsToArray(patch_coords, num_patch_coords, patch_map_, &patch_coords_array);
+  implementation_->evalPatchesFaceVarying(
+      face_varying_channel, patch_coords_array.data(), num_patch_coords, face_varying);
+}
+
 }  // namespace opensubdiv_capi
 
 OpenSubdiv_EvaluatorInternal::OpenSubdiv_EvaluatorInternal()
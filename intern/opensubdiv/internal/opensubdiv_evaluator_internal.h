@@ -127,6 +127,14 @@ class CpuEvalOutputAPI {
                             float *dPdu,
                             float *dPdv);
 
+  // Evaluate face-varying data of the given channel.
+  //
+  // NOTE: Output array must point to a memory of size float[2]*num_patch_coords.
+  void evaluatePatchesFaceVarying(const int face_varying_channel,
+                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                  const int num_patch_coords,
+                                  float *face_varying);
+
  protected:
   CpuEvalOutput *implementation_;
   OpenSubdiv::Far::PatchMap *patch_map_;
@@ -122,6 +122,15 @@ typedef struct OpenSubdiv_Evaluator {
                                float *dPdu,
                                float *dPdv);
 
+  // Evaluate face-varying data of the given channel.
+  //
+  // NOTE: Output array must point to a memory of size float[2]*num_patch_coords.
+  void (*evaluatePatchesFaceVarying)(struct OpenSubdiv_Evaluator *evaluator,
+                                     const int face_varying_channel,
+                                     const struct OpenSubdiv_PatchCoord *patch_coords,
+                                     const int num_patch_coords,
+                                     float *face_varying);
+
   // Internal storage for the use in this module only.
   //
   // This is where actual OpenSubdiv's evaluator is living.
@@ -23,6 +23,9 @@
 #include "MEM_guardedalloc.h"
 #include "openvdb/tools/Composite.h"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 OpenVDBLevelSet::OpenVDBLevelSet()
 {
   openvdb::initialize();
@@ -42,13 +45,21 @@ void OpenVDBLevelSet::mesh_to_level_set(const float *vertices,
   std::vector<openvdb::Vec3I> triangles(totfaces);
   std::vector<openvdb::Vec4I> quads;
 
-  for (unsigned int i = 0; i < totvertices; i++) {
-    points[i] = openvdb::Vec3s(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
-  }
-
-  for (unsigned int i = 0; i < totfaces; i++) {
-    triangles[i] = openvdb::Vec3I(faces[i * 3], faces[i * 3 + 1], faces[i * 3 + 2]);
-  }
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, totvertices),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t i = range.begin(); i != range.end(); i++) {
+                        points[i] = openvdb::Vec3s(
+                            vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+                      }
+                    });
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, totfaces),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t i = range.begin(); i != range.end(); i++) {
+                        triangles[i] = openvdb::Vec3I(
+                            faces[i * 3], faces[i * 3 + 1], faces[i * 3 + 2]);
+                      }
+                    });
 
   this->grid = openvdb::tools::meshToLevelSet<openvdb::FloatGrid>(
       *xform, points, triangles, quads, 1);
@@ -83,24 +94,33 @@ void OpenVDBLevelSet::volume_to_mesh(OpenVDBVolumeToMeshData *mesh,
   mesh->tottriangles = out_tris.size();
   mesh->totquads = out_quads.size();
 
-  for (size_t i = 0; i < out_points.size(); i++) {
-    mesh->vertices[i * 3] = out_points[i].x();
-    mesh->vertices[i * 3 + 1] = out_points[i].y();
-    mesh->vertices[i * 3 + 2] = out_points[i].z();
-  }
-
-  for (size_t i = 0; i < out_quads.size(); i++) {
-    mesh->quads[i * 4] = out_quads[i].x();
-    mesh->quads[i * 4 + 1] = out_quads[i].y();
-    mesh->quads[i * 4 + 2] = out_quads[i].z();
-    mesh->quads[i * 4 + 3] = out_quads[i].w();
-  }
-
-  for (size_t i = 0; i < out_tris.size(); i++) {
-    mesh->triangles[i * 3] = out_tris[i].x();
-    mesh->triangles[i * 3 + 1] = out_tris[i].y();
-    mesh->triangles[i * 3 + 2] = out_tris[i].z();
-  }
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, out_points.size()),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t i = range.begin(); i != range.end(); i++) {
+                        mesh->vertices[i * 3] = out_points[i].x();
+                        mesh->vertices[i * 3 + 1] = out_points[i].y();
+                        mesh->vertices[i * 3 + 2] = out_points[i].z();
+                      }
+                    });
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, out_quads.size()),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t i = range.begin(); i != range.end(); i++) {
+                        mesh->quads[i * 4] = out_quads[i].x();
+                        mesh->quads[i * 4 + 1] = out_quads[i].y();
+                        mesh->quads[i * 4 + 2] = out_quads[i].z();
+                        mesh->quads[i * 4 + 3] = out_quads[i].w();
+                      }
+                    });
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, out_tris.size()),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t i = range.begin(); i != range.end(); i++) {
+                        mesh->triangles[i * 3] = out_tris[i].x();
+                        mesh->triangles[i * 3 + 1] = out_tris[i].y();
+                        mesh->triangles[i * 3 + 2] = out_tris[i].z();
+                      }
+                    });
 }
 
 void OpenVDBLevelSet::filter(OpenVDBLevelSet_FilterType filter_type,
@@ -324,6 +324,10 @@ class PHYSICS_PT_cloth_collision(PhysicButtonsPanel, Panel):
         col = flow.column()
         col.prop(cloth, "collision_quality", text="Quality")
 
+        col = flow.column()
+        col.prop(cloth, "collision_broadphase")
+        col.prop(cloth, "use_continuous_collision")
+
 
 class PHYSICS_PT_cloth_object_collision(PhysicButtonsPanel, Panel):
     bl_label = "Object Collisions"
@@ -67,7 +67,11 @@ int where_on_path(struct Object *ob,
 struct ListBase *object_duplilist(struct Depsgraph *depsgraph,
                                   struct Scene *sce,
                                   struct Object *ob);
+struct ListBase *object_duplilist_cached(struct Depsgraph *depsgraph,
+                                         struct Scene *sce,
+                                         struct Object *ob);
 void free_object_duplilist(struct ListBase *lb);
+void object_duplilist_cache_free(struct Object *ob);
 
 typedef struct DupliObject {
   struct DupliObject *next, *prev;
@@ -90,6 +90,7 @@ typedef struct Cloth {
   int last_frame;
   float initial_mesh_volume; /* Initial volume of the mesh. Used for pressure */
   struct MEdge *edges;       /* Used for hair collisions. */
+  struct ClothSpringGroups *spring_groups; /* Springs grouped for multi-threaded forces. */
 } Cloth;
 
 /**
@@ -226,8 +227,16 @@ typedef enum {
 typedef enum {
   CLOTH_COLLSETTINGS_FLAG_ENABLED = (1 << 1), /* enables cloth - object collisions */
   CLOTH_COLLSETTINGS_FLAG_SELF = (1 << 2),    /* enables selfcollisions */
+  /** Detect faces passing through each other during a collision step. */
+  CLOTH_COLLSETTINGS_FLAG_CONTINUOUS = (1 << 3),
 } CLOTH_COLLISIONSETTINGS_FLAGS;
 
+/* ClothCollSettings.broadphase. */
+typedef enum {
+  CLOTH_COLLISION_BROADPHASE_BVH = 0,
+  CLOTH_COLLISION_BROADPHASE_GRID = 1,
+} CLOTH_COLLISION_BROADPHASE;
+
 /* Spring types as defined in the paper.*/
 typedef enum {
   CLOTH_SPRING_TYPE_STRUCTURAL = (1 << 1),
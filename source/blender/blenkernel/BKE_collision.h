@@ -135,6 +135,14 @@ void collision_get_collider_velocity(float vel_old[3],
                                      struct CollisionModifierData *collmd,
                                      struct CollPair *collpair);
 
+/* Continuous collision check of two moving triangles. */
+bool BKE_collision_tri_tri_crossed(const float *a_prev[3],
+                                   const float *b_prev[3],
+                                   const float *a_next[3],
+                                   const float *b_next[3],
+                                   const float epsilon,
+                                   float r_vec[3]);
+
 /* Collision relations for dependency graph build. */
 
 typedef struct CollisionRelation {
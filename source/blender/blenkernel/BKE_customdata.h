@@ -73,6 +73,12 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Use data pointers of layers with a shared storage (see #CustomData_ensure_shared) and add
+   * a user to it, the data is freed by the last user. Other layers are duplicated.
+   * Layers need to be duplicated before modification, like referenced ones.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -231,6 +237,9 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
                                                   const char *name,
                                                   const int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
+void *CustomData_unshare_layer(struct CustomData *data, const int type, const int totelem);
+
+void CustomData_ensure_shared(struct CustomData *data, int totelem);
 
 /* set the CD_FLAG_NOCOPY flag in custom data layers where the mask is
  * zero for the layer type, so only layer types specified by the mask
@@ -394,6 +403,7 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 void CustomData_clear_layer_flag(struct CustomData *data, int type, int flag);
 
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void *block);
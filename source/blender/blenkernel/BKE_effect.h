@@ -127,6 +127,15 @@ void BKE_effectors_apply(struct ListBase *effectors,
                          struct EffectedPoint *point,
                          float *force,
                          float *impulse);
+void BKE_effectors_apply_array(struct ListBase *effectors,
+                               struct ListBase *colliders,
+                               struct EffectorWeights *weights,
+                               const struct EffectedPoint *point_template,
+                               const float (*locs)[3],
+                               const float (*vels)[3],
+                               int totpoint,
+                               float (*r_forces)[3],
+                               float (*r_impulses)[3]);
 void BKE_effectors_free(struct ListBase *lb);
 
 void pd_point_from_particle(struct ParticleSimulationData *sim,
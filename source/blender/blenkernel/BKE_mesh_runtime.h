@@ -35,6 +35,8 @@ struct MLoop;
 struct MLoopTri;
 struct MVertTri;
 struct Mesh;
+struct MeshSharedEval;
+struct ModifierCacheKey;
 struct Object;
 struct Scene;
 
@@ -43,6 +45,17 @@ void BKE_mesh_runtime_reset_on_copy(struct Mesh *mesh, const int flag);
 int BKE_mesh_runtime_looptri_len(const struct Mesh *mesh);
 void BKE_mesh_runtime_looptri_recalc(struct Mesh *mesh);
 const struct MLoopTri *BKE_mesh_runtime_looptri_ensure(struct Mesh *mesh);
+void BKE_mesh_runtime_looptri_copy_from(struct Mesh *mesh, struct Mesh *mesh_src);
+bool BKE_mesh_runtime_looptri_is_coords_independent(const struct Mesh *mesh);
+struct MeshSharedEval *BKE_mesh_runtime_shared_eval_acquire(struct Mesh *mesh,
+                                                            const struct ModifierCacheKey *key,
+                                                            int update_count,
+                                                            struct Mesh **r_mesh_eval,
+                                                            bool *r_is_evaluated);
+void BKE_mesh_runtime_shared_eval_release(struct Mesh *mesh,
+                                          struct MeshSharedEval *shared,
+                                          struct Mesh *mesh_eval);
+void BKE_mesh_runtime_shared_eval_clear(struct Mesh *mesh);
 bool BKE_mesh_runtime_ensure_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_clear_edit_data(struct Mesh *mesh);
 void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
@@ -101,6 +101,11 @@ typedef enum {
   /* For modifiers that use CD_PREVIEW_MCOL for preview. */
   eModifierTypeFlag_UsesPreview = (1 << 9),
   eModifierTypeFlag_AcceptsLattice = (1 << 10),
+
+  /* For modifiers which result only depends on the input mesh, the settings and the transform
+   * and geometry of linked objects, so it can be reused while none of these change.
+   * The settings should not hold pointers to owned data (IDs are fine). */
+  eModifierTypeFlag_SupportsResultCache = (1 << 11),
 } ModifierTypeFlag;
 
 /* IMPORTANT! Keep ObjectWalkFunc and IDWalkFunc signatures compatible. */
@@ -465,6 +470,33 @@ void modwrap_deformVertsEM(ModifierData *md,
 struct Mesh *BKE_modifier_get_evaluated_mesh_from_evaluated_object(struct Object *ob_eval,
                                                                    const bool get_cage_mesh);
 
+/* Cache of modifier results of the evaluated object (modifier_cache.c). */
+
+typedef struct ModifierCacheKey {
+  /** Two differently seeded hashes of everything the result depends on. */
+  uint32_t hash[2];
+  /** Element counts of the input mesh, compared exactly. */
+  int totvert, totedge, totloop, totpoly;
+} ModifierCacheKey;
+
+bool BKE_modifier_cache_mesh_key(const struct Mesh *mesh, ModifierCacheKey *r_key);
+bool BKE_modifier_cache_key(const struct ModifierEvalContext *ctx,
+                            struct ModifierData *md,
+                            const struct CustomData_MeshMasks *mask,
+                            const struct Mesh *mesh_input,
+                            const ModifierCacheKey *input_key,
+                            ModifierCacheKey *r_key);
+bool BKE_modifier_cache_key_equals(const ModifierCacheKey *key_a, const ModifierCacheKey *key_b);
+struct Mesh *BKE_modifier_cache_lookup(struct Object *ob_eval,
+                                       struct ModifierData *md,
+                                       const ModifierCacheKey *key);
+void BKE_modifier_cache_store(struct Object *ob_eval,
+                              struct ModifierData *md,
+                              const ModifierCacheKey *key,
+                              struct Mesh *mesh);
+void BKE_modifier_cache_prune(struct Object *ob_eval);
+void BKE_modifier_cache_free(struct Object *ob_eval);
+
 #ifdef __cplusplus
 }
 #endif
@@ -163,6 +163,8 @@ typedef struct ParticleThreadContext {
 
   /* path caching */
   bool editupdate;
+  /* Only update children of parents with changed paths. */
+  bool incremental;
   int between, segments, extra_segments;
   int totchild, totparent, parent_pass;
 
@@ -45,6 +45,8 @@
 
 /* Add the blendfile name after blendcache_ */
 #define PTCACHE_EXT ".bphys"
+/* Baked disk caches, multiple frames per file. */
+#define PTCACHE_PACK_EXT ".bpack"
 #define PTCACHE_PATH "blendcache_"
 
 /* File open options, for BKE_ptcache_file_open */
@@ -104,6 +106,8 @@ typedef struct PTCacheData {
 
 typedef struct PTCacheFile {
   FILE *fp;
+  /** Bytes left to read, frames read from a pack are followed by other frames. */
+  size_t remaining;
 
   int frame, old_format;
   unsigned int totpoint, type;
@@ -27,6 +27,7 @@
 #include "BLI_sys_types.h"
 
 struct Mesh;
+struct OpenSubdiv_PatchCoord;
 struct Subdiv;
 
 /* Returns true if evaluator is ready for use. */
@@ -92,6 +93,24 @@ void BKE_subdiv_eval_displacement(struct Subdiv *subdiv,
 void BKE_subdiv_eval_final_point(
     struct Subdiv *subdiv, const int ptex_face_index, const float u, const float v, float r_P[3]);
 
+/* Batched queries.
+ *
+ * Evaluate an array of points at once, which avoids per-point overhead of the evaluator.
+ * Output arrays are to be allocated for num_patch_coords elements. */
+
+void BKE_subdiv_eval_limit_points_and_derivatives(struct Subdiv *subdiv,
+                                                  const struct OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3]);
+
+void BKE_subdiv_eval_face_varying_points(struct Subdiv *subdiv,
+                                         const int face_varying_channel,
+                                         const struct OpenSubdiv_PatchCoord *patch_coords,
+                                         const int num_patch_coords,
+                                         float (*r_face_varying)[2]);
+
 /* Patch queries at given resolution.
  *
  * Will evaluate patch at uniformly distributed (u, v) coordinates on a grid
@@ -921,6 +921,15 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   const ModifierEvalContext mectx = {depsgraph, ob, app_render | app_cache};
   const ModifierEvalContext mectx_orco = {depsgraph, ob, app_render | MOD_APPLY_ORCO};
 
+  /* Results of expensive modifiers are kept in the evaluated object and reused while their input
+   * and settings do not change. Only done for the interactive viewport evaluation of the whole
+   * stack. While consecutive modifiers are served from the cache, the key of the input mesh is
+   * derived from the key of the previous result instead of hashing the mesh again. */
+  const bool use_result_cache = !use_render && !sculpt_mode && index == -1 &&
+                                DEG_is_evaluating(depsgraph) && DEG_is_evaluated_object(ob);
+  bool is_result_key_valid = false;
+  ModifierCacheKey result_key = {{0}};
+
   /* Get effective list of modifiers to execute. Some effects like shape keys
    * are added as virtual modifiers before the user created modifiers. */
   VirtualModifierData virtualModifierData;
@@ -1103,6 +1112,7 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
       }
       modwrap_deformVerts(md, &mectx, mesh_final, deformed_verts, num_deformed_verts);
+      is_result_key_valid = false;
     }
     else {
       have_non_onlydeform_modifiers_appled = true;
@@ -1184,8 +1194,33 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         }
       }
 
-      Mesh *mesh_next = modwrap_applyModifier(md, &mectx, mesh_final);
+      /* Orco meshes are evaluated along with the final mesh, they are not cached. */
+      bool use_result_cache_md = use_result_cache && mesh_orco == NULL &&
+                                 mesh_orco_cloth == NULL &&
+                                 ((nextmask.vmask | mask.vmask) &
+                                  (CD_MASK_ORCO | CD_MASK_CLOTH_ORCO)) == 0;
+      ModifierCacheKey input_key = result_key;
+      if (use_result_cache_md && !is_result_key_valid) {
+        use_result_cache_md = BKE_modifier_cache_mesh_key(mesh_final, &input_key);
+      }
+      if (use_result_cache_md) {
+        use_result_cache_md = BKE_modifier_cache_key(
+            &mectx, md, &mask, mesh_final, &input_key, &result_key);
+      }
+
+      Mesh *mesh_next = NULL;
+      if (use_result_cache_md) {
+        mesh_next = BKE_modifier_cache_lookup(ob, md, &result_key);
+      }
+      if (mesh_next == NULL) {
+        mesh_next = modwrap_applyModifier(md, &mectx, mesh_final);
+        /* Results with warnings are not stored, so the warning is not lost on the next update. */
+        if (use_result_cache_md && mesh_next && md->error == NULL) {
+          BKE_modifier_cache_store(ob, md, &result_key, mesh_next);
+        }
+      }
       ASSERT_IS_VALID_MESH(mesh_next);
+      is_result_key_valid = use_result_cache_md && mesh_next;
 
       if (mesh_next) {
         /* if the modifier returned a new mesh, release the old one */
@@ -1287,6 +1322,10 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
     modifier_freeTemporaryData(md);
   }
 
+  if (use_result_cache) {
+    BKE_modifier_cache_prune(ob);
+  }
+
   /* Yay, we are done. If we have a Mesh and deformed vertices,
    * we need to apply these back onto the Mesh. If we have no
    * Mesh then we need to build one. */
@@ -1336,6 +1375,16 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* Compute normals. */
   if (is_own_mesh) {
     mesh_calc_modifier_final_normals(mesh_input, &final_datamask, sculpt_dyntopo, mesh_final);
+
+    /* Deform-only stacks share topology arrays with the input mesh. For triangle meshes its
+     * triangulation stays valid for the deformed vertices: copy it instead of tessellating all
+     * polygons again. */
+    if (mesh_final->totpoly != 0 && mesh_final->mpoly == mesh_input->mpoly &&
+        mesh_final->mloop == mesh_input->mloop && mesh_final->totpoly == mesh_input->totpoly &&
+        mesh_final->totloop == mesh_input->totloop &&
+        BKE_mesh_runtime_looptri_is_coords_independent(mesh_final)) {
+      BKE_mesh_runtime_looptri_copy_from(mesh_final, mesh_input);
+    }
   }
   else {
     Mesh_Runtime *runtime = &mesh_input->runtime;
@@ -1776,6 +1825,149 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Key of the result of the modifier stack of the object, used to evaluate the stack only once for
+ * all objects using the same mesh with identical stacks. Only stacks of constructive modifiers in
+ * object mode are shared: deform modifiers need a per-object deformed mesh, and the other modes
+ * preview or edit data of the object. Like the result cache, only modifiers supporting it are
+ * shared, their inputs are hashed entirely.
+ */
+static bool mesh_shared_eval_key(struct Depsgraph *depsgraph,
+                                 Scene *scene,
+                                 Object *ob,
+                                 const CustomData_MeshMasks *dataMask,
+                                 const bool need_mapping,
+                                 ModifierCacheKey *r_key)
+{
+  if (ob->mode != OB_MODE_OBJECT || ob->sculpt != NULL) {
+    return false;
+  }
+  /* Tessellated faces are not kept by copies of the result. */
+  if (dataMask->fmask & CD_MASK_MFACE) {
+    return false;
+  }
+
+  const bool use_render = (DEG_get_mode(depsgraph) == DAG_EVAL_RENDER);
+  const int required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
+  const ModifierEvalContext mectx = {
+      depsgraph, ob, (use_render ? MOD_APPLY_RENDER : 0) | MOD_APPLY_USECACHE};
+
+  VirtualModifierData virtualModifierData;
+  ModifierData *md = modifiers_getVirtualModifierList(ob, &virtualModifierData);
+  ModifierCacheKey key = {{need_mapping ? 1 : 0, 0}};
+  bool has_modifiers = false;
+
+  for (; md; md = md->next) {
+    const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+
+    if (!modifier_isEnabled(scene, md, required_mode)) {
+      continue;
+    }
+    if (mti->type == eModifierTypeType_OnlyDeform) {
+      return false;
+    }
+    /* Only the evaluated object writes its face count back to the original modifier. */
+    if (md->type == eModifierType_Decimate) {
+      return false;
+    }
+    /* The element counts of the key are the ones of the input of the stack. */
+    if (!BKE_modifier_cache_key(
+            &mectx, md, dataMask, has_modifiers ? NULL : ob->data, &key, &key)) {
+      return false;
+    }
+    has_modifiers = true;
+  }
+
+  *r_key = key;
+  return has_modifiers;
+}
+
+static bool modifiers_have_errors(Object *ob)
+{
+  LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+    if (md->error != NULL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Copy of an evaluated mesh which shares its arrays. Normals are not part of the layers copied
+ * from evaluated meshes, they are shared as well. Only a mesh owned by the caller gets shared
+ * storage for its layers, a stored result is copied from multiple threads. */
+static Mesh *mesh_eval_copy_shared(const Mesh *mesh_input, Mesh *mesh_eval, const bool is_own)
+{
+  Mesh *result;
+  if (is_own) {
+    result = BKE_mesh_copy_for_eval_shared(mesh_eval);
+  }
+  else {
+    BKE_id_copy_ex(
+        NULL, &mesh_eval->id, (ID **)&result, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+  }
+  CustomData_merge(&mesh_eval->ldata, &result->ldata, CD_MASK_NORMAL, CD_SHARE, result->totloop);
+  CustomData_merge(&mesh_eval->pdata, &result->pdata, CD_MASK_NORMAL, CD_SHARE, result->totpoly);
+  if (result->totpoly != 0) {
+    BKE_mesh_runtime_looptri_copy_from(result, mesh_eval);
+  }
+  mesh_calc_finalize(mesh_input, result);
+  return result;
+}
+
+/**
+ * Evaluate the modifier stack of the object, sharing the result with other objects using the
+ * same mesh with identical stacks. Returns false when the stack can not be shared.
+ */
+static bool mesh_build_data_shared(struct Depsgraph *depsgraph,
+                                   Scene *scene,
+                                   Object *ob,
+                                   const CustomData_MeshMasks *dataMask,
+                                   const bool need_mapping)
+{
+  ModifierCacheKey key;
+  if (!mesh_shared_eval_key(depsgraph, scene, ob, dataMask, need_mapping, &key)) {
+    return false;
+  }
+
+  Mesh *mesh_input = ob->data;
+  Mesh *mesh_shared;
+  bool is_evaluated;
+  struct MeshSharedEval *shared = BKE_mesh_runtime_shared_eval_acquire(
+      mesh_input, &key, DEG_get_update_count(depsgraph), &mesh_shared, &is_evaluated);
+
+  if (is_evaluated) {
+    if (mesh_shared != NULL) {
+      modifiers_clearErrors(ob);
+      ob->runtime.mesh_eval = mesh_eval_copy_shared(mesh_input, mesh_shared, false);
+      /* Without deform modifiers, the deformed mesh is the input mesh. */
+      ob->runtime.mesh_deform_eval = BKE_mesh_copy_for_eval(mesh_input, true);
+    }
+    BKE_mesh_runtime_shared_eval_release(mesh_input, shared, NULL);
+    return (mesh_shared != NULL);
+  }
+
+  mesh_calc_modifiers(depsgraph,
+                      scene,
+                      ob,
+                      1,
+                      need_mapping,
+                      dataMask,
+                      -1,
+                      true,
+                      true,
+                      &ob->runtime.mesh_deform_eval,
+                      &ob->runtime.mesh_eval);
+
+  /* Errors are reported on the modifiers of the evaluated object only, let every object
+   * evaluate its own stack then. */
+  Mesh *mesh_store = NULL;
+  if (ob->runtime.mesh_eval != mesh_input->runtime.mesh_eval && !modifiers_have_errors(ob)) {
+    mesh_store = mesh_eval_copy_shared(mesh_input, ob->runtime.mesh_eval, true);
+  }
+  BKE_mesh_runtime_shared_eval_release(mesh_input, shared, mesh_store);
+  return true;
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1802,17 +1994,19 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   }
 #endif
 
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &ob->runtime.mesh_deform_eval,
-                      &ob->runtime.mesh_eval);
+  if (!mesh_build_data_shared(depsgraph, scene, ob, dataMask, need_mapping)) {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &ob->runtime.mesh_deform_eval,
+                        &ob->runtime.mesh_eval);
+  }
 
   BKE_object_boundbox_calc_from_mesh(ob, ob->runtime.mesh_eval);
 
@@ -364,6 +364,9 @@ static void setup_app_data(bContext *C,
     /* TODO(sergey): Can this be also move above? */
     RE_FreeAllPersistentData();
   }
+  else {
+    RE_FreeAllPersistentDepsgraphs();
+  }
 
   if (mode == LOAD_UNDO) {
     /* In undo/redo case, we do a whole lot of magic tricks to avoid having to re-read linked
@@ -63,6 +63,7 @@ typedef struct ColDetectData {
   CollPair *collisions;
   bool culling;
   bool use_normal;
+  bool continuous;
   bool collided;
 } ColDetectData;
 
@@ -70,6 +71,7 @@ typedef struct SelfColDetectData {
   ClothModifierData *clmd;
   BVHTreeOverlap *overlap;
   CollPair *collisions;
+  bool continuous;
   bool collided;
 } SelfColDetectData;
 
@@ -597,6 +599,83 @@ static float compute_collision_point_edge_tri(const float a1[3],
   return dist;
 }
 
+/**
+ * Continuous check for triangles which are apart at the end of the step.
+ *
+ * The closest points of the start of the step are moved along with their triangles.
+ * When their signed distance along the contact normal changes sign, the triangles are checked
+ * for contact at the time it crosses zero. Triangles sliding past each other keep the sign,
+ * triangles passing by each other at a distance aren't in contact at that time.
+ *
+ * \param epsilon: Distance at which the triangles are in contact.
+ * \param r_vec: Direction at the start of the step, to push the triangles back to that side.
+ */
+bool BKE_collision_tri_tri_crossed(const float *a_prev[3],
+                                   const float *b_prev[3],
+                                   const float *a_next[3],
+                                   const float *b_next[3],
+                                   const float epsilon,
+                                   float r_vec[3])
+{
+  float pa[3], pb[3], vec_prev[3];
+  const float distance_prev = compute_collision_point_tri_tri(a_prev[0],
+                                                              a_prev[1],
+                                                              a_prev[2],
+                                                              b_prev[0],
+                                                              b_prev[1],
+                                                              b_prev[2],
+                                                              false,
+                                                              false,
+                                                              pa,
+                                                              pb,
+                                                              vec_prev);
+
+  /* Already intersecting at the start of the step, nothing to restore. */
+  if (distance_prev <= 0.0f || len_squared_v3(vec_prev) <= ALMOST_ZERO) {
+    return false;
+  }
+
+  float wa[3], wb[3], pa_next[3], pb_next[3], delta_prev[3], delta_next[3];
+  interp_weights_tri_v3(wa, a_prev[0], a_prev[1], a_prev[2], pa);
+  interp_weights_tri_v3(wb, b_prev[0], b_prev[1], b_prev[2], pb);
+  interp_v3_v3v3v3(pa_next, a_next[0], a_next[1], a_next[2], wa);
+  interp_v3_v3v3v3(pb_next, b_next[0], b_next[1], b_next[2], wb);
+
+  sub_v3_v3v3(delta_prev, pb, pa);
+  sub_v3_v3v3(delta_next, pb_next, pa_next);
+
+  const float side_prev = dot_v3v3(delta_prev, vec_prev);
+  const float side_next = dot_v3v3(delta_next, vec_prev);
+  if ((side_prev > 0.0f) == (side_next > 0.0f)) {
+    return false;
+  }
+
+  /* Positions at the time of crossing, with vertices moving linearly over the step. */
+  const float t = side_prev / (side_prev - side_next);
+  float a_cross[3][3], b_cross[3][3], pa_cross[3], pb_cross[3], vec_cross[3];
+  for (int i = 0; i < 3; i++) {
+    interp_v3_v3v3(a_cross[i], a_prev[i], a_next[i], t);
+    interp_v3_v3v3(b_cross[i], b_prev[i], b_next[i], t);
+  }
+  const float distance_cross = compute_collision_point_tri_tri(a_cross[0],
+                                                               a_cross[1],
+                                                               a_cross[2],
+                                                               b_cross[0],
+                                                               b_cross[1],
+                                                               b_cross[2],
+                                                               false,
+                                                               false,
+                                                               pa_cross,
+                                                               pb_cross,
+                                                               vec_cross);
+  if (distance_cross > epsilon) {
+    return false;
+  }
+
+  copy_v3_v3(r_vec, vec_prev);
+  return true;
+}
+
 // w3 is not perfect
 static void collision_compute_barycentric(
     const float pv[3], float p1[3], float p2[3], float p3[3], float *w1, float *w2, float *w3)
@@ -1087,7 +1166,46 @@ static void cloth_collision(void *__restrict userdata,
                                              pb,
                                              vect);
 
-  if ((distance <= (epsilon1 + epsilon2 + ALMOST_ZERO)) && (len_squared_v3(vect) > ALMOST_ZERO)) {
+  bool collided = (distance <= (epsilon1 + epsilon2 + ALMOST_ZERO)) &&
+                  (len_squared_v3(vect) > ALMOST_ZERO);
+
+  if (!collided && data->continuous) {
+    const float *a_prev[3] = {
+        verts1[tri_a->tri[0]].txold, verts1[tri_a->tri[1]].txold, verts1[tri_a->tri[2]].txold};
+    const float *b_prev[3] = {collmd->current_x[tri_b->tri[0]].co,
+                              collmd->current_x[tri_b->tri[1]].co,
+                              collmd->current_x[tri_b->tri[2]].co};
+    const float *a_next[3] = {
+        verts1[tri_a->tri[0]].tx, verts1[tri_a->tri[1]].tx, verts1[tri_a->tri[2]].tx};
+    const float *b_next[3] = {collmd->current_xnew[tri_b->tri[0]].co,
+                              collmd->current_xnew[tri_b->tri[1]].co,
+                              collmd->current_xnew[tri_b->tri[2]].co};
+    float pa_raw[3], pb_raw[3], vect_raw[3];
+
+    /* Closest points without culling or the collider normal, which may have rejected them. */
+    compute_collision_point_tri_tri(a_next[0],
+                                    a_next[1],
+                                    a_next[2],
+                                    b_next[0],
+                                    b_next[1],
+                                    b_next[2],
+                                    false,
+                                    false,
+                                    pa_raw,
+                                    pb_raw,
+                                    vect_raw);
+
+    /* Triangles which passed through each other are handled as intersecting. */
+    if (BKE_collision_tri_tri_crossed(
+            a_prev, b_prev, a_next, b_next, epsilon1 + epsilon2 + ALMOST_ZERO, vect)) {
+      copy_v3_v3(pa, pa_raw);
+      copy_v3_v3(pb, pb_raw);
+      distance = 0.0f;
+      collided = true;
+    }
+  }
+
+  if (collided) {
     collpair[index].ap1 = tri_a->tri[0];
     collpair[index].ap2 = tri_a->tri[1];
     collpair[index].ap3 = tri_a->tri[2];
@@ -1158,7 +1276,29 @@ static void cloth_selfcollision(void *__restrict userdata,
                                              pb,
                                              vect);
 
-  if ((distance <= (epsilon * 2.0f + ALMOST_ZERO)) && (len_squared_v3(vect) > ALMOST_ZERO)) {
+  bool collided = (distance <= (epsilon * 2.0f + ALMOST_ZERO)) &&
+                  (len_squared_v3(vect) > ALMOST_ZERO);
+
+  if (!collided && data->continuous) {
+    const float *a_prev[3] = {
+        verts1[tri_a->tri[0]].txold, verts1[tri_a->tri[1]].txold, verts1[tri_a->tri[2]].txold};
+    const float *b_prev[3] = {
+        verts1[tri_b->tri[0]].txold, verts1[tri_b->tri[1]].txold, verts1[tri_b->tri[2]].txold};
+
+    const float *a_next[3] = {
+        verts1[tri_a->tri[0]].tx, verts1[tri_a->tri[1]].tx, verts1[tri_a->tri[2]].tx};
+    const float *b_next[3] = {
+        verts1[tri_b->tri[0]].tx, verts1[tri_b->tri[1]].tx, verts1[tri_b->tri[2]].tx};
+
+    /* Triangles which passed through each other are handled as intersecting. */
+    if (BKE_collision_tri_tri_crossed(
+            a_prev, b_prev, a_next, b_next, epsilon * 2.0f + ALMOST_ZERO, vect)) {
+      distance = 0.0f;
+      collided = true;
+    }
+  }
+
+  if (collided) {
     collpair[index].ap1 = tri_a->tri[0];
     collpair[index].ap2 = tri_a->tri[1];
     collpair[index].ap3 = tri_a->tri[2];
@@ -1398,13 +1538,423 @@ void BKE_collider_cache_free(ListBase **colliders)
   }
 }
 
+/***********************************
+ * Spatial hash broadphase
+ *
+ * Alternative to the BVH trees for finding pairs of triangles that may collide. Triangles are
+ * stored in every cell of a uniform grid their bounds touch. Only non-empty cells are stored,
+ * in a hash table indexed by cell, so the grid doesn't need to be allocated. The result is an
+ * overlap array compatible with #BLI_bvhtree_overlap, so the narrow phase is shared.
+ ***********************************/
+
+/* Limit for the number of cells along each axis, keeps cell keys in 64 bits. */
+#define COLLISION_GRID_MAX_DIM (1 << 20)
+
+typedef struct CollisionGridEntry {
+  /** Linear index of the cell. */
+  uint64_t key;
+  uint prim;
+} CollisionGridEntry;
+
+typedef struct CollisionGrid {
+  float min[3], max[3];
+  float cell_size;
+  int dims[3];
+
+  /** Entries of bucket i are in [bucket_offsets[i], bucket_offsets[i + 1]). */
+  uint bucket_mask;
+  uint *bucket_offsets;
+  CollisionGridEntry *entries;
+} CollisionGrid;
+
+/* Triangles and the positions of their vertices, as base pointer and stride so both cloth
+ * vertices and collider #MVert arrays can be used. */
+typedef struct CollisionGridPrims {
+  const MVertTri *tri;
+  uint num;
+  const char *co;
+  /** Optional positions at the start of the step, the bounds then cover the whole motion. */
+  const char *co_prev;
+  size_t co_stride;
+  float epsilon;
+} CollisionGridPrims;
+
+typedef struct CollisionGridBoundsData {
+  const CollisionGridPrims *prims;
+  float (*bounds)[2][3];
+} CollisionGridBoundsData;
+
+typedef struct CollisionGridQueryData {
+  const CollisionGrid *grid;
+  const float (*grid_bounds)[2][3];
+  const float (*query_bounds)[2][3];
+  /** Query primitives are the second index of the pairs. */
+  bool swap;
+  /** Skip pairs of a primitive with itself. */
+  bool self;
+  /** Number of pairs per query primitive, turned into offsets before the second pass. */
+  uint *counts;
+  /** NULL in the first pass, which only counts pairs. */
+  BVHTreeOverlap *overlap;
+} CollisionGridQueryData;
+
+BLI_INLINE const float *collision_grid_prim_co(const char *co, size_t stride, uint index)
+{
+  return (const float *)(co + (size_t)index * stride);
+}
+
+BLI_INLINE uint64_t collision_grid_cell_key(const CollisionGrid *grid, const int cell[3])
+{
+  return (uint64_t)cell[0] +
+         (uint64_t)grid->dims[0] * ((uint64_t)cell[1] + (uint64_t)grid->dims[1] * cell[2]);
+}
+
+BLI_INLINE uint collision_grid_bucket(const CollisionGrid *grid, uint64_t key)
+{
+  return (uint)((key * 0x9E3779B97F4A7C15ull) >> 32) & grid->bucket_mask;
+}
+
+/* Range of cells touched by the bounds, clamped to the grid. */
+BLI_INLINE void collision_grid_cell_range(const CollisionGrid *grid,
+                                          const float bounds[2][3],
+                                          int r_min[3],
+                                          int r_max[3])
+{
+  for (int k = 0; k < 3; k++) {
+    const float inv_cell_size = 1.0f / grid->cell_size;
+    r_min[k] = (int)floorf((bounds[0][k] - grid->min[k]) * inv_cell_size);
+    r_max[k] = (int)floorf((bounds[1][k] - grid->min[k]) * inv_cell_size);
+    CLAMP(r_min[k], 0, grid->dims[k] - 1);
+    CLAMP(r_max[k], 0, grid->dims[k] - 1);
+  }
+}
+
+BLI_INLINE bool collision_bounds_overlap(const float a[2][3], const float b[2][3])
+{
+  return (a[0][0] <= b[1][0] && a[1][0] >= b[0][0] && a[0][1] <= b[1][1] &&
+          a[1][1] >= b[0][1] && a[0][2] <= b[1][2] && a[1][2] >= b[0][2]);
+}
+
+static void collision_grid_bounds_cb(void *__restrict userdata,
+                                     const int index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CollisionGridBoundsData *data = (CollisionGridBoundsData *)userdata;
+  const CollisionGridPrims *prims = data->prims;
+  const MVertTri *vt = &prims->tri[index];
+  float(*bounds)[3] = data->bounds[index];
+
+  INIT_MINMAX(bounds[0], bounds[1]);
+
+  for (int i = 0; i < 3; i++) {
+    minmax_v3v3_v3(
+        bounds[0], bounds[1], collision_grid_prim_co(prims->co, prims->co_stride, vt->tri[i]));
+
+    if (prims->co_prev) {
+      minmax_v3v3_v3(bounds[0],
+                     bounds[1],
+                     collision_grid_prim_co(prims->co_prev, prims->co_stride, vt->tri[i]));
+    }
+  }
+
+  add_v3_fl(bounds[0], -prims->epsilon);
+  add_v3_fl(bounds[1], prims->epsilon);
+}
+
+/* Bounds of all primitives, grown by the collision distance. */
+static float (*collision_grid_bounds_create(const CollisionGridPrims *prims))[2][3]
+{
+  float(*bounds)[2][3] = MEM_mallocN(sizeof(*bounds) * max_ii(prims->num, 1), __func__);
+
+  CollisionGridBoundsData data = {
+      .prims = prims,
+      .bounds = bounds,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (prims->num > 1024);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, prims->num, &data, collision_grid_bounds_cb, &settings);
+
+  return bounds;
+}
+
+/**
+ * Insert all primitives in the grid. The cell size is the average size of the primitive bounds,
+ * which include the collision distance, so most primitives only touch a few cells.
+ */
+static void collision_grid_build(CollisionGrid *grid, const float (*bounds)[2][3], uint num)
+{
+  float extent_sum = 0.0f;
+  uint num_entries = 0;
+  int cell_min[3], cell_max[3], cell[3];
+
+  INIT_MINMAX(grid->min, grid->max);
+
+  for (uint i = 0; i < num; i++) {
+    float extent[3];
+    minmax_v3v3_v3(grid->min, grid->max, bounds[i][0]);
+    minmax_v3v3_v3(grid->min, grid->max, bounds[i][1]);
+    sub_v3_v3v3(extent, bounds[i][1], bounds[i][0]);
+    extent_sum += max_fff(extent[0], extent[1], extent[2]);
+  }
+
+  if (num == 0) {
+    /* Empty grid of a single cell, avoids casting the unset (infinite) bounds to cells. */
+    zero_v3(grid->min);
+    zero_v3(grid->max);
+  }
+
+  grid->cell_size = max_ff(extent_sum / (float)max_ii(num, 1), FLT_EPSILON);
+
+  for (int k = 0; k < 3; k++) {
+    const float size = grid->max[k] - grid->min[k];
+    grid->cell_size = max_ff(grid->cell_size, size / (float)(COLLISION_GRID_MAX_DIM - 1));
+  }
+
+  for (int k = 0; k < 3; k++) {
+    grid->dims[k] = max_ii((int)((grid->max[k] - grid->min[k]) / grid->cell_size) + 1, 1);
+    CLAMP_MAX(grid->dims[k], COLLISION_GRID_MAX_DIM);
+  }
+
+  for (uint i = 0; i < num; i++) {
+    collision_grid_cell_range(grid, bounds[i], cell_min, cell_max);
+    num_entries += (uint)((cell_max[0] - cell_min[0] + 1) * (cell_max[1] - cell_min[1] + 1) *
+                          (cell_max[2] - cell_min[2] + 1));
+  }
+
+  grid->bucket_mask = power_of_2_max_u(max_ii(num_entries, 1) * 2) - 1;
+  grid->bucket_offsets = MEM_callocN(sizeof(uint) * (grid->bucket_mask + 2), __func__);
+  grid->entries = MEM_mallocN(sizeof(CollisionGridEntry) * max_ii(num_entries, 1), __func__);
+
+  /* Counting sort of the entries by bucket, keeping primitives ordered within each bucket. */
+  for (uint i = 0; i < num; i++) {
+    collision_grid_cell_range(grid, bounds[i], cell_min, cell_max);
+    for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+      for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+        for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+          const uint64_t key = collision_grid_cell_key(grid, cell);
+          grid->bucket_offsets[collision_grid_bucket(grid, key) + 1]++;
+        }
+      }
+    }
+  }
+
+  for (uint i = 0; i <= grid->bucket_mask; i++) {
+    grid->bucket_offsets[i + 1] += grid->bucket_offsets[i];
+  }
+
+  for (uint i = 0; i < num; i++) {
+    collision_grid_cell_range(grid, bounds[i], cell_min, cell_max);
+    for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+      for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+        for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+          const uint64_t key = collision_grid_cell_key(grid, cell);
+          /* Use the bucket start as cursor, offsets are shifted back below. */
+          CollisionGridEntry *entry =
+              &grid->entries[grid->bucket_offsets[collision_grid_bucket(grid, key)]++];
+          entry->key = key;
+          entry->prim = i;
+        }
+      }
+    }
+  }
+
+  for (uint i = grid->bucket_mask + 1; i > 0; i--) {
+    grid->bucket_offsets[i] = grid->bucket_offsets[i - 1];
+  }
+  grid->bucket_offsets[0] = 0;
+}
+
+static void collision_grid_free(CollisionGrid *grid)
+{
+  MEM_SAFE_FREE(grid->bucket_offsets);
+  MEM_SAFE_FREE(grid->entries);
+}
+
+static void collision_grid_query_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CollisionGridQueryData *data = (CollisionGridQueryData *)userdata;
+  const CollisionGrid *grid = data->grid;
+  const float(*bounds)[3] = data->query_bounds[index];
+  int cell_min[3], cell_max[3], cell[3];
+  uint num_pairs = 0;
+
+  if (!(bounds[0][0] <= grid->max[0] && bounds[1][0] >= grid->min[0] &&
+        bounds[0][1] <= grid->max[1] && bounds[1][1] >= grid->min[1] &&
+        bounds[0][2] <= grid->max[2] && bounds[1][2] >= grid->min[2])) {
+    data->counts[index] = 0;
+    return;
+  }
+
+  collision_grid_cell_range(grid, bounds, cell_min, cell_max);
+
+  for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+    for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+      for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+        const uint64_t key = collision_grid_cell_key(grid, cell);
+        const uint bucket = collision_grid_bucket(grid, key);
+
+        for (uint e = grid->bucket_offsets[bucket]; e < grid->bucket_offsets[bucket + 1]; e++) {
+          const CollisionGridEntry *entry = &grid->entries[e];
+          const uint prim = entry->prim;
+          int other_min[3], other_max[3];
+
+          if (entry->key != key || (data->self && prim == (uint)index) ||
+              !collision_bounds_overlap(bounds, data->grid_bounds[prim])) {
+            continue;
+          }
+
+          /* Both primitives can share several cells, only report the pair in the first one. */
+          collision_grid_cell_range(grid, data->grid_bounds[prim], other_min, other_max);
+          if (cell[0] != max_ii(cell_min[0], other_min[0]) ||
+              cell[1] != max_ii(cell_min[1], other_min[1]) ||
+              cell[2] != max_ii(cell_min[2], other_min[2])) {
+            continue;
+          }
+
+          if (data->overlap) {
+            BVHTreeOverlap *overlap = &data->overlap[data->counts[index] + num_pairs];
+            overlap->indexA = data->swap ? (int)prim : index;
+            overlap->indexB = data->swap ? index : (int)prim;
+          }
+          num_pairs++;
+        }
+      }
+    }
+  }
+
+  if (data->overlap == NULL) {
+    data->counts[index] = num_pairs;
+  }
+}
+
+/**
+ * Find all pairs of grid and query primitives with overlapping bounds. Pairs are computed in
+ * parallel, in two passes so the result has a deterministic order.
+ *
+ * \param swap: Query primitives are stored as the second index of the pairs.
+ */
+static BVHTreeOverlap *collision_grid_overlap(const CollisionGrid *grid,
+                                              const float (*grid_bounds)[2][3],
+                                              const float (*query_bounds)[2][3],
+                                              uint query_num,
+                                              bool swap,
+                                              bool self,
+                                              uint *r_overlap_num)
+{
+  uint *counts = MEM_mallocN(sizeof(uint) * max_ii(query_num, 1), __func__);
+  uint overlap_num = 0;
+
+  CollisionGridQueryData data = {
+      .grid = grid,
+      .grid_bounds = grid_bounds,
+      .query_bounds = query_bounds,
+      .swap = swap,
+      .self = self,
+      .counts = counts,
+      .overlap = NULL,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (query_num > 256);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, query_num, &data, collision_grid_query_cb, &settings);
+
+  for (uint i = 0; i < query_num; i++) {
+    const uint count = counts[i];
+    counts[i] = overlap_num;
+    overlap_num += count;
+  }
+
+  BVHTreeOverlap *overlap = NULL;
+  if (overlap_num) {
+    data.overlap = overlap = MEM_mallocN(sizeof(BVHTreeOverlap) * overlap_num, __func__);
+    BLI_task_parallel_range(0, query_num, &data, collision_grid_query_cb, &settings);
+  }
+
+  MEM_freeN(counts);
+
+  *r_overlap_num = overlap_num;
+  return overlap;
+}
+
+static CollisionGridPrims collision_grid_cloth_prims(ClothModifierData *clmd,
+                                                     float epsilon,
+                                                     bool continuous)
+{
+  Cloth *cloth = clmd->clothObject;
+  CollisionGridPrims prims = {
+      .tri = cloth->tri,
+      .num = cloth->primitive_num,
+      .co = (const char *)cloth->verts[0].tx,
+      .co_prev = continuous ? (const char *)cloth->verts[0].txold : NULL,
+      .co_stride = sizeof(ClothVertex),
+      .epsilon = epsilon,
+  };
+  return prims;
+}
+
+static CollisionGridPrims collision_grid_collider_prims(CollisionModifierData *collmd,
+                                                        bool continuous)
+{
+  CollisionGridPrims prims = {
+      .tri = collmd->tri,
+      .num = collmd->tri_num,
+      .co = (const char *)collmd->current_xnew[0].co,
+      .co_prev = continuous ? (const char *)collmd->current_x[0].co : NULL,
+      .co_stride = sizeof(MVert),
+      .epsilon = BLI_bvhtree_get_epsilon(collmd->bvhtree),
+  };
+  return prims;
+}
+
+static BVHTreeOverlap *cloth_grid_objcollisions_overlap(const CollisionGrid *cloth_grid,
+                                                        const float (*cloth_bounds)[2][3],
+                                                        CollisionModifierData *collmd,
+                                                        bool continuous,
+                                                        uint *r_overlap_num)
+{
+  CollisionGridPrims prims = collision_grid_collider_prims(collmd, continuous);
+  float(*bounds)[2][3] = collision_grid_bounds_create(&prims);
+
+  BVHTreeOverlap *overlap = collision_grid_overlap(
+      cloth_grid, cloth_bounds, bounds, prims.num, true, false, r_overlap_num);
+
+  MEM_freeN(bounds);
+  return overlap;
+}
+
+static BVHTreeOverlap *cloth_grid_selfcollisions_overlap(ClothModifierData *clmd,
+                                                         bool continuous,
+                                                         uint *r_overlap_num)
+{
+  CollisionGridPrims prims = collision_grid_cloth_prims(
+      clmd, clmd->coll_parms->selfepsilon, continuous);
+  float(*bounds)[2][3] = collision_grid_bounds_create(&prims);
+  CollisionGrid grid;
+
+  collision_grid_build(&grid, bounds, prims.num);
+  BVHTreeOverlap *overlap = collision_grid_overlap(
+      &grid, bounds, bounds, prims.num, false, true, r_overlap_num);
+
+  collision_grid_free(&grid);
+  MEM_freeN(bounds);
+  return overlap;
+}
+
 static bool cloth_bvh_objcollisions_nearcheck(ClothModifierData *clmd,
                                               CollisionModifierData *collmd,
                                               CollPair **collisions,
                                               int numresult,
                                               BVHTreeOverlap *overlap,
                                               bool culling,
-                                              bool use_normal)
+                                              bool use_normal,
+                                              bool continuous)
 {
   const bool is_hair = (clmd->hairdata != NULL);
   *collisions = (CollPair *)MEM_mallocN(sizeof(CollPair) * numresult, "collision array");
@@ -1416,6 +1966,7 @@ static bool cloth_bvh_objcollisions_nearcheck(ClothModifierData *clmd,
       .collisions = *collisions,
       .culling = culling,
       .use_normal = use_normal,
+      .continuous = continuous,
       .collided = false,
   };
 
@@ -1431,12 +1982,14 @@ static bool cloth_bvh_objcollisions_nearcheck(ClothModifierData *clmd,
 static bool cloth_bvh_selfcollisions_nearcheck(ClothModifierData *clmd,
                                                CollPair *collisions,
                                                int numresult,
-                                               BVHTreeOverlap *overlap)
+                                               BVHTreeOverlap *overlap,
+                                               bool continuous)
 {
   SelfColDetectData data = {
       .clmd = clmd,
       .overlap = overlap,
       .collisions = collisions,
+      .continuous = continuous,
       .collided = false,
   };
 
@@ -1557,6 +2110,8 @@ int cloth_bvh_collision(
   BVHTreeOverlap **overlap_obj = NULL;
   uint coll_count_self = 0;
   BVHTreeOverlap *overlap_self = NULL;
+  CollisionGrid cloth_grid = {{0}};
+  float(*cloth_bounds)[2][3] = NULL;
 
   if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_COLLOBJ) || cloth_bvh == NULL) {
     return 0;
@@ -1565,11 +2120,19 @@ int cloth_bvh_collision(
   verts = cloth->verts;
   mvert_num = cloth->mvert_num;
 
-  if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) {
-    bvhtree_update_from_cloth(clmd, false, false);
+  /* Enable self collision if this is a hair sim */
+  const bool is_hair = (clmd->hairdata != NULL);
 
-    /* Enable self collision if this is a hair sim */
-    const bool is_hair = (clmd->hairdata != NULL);
+  /* Hair collides edges, which are only supported by the BVH trees. */
+  const bool use_grid = (clmd->coll_parms->broadphase == CLOTH_COLLISION_BROADPHASE_GRID) &&
+                        !is_hair;
+  const bool continuous = (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_CONTINUOUS) &&
+                          !is_hair;
+
+  if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) {
+    if (!use_grid) {
+      bvhtree_update_from_cloth(clmd, continuous, false);
+    }
 
     collobjs = BKE_collision_objects_create(depsgraph,
                                             is_hair ? NULL : ob,
@@ -1581,6 +2144,13 @@ int cloth_bvh_collision(
       coll_counts_obj = MEM_callocN(sizeof(uint) * numcollobj, "CollCounts");
       overlap_obj = MEM_callocN(sizeof(*overlap_obj) * numcollobj, "BVHOverlap");
 
+      if (use_grid) {
+        CollisionGridPrims prims = collision_grid_cloth_prims(
+            clmd, clmd->coll_parms->epsilon, continuous);
+        cloth_bounds = collision_grid_bounds_create(&prims);
+        collision_grid_build(&cloth_grid, cloth_bounds, prims.num);
+      }
+
       for (i = 0; i < numcollobj; i++) {
         Object *collob = collobjs[i];
         CollisionModifierData *collmd = (CollisionModifierData *)modifiers_findByType(
@@ -1591,19 +2161,35 @@ int cloth_bvh_collision(
         }
 
         /* Move object to position (step) in time. */
-        collision_move_object(collmd, step + dt, step, false);
+        collision_move_object(collmd, step + dt, step, continuous && !use_grid);
 
-        overlap_obj[i] = BLI_bvhtree_overlap(
-            cloth_bvh, collmd->bvhtree, &coll_counts_obj[i], NULL, NULL);
+        if (use_grid) {
+          overlap_obj[i] = cloth_grid_objcollisions_overlap(
+              &cloth_grid, cloth_bounds, collmd, continuous, &coll_counts_obj[i]);
+        }
+        else {
+          overlap_obj[i] = BLI_bvhtree_overlap(
+              cloth_bvh, collmd->bvhtree, &coll_counts_obj[i], NULL, NULL);
+        }
+      }
+
+      if (use_grid) {
+        collision_grid_free(&cloth_grid);
+        MEM_freeN(cloth_bounds);
       }
     }
   }
 
   if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) {
-    bvhtree_update_from_cloth(clmd, false, true);
+    if (use_grid) {
+      overlap_self = cloth_grid_selfcollisions_overlap(clmd, continuous, &coll_count_self);
+    }
+    else {
+      bvhtree_update_from_cloth(clmd, continuous, true);
 
-    overlap_self = BLI_bvhtree_overlap(
-        cloth->bvhselftree, cloth->bvhselftree, &coll_count_self, NULL, NULL);
+      overlap_self = BLI_bvhtree_overlap(
+          cloth->bvhselftree, cloth->bvhselftree, &coll_count_self, NULL, NULL);
+    }
   }
 
   do {
@@ -1633,7 +2219,8 @@ int cloth_bvh_collision(
                          coll_counts_obj[i],
                          overlap_obj[i],
                          (collob->pd->flag & PFIELD_CLOTH_USE_CULLING),
-                         (collob->pd->flag & PFIELD_CLOTH_USE_NORMAL)) ||
+                         (collob->pd->flag & PFIELD_CLOTH_USE_NORMAL),
+                         continuous) ||
                      collided;
         }
       }
@@ -1664,7 +2251,7 @@ int cloth_bvh_collision(
                                                "collision array");
 
           if (cloth_bvh_selfcollisions_nearcheck(
-                  clmd, collisions, coll_count_self, overlap_self)) {
+                  clmd, collisions, coll_count_self, overlap_self, continuous)) {
             ret += cloth_bvh_selfcollisions_resolve(clmd, collisions, coll_count_self, dt);
             ret2 += ret;
           }
@@ -1707,13 +2294,6 @@ int cloth_bvh_collision(
   return MIN2(ret, 1);
 }
 
-BLI_INLINE void max_v3_v3v3(float r[3], const float a[3], const float b[3])
-{
-  r[0] = max_ff(a[0], b[0]);
-  r[1] = max_ff(a[1], b[1]);
-  r[2] = max_ff(a[2], b[2]);
-}
-
 void collision_get_collider_velocity(float vel_old[3],
                                      float vel_new[3],
                                      CollisionModifierData *collmd,
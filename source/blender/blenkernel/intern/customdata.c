@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* Since we have versioning code here (CustomData_verify_versions()). */
 #define DNA_DEPRECATED_ALLOW
 
@@ -1838,6 +1840,144 @@ void CustomData_update_typemap(CustomData *data)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/* Shared layer data.
+ *
+ * Layers which use the same data array as other layers (an evaluated mesh and its copy in a
+ * modifier result cache for example) point to the same #CustomDataShared, which owns the
+ * array and counts its users. The last user frees the data, a user which is about to modify
+ * the data gets its own copy first (see #CustomData_duplicate_referenced_layer).
+ *
+ * Layer data of shared layers is only to be replaced through the CustomData API: a layer whose
+ * data pointer differs from the one of its storage is no longer using the shared array.
+ */
+
+static void customData_layer_data_free(int type, void *data, int totelem);
+
+typedef struct CustomDataShared {
+  void *data;
+  int type;
+  int totelem;
+  /** Number of layers using the data, changed atomically. */
+  int32_t users;
+} CustomDataShared;
+
+/* Whether the layer currently uses the array of its shared storage. */
+static bool customData_layer_uses_shared(const CustomDataLayer *layer)
+{
+  return (layer->shared != NULL) && (layer->data == layer->shared->data);
+}
+
+/* Whether data of the layer is used by other layers as well. */
+static bool customData_layer_is_shared(const CustomDataLayer *layer)
+{
+  return customData_layer_uses_shared(layer) &&
+         atomic_add_and_fetch_int32(&layer->shared->users, 0) > 1;
+}
+
+/* Make the storage of \a layer_src shared with the (new) layer \a layer_dst. */
+static void customData_layer_shared_add_user(const CustomDataLayer *layer_src,
+                                             CustomDataLayer *layer_dst)
+{
+  BLI_assert(customData_layer_uses_shared(layer_src));
+  atomic_add_and_fetch_int32(&layer_src->shared->users, 1);
+  layer_dst->shared = layer_src->shared;
+}
+
+/* Remove the layer from the users of its shared storage. Returns true when the layer data is
+ * owned by the layer only afterwards: it was the last user, or the layer data was replaced. */
+static bool customData_layer_shared_release(CustomDataLayer *layer)
+{
+  CustomDataShared *shared = layer->shared;
+  const bool uses_shared = customData_layer_uses_shared(layer);
+
+  layer->shared = NULL;
+  if (atomic_sub_and_fetch_int32(&shared->users, 1) != 0) {
+    return !uses_shared;
+  }
+  if (!uses_shared) {
+    customData_layer_data_free(shared->type, shared->data, shared->totelem);
+  }
+  MEM_freeN(shared);
+  return true;
+}
+
+static void customData_layer_data_free(int type, void *data, int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->free) {
+    typeInfo->free(data, totelem, typeInfo->size);
+  }
+
+  MEM_freeN(data);
+}
+
+static void *customData_layer_data_duplicate(int type, const void *data, int totelem)
+{
+  /* MEM_dupallocN won't work in case of complex layers, like e.g.
+   * CD_MDEFORMVERT, which has pointers to allocated data...
+   * So in case a custom copy function is defined, use it!
+   */
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->copy) {
+    void *dst_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    typeInfo->copy(data, dst_data, totelem);
+    return dst_data;
+  }
+  return MEM_dupallocN(data);
+}
+
+/* Make the layer the only user of its data, copying the data when it is used elsewhere. */
+static void customData_layer_unshare(CustomDataLayer *layer, int totelem)
+{
+  void *data_own = NULL;
+
+  if (layer->shared == NULL) {
+    return;
+  }
+  if (customData_layer_is_shared(layer)) {
+    data_own = customData_layer_data_duplicate(layer->type, layer->data, totelem);
+  }
+  if (customData_layer_shared_release(layer)) {
+    /* Other users released the data meanwhile, keep using it. */
+    if (data_own != NULL) {
+      customData_layer_data_free(layer->type, data_own, totelem);
+    }
+    return;
+  }
+  BLI_assert(data_own != NULL);
+  layer->data = data_own;
+}
+
+/**
+ * Give all layers a shared storage, so copies made with #CD_SHARE use their data instead of
+ * duplicating it. Not thread safe, unlike copying from the layers afterwards.
+ */
+void CustomData_ensure_shared(CustomData *data, int totelem)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    CustomDataLayer *layer = &data->layers[i];
+
+    if ((layer->flag & CD_FLAG_NOFREE) || (layer->data == NULL) ||
+        customData_layer_uses_shared(layer)) {
+      continue;
+    }
+    if (layer->shared != NULL) {
+      /* Data was replaced since the layer was shared. */
+      customData_layer_shared_release(layer);
+    }
+
+    CustomDataShared *shared = MEM_mallocN(sizeof(*shared), __func__);
+    shared->data = layer->data;
+    shared->type = layer->type;
+    shared->totelem = totelem;
+    shared->users = 1;
+    layer->shared = shared;
+  }
+}
+
 /* currently only used in BLI_assert */
 #ifndef NDEBUG
 static bool customdata_typemap_is_valid(const CustomData *data)
@@ -1899,6 +2039,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -1910,10 +2051,20 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if ((alloctype == CD_SHARE) && !customData_layer_uses_shared(layer)) {
+      /* Only layers with a shared storage can be shared (see #CustomData_ensure_shared),
+       * the lifetime of other data is not known. */
+      newlayer = customData_add_layer__internal(
+          dest, type, CD_DUPLICATE, data, totelem, layer->name);
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
     }
 
+    if (newlayer && (alloctype == CD_SHARE) && (newlayer->data == data)) {
+      customData_layer_shared_add_user(layer, newlayer);
+    }
+
     if (newlayer) {
       newlayer->uid = layer->uid;
 
@@ -1922,6 +2073,10 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer->active_clone = lastclone;
       newlayer->active_mask = lastmask;
       newlayer->flag |= flag & (CD_FLAG_EXTERNAL | CD_FLAG_IN_MEMORY);
+      if (alloctype == CD_ASSIGN) {
+        /* The new layer takes over the user of the shared storage. */
+        newlayer->shared = layer->shared;
+      }
       changed = true;
     }
   }
@@ -1941,6 +2096,11 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->shared != NULL) {
+      /* Shared data is not to be reallocated in place, resize a copy. */
+      const int totelem_old = (int)(MEM_allocN_len(layer->data) / typeInfo->size);
+      customData_layer_unshare(layer, totelem_old);
+    }
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
 }
@@ -1962,18 +2122,12 @@ void CustomData_copy(const struct CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
   if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
-    }
-
-    if (layer->data) {
-      MEM_freeN(layer->data);
+    if ((layer->shared != NULL) && !customData_layer_shared_release(layer)) {
+      /* Data is still used by other layers. */
+      return;
     }
+    customData_layer_data_free(layer->type, layer->data, totelem);
   }
 }
 
@@ -2304,13 +2458,13 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   /* Passing a layer-data to copy from with an alloctype that won't copy is
    * most likely a bug */
   BLI_assert(!layerdata || (alloctype == CD_ASSIGN) || (alloctype == CD_DUPLICATE) ||
-             (alloctype == CD_REFERENCE));
+             (alloctype == CD_REFERENCE) || (alloctype == CD_SHARE));
 
   if (!typeInfo->defaultname && CustomData_has_layer(data, type)) {
     return &data->layers[CustomData_get_layer_index(data, type)];
   }
 
-  if ((alloctype == CD_ASSIGN) || (alloctype == CD_REFERENCE)) {
+  if ((alloctype == CD_ASSIGN) || (alloctype == CD_REFERENCE) || (alloctype == CD_SHARE)) {
     newlayerdata = layerdata;
   }
   else if (totelem > 0 && typeInfo->size > 0) {
@@ -2362,6 +2516,8 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  /* Shared storage is set by the caller. */
+  data->layers[index].shared = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2548,24 +2704,12 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
   layer = &data->layers[layer_index];
 
   if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          (size_t)totelem, typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
-
+    layer->data = customData_layer_data_duplicate(layer->type, layer->data, totelem);
     layer->flag &= ~CD_FLAG_NOFREE;
   }
+  else if (layer->shared != NULL) {
+    customData_layer_unshare(layer, totelem);
+  }
 
   return layer->data;
 }
@@ -2606,6 +2750,24 @@ void *CustomData_duplicate_referenced_layer_named(CustomData *data,
   return customData_duplicate_referenced_layer_index(data, layer_index, totelem);
 }
 
+/**
+ * Make the active layer of the type the only user of its data, when the data is shared with
+ * other custom data (see #CD_SHARE). Unlike #CustomData_duplicate_referenced_layer, referenced
+ * layers are kept, for data derived from the layer itself which is written in place, like vertex
+ * normals.
+ */
+void *CustomData_unshare_layer(CustomData *data, const int type, const int totelem)
+{
+  const int layer_index = CustomData_get_active_layer_index(data, type);
+  if (layer_index == -1) {
+    return NULL;
+  }
+
+  CustomDataLayer *layer = &data->layers[layer_index];
+  customData_layer_unshare(layer, totelem);
+  return layer->data;
+}
+
 bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 {
   CustomDataLayer *layer;
@@ -2619,7 +2781,7 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 
   layer = &data->layers[layer_index];
 
-  return (layer->flag & CD_FLAG_NOFREE) != 0;
+  return (layer->flag & CD_FLAG_NOFREE) != 0 || customData_layer_is_shared(layer);
 }
 
 void CustomData_free_temporary(CustomData *data, int totelem)
@@ -3053,6 +3215,11 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return NULL;
   }
 
+  /* Shared data is to be made local first, see #CustomData_duplicate_referenced_layer. */
+  BLI_assert(!customData_layer_is_shared(&data->layers[layer_index]));
+  if (data->layers[layer_index].shared != NULL) {
+    customData_layer_shared_release(&data->layers[layer_index]);
+  }
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -3432,9 +3599,12 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/**
+ * Allocate a block without initializing it,
+ * so the data can be filled in later (possibly from multiple threads).
+ */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
-
   if (*block) {
     CustomData_bmesh_free_block(data, block);
   }
@@ -4278,6 +4448,7 @@ void CustomData_external_reload(CustomData *data, ID *UNUSED(id), CustomDataMask
       /* pass */
     }
     else if ((layer->flag & CD_FLAG_EXTERNAL) && (layer->flag & CD_FLAG_IN_MEMORY)) {
+      customData_layer_unshare(layer, totelem);
       if (typeInfo->free) {
         typeInfo->free(layer->data, totelem, typeInfo->size);
       }
@@ -4456,6 +4627,7 @@ void CustomData_external_write(
 
     if ((layer->flag & CD_FLAG_EXTERNAL) && typeInfo->write) {
       if (free) {
+        customData_layer_unshare(layer, totelem);
         if (typeInfo->free) {
           typeInfo->free(layer->data, totelem, typeInfo->size);
         }
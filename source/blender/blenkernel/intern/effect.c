@@ -44,6 +44,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_noise.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 
@@ -1065,6 +1066,54 @@ static void do_physical_effector(EffectorCache *eff,
   }
 }
 
+/* Apply a single effector to a point, see #BKE_effectors_apply. */
+static void effector_apply(EffectorCache *eff,
+                           ListBase *colliders,
+                           EffectorWeights *weights,
+                           EffectedPoint *point,
+                           float *force,
+                           float *impulse)
+{
+  EffectorData efd;
+  int p = 0, tot = 1, step = 1;
+
+  /* object effectors were fully checked to be OK to evaluate! */
+
+  get_effector_tot(eff, &efd, point, &tot, &p, &step);
+
+  for (; p < tot; p += step) {
+    if (get_effector_data(eff, &efd, point, 0)) {
+      efd.falloff = effector_falloff(eff, &efd, point, weights);
+
+      if (efd.falloff > 0.0f) {
+        efd.falloff *= eff_calc_visibility(colliders, eff, &efd, point);
+      }
+      if (efd.falloff <= 0.0f) {
+        /* don't do anything */
+      }
+      else if (eff->pd->forcefield == PFIELD_TEXTURE) {
+        do_texture_effector(eff, &efd, point, force);
+      }
+      else {
+        float temp1[3] = {0, 0, 0}, temp2[3];
+        copy_v3_v3(temp1, force);
+
+        do_physical_effector(eff, &efd, point, force);
+
+        /* for softbody backward compatibility */
+        if (point->flag & PE_WIND_AS_SPEED && impulse) {
+          sub_v3_v3v3(temp2, force, temp1);
+          sub_v3_v3v3(impulse, impulse, temp2);
+        }
+      }
+    }
+    else if (eff->flag & PE_VELOCITY_TO_IMPULSE && impulse) {
+      /* special case for harmonic effector */
+      add_v3_v3v3(impulse, impulse, efd.vel);
+    }
+  }
+}
+
 /*  -------- BKE_effectors_apply() --------
  * generic force/speed system, now used for particles and softbodies
  * scene       = scene where it runs in, for time and stuff
@@ -1099,51 +1148,134 @@ void BKE_effectors_apply(ListBase *effectors,
    *     (is independent of other effectors)
    */
   EffectorCache *eff;
-  EffectorData efd;
-  int p = 0, tot = 1, step = 1;
 
   /* Cycle through collected objects, get total of (1/(gravity_strength * dist^gravity_power)) */
   /* Check for min distance here? (yes would be cool to add that, ton) */
 
   if (effectors) {
     for (eff = effectors->first; eff; eff = eff->next) {
-      /* object effectors were fully checked to be OK to evaluate! */
+      effector_apply(eff, colliders, weights, point, force, impulse);
+    }
+  }
+}
 
-      get_effector_tot(eff, &efd, point, &tot, &p, &step);
+/* Number of points evaluated by a single task in #BKE_effectors_apply_array. */
+#define EFFECTORS_APPLY_CHUNK_SIZE 256
+
+typedef struct EffectorsApplyArrayData {
+  ListBase *effectors;
+  ListBase *colliders;
+  EffectorWeights *weights;
+  const EffectedPoint *point_template;
+  const float (*locs)[3];
+  const float (*vels)[3];
+  int totpoint;
+  float (*r_forces)[3];
+  float (*r_impulses)[3];
+} EffectorsApplyArrayData;
+
+static void effectors_apply_array_cb(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EffectorsApplyArrayData *data = (EffectorsApplyArrayData *)userdata;
+  const int start = chunk * EFFECTORS_APPLY_CHUNK_SIZE;
+  const int num = min_ii(EFFECTORS_APPLY_CHUNK_SIZE, data->totpoint - start);
+  EffectedPoint points[EFFECTORS_APPLY_CHUNK_SIZE];
+  float locs[EFFECTORS_APPLY_CHUNK_SIZE][3], vels[EFFECTORS_APPLY_CHUNK_SIZE][3];
+
+  for (int i = 0; i < num; i++) {
+    copy_v3_v3(locs[i], data->locs[start + i]);
+    copy_v3_v3(vels[i], data->vels[start + i]);
+
+    points[i] = *data->point_template;
+    points[i].loc = locs[i];
+    points[i].vel = vels[i];
+    points[i].index = start + i;
+  }
+
+  /* Loop over points for each effector, so effector data stays in cache. Forces of every point
+   * are still accumulated in the same order as #BKE_effectors_apply does. */
+  for (EffectorCache *eff = data->effectors->first; eff; eff = eff->next) {
+    for (int i = 0; i < num; i++) {
+      effector_apply(eff,
+                     data->colliders,
+                     data->weights,
+                     &points[i],
+                     data->r_forces[start + i],
+                     data->r_impulses ? data->r_impulses[start + i] : NULL);
+    }
+  }
+}
 
-      for (; p < tot; p += step) {
-        if (get_effector_data(eff, &efd, point, 0)) {
-          efd.falloff = effector_falloff(eff, &efd, point, weights);
+/**
+ * Evaluate effectors for an array of points, same as calling #BKE_effectors_apply for every
+ * point, with the point index set to its position in the array.
+ *
+ * Points are evaluated in parallel. Colliders needed for visibility checks are gathered once
+ * for all points instead of once per point and effector.
+ *
+ * \param point_template: Settings shared by all points, e.g. from #pd_point_from_loc.
+ * Particles with dynamic rotation are not supported.
+ * \param r_forces, r_impulses: Forces and optional impulses are added to these arrays.
+ */
+void BKE_effectors_apply_array(ListBase *effectors,
+                               ListBase *colliders,
+                               EffectorWeights *weights,
+                               const EffectedPoint *point_template,
+                               const float (*locs)[3],
+                               const float (*vels)[3],
+                               int totpoint,
+                               float (*r_forces)[3],
+                               float (*r_impulses)[3])
+{
+  ListBase *colliders_shared = NULL;
+  bool use_threading = true;
 
-          if (efd.falloff > 0.0f) {
-            efd.falloff *= eff_calc_visibility(colliders, eff, &efd, point);
-          }
-          if (efd.falloff <= 0.0f) {
-            /* don't do anything */
-          }
-          else if (eff->pd->forcefield == PFIELD_TEXTURE) {
-            do_texture_effector(eff, &efd, point, force);
-          }
-          else {
-            float temp1[3] = {0, 0, 0}, temp2[3];
-            copy_v3_v3(temp1, force);
+  BLI_assert(point_template->ave == NULL && point_template->rot == NULL);
 
-            do_physical_effector(eff, &efd, point, force);
+  if (effectors == NULL || BLI_listbase_is_empty(effectors) || totpoint == 0) {
+    return;
+  }
 
-            /* for softbody backward compatibility */
-            if (point->flag & PE_WIND_AS_SPEED && impulse) {
-              sub_v3_v3v3(temp2, force, temp1);
-              sub_v3_v3v3(impulse, impulse, temp2);
-            }
-          }
-        }
-        else if (eff->flag & PE_VELOCITY_TO_IMPULSE && impulse) {
-          /* special case for harmonic effector */
-          add_v3_v3v3(impulse, impulse, efd.vel);
-        }
-      }
+  for (EffectorCache *eff = effectors->first; eff; eff = eff->next) {
+    if (colliders == NULL && colliders_shared == NULL && (eff->pd->flag & PFIELD_VISIBILITY)) {
+      /* Effectors skip their own object when checking visibility, so the cache is shared. */
+      colliders_shared = BKE_collider_cache_create(eff->depsgraph, NULL, NULL);
+    }
+
+    /* Noise uses the random generator of the effector, so the order of evaluation matters.
+     * Particle states may be read from the point cache. */
+    if ((eff->pd->f_noise > 0.0f) || eff->psys) {
+      use_threading = false;
     }
   }
+
+  EffectorsApplyArrayData data = {
+      .effectors = effectors,
+      .colliders = colliders ? colliders : colliders_shared,
+      .weights = weights,
+      .point_template = point_template,
+      .locs = locs,
+      .vels = vels,
+      .totpoint = totpoint,
+      .r_forces = r_forces,
+      .r_impulses = r_impulses,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threading && (totpoint > EFFECTORS_APPLY_CHUNK_SIZE);
+  BLI_task_parallel_range(0,
+                          (totpoint + EFFECTORS_APPLY_CHUNK_SIZE - 1) /
+                              EFFECTORS_APPLY_CHUNK_SIZE,
+                          &data,
+                          effectors_apply_array_cb,
+                          &settings);
+
+  if (colliders_shared) {
+    BKE_collider_cache_free(&colliders_shared);
+  }
 }
 
 /* ======== Simulation Debugging ======== */
@@ -587,7 +587,9 @@ void BKE_mesh_copy_data(Main *bmain, Mesh *me_dst, const Mesh *me_src, const int
 
   me_dst->mat = MEM_dupallocN(me_src->mat);
 
-  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE : CD_DUPLICATE;
+  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ?
+                                     CD_REFERENCE :
+                                     (flag & LIB_ID_COPY_CD_SHARE) ? CD_SHARE : CD_DUPLICATE;
   CustomData_copy(&me_src->vdata, &me_dst->vdata, mask.vmask, alloc_type, me_dst->totvert);
   CustomData_copy(&me_src->edata, &me_dst->edata, mask.emask, alloc_type, me_dst->totedge);
   CustomData_copy(&me_src->ldata, &me_dst->ldata, mask.lmask, alloc_type, me_dst->totloop);
@@ -758,6 +760,27 @@ Mesh *BKE_mesh_copy_for_eval(struct Mesh *source, bool reference)
   return result;
 }
 
+/**
+ * Copy of an evaluated mesh which shares all its layers with \a source (see #CD_SHARE).
+ * Arrays are copied by whichever mesh modifies them first, so unlike referenced layers
+ * the copy stays valid when the source is freed.
+ *
+ * \note Gives the layers of \a source a shared storage, so it can't be used from other threads
+ * meanwhile. Original meshes are never shared, they are modified without copying arrays.
+ */
+Mesh *BKE_mesh_copy_for_eval_shared(Mesh *source)
+{
+  CustomData_ensure_shared(&source->vdata, source->totvert);
+  CustomData_ensure_shared(&source->edata, source->totedge);
+  CustomData_ensure_shared(&source->ldata, source->totloop);
+  CustomData_ensure_shared(&source->pdata, source->totpoly);
+
+  Mesh *result;
+  BKE_id_copy_ex(
+      NULL, &source->id, (ID **)&result, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+  return result;
+}
+
 Mesh *BKE_mesh_copy(Main *bmain, const Mesh *me)
 {
   Mesh *me_copy;
@@ -1615,7 +1638,8 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
   const float split_angle = (mesh->flag & ME_AUTOSMOOTH) != 0 ? mesh->smoothresh : (float)M_PI;
 
   if (CustomData_has_layer(&mesh->ldata, CD_NORMAL)) {
-    r_loopnors = CustomData_get_layer(&mesh->ldata, CD_NORMAL);
+    /* Normals may be shared with cached modifier results. */
+    r_loopnors = CustomData_unshare_layer(&mesh->ldata, CD_NORMAL, mesh->totloop);
     memset(r_loopnors, 0, sizeof(float[3]) * mesh->totloop);
   }
   else {
@@ -1634,6 +1658,7 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
   }
   else {
     polynors = MEM_malloc_arrayN(mesh->totpoly, sizeof(float[3]), __func__);
+    mesh->mvert = CustomData_unshare_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
     BKE_mesh_calc_normals_poly(mesh->mvert,
                                NULL,
                                mesh->totvert,
@@ -1954,6 +1979,7 @@ void BKE_mesh_eval_geometry(Depsgraph *depsgraph, Mesh *mesh)
     BKE_id_free(NULL, mesh->runtime.mesh_eval);
     mesh->runtime.mesh_eval = NULL;
   }
+  BKE_mesh_runtime_shared_eval_clear(mesh);
   if (DEG_is_active(depsgraph)) {
     Mesh *mesh_orig = (Mesh *)DEG_get_original_id(&mesh->id);
     if (mesh->texflag & ME_AUTOSPACE_EVALUATED) {
@@ -402,6 +402,13 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
 
   if (do_vert_normals || do_poly_normals) {
     const bool do_add_poly_nors_cddata = (poly_nors == NULL);
+    /* Data written in place may be shared with cached modifier results. */
+    if (do_vert_normals) {
+      mesh->mvert = CustomData_unshare_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
+    }
+    if (!do_add_poly_nors_cddata) {
+      poly_nors = CustomData_unshare_layer(&mesh->pdata, CD_NORMAL, mesh->totpoly);
+    }
     if (do_add_poly_nors_cddata) {
       poly_nors = MEM_malloc_arrayN((size_t)mesh->totpoly, sizeof(*poly_nors), __func__);
     }
@@ -433,6 +440,8 @@ void BKE_mesh_calc_normals(Mesh *mesh)
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
+  /* Vertices may be shared with cached modifier results. */
+  mesh->mvert = CustomData_unshare_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
   BKE_mesh_calc_normals_poly(mesh->mvert,
                              NULL,
                              mesh->totvert,
@@ -32,6 +32,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_object_types.h"
@@ -56,16 +57,42 @@
 #  include "quadriflow_capi.hpp"
 #endif
 
+/* Conversions between meshes and the remesher arrays are done in parallel above this size. */
+#define REMESH_PARALLEL_MIN_ITER 4096
+
 #ifdef WITH_OPENVDB
+typedef struct LevelSetInputData {
+  const MVert *mvert;
+  const MLoop *mloop;
+  const MLoopTri *looptri;
+  float *verts;
+  unsigned int *faces;
+} LevelSetInputData;
+
+static void level_set_input_verts_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LevelSetInputData *data = userdata;
+  copy_v3_v3(&data->verts[i * 3], data->mvert[i].co);
+}
+
+static void level_set_input_faces_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LevelSetInputData *data = userdata;
+  const MLoopTri *lt = &data->looptri[i];
+  data->faces[i * 3] = data->mloop[lt->tri[0]].v;
+  data->faces[i * 3 + 1] = data->mloop[lt->tri[1]].v;
+  data->faces[i * 3 + 2] = data->mloop[lt->tri[2]].v;
+}
+
 struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
     Mesh *mesh, struct OpenVDBTransform *transform)
 {
   BKE_mesh_runtime_looptri_recalc(mesh);
   const MLoopTri *looptri = BKE_mesh_runtime_looptri_ensure(mesh);
-  MVertTri *verttri = MEM_callocN(sizeof(*verttri) * BKE_mesh_runtime_looptri_len(mesh),
-                                  "remesh_looptri");
-  BKE_mesh_runtime_verttri_from_looptri(
-      verttri, mesh->mloop, looptri, BKE_mesh_runtime_looptri_len(mesh));
 
   unsigned int totfaces = BKE_mesh_runtime_looptri_len(mesh);
   unsigned int totverts = mesh->totvert;
@@ -73,30 +100,73 @@ struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
   unsigned int *faces = (unsigned int *)MEM_malloc_arrayN(
       totfaces * 3, sizeof(unsigned int), "remesh_intput_faces");
 
-  for (unsigned int i = 0; i < totverts; i++) {
-    MVert *mvert = &mesh->mvert[i];
-    verts[i * 3] = mvert->co[0];
-    verts[i * 3 + 1] = mvert->co[1];
-    verts[i * 3 + 2] = mvert->co[2];
-  }
+  LevelSetInputData data = {
+      .mvert = mesh->mvert,
+      .mloop = mesh->mloop,
+      .looptri = looptri,
+      .verts = verts,
+      .faces = faces,
+  };
 
-  for (unsigned int i = 0; i < totfaces; i++) {
-    MVertTri *vt = &verttri[i];
-    faces[i * 3] = vt->tri[0];
-    faces[i * 3 + 1] = vt->tri[1];
-    faces[i * 3 + 2] = vt->tri[2];
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = REMESH_PARALLEL_MIN_ITER;
+  BLI_task_parallel_range(0, (int)totverts, &data, level_set_input_verts_cb, &settings);
+  BLI_task_parallel_range(0, (int)totfaces, &data, level_set_input_faces_cb, &settings);
 
   struct OpenVDBLevelSet *level_set = OpenVDBLevelSet_create(false, NULL);
   OpenVDBLevelSet_mesh_to_level_set(level_set, verts, faces, totverts, totfaces, transform);
 
   MEM_freeN(verts);
   MEM_freeN(faces);
-  MEM_freeN(verttri);
 
   return level_set;
 }
 
+typedef struct VolumeToMeshData {
+  const struct OpenVDBVolumeToMeshData *output_mesh;
+  Mesh *mesh;
+} VolumeToMeshData;
+
+static void volume_to_mesh_verts_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VolumeToMeshData *data = userdata;
+  copy_v3_v3(data->mesh->mvert[i].co, &data->output_mesh->vertices[i * 3]);
+}
+
+/* Quads come first, followed by triangles: the loops of every face are known up-front. */
+static void volume_to_mesh_faces_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VolumeToMeshData *data = userdata;
+  const struct OpenVDBVolumeToMeshData *output_mesh = data->output_mesh;
+  MPoly *mp = &data->mesh->mpoly[i];
+
+  if (i < output_mesh->totquads) {
+    MLoop *ml = &data->mesh->mloop[i * 4];
+    mp->loopstart = i * 4;
+    mp->totloop = 4;
+
+    ml[0].v = output_mesh->quads[i * 4 + 3];
+    ml[1].v = output_mesh->quads[i * 4 + 2];
+    ml[2].v = output_mesh->quads[i * 4 + 1];
+    ml[3].v = output_mesh->quads[i * 4];
+  }
+  else {
+    const int i_tri = i - output_mesh->totquads;
+    MLoop *ml = &data->mesh->mloop[(output_mesh->totquads * 4) + (i_tri * 3)];
+    mp->loopstart = (int)(ml - data->mesh->mloop);
+    mp->totloop = 3;
+
+    ml[0].v = output_mesh->triangles[i_tri * 3 + 2];
+    ml[1].v = output_mesh->triangles[i_tri * 3 + 1];
+    ml[2].v = output_mesh->triangles[i_tri * 3];
+  }
+}
+
 Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *level_set,
                                                        double isovalue,
                                                        double adaptivity,
@@ -114,30 +184,16 @@ Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *l
                                    (output_mesh.totquads * 4) + (output_mesh.tottriangles * 3),
                                    output_mesh.totquads + output_mesh.tottriangles);
 
-  for (int i = 0; i < output_mesh.totvertices; i++) {
-    copy_v3_v3(mesh->mvert[i].co, &output_mesh.vertices[i * 3]);
-  }
-
-  MPoly *mp = mesh->mpoly;
-  MLoop *ml = mesh->mloop;
-  for (int i = 0; i < output_mesh.totquads; i++, mp++, ml += 4) {
-    mp->loopstart = (int)(ml - mesh->mloop);
-    mp->totloop = 4;
-
-    ml[0].v = output_mesh.quads[i * 4 + 3];
-    ml[1].v = output_mesh.quads[i * 4 + 2];
-    ml[2].v = output_mesh.quads[i * 4 + 1];
-    ml[3].v = output_mesh.quads[i * 4];
-  }
-
-  for (int i = 0; i < output_mesh.tottriangles; i++, mp++, ml += 3) {
-    mp->loopstart = (int)(ml - mesh->mloop);
-    mp->totloop = 3;
+  VolumeToMeshData data = {
+      .output_mesh = &output_mesh,
+      .mesh = mesh,
+  };
 
-    ml[0].v = output_mesh.triangles[i * 3 + 2];
-    ml[1].v = output_mesh.triangles[i * 3 + 1];
-    ml[2].v = output_mesh.triangles[i * 3];
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = REMESH_PARALLEL_MIN_ITER;
+  BLI_task_parallel_range(0, mesh->totvert, &data, volume_to_mesh_verts_cb, &settings);
+  BLI_task_parallel_range(0, mesh->totpoly, &data, volume_to_mesh_faces_cb, &settings);
 
   BKE_mesh_calc_edges(mesh, false, false);
   BKE_mesh_calc_normals(mesh);
@@ -316,6 +372,29 @@ Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(Mesh *mesh,
   return new_mesh;
 }
 
+typedef struct ReprojectPaintMaskData {
+  BVHTreeFromMesh *bvhtree;
+  const MVert *target_verts;
+  float *target_mask;
+  const float *source_mask;
+} ReprojectPaintMaskData;
+
+static void reproject_paint_mask_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReprojectPaintMaskData *data = userdata;
+  BVHTreeFromMesh *bvhtree = data->bvhtree;
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = FLT_MAX;
+  BLI_bvhtree_find_nearest(
+      bvhtree->tree, data->target_verts[i].co, &nearest, bvhtree->nearest_callback, bvhtree);
+  if (nearest.index != -1) {
+    data->target_mask[i] = data->source_mask[nearest.index];
+  }
+}
+
 void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
 {
   BVHTreeFromMesh bvhtree = {
@@ -342,17 +421,18 @@ void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
         &source->vdata, CD_PAINT_MASK, CD_CALLOC, NULL, source->totvert);
   }
 
-  for (int i = 0; i < target->totvert; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    copy_v3_v3(from_co, target_verts[i].co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_mask[i] = source_mask[nearest.index];
-    }
-  }
+  ReprojectPaintMaskData data = {
+      .bvhtree = &bvhtree,
+      .target_verts = target_verts,
+      .target_mask = target_mask,
+      .source_mask = source_mask,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = REMESH_PARALLEL_MIN_ITER;
+  BLI_task_parallel_range(0, target->totvert, &data, reproject_paint_mask_cb, &settings);
+
   free_bvhtree_from_mesh(&bvhtree);
 }
 
@@ -436,12 +516,17 @@ struct Mesh *BKE_mesh_remesh_voxel_fix_poles(struct Mesh *mesh)
   for (int i = 0; i < 4; i++) {
     BM_ITER_MESH (v, &iter_a, bm, BM_VERTS_OF_MESH) {
       float co[3];
+      int tot = 0;
       zero_v3(co);
       BM_ITER_ELEM (ed, &iter_b, v, BM_EDGES_OF_VERT) {
         BMVert *vert = BM_edge_other_vert(ed, v);
         add_v3_v3(co, vert->co);
+        tot++;
+      }
+      if (tot == 0) {
+        continue;
       }
-      mul_v3_fl(co, 1.0f / (float)BM_vert_edge_count(v));
+      mul_v3_fl(co, 1.0f / (float)tot);
       mid_v3_v3v3(v->co, v->co, co);
     }
   }
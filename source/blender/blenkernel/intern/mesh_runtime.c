@@ -29,6 +29,7 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_listbase.h"
 #include "BLI_math_geom.h"
 #include "BLI_threads.h"
 
@@ -36,6 +37,7 @@
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
+#include "BKE_modifier.h"
 #include "BKE_subdiv_ccg.h"
 #include "BKE_shrinkwrap.h"
 
@@ -63,6 +65,7 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   Mesh_Runtime *runtime = &mesh->runtime;
 
   runtime->mesh_eval = NULL;
+  BLI_listbase_clear(&runtime->shared_evals);
   runtime->edit_data = NULL;
   runtime->batch_cache = NULL;
   runtime->subdiv_ccg = NULL;
@@ -76,6 +79,7 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
 
 void BKE_mesh_runtime_clear_cache(Mesh *mesh)
 {
+  BKE_mesh_runtime_shared_eval_clear(mesh);
   if (mesh->runtime.eval_mutex != NULL) {
     BLI_mutex_end(mesh->runtime.eval_mutex);
     MEM_freeN(mesh->runtime.eval_mutex);
@@ -178,6 +182,43 @@ const MLoopTri *BKE_mesh_runtime_looptri_ensure(Mesh *mesh)
   return looptri;
 }
 
+/**
+ * Initialize the triangulation of \a mesh from \a mesh_src, which must have the same topology.
+ * When the vertex coordinates differ, this is only valid for meshes made of triangles, see
+ * #BKE_mesh_runtime_looptri_is_coords_independent.
+ */
+void BKE_mesh_runtime_looptri_copy_from(Mesh *mesh, Mesh *mesh_src)
+{
+  BLI_assert(mesh->totpoly == mesh_src->totpoly && mesh->totloop == mesh_src->totloop);
+  const MLoopTri *looptri_src = BKE_mesh_runtime_looptri_ensure(mesh_src);
+
+  BLI_rw_mutex_lock(&loops_cache_lock, THREAD_LOCK_WRITE);
+  if (mesh->runtime.looptris.array == NULL) {
+    mesh_ensure_looptri_data(mesh);
+    if (mesh->totpoly) {
+      memcpy(mesh->runtime.looptris.array_wip,
+             looptri_src,
+             sizeof(*looptri_src) * (size_t)mesh->runtime.looptris.len);
+    }
+    atomic_cas_ptr((void **)&mesh->runtime.looptris.array,
+                   mesh->runtime.looptris.array,
+                   mesh->runtime.looptris.array_wip);
+    mesh->runtime.looptris.array_wip = NULL;
+  }
+  BLI_rw_mutex_unlock(&loops_cache_lock);
+}
+
+/**
+ * Whether the triangulation of the mesh does not depend on its vertex coordinates, so it stays
+ * valid when the vertices are deformed. Only true for meshes made of triangles: the split of
+ * quads is flipped out of degenerate states and n-gons are filled in their projection.
+ */
+bool BKE_mesh_runtime_looptri_is_coords_independent(const Mesh *mesh)
+{
+  /* Polygons have at least three corners. */
+  return mesh->totloop == mesh->totpoly * 3;
+}
+
 /* This is a copy of DM_verttri_from_looptri(). */
 void BKE_mesh_runtime_verttri_from_looptri(MVertTri *r_verttri,
                                            const MLoop *mloop,
@@ -239,6 +280,135 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Modifier Stack Results
+ *
+ * Objects using the same mesh with identical modifier stacks evaluate the stack only once: the
+ * first object evaluates it and stores the result in the mesh, other objects get a copy of it
+ * which shares its arrays (see #CD_SHARE). Every object owns its copy, so results can be freed
+ * at any time without affecting the objects using them.
+ *
+ * Results are only shared within one evaluation of the dependency graph: objects linked by the
+ * modifiers may change without the key changing (data which is not hashed), so results of
+ * previous evaluations are never reused.
+ * \{ */
+
+/* Results of stacks which are not used anymore are kept until there are more than this. */
+#define MESH_SHARED_EVAL_MAX 8
+
+typedef struct MeshSharedEval {
+  struct MeshSharedEval *next, *prev;
+  ModifierCacheKey key;
+  /** Update count of the dependency graph evaluating the stack, see #DEG_get_update_count. */
+  int update_count;
+  /** Objects currently accessing the result, which is not freed meanwhile. */
+  int users;
+  /** Held by the object evaluating the stack, other objects wait for the result. */
+  ThreadMutex mutex;
+  bool is_evaluated;
+  /** NULL when the result could not be shared. */
+  Mesh *mesh_eval;
+} MeshSharedEval;
+
+static void mesh_shared_eval_free(Mesh *mesh, MeshSharedEval *shared)
+{
+  BLI_assert(shared->users == 0);
+  BLI_remlink(&mesh->runtime.shared_evals, shared);
+  BLI_mutex_end(&shared->mutex);
+  if (shared->mesh_eval != NULL) {
+    BKE_id_free(NULL, shared->mesh_eval);
+  }
+  MEM_freeN(shared);
+}
+
+/**
+ * Get the result of the modifier stack with the given key. When \a r_is_evaluated is false, the
+ * caller is to evaluate the stack and pass its result to #BKE_mesh_runtime_shared_eval_release,
+ * other objects asking for the same key wait until then.
+ * \param update_count: Update count of the dependency graph, results of previous evaluations
+ * are freed.
+ */
+struct MeshSharedEval *BKE_mesh_runtime_shared_eval_acquire(Mesh *mesh,
+                                                            const ModifierCacheKey *key,
+                                                            int update_count,
+                                                            Mesh **r_mesh_eval,
+                                                            bool *r_is_evaluated)
+{
+  MeshSharedEval *shared = NULL;
+
+  BLI_mutex_lock(mesh->runtime.eval_mutex);
+  LISTBASE_FOREACH_MUTABLE (MeshSharedEval *, shared_iter, &mesh->runtime.shared_evals) {
+    if (shared_iter->update_count != update_count) {
+      if (shared_iter->users == 0) {
+        mesh_shared_eval_free(mesh, shared_iter);
+      }
+    }
+    else if (shared == NULL && BKE_modifier_cache_key_equals(&shared_iter->key, key)) {
+      shared = shared_iter;
+    }
+  }
+  if (shared == NULL) {
+    shared = MEM_callocN(sizeof(*shared), __func__);
+    shared->key = *key;
+    shared->update_count = update_count;
+    BLI_mutex_init(&shared->mutex);
+  }
+  else {
+    BLI_remlink(&mesh->runtime.shared_evals, shared);
+  }
+  BLI_addhead(&mesh->runtime.shared_evals, shared);
+  shared->users++;
+  BLI_mutex_unlock(mesh->runtime.eval_mutex);
+
+  BLI_mutex_lock(&shared->mutex);
+  *r_mesh_eval = shared->mesh_eval;
+  *r_is_evaluated = shared->is_evaluated;
+  return shared;
+}
+
+/**
+ * Release the result acquired with #BKE_mesh_runtime_shared_eval_acquire.
+ * \param mesh_eval: Result of the evaluation of the stack, ownership is taken. Only used when
+ * the stack was evaluated by the caller, NULL when the result is not to be shared.
+ */
+void BKE_mesh_runtime_shared_eval_release(Mesh *mesh,
+                                          struct MeshSharedEval *shared,
+                                          Mesh *mesh_eval)
+{
+  if (!shared->is_evaluated) {
+    shared->mesh_eval = mesh_eval;
+    shared->is_evaluated = true;
+  }
+  else {
+    BLI_assert(mesh_eval == NULL);
+  }
+  BLI_mutex_unlock(&shared->mutex);
+
+  BLI_mutex_lock(mesh->runtime.eval_mutex);
+  shared->users--;
+  int shared_len = BLI_listbase_count(&mesh->runtime.shared_evals);
+  MeshSharedEval *shared_iter = mesh->runtime.shared_evals.last;
+  while (shared_iter && shared_len > MESH_SHARED_EVAL_MAX) {
+    MeshSharedEval *shared_prev = shared_iter->prev;
+    if (shared_iter->users == 0) {
+      mesh_shared_eval_free(mesh, shared_iter);
+      shared_len--;
+    }
+    shared_iter = shared_prev;
+  }
+  BLI_mutex_unlock(mesh->runtime.eval_mutex);
+}
+
+/* Free all shared results, the mesh they were evaluated from changed. */
+void BKE_mesh_runtime_shared_eval_clear(Mesh *mesh)
+{
+  LISTBASE_FOREACH_MUTABLE (MeshSharedEval *, shared, &mesh->runtime.shared_evals) {
+    mesh_shared_eval_free(mesh, shared);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Batch Cache Callbacks
  * \{ */
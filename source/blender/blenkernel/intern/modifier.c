@@ -970,8 +970,9 @@ void modwrap_deformVerts(ModifierData *md,
   const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
   BLI_assert(!me || CustomData_has_layer(&me->pdata, CD_NORMAL) == false);
 
+  /* Deformed meshes tag their normals dirty, only recalculate when they actually changed. */
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
-    BKE_mesh_calc_normals(me);
+    BKE_mesh_ensure_normals(me);
   }
   mti->deformVerts(md, ctx, me, vertexCos, numVerts);
 }
@@ -987,7 +988,7 @@ void modwrap_deformVertsEM(ModifierData *md,
   BLI_assert(!me || CustomData_has_layer(&me->pdata, CD_NORMAL) == false);
 
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
-    BKE_mesh_calc_normals(me);
+    BKE_mesh_ensure_normals(me);
   }
   mti->deformVertsEM(md, ctx, em, me, vertexCos, numVerts);
 }
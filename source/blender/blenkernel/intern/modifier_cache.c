@@ -0,0 +1,514 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * Cache of the results of expensive modifiers of an evaluated object.
+ *
+ * Every result is stored with a key which is a hash of everything the modifier result depends on:
+ * the input mesh, the modifier settings and the objects it links to. The key of the input mesh is
+ * either hashed from its content, or derived from the key of the previous cached modifier result
+ * when nothing changed the mesh in between. This way tweaking the last modifier of a stack reuses
+ * the results of the modifiers before it, and playing back an animation which loops back to a
+ * state seen before reuses the results computed for it.
+ *
+ * Cached meshes share their arrays with the meshes handed to the modifier stack (see #CD_SHARE),
+ * so storing and restoring a result does not copy geometry. Modifiers and normal calculation make
+ * shared arrays local before writing to them (see #CustomData_duplicate_referenced_layer and
+ * #CustomData_unshare_layer).
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_curveprofile_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_hash_mm2a.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph_query.h"
+
+/* Memory used by all the cached results of all objects, before the least recently used results
+ * are discarded. This is an upper bound, results share most of their arrays with the evaluated
+ * mesh. */
+#define MODIFIER_CACHE_MEMORY_LIMIT ((size_t)512 * 1024 * 1024)
+
+typedef struct ModifierCacheEntry {
+  struct ModifierCacheEntry *next, *prev;
+  /** Link in #modifier_cache_lru. */
+  LinkData lru_link;
+  struct ModifierResultCache *cache;
+  /** Original modifier which generated the result, only used for lookup. */
+  const ModifierData *md_orig;
+  ModifierCacheKey key;
+  /** Value of #ModifierResultCache.generation when the entry was last used. */
+  int generation;
+  size_t mem_size;
+  Mesh *mesh;
+} ModifierCacheEntry;
+
+typedef struct ModifierResultCache {
+  /** Most recently used entries of the object first. */
+  ListBase entries;
+  /** Incremented after every evaluation of the modifier stack. */
+  int generation;
+} ModifierResultCache;
+
+/* Objects are evaluated from multiple threads, and storing a result of one object may discard
+ * results of other objects. All caches are accessed with this lock held. */
+static ThreadMutex modifier_cache_lock = BLI_MUTEX_INITIALIZER;
+/* Entries of all objects, most recently used first. */
+static ListBase modifier_cache_lru = {NULL, NULL};
+static size_t modifier_cache_mem_size = 0;
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ *
+ * Keys are hashed twice with different seeds, with the thousands of results seen over an editing
+ * session a single 32 bit hash is likely to collide. The element counts of the input mesh are
+ * compared as well.
+ * \{ */
+
+typedef struct ModifierCacheHash {
+  BLI_HashMurmur2A mm2[2];
+} ModifierCacheHash;
+
+static void cache_hash_init(ModifierCacheHash *hash, const uint32_t seed[2])
+{
+  BLI_hash_mm2a_init(&hash->mm2[0], seed[0]);
+  BLI_hash_mm2a_init(&hash->mm2[1], seed[1] ^ 0x9e3779b9);
+}
+
+static void cache_hash_add(ModifierCacheHash *hash, const void *data, size_t len)
+{
+  BLI_hash_mm2a_add(&hash->mm2[0], (const unsigned char *)data, len);
+  BLI_hash_mm2a_add(&hash->mm2[1], (const unsigned char *)data, len);
+}
+
+static void cache_hash_add_int(ModifierCacheHash *hash, int data)
+{
+  BLI_hash_mm2a_add_int(&hash->mm2[0], data);
+  BLI_hash_mm2a_add_int(&hash->mm2[1], data);
+}
+
+static void cache_hash_end(ModifierCacheHash *hash, uint32_t r_hash[2])
+{
+  r_hash[0] = BLI_hash_mm2a_end(&hash->mm2[0]);
+  r_hash[1] = BLI_hash_mm2a_end(&hash->mm2[1]);
+}
+
+static bool customdata_hash(ModifierCacheHash *hash, const CustomData *data, int totelem)
+{
+  cache_hash_add_int(hash, totelem);
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+
+    cache_hash_add_int(hash, layer->type);
+    cache_hash_add(hash, layer->name, strlen(layer->name));
+    if (layer->data == NULL) {
+      continue;
+    }
+
+    switch (layer->type) {
+      case CD_MDEFORMVERT: {
+        const MDeformVert *dvert = layer->data;
+        for (int j = 0; j < totelem; j++) {
+          cache_hash_add_int(hash, dvert[j].totweight);
+          if (dvert[j].dw != NULL) {
+            cache_hash_add(hash, dvert[j].dw, sizeof(MDeformWeight) * (size_t)dvert[j].totweight);
+          }
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+        /* Elements point to data of variable size, not worth supporting. */
+        return false;
+      default:
+        cache_hash_add(
+            hash, layer->data, (size_t)CustomData_sizeof(layer->type) * (size_t)totelem);
+        break;
+    }
+  }
+  return true;
+}
+
+static bool mesh_hash(ModifierCacheHash *hash, const Mesh *mesh)
+{
+  cache_hash_add_int(hash, mesh->flag);
+  cache_hash_add_int(hash, mesh->cd_flag);
+  cache_hash_add_int(hash, mesh->totcol);
+  cache_hash_add(hash, &mesh->smoothresh, sizeof(mesh->smoothresh));
+
+  return customdata_hash(hash, &mesh->vdata, mesh->totvert) &&
+         customdata_hash(hash, &mesh->edata, mesh->totedge) &&
+         customdata_hash(hash, &mesh->ldata, mesh->totloop) &&
+         customdata_hash(hash, &mesh->pdata, mesh->totpoly);
+}
+
+static void mesh_key_counts_set(const Mesh *mesh, ModifierCacheKey *r_key)
+{
+  r_key->totvert = mesh->totvert;
+  r_key->totedge = mesh->totedge;
+  r_key->totloop = mesh->totloop;
+  r_key->totpoly = mesh->totpoly;
+}
+
+/**
+ * Hash the content of a mesh used as input of a modifier.
+ * Returns false when the mesh contains data which can not be hashed.
+ */
+bool BKE_modifier_cache_mesh_key(const Mesh *mesh, ModifierCacheKey *r_key)
+{
+  const uint32_t seed[2] = {0, 0};
+  ModifierCacheHash hash;
+  cache_hash_init(&hash, seed);
+  if (!mesh_hash(&hash, mesh)) {
+    return false;
+  }
+  cache_hash_end(&hash, r_key->hash);
+  mesh_key_counts_set(mesh, r_key);
+  return true;
+}
+
+typedef struct LinkedIDHashData {
+  ModifierCacheHash *hash;
+  bool has_links;
+  bool is_valid;
+} LinkedIDHashData;
+
+static void modifier_cache_linked_id_hash(void *user_data,
+                                          Object *UNUSED(ob),
+                                          ID **idpoin,
+                                          int UNUSED(cb_flag))
+{
+  LinkedIDHashData *data = user_data;
+  ID *id = *idpoin;
+
+  if (id == NULL) {
+    return;
+  }
+  data->has_links = true;
+  if (GS(id->name) != ID_OB) {
+    data->is_valid = false;
+    return;
+  }
+
+  /* Results are also shared between objects using the same mesh (see #mesh_build_data_shared),
+   * same content of different linked objects is not enough then. */
+  Object *ob_linked = (Object *)id;
+  cache_hash_add(data->hash, &ob_linked, sizeof(ob_linked));
+  cache_hash_add_int(data->hash, ob_linked->type);
+  cache_hash_add(data->hash, ob_linked->obmat, sizeof(ob_linked->obmat));
+
+  if (ob_linked->type == OB_MESH) {
+    Mesh *mesh = BKE_modifier_get_evaluated_mesh_from_evaluated_object(ob_linked, false);
+    if (mesh == NULL || !mesh_hash(data->hash, mesh)) {
+      data->is_valid = false;
+    }
+  }
+}
+
+static void modifier_settings_hash(ModifierCacheHash *hash,
+                                   const ModifierEvalContext *ctx,
+                                   ModifierData *md)
+{
+  const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+  const size_t header_size = sizeof(ModifierData);
+
+  cache_hash_add_int(hash, md->type);
+
+  if (md->type == eModifierType_Subsurf) {
+    /* Skip the caches of the old subdivision code. The levels are limited by the simplify
+     * settings of the scene. */
+    const SubsurfModifierData *smd = (const SubsurfModifierData *)md;
+    const Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
+    const bool use_render_params = (ctx->flag & MOD_APPLY_RENDER) != 0;
+    cache_hash_add(hash,
+                   (const char *)md + header_size,
+                   offsetof(SubsurfModifierData, emCache) - header_size);
+    cache_hash_add_int(hash,
+                       get_render_subsurf_level(&scene->r,
+                                                use_render_params ? smd->renderLevels :
+                                                                    smd->levels,
+                                                use_render_params));
+    return;
+  }
+
+  if (md->type == eModifierType_Bevel) {
+    /* The profile is re-allocated on every copy-on-write update, hash its content instead. */
+    BevelModifierData bmd = *(BevelModifierData *)md;
+    const CurveProfile *profile = bmd.custom_profile;
+    bmd.custom_profile = NULL;
+    cache_hash_add(hash, (const char *)&bmd + header_size, sizeof(bmd) - header_size);
+    if (profile != NULL) {
+      cache_hash_add_int(hash, profile->flag);
+      cache_hash_add(hash, profile->path, sizeof(CurveProfilePoint) * (size_t)profile->path_len);
+    }
+    return;
+  }
+
+  cache_hash_add(hash, (const char *)md + header_size, (size_t)mti->structSize - header_size);
+}
+
+/**
+ * Compute the key of the result of the modifier from the key of its input mesh.
+ * \param mesh_input: Input mesh of the modifier, when NULL the element counts of \a input_key
+ * are used.
+ * Returns false when the result can not be cached.
+ */
+bool BKE_modifier_cache_key(const ModifierEvalContext *ctx,
+                            ModifierData *md,
+                            const CustomData_MeshMasks *mask,
+                            const Mesh *mesh_input,
+                            const ModifierCacheKey *input_key,
+                            ModifierCacheKey *r_key)
+{
+  const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+  Object *ob = ctx->object;
+
+  if ((mti->flags & eModifierTypeFlag_SupportsResultCache) == 0) {
+    return false;
+  }
+  if (mti->dependsOnTime && mti->dependsOnTime(md)) {
+    return false;
+  }
+
+  ModifierCacheKey key = *input_key;
+  if (mesh_input != NULL) {
+    mesh_key_counts_set(mesh_input, &key);
+  }
+
+  ModifierCacheHash hash;
+  cache_hash_init(&hash, input_key->hash);
+  cache_hash_add_int(&hash, ctx->flag);
+  cache_hash_add(&hash, mask, sizeof(*mask));
+
+  modifier_settings_hash(&hash, ctx, md);
+
+  /* Vertex groups are referenced by name. */
+  LISTBASE_FOREACH (const bDeformGroup *, dg, &ob->defbase) {
+    cache_hash_add(&hash, dg->name, strlen(dg->name));
+  }
+  cache_hash_add_int(&hash, ob->totcol);
+
+  LinkedIDHashData data = {&hash, false, true};
+  if (mti->foreachIDLink) {
+    mti->foreachIDLink(md, ob, modifier_cache_linked_id_hash, &data);
+  }
+  else if (mti->foreachObjectLink) {
+    mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_cache_linked_id_hash, &data);
+  }
+  if (!data.is_valid) {
+    return false;
+  }
+  if (data.has_links) {
+    /* Linked objects are used relative to the modified object. */
+    cache_hash_add(&hash, ob->obmat, sizeof(ob->obmat));
+  }
+
+  cache_hash_end(&hash, key.hash);
+  *r_key = key;
+  return true;
+}
+
+bool BKE_modifier_cache_key_equals(const ModifierCacheKey *key_a, const ModifierCacheKey *key_b)
+{
+  return key_a->hash[0] == key_b->hash[0] && key_a->hash[1] == key_b->hash[1] &&
+         key_a->totvert == key_b->totvert && key_a->totedge == key_b->totedge &&
+         key_a->totloop == key_b->totloop && key_a->totpoly == key_b->totpoly;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Storage
+ * \{ */
+
+static const ModifierData *modifier_cache_md_orig(ModifierData *md)
+{
+  return (md->orig_modifier_data != NULL) ? md->orig_modifier_data : md;
+}
+
+static size_t customdata_mem_size(const CustomData *data, int totelem)
+{
+  size_t size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    size += (size_t)CustomData_sizeof(data->layers[i].type) * (size_t)totelem;
+  }
+  return size;
+}
+
+static size_t mesh_mem_size(const Mesh *mesh)
+{
+  return customdata_mem_size(&mesh->vdata, mesh->totvert) +
+         customdata_mem_size(&mesh->edata, mesh->totedge) +
+         customdata_mem_size(&mesh->ldata, mesh->totloop) +
+         customdata_mem_size(&mesh->pdata, mesh->totpoly);
+}
+
+static Mesh *mesh_copy_shared(Mesh *mesh)
+{
+  return BKE_mesh_copy_for_eval_shared(mesh);
+}
+
+static void modifier_cache_entry_free(ModifierCacheEntry *entry)
+{
+  BLI_remlink(&entry->cache->entries, entry);
+  BLI_remlink(&modifier_cache_lru, &entry->lru_link);
+  modifier_cache_mem_size -= entry->mem_size;
+  BKE_id_free(NULL, entry->mesh);
+  MEM_freeN(entry);
+}
+
+static void modifier_cache_entry_use(ModifierCacheEntry *entry)
+{
+  ModifierResultCache *cache = entry->cache;
+  entry->generation = cache->generation;
+  BLI_remlink(&cache->entries, entry);
+  BLI_addhead(&cache->entries, entry);
+  BLI_remlink(&modifier_cache_lru, &entry->lru_link);
+  BLI_addhead(&modifier_cache_lru, &entry->lru_link);
+}
+
+/**
+ * Get a copy of the cached result of the modifier for the given key, or NULL.
+ * The copy shares its arrays with the cached result.
+ */
+Mesh *BKE_modifier_cache_lookup(Object *ob_eval, ModifierData *md, const ModifierCacheKey *key)
+{
+  Mesh *mesh = NULL;
+
+  BLI_mutex_lock(&modifier_cache_lock);
+  ModifierResultCache *cache = ob_eval->runtime.modifier_cache;
+  if (cache != NULL) {
+    const ModifierData *md_orig = modifier_cache_md_orig(md);
+    LISTBASE_FOREACH (ModifierCacheEntry *, entry, &cache->entries) {
+      if (entry->md_orig == md_orig && BKE_modifier_cache_key_equals(&entry->key, key)) {
+        modifier_cache_entry_use(entry);
+        mesh = mesh_copy_shared(entry->mesh);
+        break;
+      }
+    }
+  }
+  BLI_mutex_unlock(&modifier_cache_lock);
+  return mesh;
+}
+
+/**
+ * Store the result of the modifier for the given key.
+ * Least recently used results of all objects are discarded to stay in the memory limit,
+ * results used by the current evaluation of their object are kept.
+ */
+void BKE_modifier_cache_store(Object *ob_eval,
+                              ModifierData *md,
+                              const ModifierCacheKey *key,
+                              Mesh *mesh)
+{
+  /* The mesh is owned by the caller, its storage is made shareable outside of the lock. */
+  Mesh *mesh_store = mesh_copy_shared(mesh);
+  const size_t mem_size = mesh_mem_size(mesh);
+
+  BLI_mutex_lock(&modifier_cache_lock);
+  ModifierResultCache *cache = ob_eval->runtime.modifier_cache;
+  if (cache == NULL) {
+    cache = ob_eval->runtime.modifier_cache = MEM_callocN(sizeof(*cache), __func__);
+  }
+
+  ModifierCacheEntry *entry = MEM_callocN(sizeof(*entry), __func__);
+  entry->lru_link.data = entry;
+  entry->cache = cache;
+  entry->md_orig = modifier_cache_md_orig(md);
+  entry->key = *key;
+  entry->generation = cache->generation;
+  entry->mesh = mesh_store;
+  entry->mem_size = mem_size;
+  BLI_addhead(&cache->entries, entry);
+  BLI_addhead(&modifier_cache_lru, &entry->lru_link);
+  modifier_cache_mem_size += mem_size;
+
+  LinkData *link = modifier_cache_lru.last;
+  while (link != NULL && modifier_cache_mem_size > MODIFIER_CACHE_MEMORY_LIMIT) {
+    LinkData *link_prev = link->prev;
+    ModifierCacheEntry *entry_iter = link->data;
+    if (entry_iter->generation != entry_iter->cache->generation) {
+      modifier_cache_entry_free(entry_iter);
+    }
+    link = link_prev;
+  }
+  BLI_mutex_unlock(&modifier_cache_lock);
+}
+
+/**
+ * Called after evaluation of the modifier stack,
+ * discards results of modifiers which are not in the stack anymore.
+ */
+void BKE_modifier_cache_prune(Object *ob_eval)
+{
+  BLI_mutex_lock(&modifier_cache_lock);
+  ModifierResultCache *cache = ob_eval->runtime.modifier_cache;
+  if (cache != NULL) {
+    LISTBASE_FOREACH_MUTABLE (ModifierCacheEntry *, entry, &cache->entries) {
+      bool found = false;
+      LISTBASE_FOREACH (ModifierData *, md, &ob_eval->modifiers) {
+        if (modifier_cache_md_orig(md) == entry->md_orig) {
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        modifier_cache_entry_free(entry);
+      }
+    }
+    cache->generation++;
+  }
+  BLI_mutex_unlock(&modifier_cache_lock);
+}
+
+void BKE_modifier_cache_free(Object *ob_eval)
+{
+  BLI_mutex_lock(&modifier_cache_lock);
+  ModifierResultCache *cache = ob_eval->runtime.modifier_cache;
+  if (cache != NULL) {
+    LISTBASE_FOREACH_MUTABLE (ModifierCacheEntry *, entry, &cache->entries) {
+      modifier_cache_entry_free(entry);
+    }
+    MEM_freeN(cache);
+    ob_eval->runtime.modifier_cache = NULL;
+  }
+  BLI_mutex_unlock(&modifier_cache_lock);
+}
+
+/** \} */
@@ -451,6 +451,7 @@ void BKE_object_free_derived_caches(Object *ob)
 
   BKE_object_to_mesh_clear(ob);
   BKE_object_free_curve_cache(ob);
+  object_duplilist_cache_free(ob);
 
   /* clear grease pencil data */
   DRW_gpencil_freecache(ob);
@@ -556,6 +557,9 @@ void BKE_object_free(Object *ob)
     ob->runtime.curve_cache = NULL;
   }
 
+  /* Free cached modifier results. */
+  BKE_modifier_cache_free(ob);
+
   BKE_previewimg_free(&ob->preview);
 }
 
@@ -3929,6 +3933,8 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->mesh_deform_eval = NULL;
   runtime->curve_cache = NULL;
   runtime->gpencil_cache = NULL;
+  runtime->duplilist_cache = NULL;
+  runtime->modifier_cache = NULL;
 }
 
 /*
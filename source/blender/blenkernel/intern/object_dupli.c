@@ -28,7 +28,10 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
+#include "BLI_memarena.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BLI_math.h"
 #include "BLI_rand.h"
@@ -64,6 +67,18 @@
 
 /* Dupli-Geometry */
 
+/* Minimum number of instances per thread when generating vertex and face instances. */
+#define DUPLI_PARALLEL_MIN_ITER 1024
+
+typedef struct DupliListStorage {
+  /** Must be first: the storage is handed out as a list of DupliObject. */
+  ListBase duplilist;
+  /** All DupliObject of the list are allocated from this arena. */
+  MemArena *arena;
+  /** Owned by the instancer object runtime, not freed by #free_object_duplilist. */
+  bool is_cached;
+} DupliListStorage;
+
 typedef struct DupliContext {
   Depsgraph *depsgraph;
   /** XXX child objects are selected from this group if set, could be nicer. */
@@ -81,8 +96,8 @@ typedef struct DupliContext {
 
   const struct DupliGenerator *gen;
 
-  /** Result containers. */
-  ListBase *duplilist; /* legacy doubly-linked list */
+  /** Result container. */
+  DupliListStorage *storage;
 } DupliContext;
 
 typedef struct DupliGenerator {
@@ -116,7 +131,7 @@ static void init_context(DupliContext *r_ctx,
 
   r_ctx->gen = get_dupli_generator(r_ctx);
 
-  r_ctx->duplilist = NULL;
+  r_ctx->storage = NULL;
 }
 
 /* create sub-context for recursive duplis */
@@ -141,23 +156,30 @@ static void copy_dupli_context(
   r_ctx->gen = get_dupli_generator(r_ctx);
 }
 
-/* generate a dupli instance
+/* allocate DupliObject instances and add them to the result container */
+static DupliObject *dupli_alloc(const DupliContext *ctx, int count)
+{
+  return BLI_memarena_calloc(ctx->storage->arena, sizeof(DupliObject) * (size_t)count);
+}
+
+/* allocate a contiguous block of instances, linked in order into the result container */
+static DupliObject *dupli_alloc_array(const DupliContext *ctx, int count)
+{
+  DupliObject *dob_array = dupli_alloc(ctx, count);
+  for (int i = 0; i < count; i++) {
+    BLI_addtail(&ctx->storage->duplilist, &dob_array[i]);
+  }
+  return dob_array;
+}
+
+/* fill in a dupli instance, does not touch any other state so can be called from threads
  * mat is transform of the object relative to current context (including object obmat)
  */
-static DupliObject *make_dupli(const DupliContext *ctx, Object *ob, float mat[4][4], int index)
+static void dupli_init(
+    const DupliContext *ctx, DupliObject *dob, Object *ob, float mat[4][4], int index)
 {
-  DupliObject *dob;
   int i;
 
-  /* add a DupliObject instance to the result container */
-  if (ctx->duplilist) {
-    dob = MEM_callocN(sizeof(DupliObject), "dupli object");
-    BLI_addtail(ctx->duplilist, dob);
-  }
-  else {
-    return NULL;
-  }
-
   dob->ob = ob;
   mul_m4_m4m4(dob->mat, (float(*)[4])ctx->space_mat, mat);
   dob->type = ctx->gen->type;
@@ -198,10 +220,48 @@ static DupliObject *make_dupli(const DupliContext *ctx, Object *ob, float mat[4]
   if (ctx->object != ob) {
     dob->random_id ^= BLI_hash_int(BLI_hash_string(ctx->object->id.name + 2));
   }
+}
+
+/* generate a dupli instance
+ * mat is transform of the object relative to current context (including object obmat)
+ */
+static DupliObject *make_dupli(const DupliContext *ctx, Object *ob, float mat[4][4], int index)
+{
+  DupliObject *dob;
+
+  /* add a DupliObject instance to the result container */
+  if (ctx->storage) {
+    dob = dupli_alloc(ctx, 1);
+    BLI_addtail(&ctx->storage->duplilist, dob);
+  }
+  else {
+    return NULL;
+  }
+
+  dupli_init(ctx, dob, ob, mat, index);
 
   return dob;
 }
 
+/* check whether instancing ob from the given context generates nested instances */
+static bool dupli_has_recursion(const DupliContext *ctx, Object *ob)
+{
+  if (ctx->level >= MAX_DUPLI_RECUR) {
+    return false;
+  }
+  DupliContext rctx;
+  copy_dupli_context(&rctx, ctx, ob, NULL, 0);
+  return rctx.gen != NULL;
+}
+
+/* Instances without nested instances are independent of each other,
+ * so big batches of them can be filled in parallel. */
+static bool dupli_use_parallel(const DupliContext *ctx, Object *ob, int count)
+{
+  return (ctx->storage != NULL) && (count > DUPLI_PARALLEL_MIN_ITER) &&
+         !dupli_has_recursion(ctx, ob);
+}
+
 /* recursive dupli objects
  * space_mat is the local dupli space (excluding dupli object obmat!)
  */
@@ -332,6 +392,7 @@ typedef struct VertexDupliData {
   const DupliContext *ctx;
   Object *inst_ob; /* object to instantiate (argument for vertex map callback) */
   float child_imat[4][4];
+  DupliObject *dob_array; /* preallocated instances when filled in parallel */
 } VertexDupliData;
 
 static void get_duplivert_transform(const float co[3],
@@ -359,14 +420,12 @@ static void get_duplivert_transform(const float co[3],
   loc_quat_size_to_mat4(mat, co, quat, size);
 }
 
-static void vertex_dupli(const VertexDupliData *vdd,
-                         int index,
-                         const float co[3],
-                         const short no[3])
+static void vertex_dupli_transform(const VertexDupliData *vdd,
+                                   const float co[3],
+                                   const short no[3],
+                                   float obmat[4][4])
 {
   Object *inst_ob = vdd->inst_ob;
-  DupliObject *dob;
-  float obmat[4][4], space_mat[4][4];
 
   /* obmat is transform to vertex */
   get_duplivert_transform(co, no, vdd->use_rotation, inst_ob->trackflag, inst_ob->upflag, obmat);
@@ -374,6 +433,18 @@ static void vertex_dupli(const VertexDupliData *vdd,
   mul_mat3_m4_v3((float(*)[4])vdd->child_imat, obmat[3]);
   /* apply obmat _after_ the local vertex transform */
   mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+}
+
+static void vertex_dupli(const VertexDupliData *vdd,
+                         int index,
+                         const float co[3],
+                         const short no[3])
+{
+  Object *inst_ob = vdd->inst_ob;
+  DupliObject *dob;
+  float obmat[4][4], space_mat[4][4];
+
+  vertex_dupli_transform(vdd, co, no, obmat);
 
   /* space matrix is constructed by removing obmat transform,
    * this yields the worldspace transform for recursive duplis
@@ -390,6 +461,23 @@ static void vertex_dupli(const VertexDupliData *vdd,
   make_recursive_duplis(vdd->ctx, vdd->inst_ob, space_mat, index);
 }
 
+static void make_child_duplis_verts_cb(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const VertexDupliData *vdd = userdata;
+  const MVert *mv = &vdd->me_eval->mvert[index];
+  DupliObject *dob = &vdd->dob_array[index];
+  float obmat[4][4];
+
+  vertex_dupli_transform(vdd, mv->co, mv->no, obmat);
+  dupli_init(vdd->ctx, dob, vdd->inst_ob, obmat, index);
+
+  if (vdd->orco) {
+    copy_v3_v3(dob->orco, vdd->orco[index]);
+  }
+}
+
 static void make_child_duplis_verts(const DupliContext *ctx, void *userdata, Object *child)
 {
   VertexDupliData *vdd = userdata;
@@ -400,6 +488,18 @@ static void make_child_duplis_verts(const DupliContext *ctx, void *userdata, Obj
   /* relative transform from parent to child space */
   mul_m4_m4m4(vdd->child_imat, child->imat, ctx->object->obmat);
 
+  if (dupli_use_parallel(vdd->ctx, child, me_eval->totvert)) {
+    vdd->dob_array = dupli_alloc_array(vdd->ctx, me_eval->totvert);
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = DUPLI_PARALLEL_MIN_ITER;
+    BLI_task_parallel_range(0, me_eval->totvert, vdd, make_child_duplis_verts_cb, &settings);
+
+    vdd->dob_array = NULL;
+    return;
+  }
+
   const MVert *mvert = me_eval->mvert;
   for (int i = 0; i < me_eval->totvert; i++) {
     vertex_dupli(vdd, i, mvert[i].co, mvert[i].no);
@@ -413,6 +513,7 @@ static void make_duplis_verts(const DupliContext *ctx)
 
   vdd.ctx = ctx;
   vdd.use_rotation = parent->transflag & OB_DUPLIROT;
+  vdd.dob_array = NULL;
 
   /* gather mesh info */
   {
@@ -584,6 +685,12 @@ typedef struct FaceDupliData {
   float (*orco)[3];
   MLoopUV *mloopuv;
   bool use_scale;
+
+  /* Only used when filling instances in parallel. */
+  const DupliContext *ctx;
+  Object *inst_ob;
+  float child_imat[4][4];
+  DupliObject *dob_array;
 } FaceDupliData;
 
 static void get_dupliface_transform(
@@ -616,14 +723,76 @@ static void get_dupliface_transform(
   loc_quat_size_to_mat4(mat, loc, quat, size);
 }
 
+/* world-space transform of the instance on a face */
+static void face_dupli_transform(const DupliContext *ctx,
+                                 const FaceDupliData *fdd,
+                                 Object *inst_ob,
+                                 const float child_imat[4][4],
+                                 MPoly *mp,
+                                 float obmat[4][4])
+{
+  MLoop *loopstart = fdd->mloop + mp->loopstart;
+
+  /* obmat is transform to face */
+  get_dupliface_transform(
+      mp, loopstart, fdd->mvert, fdd->use_scale, ctx->object->instance_faces_scale, obmat);
+  /* make offset relative to inst_ob using relative child transform */
+  mul_mat3_m4_v3((float(*)[4])child_imat, obmat[3]);
+
+  /* XXX ugly hack to ensure same behavior as in master
+   * this should not be needed, parentinv is not consistent
+   * outside of parenting.
+   */
+  {
+    float imat[3][3];
+    copy_m3_m4(imat, inst_ob->parentinv);
+    mul_m4_m3m4(obmat, imat, obmat);
+  }
+
+  /* apply obmat _after_ the local face transform */
+  mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+}
+
+/* interpolate generated coordinates and UV of the face */
+static void face_dupli_attributes(const FaceDupliData *fdd, const MPoly *mp, DupliObject *dob)
+{
+  const MLoop *loopstart = fdd->mloop + mp->loopstart;
+  const float w = 1.0f / (float)mp->totloop;
+
+  if (fdd->orco) {
+    for (int j = 0; j < mp->totloop; j++) {
+      madd_v3_v3fl(dob->orco, fdd->orco[loopstart[j].v], w);
+    }
+  }
+  if (fdd->mloopuv) {
+    for (int j = 0; j < mp->totloop; j++) {
+      madd_v2_v2fl(dob->uv, fdd->mloopuv[mp->loopstart + j].uv, w);
+    }
+  }
+}
+
+static void make_child_duplis_faces_cb(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FaceDupliData *fdd = userdata;
+  MPoly *mp = &fdd->mpoly[index];
+  DupliObject *dob = &fdd->dob_array[index];
+  float obmat[4][4];
+
+  if (UNLIKELY(mp->totloop < 3)) {
+    return;
+  }
+
+  face_dupli_transform(fdd->ctx, fdd, fdd->inst_ob, fdd->child_imat, mp, obmat);
+  dupli_init(fdd->ctx, dob, fdd->inst_ob, obmat, index);
+  face_dupli_attributes(fdd, mp, dob);
+}
+
 static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Object *inst_ob)
 {
   FaceDupliData *fdd = userdata;
   MPoly *mpoly = fdd->mpoly, *mp;
-  MLoop *mloop = fdd->mloop;
-  MVert *mvert = fdd->mvert;
-  float(*orco)[3] = fdd->orco;
-  MLoopUV *mloopuv = fdd->mloopuv;
   int a, totface = fdd->totface;
   float child_imat[4][4];
   DupliObject *dob;
@@ -632,32 +801,36 @@ static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Obj
   /* relative transform from parent to child space */
   mul_m4_m4m4(child_imat, inst_ob->imat, ctx->object->obmat);
 
+  if (dupli_use_parallel(ctx, inst_ob, totface)) {
+    /* Slots of degenerate faces are left out of the list. */
+    fdd->dob_array = dupli_alloc(ctx, totface);
+    for (a = 0, mp = mpoly; a < totface; a++, mp++) {
+      if (LIKELY(mp->totloop >= 3)) {
+        BLI_addtail(&ctx->storage->duplilist, &fdd->dob_array[a]);
+      }
+    }
+
+    fdd->ctx = ctx;
+    fdd->inst_ob = inst_ob;
+    copy_m4_m4(fdd->child_imat, child_imat);
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = DUPLI_PARALLEL_MIN_ITER;
+    BLI_task_parallel_range(0, totface, fdd, make_child_duplis_faces_cb, &settings);
+
+    fdd->dob_array = NULL;
+    return;
+  }
+
   for (a = 0, mp = mpoly; a < totface; a++, mp++) {
-    MLoop *loopstart = mloop + mp->loopstart;
     float space_mat[4][4], obmat[4][4];
 
     if (UNLIKELY(mp->totloop < 3)) {
       continue;
     }
 
-    /* obmat is transform to face */
-    get_dupliface_transform(
-        mp, loopstart, mvert, fdd->use_scale, ctx->object->instance_faces_scale, obmat);
-    /* make offset relative to inst_ob using relative child transform */
-    mul_mat3_m4_v3(child_imat, obmat[3]);
-
-    /* XXX ugly hack to ensure same behavior as in master
-     * this should not be needed, parentinv is not consistent
-     * outside of parenting.
-     */
-    {
-      float imat[3][3];
-      copy_m3_m4(imat, inst_ob->parentinv);
-      mul_m4_m3m4(obmat, imat, obmat);
-    }
-
-    /* apply obmat _after_ the local face transform */
-    mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+    face_dupli_transform(ctx, fdd, inst_ob, child_imat, mp, obmat);
 
     /* space matrix is constructed by removing obmat transform,
      * this yields the worldspace transform for recursive duplis
@@ -665,18 +838,7 @@ static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Obj
     mul_m4_m4m4(space_mat, obmat, inst_ob->imat);
 
     dob = make_dupli(ctx, inst_ob, obmat, a);
-
-    const float w = 1.0f / (float)mp->totloop;
-    if (orco) {
-      for (int j = 0; j < mp->totloop; j++) {
-        madd_v3_v3fl(dob->orco, orco[loopstart[j].v], w);
-      }
-    }
-    if (mloopuv) {
-      for (int j = 0; j < mp->totloop; j++) {
-        madd_v2_v2fl(dob->uv, mloopuv[mp->loopstart + j].uv, w);
-      }
-    }
+    face_dupli_attributes(fdd, mp, dob);
 
     /* recursion */
     make_recursive_duplis(ctx, inst_ob, space_mat, a);
@@ -689,6 +851,7 @@ static void make_duplis_faces(const DupliContext *ctx)
   FaceDupliData fdd;
 
   fdd.use_scale = ((parent->transflag & OB_DUPLIFACES_SCALE) != 0);
+  fdd.dob_array = NULL;
 
   /* gather mesh info */
   {
@@ -1121,22 +1284,80 @@ static const DupliGenerator *get_dupli_generator(const DupliContext *ctx)
 
 /* ---- ListBase dupli container implementation ---- */
 
-/* Returns a list of DupliObject */
-ListBase *object_duplilist(Depsgraph *depsgraph, Scene *sce, Object *ob)
+static DupliListStorage *duplilist_storage_new(void)
 {
-  ListBase *duplilist = MEM_callocN(sizeof(ListBase), "duplilist");
+  DupliListStorage *storage = MEM_callocN(sizeof(DupliListStorage), "duplilist");
+  storage->arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "duplilist arena");
+  return storage;
+}
+
+static void duplilist_storage_free(DupliListStorage *storage)
+{
+  BLI_memarena_free(storage->arena);
+  MEM_freeN(storage);
+}
+
+static DupliListStorage *duplilist_storage_build(Depsgraph *depsgraph, Scene *sce, Object *ob)
+{
+  DupliListStorage *storage = duplilist_storage_new();
   DupliContext ctx;
   init_context(&ctx, depsgraph, sce, ob, NULL);
   if (ctx.gen) {
-    ctx.duplilist = duplilist;
+    ctx.storage = storage;
     ctx.gen->make_duplis(&ctx);
   }
+  return storage;
+}
+
+/* Returns a list of DupliObject */
+ListBase *object_duplilist(Depsgraph *depsgraph, Scene *sce, Object *ob)
+{
+  return &duplilist_storage_build(depsgraph, sce, ob)->duplilist;
+}
+
+/**
+ * Same as #object_duplilist, but the list is stored in the runtime data of the evaluated object
+ * and reused until the dependency graph is updated again.
+ * The list is to be released with #free_object_duplilist as usual (which keeps it alive).
+ */
+ListBase *object_duplilist_cached(Depsgraph *depsgraph, Scene *sce, Object *ob)
+{
+  static ThreadMutex duplilist_cache_lock = BLI_MUTEX_INITIALIZER;
+
+  /* Instancer might be modified while being evaluated, don't keep anything around. */
+  if (DEG_is_evaluating(depsgraph) || !DEG_is_evaluated_object(ob)) {
+    return object_duplilist(depsgraph, sce, ob);
+  }
 
-  return duplilist;
+  const int update_count = DEG_get_update_count(depsgraph);
+
+  BLI_mutex_lock(&duplilist_cache_lock);
+  if (ob->runtime.duplilist_cache == NULL ||
+      ob->runtime.duplilist_cache_update_count != update_count) {
+    object_duplilist_cache_free(ob);
+    DupliListStorage *storage = duplilist_storage_build(depsgraph, sce, ob);
+    storage->is_cached = true;
+    ob->runtime.duplilist_cache = &storage->duplilist;
+    ob->runtime.duplilist_cache_update_count = update_count;
+  }
+  BLI_mutex_unlock(&duplilist_cache_lock);
+
+  return ob->runtime.duplilist_cache;
 }
 
 void free_object_duplilist(ListBase *lb)
 {
-  BLI_freelistN(lb);
-  MEM_freeN(lb);
+  DupliListStorage *storage = (DupliListStorage *)lb;
+  if (storage->is_cached) {
+    return;
+  }
+  duplilist_storage_free(storage);
+}
+
+void object_duplilist_cache_free(Object *ob)
+{
+  if (ob->runtime.duplilist_cache != NULL) {
+    duplilist_storage_free((DupliListStorage *)ob->runtime.duplilist_cache);
+    ob->runtime.duplilist_cache = NULL;
+  }
 }
@@ -189,6 +189,22 @@ static ParticleCacheKey **psys_alloc_path_cache_buffers(ListBase *bufs, int tot,
   return cache;
 }
 
+/* Check if existing path cache buffers can be reused for the same number of paths, with the
+ * same number of keys, so the buffers don't have to be reallocated on every update. */
+static bool psys_path_cache_buffers_reusable(
+    ParticleCacheKey **cache, ListBase *bufs, int tot, int totcached, int totkeys)
+{
+  if (cache == NULL || tot != totcached || BLI_listbase_is_empty(bufs)) {
+    return false;
+  }
+
+  /* The first buffer holds the keys of the first PATH_CACHE_BUF_SIZE paths. */
+  LinkData *buf = bufs->first;
+  tot = MAX2(tot, 1);
+  return MEM_allocN_len(buf->data) ==
+         sizeof(ParticleCacheKey) * MIN2(tot, PATH_CACHE_BUF_SIZE) * totkeys;
+}
+
 static void psys_free_path_cache_buffers(ParticleCacheKey **cache, ListBase *bufs)
 {
   LinkData *buf;
@@ -2430,6 +2446,7 @@ static void psys_thread_create_path(ParticleTask *task,
   short cpa_from;
 
   if (!pcache) {
+    memset(child_keys, 0, sizeof(*child_keys) * (ctx->segments + 1));
     return;
   }
 
@@ -2550,6 +2567,11 @@ static void psys_thread_create_path(ParticleTask *task,
       memset(child_keys, 0, sizeof(*child_keys) * (ctx->segments + 1));
     }
 
+    if (ctx->incremental && (pa->flag & PARS_PATH_CHANGED) == 0) {
+      /* The parent path didn't change, keep the existing child path. */
+      return;
+    }
+
     /* get the parent path */
     key[0] = pcache[cpa->parent];
 
@@ -2758,6 +2780,32 @@ static void exec_child_path_cache(TaskPool *__restrict UNUSED(pool),
   }
 }
 
+/* Children only depend on their parent path, unless they are interpolated between multiple
+ * parents on the emitter, or use inputs that may change without their parent changing. */
+static bool psys_child_paths_incremental_supported(ParticleThreadContext *ctx)
+{
+  ParticleSystem *psys = ctx->sim.psys;
+  ParticleSettings *part = psys->part;
+
+  if (ctx->between || ctx->editupdate || psys->recalc || psys->lattice_deform_data ||
+      (part->flag & PART_CHILD_EFFECT) || psys_in_edit_mode(ctx->sim.depsgraph, psys)) {
+    return false;
+  }
+
+  if (ctx->vg_length || ctx->vg_clump || ctx->vg_kink || ctx->vg_rough1 || ctx->vg_rough2 ||
+      ctx->vg_roughe || ctx->vg_twist) {
+    return false;
+  }
+
+  for (int i = 0; i < MAX_MTEX; i++) {
+    if (part->mtex[i] && part->mtex[i]->tex) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void psys_cache_child_paths(ParticleSimulationData *sim,
                             float cfra,
                             const bool editupdate,
@@ -2784,15 +2832,26 @@ void psys_cache_child_paths(ParticleSimulationData *sim,
   totchild = ctx.totchild;
   totparent = ctx.totparent;
 
+  const int totkeys = ctx.segments + ctx.extra_segments + 1;
+  const bool reuse_cache = psys_path_cache_buffers_reusable(sim->psys->childcache,
+                                                            &sim->psys->childcachebufs,
+                                                            totchild,
+                                                            sim->psys->totchildcache,
+                                                            totkeys);
+
   if (editupdate && sim->psys->childcache && totchild == sim->psys->totchildcache) {
     /* just overwrite the existing cache */
   }
+  else if (reuse_cache) {
+    /* Overwrite the existing cache, only updating children of changed parents if possible. */
+    ctx.incremental = psys_child_paths_incremental_supported(&ctx);
+  }
   else {
     /* clear out old and create new empty path cache */
     free_child_path_cache(sim->psys);
 
     sim->psys->childcache = psys_alloc_path_cache_buffers(
-        &sim->psys->childcachebufs, totchild, ctx.segments + ctx.extra_segments + 1);
+        &sim->psys->childcachebufs, totchild, totkeys);
     sim->psys->totchildcache = totchild;
   }
 
@@ -2826,6 +2885,21 @@ void psys_cache_child_paths(ParticleSimulationData *sim,
   psys_thread_context_free(&ctx);
 }
 
+/* Tag particles for which the path changed since the previous update, see #PARS_PATH_CHANGED.
+ * Without previous keys the path is always considered changed. */
+static void psys_path_cache_tag_changed(ParticleData *pa,
+                                        const ParticleCacheKey *keys,
+                                        const ParticleCacheKey *prev_keys,
+                                        int totkeys)
+{
+  if (prev_keys == NULL || memcmp(keys, prev_keys, sizeof(*keys) * totkeys) != 0) {
+    pa->flag |= PARS_PATH_CHANGED;
+  }
+  else {
+    pa->flag &= ~PARS_PATH_CHANGED;
+  }
+}
+
 /* figure out incremental rotations along path starting from unit quat */
 static void cache_key_incremental_rotation(ParticleCacheKey *key0,
                                            ParticleCacheKey *key1,
@@ -2904,6 +2978,7 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
   float length, vec[3];
   float *vg_effector = NULL;
   float *vg_length = NULL, pa_length = 1.0f;
+  ParticleCacheKey *prev_keys = NULL;
   int keyed, baked;
 
   /* we don't have anything valid to create paths from so let's quit here */
@@ -2920,10 +2995,26 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
   keyed = psys->flag & PSYS_KEYED;
   baked = psys->pointcache->mem_cache.first && psys->part->type != PART_HAIR;
 
-  /* clear out old and create new empty path cache */
-  psys_free_path_cache(psys, psys->edit);
-  cache = psys->pathcache = psys_alloc_path_cache_buffers(
-      &psys->pathcachebufs, totpart, segments + 1);
+  if (psys_path_cache_buffers_reusable(
+          psys->pathcache, &psys->pathcachebufs, totpart, psys->totcached, segments + 1)) {
+    /* Overwrite the existing cache, keeping a copy of each path to detect changes,
+     * so child paths of unchanged parents don't have to be updated. */
+    cache = psys->pathcache;
+    prev_keys = MEM_malloc_arrayN(segments + 1, sizeof(ParticleCacheKey), __func__);
+
+    psys_free_path_cache(NULL, psys->edit);
+    /* Child paths are reused too when they are updated next, see #psys_update_path_cache. */
+    if (!(part->childtype && psys->totchild &&
+          (part->type != PART_HAIR || (psys->flag & PSYS_HAIR_DONE)))) {
+      free_child_path_cache(psys);
+    }
+  }
+  else {
+    /* clear out old and create new empty path cache */
+    psys_free_path_cache(psys, psys->edit);
+    cache = psys->pathcache = psys_alloc_path_cache_buffers(
+        &psys->pathcachebufs, totpart, segments + 1);
+  }
 
   psys->lattice_deform_data = psys_create_lattice_deform_data(sim);
   ma = BKE_object_material_get(sim->ob, psys->part->omat);
@@ -2963,6 +3054,9 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
     pind.bspline = (psys->part->flag & PART_HAIR_BSPLINE);
     pind.mesh = hair_mesh;
 
+    if (prev_keys) {
+      memcpy(prev_keys, cache[p], sizeof(*cache[p]) * (segments + 1));
+    }
     memset(cache[p], 0, sizeof(*cache[p]) * (segments + 1));
 
     cache[p]->segments = segments;
@@ -2988,6 +3082,7 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
 
     if (birthtime >= dietime) {
       cache[p]->segments = -1;
+      psys_path_cache_tag_changed(pa, cache[p], prev_keys, segments + 1);
       continue;
     }
 
@@ -3087,10 +3182,16 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
      * the possibility of flipping again. -jahka
      */
     mat3_to_quat_is_ok(cache[p]->rot, rotmat);
+
+    psys_path_cache_tag_changed(pa, cache[p], prev_keys, segments + 1);
   }
 
   psys->totcached = totpart;
 
+  if (prev_keys) {
+    MEM_freeN(prev_keys);
+  }
+
   if (psys->lattice_deform_data) {
     end_latt_deform(psys->lattice_deform_data);
     psys->lattice_deform_data = NULL;
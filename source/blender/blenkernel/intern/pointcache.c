@@ -45,6 +45,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -143,7 +144,7 @@ static int ptcache_extra_datasize[] = {
 /* forward declarations */
 static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len);
 static int ptcache_file_compressed_write(
-    PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode);
+    PTCacheFile *pf, unsigned char *in, unsigned int in_len, int mode);
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size);
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size);
 
@@ -153,11 +154,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
   int error = 0;
 
   /* Custom functions should read these basic elements too! */
-  if (!error && !fread(&pf->totpoint, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->totpoint, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
-  if (!error && !fread(&pf->data_types, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->data_types, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -629,8 +630,6 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
     float dt, dx, *dens, *react, *fuel, *flame, *heat, *heatold, *vx, *vy, *vz, *r, *g, *b;
     unsigned char *obstacles;
     unsigned int in_len = sizeof(float) * (unsigned int)res;
-    unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                      "pointcache_lzo_buffer");
     // int mode = res >= 1000000 ? 2 : 1;
     int mode = 1;  // light
     if (mds->cache_comp == SM_CACHE_HEAVY) {
@@ -655,26 +654,26 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
                  &obstacles,
                  NULL);
 
-    ptcache_file_compressed_write(pf, (unsigned char *)mds->shadow, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len, out, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)mds->shadow, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len, mode);
     if (fluid_fields & FLUID_DOMAIN_ACTIVE_HEAT) {
-      ptcache_file_compressed_write(pf, (unsigned char *)heat, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)heatold, in_len, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)heat, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)heatold, in_len, mode);
     }
     if (fluid_fields & FLUID_DOMAIN_ACTIVE_FIRE) {
-      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len, mode);
     }
     if (fluid_fields & FLUID_DOMAIN_ACTIVE_COLORS) {
-      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len, out, mode);
-    }
-    ptcache_file_compressed_write(pf, (unsigned char *)vx, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)vy, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)vz, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)obstacles, (unsigned int)res, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len, mode);
+    }
+    ptcache_file_compressed_write(pf, (unsigned char *)vx, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)vy, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)vz, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)obstacles, (unsigned int)res, mode);
     ptcache_file_write(pf, &dt, 1, sizeof(float));
     ptcache_file_write(pf, &dx, 1, sizeof(float));
     ptcache_file_write(pf, &mds->p0, 3, sizeof(float));
@@ -688,8 +687,6 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
     ptcache_file_write(pf, &mds->res_max, 3, sizeof(int));
     ptcache_file_write(pf, &mds->active_color, 3, sizeof(float));
 
-    MEM_freeN(out);
-
     ret = 1;
   }
 
@@ -700,7 +697,6 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
     float *dens, *react, *fuel, *flame, *tcu, *tcv, *tcw, *r, *g, *b;
     unsigned int in_len = sizeof(float) * (unsigned int)res;
     unsigned int in_len_big;
-    unsigned char *out;
     int mode;
 
     smoke_turbulence_get_res(mds->wt, res_big_array);
@@ -715,25 +711,21 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 
     smoke_turbulence_export(mds->wt, &dens, &react, &flame, &fuel, &r, &g, &b, &tcu, &tcv, &tcw);
 
-    out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len_big), "pointcache_lzo_buffer");
-    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len_big, out, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len_big, mode);
     if (fluid_fields & FLUID_DOMAIN_ACTIVE_FIRE) {
-      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len_big, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len_big, mode);
     }
     if (fluid_fields & FLUID_DOMAIN_ACTIVE_COLORS) {
-      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len_big, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len_big, mode);
     }
-    MEM_freeN(out);
 
-    out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len), "pointcache_lzo_buffer");
-    ptcache_file_compressed_write(pf, (unsigned char *)tcu, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)tcv, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)tcw, in_len, out, mode);
-    MEM_freeN(out);
+    ptcache_file_compressed_write(pf, (unsigned char *)tcu, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)tcv, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)tcw, in_len, mode);
 
     ret = 1;
   }
@@ -848,6 +840,7 @@ static int ptcache_smoke_read(PTCacheFile *pf, void *smoke_v)
   if (!STREQLEN(version, SMOKE_CACHE_VERSION, 4)) {
     /* reset file pointer */
     fseek(pf->fp, -4, SEEK_CUR);
+    pf->remaining += 4;
     return ptcache_smoke_read_old(pf, smoke_v);
   }
 
@@ -1376,7 +1369,6 @@ static int ptcache_dynamicpaint_write(PTCacheFile *pf, void *dp_v)
   if (surface->format != MOD_DPAINT_SURFACE_F_IMAGESEQ && surface->data) {
     int total_points = surface->data->total_points;
     unsigned int in_len;
-    unsigned char *out;
 
     /* cache type */
     ptcache_file_write(pf, &surface->type, 1, sizeof(int));
@@ -1395,11 +1387,8 @@ static int ptcache_dynamicpaint_write(PTCacheFile *pf, void *dp_v)
       return 0;
     }
 
-    out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len), "pointcache_lzo_buffer");
-
     ptcache_file_compressed_write(
-        pf, (unsigned char *)surface->data->type_data, in_len, out, cache_compress);
-    MEM_freeN(out);
+        pf, (unsigned char *)surface->data->type_data, in_len, cache_compress);
   }
   return 1;
 }
@@ -2051,6 +2040,7 @@ static int ptcache_frame_from_filename(const char *filename, const char *ext)
 
 #define MAX_PTCACHE_PATH FILE_MAX
 #define MAX_PTCACHE_FILE (FILE_MAX * 2)
+#define PTCACHE_FILE_BUFFER_SIZE (1 << 20)
 
 static int ptcache_path(PTCacheID *pid, char *filename)
 {
@@ -2154,11 +2144,307 @@ static int ptcache_filename(PTCacheID *pid, char *filename, int cfra, short do_p
   return len; /* make sure the above string is always 16 chars */
 }
 
+/* Frame Packs
+ *
+ * Every frame of a disk cache is a file, so a long bake is thousands of small files.
+ * On network storage opening, listing and deleting those is what playback and cache management
+ * spend most time on. Once a disk cache is baked its frames are moved into packs of
+ * #PTCACHE_PACK_FRAMES consecutive frames, each starting with an index of its frames.
+ * Frames are stored exactly as they were in their own file, reading a frame opens its pack and
+ * continues at the frame's offset. Changing a packed cache unpacks it first.
+ * The info file (frame 0) is never packed. */
+
+#define PTCACHE_PACK_FRAMES 32
+#define PTCACHE_PACK_VERSION 1
+
+typedef struct PTCachePackHeader {
+  char id[8];
+  unsigned int version;
+  unsigned int totframe;
+} PTCachePackHeader;
+
+typedef struct PTCachePackFrame {
+  int frame;
+  char _pad[4];
+  uint64_t offset;
+  uint64_t size;
+} PTCachePackFrame;
+
+typedef struct PTCachePack {
+  FILE *fp;
+  unsigned int totframe;
+  PTCachePackFrame frames[PTCACHE_PACK_FRAMES];
+} PTCachePack;
+
+static int ptcache_pack_first_frame(int cfra)
+{
+  /* Round down, also for negative frames. */
+  return (cfra >= 0) ? cfra - (cfra % PTCACHE_PACK_FRAMES) :
+                       cfra - (PTCACHE_PACK_FRAMES - 1) - ((cfra + 1) % PTCACHE_PACK_FRAMES);
+}
+
+static bool ptcache_pack_use(const PTCacheID *pid, int cfra)
+{
+  return (pid->cache->flag & PTCACHE_PACKED) && (cfra != 0);
+}
+
+/* File name of the pack containing \a cfra. */
+static void ptcache_pack_filename(PTCacheID *pid, char *filename, int cfra)
+{
+  const int len = ptcache_filename(pid, filename, cfra, 1, 0);
+  BLI_snprintf(filename + len,
+               MAX_PTCACHE_FILE - len,
+               "_%06d_%02u" PTCACHE_PACK_EXT,
+               ptcache_pack_first_frame(cfra),
+               pid->stack_index);
+}
+
+static int ptcache_file_seek(FILE *fp, uint64_t offset)
+{
+#ifdef WIN32
+  return _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+  return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+/* Open the pack containing \a cfra and read its index. */
+static bool ptcache_pack_open(PTCacheID *pid, int cfra, PTCachePack *pack)
+{
+  char filename[MAX_PTCACHE_FILE];
+  PTCachePackHeader header;
+
+  ptcache_pack_filename(pid, filename, cfra);
+  pack->fp = BLI_fopen(filename, "rb");
+  pack->totframe = 0;
+  if (pack->fp == NULL) {
+    return false;
+  }
+
+  if (fread(&header, sizeof(header), 1, pack->fp) == 1 && STREQLEN(header.id, "BPHYSPAK", 8) &&
+      header.version == PTCACHE_PACK_VERSION && header.totframe <= PTCACHE_PACK_FRAMES &&
+      fread(pack->frames, sizeof(PTCachePackFrame), header.totframe, pack->fp) ==
+          header.totframe) {
+    pack->totframe = header.totframe;
+    return true;
+  }
+
+  fclose(pack->fp);
+  pack->fp = NULL;
+  return false;
+}
+
+static const PTCachePackFrame *ptcache_pack_find(const PTCachePack *pack, int cfra)
+{
+  for (unsigned int i = 0; i < pack->totframe; i++) {
+    if (pack->frames[i].frame == cfra) {
+      return &pack->frames[i];
+    }
+  }
+  return NULL;
+}
+
+/* Open a packed frame for reading, returns its size in \a r_size. */
+static FILE *ptcache_pack_frame_open(PTCacheID *pid, int cfra, size_t *r_size)
+{
+  PTCachePack pack;
+  if (!ptcache_pack_open(pid, cfra, &pack)) {
+    return NULL;
+  }
+
+  const PTCachePackFrame *frame = ptcache_pack_find(&pack, cfra);
+  if (frame == NULL || ptcache_file_seek(pack.fp, frame->offset) != 0) {
+    fclose(pack.fp);
+    return NULL;
+  }
+
+  *r_size = (size_t)frame->size;
+  return pack.fp;
+}
+
+static bool ptcache_pack_frame_exists(PTCacheID *pid, int cfra)
+{
+  PTCachePack pack;
+  if (!ptcache_pack_open(pid, cfra, &pack)) {
+    return false;
+  }
+  const bool exists = ptcache_pack_find(&pack, cfra) != NULL;
+  fclose(pack.fp);
+  return exists;
+}
+
+static bool ptcache_file_copy_data(FILE *fp_dst, FILE *fp_src, uint64_t size)
+{
+  char *buf = MEM_mallocN(PTCACHE_FILE_BUFFER_SIZE, __func__);
+  bool ok = true;
+
+  while (size && ok) {
+    const size_t len = (size_t)MIN2(size, (uint64_t)PTCACHE_FILE_BUFFER_SIZE);
+    ok = (fread(buf, 1, len, fp_src) == len) && (fwrite(buf, 1, len, fp_dst) == len);
+    size -= len;
+  }
+
+  MEM_freeN(buf);
+  return ok;
+}
+
+/* Write the frames of the pack starting at \a first_frame, returns false on failure. */
+static bool ptcache_pack_write(PTCacheID *pid, int first_frame, bool *r_written)
+{
+  char filename[MAX_PTCACHE_FILE];
+  PTCachePackHeader header = {.id = {'B', 'P', 'H', 'Y', 'S', 'P', 'A', 'K'},
+                              .version = PTCACHE_PACK_VERSION};
+  PTCachePackFrame frames[PTCACHE_PACK_FRAMES];
+  uint64_t offset;
+  bool ok = true;
+
+  *r_written = false;
+
+  for (int i = 0; i < PTCACHE_PACK_FRAMES; i++) {
+    const int cfra = first_frame + i;
+    if (cfra == 0 || cfra < pid->cache->startframe || cfra > pid->cache->endframe) {
+      continue;
+    }
+    ptcache_filename(pid, filename, cfra, 1, 1);
+    if (!BLI_exists(filename)) {
+      continue;
+    }
+    memset(&frames[header.totframe], 0, sizeof(*frames));
+    frames[header.totframe].frame = cfra;
+    frames[header.totframe].size = (uint64_t)BLI_file_size(filename);
+    header.totframe++;
+  }
+
+  if (header.totframe == 0) {
+    return true;
+  }
+
+  offset = sizeof(header) + sizeof(PTCachePackFrame) * header.totframe;
+  for (unsigned int i = 0; i < header.totframe; i++) {
+    frames[i].offset = offset;
+    offset += frames[i].size;
+  }
+
+  ptcache_pack_filename(pid, filename, first_frame);
+  FILE *fp = BLI_fopen(filename, "wb");
+  if (fp == NULL) {
+    return false;
+  }
+  setvbuf(fp, NULL, _IOFBF, PTCACHE_FILE_BUFFER_SIZE);
+  *r_written = true;
+
+  ok = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+       (fwrite(frames, sizeof(PTCachePackFrame), header.totframe, fp) == header.totframe);
+
+  for (unsigned int i = 0; i < header.totframe && ok; i++) {
+    char filename_frame[MAX_PTCACHE_FILE];
+    ptcache_filename(pid, filename_frame, frames[i].frame, 1, 1);
+    FILE *fp_frame = BLI_fopen(filename_frame, "rb");
+    ok = (fp_frame != NULL) && ptcache_file_copy_data(fp, fp_frame, frames[i].size);
+    if (fp_frame) {
+      fclose(fp_frame);
+    }
+  }
+
+  if (fclose(fp) != 0) {
+    ok = false;
+  }
+  return ok;
+}
+
+/* Move the frames of a baked disk cache into packs. */
+static void ptcache_disk_pack(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  char filename[MAX_PTCACHE_FILE];
+  const int sta = ptcache_pack_first_frame(cache->startframe);
+  bool ok = true;
+  int cfra;
+
+  if ((cache->flag & (PTCACHE_DISK_CACHE | PTCACHE_EXTERNAL | PTCACHE_PACKED)) !=
+          PTCACHE_DISK_CACHE ||
+      pid->file_type != PTCACHE_FILE_PTCACHE) {
+    return;
+  }
+
+  for (cfra = sta; cfra <= cache->endframe && ok; cfra += PTCACHE_PACK_FRAMES) {
+    bool written;
+    ok = ptcache_pack_write(pid, cfra, &written);
+    if (!ok && written) {
+      ptcache_pack_filename(pid, filename, cfra);
+      BLI_delete(filename, false, false);
+    }
+  }
+
+  if (!ok) {
+    /* Keep the frame files, remove the packs which were written already. */
+    for (int cfra_pack = sta; cfra_pack < cfra - PTCACHE_PACK_FRAMES;
+         cfra_pack += PTCACHE_PACK_FRAMES) {
+      ptcache_pack_filename(pid, filename, cfra_pack);
+      BLI_delete(filename, false, false);
+    }
+    if (G.debug & G_DEBUG) {
+      printf("Error packing disk cache\n");
+    }
+    return;
+  }
+
+  for (cfra = cache->startframe; cfra <= cache->endframe; cfra++) {
+    if (cfra != 0) {
+      ptcache_filename(pid, filename, cfra, 1, 1);
+      BLI_delete(filename, false, false);
+    }
+  }
+  cache->flag |= PTCACHE_PACKED;
+}
+
+/* Move the frames of packs back into their own files, before the cache is changed. */
+static void ptcache_disk_unpack(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  char filename[MAX_PTCACHE_FILE];
+
+  if ((cache->flag & PTCACHE_PACKED) == 0) {
+    return;
+  }
+  cache->flag &= ~PTCACHE_PACKED;
+
+  for (int cfra = ptcache_pack_first_frame(cache->startframe); cfra <= cache->endframe;
+       cfra += PTCACHE_PACK_FRAMES) {
+    PTCachePack pack;
+    if (!ptcache_pack_open(pid, cfra, &pack)) {
+      continue;
+    }
+
+    for (unsigned int i = 0; i < pack.totframe; i++) {
+      const PTCachePackFrame *frame = &pack.frames[i];
+      ptcache_filename(pid, filename, frame->frame, 1, 1);
+      FILE *fp = BLI_fopen(filename, "wb");
+      bool ok = (fp != NULL) && (ptcache_file_seek(pack.fp, frame->offset) == 0) &&
+                ptcache_file_copy_data(fp, pack.fp, frame->size);
+      if (fp && fclose(fp) != 0) {
+        ok = false;
+      }
+      if (!ok) {
+        BLI_delete(filename, false, false);
+        if (G.debug & G_DEBUG) {
+          printf("Error unpacking disk cache frame %d\n", frame->frame);
+        }
+      }
+    }
+
+    fclose(pack.fp);
+    ptcache_pack_filename(pid, filename, cfra);
+    BLI_delete(filename, false, false);
+  }
+}
+
 /* youll need to close yourself after! */
 static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 {
   PTCacheFile *pf;
   FILE *fp = NULL;
+  size_t remaining = SIZE_MAX;
   char filename[FILE_MAX * 2];
 
 #ifndef DURIAN_POINTCACHE_LIB_OK
@@ -2173,7 +2459,14 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 
   ptcache_filename(pid, filename, cfra, 1, 1);
 
-  if (mode == PTCACHE_FILE_READ) {
+  if (mode != PTCACHE_FILE_READ && ptcache_pack_use(pid, cfra)) {
+    ptcache_disk_unpack(pid);
+  }
+
+  if (mode == PTCACHE_FILE_READ && ptcache_pack_use(pid, cfra)) {
+    fp = ptcache_pack_frame_open(pid, cfra, &remaining);
+  }
+  else if (mode == PTCACHE_FILE_READ) {
     fp = BLI_fopen(filename, "rb");
   }
   else if (mode == PTCACHE_FILE_WRITE) {
@@ -2191,8 +2484,13 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
     return NULL;
   }
 
+  /* Cache files are read and written as a whole, use large buffers so that this is done with few
+   * system calls, which matters most on network storage. */
+  setvbuf(fp, NULL, _IOFBF, PTCACHE_FILE_BUFFER_SIZE);
+
   pf = MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
   pf->fp = fp;
+  pf->remaining = remaining;
   pf->old_format = 0;
   pf->frame = cfra;
 
@@ -2206,128 +2504,264 @@ static void ptcache_file_close(PTCacheFile *pf)
   }
 }
 
-static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len)
+/* A block of data stored in a cache file, optionally compressed. Point data is stored as one
+ * column per data type, so columns can be (de)compressed independently, in parallel. */
+typedef struct PTCacheFileColumn {
+  /** Uncompressed data. */
+  unsigned char *data;
+  unsigned int len;
+
+  /** Compression mode: 0 for none, 1 for LZO and 2 for LZMA. */
+  unsigned char compressed;
+  /** Compressed data, owned by the column. */
+  unsigned char *comp;
+  size_t comp_len;
+  unsigned char props[16];
+  size_t props_len;
+
+  int result;
+} PTCacheFileColumn;
+
+static void ptcache_file_column_free(PTCacheFileColumn *col)
+{
+  MEM_SAFE_FREE(col->comp);
+}
+
+static int ptcache_file_column_decompress(PTCacheFileColumn *col)
 {
   int r = 0;
-  unsigned char compressed = 0;
-  size_t in_len;
+
 #ifdef WITH_LZO
-  size_t out_len = len;
+  if (col->compressed == 1) {
+    size_t out_len = col->len;
+    r = lzo1x_decompress_safe(
+        col->comp, (lzo_uint)col->comp_len, col->data, (lzo_uint *)&out_len, NULL);
+  }
 #endif
-  unsigned char *in;
-  unsigned char *props = MEM_callocN(16 * sizeof(char), "tmp");
+#ifdef WITH_LZMA
+  if (col->compressed == 2) {
+    size_t leni = col->comp_len, leno = col->len;
+    r = LzmaUncompress(col->data, &leno, col->comp, &leni, col->props, col->props_len);
+  }
+#endif
+
+  return r;
+}
+
+/* Read the column header and compressed data, decompression is done separately. */
+static int ptcache_file_column_read(PTCacheFile *pf, PTCacheFileColumn *col)
+{
+  unsigned char compressed = 0;
+
+  col->compressed = 0;
+  col->comp = NULL;
+  col->comp_len = 0;
+  col->props_len = 0;
+
+  if (!ptcache_file_read(pf, &compressed, 1, sizeof(unsigned char))) {
+    return 0;
+  }
 
-  ptcache_file_read(pf, &compressed, 1, sizeof(unsigned char));
   if (compressed) {
     unsigned int size;
-    ptcache_file_read(pf, &size, 1, sizeof(unsigned int));
-    in_len = (size_t)size;
-    if (in_len == 0) {
+    if (!ptcache_file_read(pf, &size, 1, sizeof(unsigned int))) {
+      return 0;
+    }
+    col->comp_len = (size_t)size;
+    if (col->comp_len == 0) {
       /* do nothing */
     }
     else {
-      in = (unsigned char *)MEM_callocN(sizeof(unsigned char) * in_len,
-                                        "pointcache_compressed_buffer");
-      ptcache_file_read(pf, in, in_len, sizeof(unsigned char));
-#ifdef WITH_LZO
-      if (compressed == 1) {
-        r = lzo1x_decompress_safe(in, (lzo_uint)in_len, result, (lzo_uint *)&out_len, NULL);
+      col->compressed = compressed;
+      col->comp = (unsigned char *)MEM_callocN(sizeof(unsigned char) * col->comp_len,
+                                               "pointcache_compressed_buffer");
+      if (!ptcache_file_read(pf, col->comp, col->comp_len, sizeof(unsigned char))) {
+        return 0;
       }
-#endif
 #ifdef WITH_LZMA
       if (compressed == 2) {
-        size_t sizeOfIt;
-        size_t leni = in_len, leno = len;
-        ptcache_file_read(pf, &size, 1, sizeof(unsigned int));
-        sizeOfIt = (size_t)size;
-        ptcache_file_read(pf, props, sizeOfIt, sizeof(unsigned char));
-        r = LzmaUncompress(result, &leno, in, &leni, props, sizeOfIt);
+        if (!ptcache_file_read(pf, &size, 1, sizeof(unsigned int))) {
+          return 0;
+        }
+        col->props_len = MIN2((size_t)size, sizeof(col->props));
+        if (!ptcache_file_read(pf, col->props, col->props_len, sizeof(unsigned char))) {
+          return 0;
+        }
       }
 #endif
-      MEM_freeN(in);
     }
-  }
-  else {
-    ptcache_file_read(pf, result, len, sizeof(unsigned char));
+    return 1;
   }
 
-  MEM_freeN(props);
-
-  return r;
+  return ptcache_file_read(pf, col->data, col->len, sizeof(unsigned char));
 }
-static int ptcache_file_compressed_write(
-    PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode)
+
+static void ptcache_file_column_compress(PTCacheFileColumn *col, int mode)
 {
   int r = 0;
-  unsigned char compressed = 0;
-  size_t out_len = 0;
-  unsigned char *props = MEM_callocN(16 * sizeof(char), "tmp");
-  size_t sizeOfIt = 5;
 
   (void)mode; /* unused when building w/o compression */
 
+  col->compressed = 0;
+
 #ifdef WITH_LZO
-  out_len = LZO_OUT_LEN(in_len);
   if (mode == 1) {
     LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
 
-    r = lzo1x_1_compress(in, (lzo_uint)in_len, out, (lzo_uint *)&out_len, wrkmem);
-    if (!(r == LZO_E_OK) || (out_len >= in_len)) {
-      compressed = 0;
+    col->comp_len = LZO_OUT_LEN(col->len);
+    col->comp = (unsigned char *)MEM_mallocN(col->comp_len, "pointcache_lzo_buffer");
+    r = lzo1x_1_compress(
+        col->data, (lzo_uint)col->len, col->comp, (lzo_uint *)&col->comp_len, wrkmem);
+    if (!(r == LZO_E_OK) || (col->comp_len >= col->len)) {
+      col->compressed = 0;
     }
     else {
-      compressed = 1;
+      col->compressed = 1;
     }
   }
 #endif
 #ifdef WITH_LZMA
   if (mode == 2) {
-
-    r = LzmaCompress(out,
-                     &out_len,
-                     in,
-                     in_len,  // assume sizeof(char)==1....
-                     props,
-                     &sizeOfIt,
+    /* The dictionary doesn't need to be bigger than the data, this keeps the memory used by the
+     * encoder low, which matters when compressing multiple columns at once. */
+    unsigned int dict_size = 1 << 12;
+    while (dict_size < col->len && dict_size < (1 << 24)) {
+      dict_size <<= 1;
+    }
+
+    col->comp_len = LZO_OUT_LEN(col->len) * 4;
+    col->comp = (unsigned char *)MEM_mallocN(col->comp_len, "pointcache_lzma_buffer");
+    col->props_len = 5;
+    r = LzmaCompress(col->comp,
+                     &col->comp_len,
+                     col->data,
+                     col->len,  // assume sizeof(char)==1....
+                     col->props,
+                     &col->props_len,
                      5,
-                     1 << 24,
+                     dict_size,
                      3,
                      0,
                      2,
                      32,
                      2);
 
-    if (!(r == SZ_OK) || (out_len >= in_len)) {
-      compressed = 0;
+    if (!(r == SZ_OK) || (col->comp_len >= col->len)) {
+      col->compressed = 0;
     }
     else {
-      compressed = 2;
+      col->compressed = 2;
     }
   }
 #endif
 
-  ptcache_file_write(pf, &compressed, 1, sizeof(unsigned char));
+  col->result = r;
+}
+
+static int ptcache_file_column_write(PTCacheFile *pf, const PTCacheFileColumn *col)
+{
+  unsigned char compressed = col->compressed;
+  int ok = ptcache_file_write(pf, &compressed, 1, sizeof(unsigned char));
+
   if (compressed) {
-    unsigned int size = out_len;
-    ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
-    ptcache_file_write(pf, out, out_len, sizeof(unsigned char));
+    unsigned int size = col->comp_len;
+    ok = ok && ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
+    ok = ok && ptcache_file_write(pf, col->comp, col->comp_len, sizeof(unsigned char));
   }
   else {
-    ptcache_file_write(pf, in, in_len, sizeof(unsigned char));
+    ok = ok && ptcache_file_write(pf, col->data, col->len, sizeof(unsigned char));
   }
 
   if (compressed == 2) {
-    unsigned int size = sizeOfIt;
-    ptcache_file_write(pf, &sizeOfIt, 1, sizeof(unsigned int));
-    ptcache_file_write(pf, props, size, sizeof(unsigned char));
+    unsigned int size = col->props_len;
+    ok = ok && ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
+    ok = ok && ptcache_file_write(pf, col->props, size, sizeof(unsigned char));
   }
 
-  MEM_freeN(props);
+  return ok;
+}
+
+typedef struct PTCacheFileColumnsCompressData {
+  PTCacheFileColumn *cols;
+  int mode;
+} PTCacheFileColumnsCompressData;
+
+static void ptcache_file_columns_compress_cb(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PTCacheFileColumnsCompressData *data = userdata;
+  ptcache_file_column_compress(&data->cols[i], data->mode);
+}
+
+static void ptcache_file_columns_decompress_cb(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PTCacheFileColumn *cols = userdata;
+  cols[i].result = ptcache_file_column_decompress(&cols[i]);
+}
+
+/* Only use threads when there is enough data to make up for the overhead. */
+static bool ptcache_file_columns_use_threading(const PTCacheFileColumn *cols, int totcol)
+{
+  size_t len = 0;
+  for (int i = 0; i < totcol; i++) {
+    len += cols[i].len;
+  }
+  return (totcol > 1) && (len > (1 << 16));
+}
+
+/* Compress multiple columns in parallel. */
+static void ptcache_file_columns_compress(PTCacheFileColumn *cols, int totcol, int mode)
+{
+  PTCacheFileColumnsCompressData data = {.cols = cols, .mode = mode};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ptcache_file_columns_use_threading(cols, totcol);
+  BLI_task_parallel_range(0, totcol, &data, ptcache_file_columns_compress_cb, &settings);
+}
+
+/* Decompress multiple columns in parallel. */
+static void ptcache_file_columns_decompress(PTCacheFileColumn *cols, int totcol)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ptcache_file_columns_use_threading(cols, totcol);
+  BLI_task_parallel_range(0, totcol, cols, ptcache_file_columns_decompress_cb, &settings);
+}
+
+static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len)
+{
+  PTCacheFileColumn col = {.data = result, .len = len};
+  int r = 0;
+
+  if (ptcache_file_column_read(pf, &col) && col.compressed) {
+    r = ptcache_file_column_decompress(&col);
+  }
+  ptcache_file_column_free(&col);
 
   return r;
 }
+static int ptcache_file_compressed_write(
+    PTCacheFile *pf, unsigned char *in, unsigned int in_len, int mode)
+{
+  PTCacheFileColumn col = {.data = in, .len = in_len};
+
+  ptcache_file_column_compress(&col, mode);
+  ptcache_file_column_write(pf, &col);
+  ptcache_file_column_free(&col);
+
+  return col.result;
+}
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
+  const size_t len = (size_t)tot * (size_t)size;
+  if (len > pf->remaining) {
+    return 0;
+  }
+  pf->remaining -= len;
   return (fread(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
@@ -2366,9 +2800,11 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
   int error = 0;
   char bphysics[8];
 
+  const size_t remaining = pf->remaining;
+
   pf->data_types = 0;
 
-  if (fread(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_read(pf, bphysics, 8, sizeof(char))) {
     error = 1;
   }
 
@@ -2376,7 +2812,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
     error = 1;
   }
 
-  if (!error && !fread(&typeflag, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &typeflag, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -2385,7 +2821,8 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   /* if there was an error set file as it was */
   if (error) {
-    fseek(pf->fp, 0, SEEK_SET);
+    fseek(pf->fp, -(long)(remaining - pf->remaining), SEEK_CUR);
+    pf->remaining = remaining;
   }
 
   return !error;
@@ -2626,6 +3063,78 @@ static void ptcache_find_frames_around(PTCacheID *pid, unsigned int frame, int *
   }
 }
 
+/* Size of all data of a point, for files storing the data of each point together. */
+static size_t ptcache_file_point_size(unsigned int data_types)
+{
+  size_t size = 0;
+  for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+    if (data_types & (1 << i)) {
+      size += ptcache_data_size[i];
+    }
+  }
+  return size;
+}
+
+/* Copy between point data of \a pm and a buffer storing the data of each point together. */
+static void ptcache_mem_interleave(PTCacheMem *pm, unsigned char *buf, const bool to_buf)
+{
+  for (unsigned int p = 0; p < pm->totpoint; p++) {
+    for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+      if (pm->data_types & (1 << i)) {
+        unsigned char *data = (unsigned char *)pm->data[i] + (size_t)p * ptcache_data_size[i];
+        if (to_buf) {
+          memcpy(buf, data, ptcache_data_size[i]);
+        }
+        else {
+          memcpy(data, buf, ptcache_data_size[i]);
+        }
+        buf += ptcache_data_size[i];
+      }
+    }
+  }
+}
+
+/* Uncompressed point data, which is stored per point, read and written in a single call. */
+static int ptcache_file_interleaved_read(PTCacheFile *pf, PTCacheMem *pm)
+{
+  const size_t len = ptcache_file_point_size(pm->data_types) * pm->totpoint;
+  if (len == 0) {
+    return 1;
+  }
+
+  unsigned char *buf = MEM_mallocN(len, __func__);
+  const int ok = ptcache_file_read(pf, buf, len, sizeof(unsigned char));
+  if (ok) {
+    ptcache_mem_interleave(pm, buf, false);
+  }
+  MEM_freeN(buf);
+  return ok;
+}
+static int ptcache_file_interleaved_write(PTCacheFile *pf, PTCacheMem *pm)
+{
+  const size_t len = ptcache_file_point_size(pm->data_types) * pm->totpoint;
+  int ok = 1;
+
+  if (len) {
+    unsigned char *buf = MEM_mallocN(len, __func__);
+    ptcache_mem_interleave(pm, buf, true);
+    ok = ptcache_file_write(pf, buf, len, sizeof(unsigned char));
+    MEM_freeN(buf);
+  }
+
+  for (PTCacheExtra *extra = pm->extradata.first; extra && ok; extra = extra->next) {
+    if (extra->data == NULL || extra->totdata == 0) {
+      continue;
+    }
+    ok = ptcache_file_write(pf, &extra->type, 1, sizeof(unsigned int)) &&
+         ptcache_file_write(pf, &extra->totdata, 1, sizeof(unsigned int)) &&
+         ptcache_file_write(
+             pf, extra->data, extra->totdata, ptcache_extra_datasize[extra->type]);
+  }
+
+  return ok;
+}
+
 static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 {
   PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
@@ -2654,51 +3163,79 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
     ptcache_data_alloc(pm);
 
     if (pf->flag & PTCACHE_TYPEFLAG_COMPRESS) {
+      PTCacheFileColumn cols[BPHYS_TOT_DATA];
+      int totcol = 0;
+
       for (i = 0; i < BPHYS_TOT_DATA; i++) {
-        unsigned int out_len = pm->totpoint * ptcache_data_size[i];
         if (pf->data_types & (1 << i)) {
-          ptcache_file_compressed_read(pf, (unsigned char *)(pm->data[i]), out_len);
+          PTCacheFileColumn *col = &cols[totcol++];
+          col->data = (unsigned char *)(pm->data[i]);
+          col->len = pm->totpoint * ptcache_data_size[i];
+          if (!ptcache_file_column_read(pf, col)) {
+            error = 1;
+            break;
+          }
         }
       }
-    }
-    else {
-      BKE_ptcache_mem_pointers_init(pm);
-      ptcache_file_pointers_init(pf);
 
-      for (i = 0; i < pm->totpoint; i++) {
-        if (!ptcache_file_data_read(pf)) {
-          error = 1;
-          break;
-        }
-        ptcache_data_copy(pf->cur, pm->cur);
-        BKE_ptcache_mem_pointers_incr(pm);
+      if (!error) {
+        ptcache_file_columns_decompress(cols, totcol);
+      }
+      for (i = 0; i < totcol; i++) {
+        ptcache_file_column_free(&cols[i]);
       }
     }
+    else if (!ptcache_file_interleaved_read(pf, pm)) {
+      error = 1;
+    }
   }
 
   if (!error && pf->flag & PTCACHE_TYPEFLAG_EXTRADATA) {
     unsigned int extratype = 0;
+    PTCacheFileColumn *cols = NULL;
+    int totcol = 0;
 
     while (ptcache_file_read(pf, &extratype, 1, sizeof(unsigned int))) {
-      PTCacheExtra *extra = MEM_callocN(sizeof(PTCacheExtra), "Pointcache extradata");
-
-      extra->type = extratype;
+      unsigned int totdata = 0;
 
-      ptcache_file_read(pf, &extra->totdata, 1, sizeof(unsigned int));
+      if (extratype >= ARRAY_SIZE(ptcache_extra_datasize) ||
+          !ptcache_file_read(pf, &totdata, 1, sizeof(unsigned int))) {
+        error = 1;
+        break;
+      }
 
+      PTCacheExtra *extra = MEM_callocN(sizeof(PTCacheExtra), "Pointcache extradata");
+      extra->type = extratype;
+      extra->totdata = totdata;
       extra->data = MEM_callocN(extra->totdata * ptcache_extra_datasize[extra->type],
                                 "Pointcache extradata->data");
+      BLI_addtail(&pm->extradata, extra);
 
       if (pf->flag & PTCACHE_TYPEFLAG_COMPRESS) {
-        ptcache_file_compressed_read(pf,
-                                     (unsigned char *)(extra->data),
-                                     extra->totdata * ptcache_extra_datasize[extra->type]);
+        /* Gather the columns, to decompress them all at once. */
+        cols = MEM_reallocN(cols, sizeof(*cols) * (totcol + 1));
+        cols[totcol].data = (unsigned char *)(extra->data);
+        cols[totcol].len = extra->totdata * ptcache_extra_datasize[extra->type];
+        if (!ptcache_file_column_read(pf, &cols[totcol++])) {
+          error = 1;
+          break;
+        }
       }
-      else {
-        ptcache_file_read(pf, extra->data, extra->totdata, ptcache_extra_datasize[extra->type]);
+      else if (!ptcache_file_read(
+                   pf, extra->data, extra->totdata, ptcache_extra_datasize[extra->type])) {
+        error = 1;
+        break;
       }
+    }
 
-      BLI_addtail(&pm->extradata, extra);
+    if (cols) {
+      if (!error) {
+        ptcache_file_columns_decompress(cols, totcol);
+      }
+      for (int c = 0; c < totcol; c++) {
+        ptcache_file_column_free(&cols[c]);
+      }
+      MEM_freeN(cols);
     }
   }
 
@@ -2742,6 +3279,7 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
     pf->flag |= PTCACHE_TYPEFLAG_EXTRADATA;
   }
 
+  /* Compressed data is stored per column, columns are compressed in parallel. */
   if (pid->cache->compression) {
     pf->flag |= PTCACHE_TYPEFLAG_COMPRESS;
   }
@@ -2750,57 +3288,55 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
     error = 1;
   }
 
-  if (!error) {
-    if (pid->cache->compression) {
-      for (i = 0; i < BPHYS_TOT_DATA; i++) {
-        if (pm->data[i]) {
-          unsigned int in_len = pm->totpoint * ptcache_data_size[i];
-          unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                            "pointcache_lzo_buffer");
-          ptcache_file_compressed_write(
-              pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
-          MEM_freeN(out);
-        }
+  if (!error && !(pf->flag & PTCACHE_TYPEFLAG_COMPRESS)) {
+    error = !ptcache_file_interleaved_write(pf, pm);
+  }
+  else if (!error) {
+    PTCacheFileColumn *cols = MEM_calloc_arrayN(
+        BPHYS_TOT_DATA + BLI_listbase_count(&pm->extradata), sizeof(*cols), "PTCacheFileColumn");
+    int totcol = 0, totcol_data;
+    PTCacheExtra *extra;
+
+    for (i = 0; i < BPHYS_TOT_DATA; i++) {
+      if (pm->data[i]) {
+        cols[totcol].data = (unsigned char *)(pm->data[i]);
+        cols[totcol].len = pm->totpoint * ptcache_data_size[i];
+        totcol++;
       }
     }
-    else {
-      BKE_ptcache_mem_pointers_init(pm);
-      ptcache_file_pointers_init(pf);
+    totcol_data = totcol;
 
-      for (i = 0; i < pm->totpoint; i++) {
-        ptcache_data_copy(pm->cur, pf->cur);
-        if (!ptcache_file_data_write(pf)) {
-          error = 1;
-          break;
-        }
-        BKE_ptcache_mem_pointers_incr(pm);
+    for (extra = pm->extradata.first; extra; extra = extra->next) {
+      if (extra->data == NULL || extra->totdata == 0) {
+        continue;
       }
+      cols[totcol].data = (unsigned char *)(extra->data);
+      cols[totcol].len = extra->totdata * ptcache_extra_datasize[extra->type];
+      totcol++;
     }
-  }
 
-  if (!error && pm->extradata.first) {
-    PTCacheExtra *extra = pm->extradata.first;
+    ptcache_file_columns_compress(cols, totcol, pid->cache->compression);
 
-    for (; extra; extra = extra->next) {
-      if (extra->data == NULL || extra->totdata == 0) {
-        continue;
+    for (i = 0; i < totcol_data && !error; i++) {
+      error = !ptcache_file_column_write(pf, &cols[i]);
+    }
+
+    /* Extra data is written after the point data, each with its own header. */
+    extra = pm->extradata.first;
+    for (i = totcol_data; i < totcol && !error; i++, extra = extra->next) {
+      while (extra->data == NULL || extra->totdata == 0) {
+        extra = extra->next;
       }
 
       ptcache_file_write(pf, &extra->type, 1, sizeof(unsigned int));
       ptcache_file_write(pf, &extra->totdata, 1, sizeof(unsigned int));
+      error = !ptcache_file_column_write(pf, &cols[i]);
+    }
 
-      if (pid->cache->compression) {
-        unsigned int in_len = extra->totdata * ptcache_extra_datasize[extra->type];
-        unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                          "pointcache_lzo_buffer");
-        ptcache_file_compressed_write(
-            pf, (unsigned char *)(extra->data), in_len, out, pid->cache->compression);
-        MEM_freeN(out);
-      }
-      else {
-        ptcache_file_write(pf, extra->data, extra->totdata, ptcache_extra_datasize[extra->type]);
-      }
+    for (i = 0; i < totcol; i++) {
+      ptcache_file_column_free(&cols[i]);
     }
+    MEM_freeN(cols);
   }
 
   ptcache_file_close(pf);
@@ -3358,6 +3894,7 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
   char filename[MAX_PTCACHE_FILE];
   char path_full[MAX_PTCACHE_FILE];
   char ext[MAX_PTCACHE_PATH];
+  char ext_pack[MAX_PTCACHE_PATH];
 
   if (!pid || !pid->cache || pid->cache->flag & PTCACHE_BAKED) {
     return;
@@ -3381,6 +3918,11 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 
   const char *fext = ptcache_file_extension(pid);
 
+  /* Only clearing everything works on packs directly. */
+  if (mode != PTCACHE_CLEAR_ALL) {
+    ptcache_disk_unpack(pid);
+  }
+
   /* clear all files in the temp dir with the prefix of the ID and the ".bphys" suffix */
   switch (mode) {
     case PTCACHE_CLEAR_ALL:
@@ -3404,9 +3946,15 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
         }
 
         BLI_snprintf(ext, sizeof(ext), "_%02u%s", pid->stack_index, fext);
+        BLI_snprintf(ext_pack, sizeof(ext_pack), "_%02u" PTCACHE_PACK_EXT, pid->stack_index);
 
         while ((de = readdir(dir)) != NULL) {
-          if (strstr(de->d_name, ext)) {               /* do we have the right extension?*/
+          if (mode == PTCACHE_CLEAR_ALL && strstr(de->d_name, ext_pack) &&
+              STREQLEN(filename, de->d_name, len)) {
+            BLI_join_dirfile(path_full, sizeof(path_full), path, de->d_name);
+            BLI_delete(path_full, false, false);
+          }
+          else if (strstr(de->d_name, ext)) {          /* do we have the right extension?*/
             if (STREQLEN(filename, de->d_name, len)) { /* do we have the right prefix */
               if (mode == PTCACHE_CLEAR_ALL) {
                 pid->cache->last_exact = MIN2(pid->cache->startframe, 0);
@@ -3433,8 +3981,11 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
         }
         closedir(dir);
 
-        if (mode == PTCACHE_CLEAR_ALL && pid->cache->cached_frames) {
-          memset(pid->cache->cached_frames, 0, MEM_allocN_len(pid->cache->cached_frames));
+        if (mode == PTCACHE_CLEAR_ALL) {
+          pid->cache->flag &= ~PTCACHE_PACKED;
+          if (pid->cache->cached_frames) {
+            memset(pid->cache->cached_frames, 0, MEM_allocN_len(pid->cache->cached_frames));
+          }
         }
       }
       else {
@@ -3520,6 +4071,14 @@ int BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
   if (pid->cache->flag & PTCACHE_DISK_CACHE) {
     char filename[MAX_PTCACHE_FILE];
 
+    if (ptcache_pack_use(pid, cfra)) {
+      /* Frames listed by the pack indices, avoids opening the pack. */
+      if (pid->cache->cached_frames) {
+        return 1;
+      }
+      return ptcache_pack_frame_exists(pid, cfra);
+    }
+
     ptcache_filename(pid, filename, cfra, 1, 1);
 
     return BLI_exists(filename);
@@ -3594,6 +4153,7 @@ void BKE_ptcache_id_time(
       char path[MAX_PTCACHE_PATH];
       char filename[MAX_PTCACHE_FILE];
       char ext[MAX_PTCACHE_PATH];
+      char ext_pack[MAX_PTCACHE_PATH];
       unsigned int len; /* store the length of the string */
 
       ptcache_path(pid, path);
@@ -3608,6 +4168,7 @@ void BKE_ptcache_id_time(
       const char *fext = ptcache_file_extension(pid);
 
       BLI_snprintf(ext, sizeof(ext), "_%02u%s", pid->stack_index, fext);
+      BLI_snprintf(ext_pack, sizeof(ext_pack), "_%02u" PTCACHE_PACK_EXT, pid->stack_index);
 
       while ((de = readdir(dir)) != NULL) {
         if (strstr(de->d_name, ext)) {               /* do we have the right extension?*/
@@ -3620,6 +4181,22 @@ void BKE_ptcache_id_time(
             }
           }
         }
+        else if ((cache->flag & PTCACHE_PACKED) && strstr(de->d_name, ext_pack) &&
+                 STREQLEN(filename, de->d_name, len)) {
+          /* Mark the frames listed in the pack index. */
+          const int frame_first = ptcache_frame_from_filename(de->d_name, ext_pack);
+          PTCachePack pack;
+
+          if (frame_first != -1 && ptcache_pack_open(pid, frame_first, &pack)) {
+            for (unsigned int i = 0; i < pack.totframe; i++) {
+              const int frame = pack.frames[i].frame;
+              if (frame >= sta && frame <= end) {
+                cache->cached_frames[frame - sta] = 1;
+              }
+            }
+            fclose(pack.fp);
+          }
+        }
       }
       closedir(dir);
     }
@@ -4158,6 +4735,7 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
       /* write info file */
       if (cache->flag & PTCACHE_DISK_CACHE) {
         BKE_ptcache_write(pid, 0);
+        ptcache_disk_pack(pid);
       }
     }
   }
@@ -4187,6 +4765,7 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
           cache->flag |= PTCACHE_BAKED;
           if (cache->flag & PTCACHE_DISK_CACHE) {
             BKE_ptcache_write(pid, 0);
+            ptcache_disk_pack(pid);
           }
         }
       }
@@ -4311,6 +4890,7 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   char new_path_full[MAX_PTCACHE_FILE];
   char old_path_full[MAX_PTCACHE_FILE];
   char ext[MAX_PTCACHE_PATH];
+  char ext_pack[MAX_PTCACHE_PATH];
 
   /* save old name */
   BLI_strncpy(old_name, pid->cache->name, sizeof(old_name));
@@ -4330,6 +4910,7 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   const char *fext = ptcache_file_extension(pid);
 
   BLI_snprintf(ext, sizeof(ext), "_%02u%s", pid->stack_index, fext);
+  BLI_snprintf(ext_pack, sizeof(ext_pack), "_%02u" PTCACHE_PACK_EXT, pid->stack_index);
 
   /* put new name into cache */
   BLI_strncpy(pid->cache->name, name_dst, sizeof(pid->cache->name));
@@ -4347,6 +4928,15 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
         }
       }
     }
+    else if (strstr(de->d_name, ext_pack) && STREQLEN(old_filename, de->d_name, len)) {
+      const int frame = ptcache_frame_from_filename(de->d_name, ext_pack);
+
+      if (frame != -1) {
+        BLI_join_dirfile(old_path_full, sizeof(old_path_full), path, de->d_name);
+        ptcache_pack_filename(pid, new_path_full, frame);
+        BLI_rename(old_path_full, new_path_full);
+      }
+    }
   }
   closedir(dir);
 
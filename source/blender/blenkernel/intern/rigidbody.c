@@ -35,6 +35,8 @@
 
 #include "BLI_math.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #ifdef WITH_BULLET
 #  include "RBI_api.h"
@@ -103,6 +105,49 @@ static void RB_constraint_delete(void *UNUSED(con))
 
 #endif
 
+/* ************************************** */
+/* Transform Cache */
+
+/* Compact copy of the simulated transforms of all bodies, per frame.
+ *
+ * Playing back cached frames from here only copies two contiguous arrays into the objects,
+ * without reading the point cache from disk for every body. The point cache stays the
+ * reference: a frame is only used when the point cache has it too.
+ *
+ * Point caches kept in memory already serve their frames from RAM, so this is only used for
+ * disk caches, and only up to a fixed memory budget. */
+#define RIGIDBODY_TRANSFORM_CACHE_MAX_MEM ((size_t)128 * 1024 * 1024)
+
+typedef struct RigidBodyTransformCache {
+  /** Point cache the transforms were stored for, the active cache can be changed. */
+  struct PointCache *pointcache;
+  int numbodies;
+  int startframe, endframe;
+  /** Size of all allocated frames, limited to #RIGIDBODY_TRANSFORM_CACHE_MAX_MEM. */
+  size_t mem_size;
+  /** One item per frame in the cache range, NULL when not cached. Each frame is a single
+   * allocation with the locations of all bodies followed by their orientations. */
+  float **frames;
+} RigidBodyTransformCache;
+
+static void rigidbody_transform_cache_free(RigidBodyWorld_Shared *shared)
+{
+  RigidBodyTransformCache *tcache = shared->transform_cache;
+
+  if (tcache == NULL) {
+    return;
+  }
+
+  for (int i = 0; i <= tcache->endframe - tcache->startframe; i++) {
+    if (tcache->frames[i]) {
+      MEM_freeN(tcache->frames[i]);
+    }
+  }
+  MEM_freeN(tcache->frames);
+  MEM_freeN(tcache);
+  shared->transform_cache = NULL;
+}
+
 /* Free rigidbody world */
 void BKE_rigidbody_free_world(Scene *scene)
 {
@@ -147,6 +192,7 @@ void BKE_rigidbody_free_world(Scene *scene)
     /* free cache */
     BKE_ptcache_free_list(&(rbw->shared->ptcaches));
     rbw->shared->pointcache = NULL;
+    rigidbody_transform_cache_free(rbw->shared);
 
     MEM_freeN(rbw->shared);
   }
@@ -1507,6 +1553,155 @@ void BKE_rigidbody_remove_constraint(Main *bmain, Scene *scene, Object *ob, cons
   BKE_rigidbody_cache_reset(rbw);
 }
 
+/* ************************************** */
+/* Transform Cache Playback */
+
+/* Get the transforms of a frame, optionally allocating them (NULL when over budget).
+ * The cache is cleared when the point cache isn't stored on disk anymore, or when the number of
+ * bodies or the frame range changed. */
+static float *rigidbody_transform_cache_frame(RigidBodyWorld *rbw, int frame, bool ensure)
+{
+  RigidBodyTransformCache *tcache = rbw->shared->transform_cache;
+  PointCache *cache = rbw->shared->pointcache;
+  const bool use_cache = (cache->flag & PTCACHE_DISK_CACHE) != 0;
+
+  if (tcache && (!use_cache || tcache->pointcache != cache ||
+                 tcache->numbodies != rbw->numbodies || tcache->startframe != cache->startframe ||
+                 tcache->endframe != cache->endframe)) {
+    rigidbody_transform_cache_free(rbw->shared);
+    tcache = NULL;
+  }
+
+  if (!use_cache || frame < cache->startframe || frame > cache->endframe ||
+      rbw->numbodies == 0) {
+    return NULL;
+  }
+
+  if (tcache == NULL) {
+    if (!ensure) {
+      return NULL;
+    }
+    tcache = MEM_callocN(sizeof(*tcache), "RigidBodyTransformCache");
+    tcache->pointcache = cache;
+    tcache->numbodies = rbw->numbodies;
+    tcache->startframe = cache->startframe;
+    tcache->endframe = cache->endframe;
+    tcache->frames = MEM_calloc_arrayN(
+        tcache->endframe - tcache->startframe + 1, sizeof(float *), "RigidBodyTransformCache");
+    rbw->shared->transform_cache = tcache;
+  }
+
+  float **r_frame = &tcache->frames[frame - tcache->startframe];
+  if (*r_frame == NULL && ensure) {
+    const size_t frame_size = sizeof(float[7]) * (size_t)tcache->numbodies;
+    if (tcache->mem_size + frame_size > RIGIDBODY_TRANSFORM_CACHE_MAX_MEM) {
+      /* Out of budget, the remaining frames are read from the point cache. */
+      return NULL;
+    }
+    *r_frame = MEM_mallocN(frame_size, __func__);
+    tcache->mem_size += frame_size;
+  }
+  return *r_frame;
+}
+
+/* The cache is shared between the depsgraphs evaluating the world, only the active one writes to
+ * it but the others read from it (and free it when it doesn't match the point cache anymore). */
+static ThreadMutex rigidbody_transform_cache_lock = BLI_MUTEX_INITIALIZER;
+
+typedef struct RigidBodyTransformCacheData {
+  RigidBodyWorld *rbw;
+  float (*pos)[3];
+  float (*orn)[4];
+} RigidBodyTransformCacheData;
+
+static RigidBodyOb *rigidbody_transform_cache_object(RigidBodyWorld *rbw, int i)
+{
+  Object *ob = rbw->objects[i];
+
+  /* Same as the point cache, only active bodies are stored. */
+  if (ob && ob->rigidbody_object && ob->rigidbody_object->type == RBO_TYPE_ACTIVE) {
+    return ob->rigidbody_object;
+  }
+  return NULL;
+}
+
+static void rigidbody_transform_cache_write_cb(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RigidBodyTransformCacheData *data = userdata;
+  RigidBodyOb *rbo = rigidbody_transform_cache_object(data->rbw, i);
+
+  if (rbo) {
+    copy_v3_v3(data->pos[i], rbo->pos);
+    copy_qt_qt(data->orn[i], rbo->orn);
+  }
+}
+
+static void rigidbody_transform_cache_read_cb(void *__restrict userdata,
+                                              const int i,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RigidBodyTransformCacheData *data = userdata;
+  RigidBodyOb *rbo = rigidbody_transform_cache_object(data->rbw, i);
+
+  if (rbo) {
+    copy_v3_v3(rbo->pos, data->pos[i]);
+    copy_qt_qt(rbo->orn, data->orn[i]);
+  }
+}
+
+static void rigidbody_transform_cache_run(RigidBodyWorld *rbw,
+                                          float *frame_data,
+                                          TaskParallelRangeFunc func)
+{
+  RigidBodyTransformCacheData data = {
+      .rbw = rbw,
+      .pos = (float(*)[3])frame_data,
+      .orn = (float(*)[4])(frame_data + 3 * rbw->numbodies),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, rbw->numbodies, &data, func, &settings);
+}
+
+/* Store the current transforms of the bodies, as written to the point cache. */
+static void rigidbody_transform_cache_write(RigidBodyWorld *rbw, int frame)
+{
+  if (rbw->objects == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&rigidbody_transform_cache_lock);
+  float *frame_data = rigidbody_transform_cache_frame(rbw, frame, true);
+  if (frame_data) {
+    rigidbody_transform_cache_run(rbw, frame_data, rigidbody_transform_cache_write_cb);
+  }
+  BLI_mutex_unlock(&rigidbody_transform_cache_lock);
+}
+
+/* Restore the transforms of the bodies for a frame, returns false when it is not cached. */
+static bool rigidbody_transform_cache_read(RigidBodyWorld *rbw, PTCacheID *pid, int frame)
+{
+  PointCache *cache = rbw->shared->pointcache;
+
+  if (rbw->objects == NULL ||
+      (cache->flag & (PTCACHE_OUTDATED | PTCACHE_FRAMES_SKIPPED | PTCACHE_READ_INFO))) {
+    return false;
+  }
+
+  BLI_mutex_lock(&rigidbody_transform_cache_lock);
+  float *frame_data = rigidbody_transform_cache_frame(rbw, frame, false);
+  const bool found = (frame_data != NULL) && BKE_ptcache_id_exist(pid, frame);
+  if (found) {
+    rigidbody_transform_cache_run(rbw, frame_data, rigidbody_transform_cache_read_cb);
+  }
+  BLI_mutex_unlock(&rigidbody_transform_cache_lock);
+  return found;
+}
+
 /* ************************************** */
 /* Simulation Interface - Bullet */
 
@@ -1560,8 +1755,20 @@ static void rigidbody_update_sim_world(Scene *scene, RigidBodyWorld *rbw)
   rigidbody_update_ob_array(rbw);
 }
 
-static void rigidbody_update_sim_ob(
-    Depsgraph *depsgraph, Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo)
+/* Objects being transformed by the user are temporarily made kinematic. */
+static bool rigidbody_is_transformed(ViewLayer *view_layer, Object *ob)
+{
+  if ((G.moving & G_TRANSFORM_OBJ) == 0) {
+    return false;
+  }
+  Base *base = BKE_view_layer_base_find(view_layer, ob);
+  return base ? (base->flag & BASE_SELECTED) != 0 : false;
+}
+
+/* Sync object transform and shape to the simulation.
+ * Only touches the simulation data of this object, so it can run for multiple objects in
+ * parallel. */
+static void rigidbody_update_sim_ob(ViewLayer *view_layer, Object *ob, RigidBodyOb *rbo)
 {
   float loc[3];
   float rot[4];
@@ -1572,9 +1779,7 @@ static void rigidbody_update_sim_ob(
     return;
   }
 
-  ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
-  Base *base = BKE_view_layer_base_find(view_layer, ob);
-  const bool is_selected = base ? (base->flag & BASE_SELECTED) != 0 : false;
+  const bool is_transformed = rigidbody_is_transformed(view_layer, ob);
 
   if (rbo->shape == RB_SHAPE_TRIMESH && rbo->flag & RBO_FLAG_USE_DEFORM) {
     Mesh *mesh = ob->runtime.mesh_deform_eval;
@@ -1604,20 +1809,40 @@ static void rigidbody_update_sim_ob(
 
   /* Make transformed objects temporarily kinmatic
    * so that they can be moved by the user during simulation. */
-  if (is_selected && (G.moving & G_TRANSFORM_OBJ)) {
+  if (is_transformed) {
     RB_body_set_kinematic_state(rbo->shared->physics_object, true);
     RB_body_set_mass(rbo->shared->physics_object, 0.0f);
   }
 
   /* update rigid body location and rotation for kinematic bodies */
-  if (rbo->flag & RBO_FLAG_KINEMATIC || (is_selected && (G.moving & G_TRANSFORM_OBJ))) {
+  if (rbo->flag & RBO_FLAG_KINEMATIC || is_transformed) {
     RB_body_activate(rbo->shared->physics_object);
     RB_body_set_loc_rot(rbo->shared->physics_object, loc, rot);
   }
+  /* NOTE: passive objects don't need to be updated since they don't move */
+
+  /* NOTE: no other settings need to be explicitly updated here,
+   * since RNA setters take care of the rest :)
+   */
+}
+
+/* Apply effector forces to the simulation object. Effectors are evaluated serially, since their
+ * evaluation is not safe to run for multiple objects at once (random generators, collider
+ * caches). */
+static void rigidbody_update_sim_ob_effectors(
+    Depsgraph *depsgraph, Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo)
+{
+  if (rbo->shared->physics_object == NULL) {
+    return;
+  }
+
+  ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
+
   /* update influence of effectors - but don't do it on an effector */
   /* only dynamic bodies need effector update */
-  else if (rbo->type == RBO_TYPE_ACTIVE &&
-           ((ob->pd == NULL) || (ob->pd->forcefield == PFIELD_NULL))) {
+  if (!(rbo->flag & RBO_FLAG_KINEMATIC) && rbo->type == RBO_TYPE_ACTIVE &&
+      ((ob->pd == NULL) || (ob->pd->forcefield == PFIELD_NULL)) &&
+      !rigidbody_is_transformed(view_layer, ob)) {
     EffectorWeights *effector_weights = rbw->effector_weights;
     EffectedPoint epoint;
     ListBase *effectors;
@@ -1660,11 +1885,23 @@ static void rigidbody_update_sim_ob(
     /* cleanup */
     BKE_effectors_free(effectors);
   }
-  /* NOTE: passive objects don't need to be updated since they don't move */
+}
 
-  /* NOTE: no other settings need to be explicitly updated here,
-   * since RNA setters take care of the rest :)
-   */
+typedef struct RigidBodyUpdateSimData {
+  RigidBodyWorld *rbw;
+  ViewLayer *view_layer;
+} RigidBodyUpdateSimData;
+
+static void rigidbody_update_sim_ob_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RigidBodyUpdateSimData *data = userdata;
+  Object *ob = data->rbw->objects[i];
+
+  if (ob->type == OB_MESH && ob->rigidbody_object) {
+    rigidbody_update_sim_ob(data->view_layer, ob, ob->rigidbody_object);
+  }
 }
 
 /**
@@ -1754,9 +1991,25 @@ static void rigidbody_update_simulation(Depsgraph *depsgraph,
         }
       }
       rbo->flag &= ~(RBO_FLAG_NEEDS_VALIDATE | RBO_FLAG_NEEDS_RESHAPE);
+    }
+  }
+  FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
+
+  /* Update simulation objects. Adding bodies to the world and evaluating transforms above is
+   * done serially, syncing the transforms and shapes of the bodies is independent per body. */
+  RigidBodyUpdateSimData data = {
+      .rbw = rbw,
+      .view_layer = DEG_get_input_view_layer(depsgraph),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, rbw->numbodies, &data, rigidbody_update_sim_ob_cb, &settings);
 
-      /* update simulation object... */
-      rigidbody_update_sim_ob(depsgraph, scene, rbw, ob, rbo);
+  FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (rbw->group, ob) {
+    if (ob->type == OB_MESH && ob->rigidbody_object) {
+      rigidbody_update_sim_ob_effectors(depsgraph, scene, rbw, ob, ob->rigidbody_object);
     }
   }
   FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
@@ -1966,6 +2219,7 @@ void BKE_rigidbody_rebuild_world(Depsgraph *depsgraph, Scene *scene, float ctime
   if (ctime == startframe + 1 && rbw->ltime == startframe) {
     if (cache->flag & PTCACHE_OUTDATED) {
       BKE_ptcache_id_reset(scene, &pid, PTCACHE_RESET_OUTDATED);
+      rigidbody_transform_cache_free(rbw->shared);
       rigidbody_update_simulation(depsgraph, scene, rbw, true);
       BKE_ptcache_validate(cache, (int)ctime);
       cache->last_exact = 0;
@@ -2008,8 +2262,18 @@ void BKE_rigidbody_do_simulation(Depsgraph *depsgraph, Scene *scene, float ctime
   // RB_TODO deal with interpolated, old and baked results
   bool can_simulate = (ctime == rbw->ltime + 1) && !(cache->flag & PTCACHE_BAKED);
 
+  if (ctime == (float)(int)ctime && rigidbody_transform_cache_read(rbw, &pid, (int)ctime)) {
+    BKE_ptcache_validate(cache, (int)ctime);
+    rbw->ltime = ctime;
+    return;
+  }
+
   if (BKE_ptcache_read(&pid, ctime, can_simulate) == PTCACHE_READ_EXACT) {
     BKE_ptcache_validate(cache, (int)ctime);
+    /* Like the point cache, only the active depsgraph writes to the transform cache. */
+    if (DEG_is_active(depsgraph)) {
+      rigidbody_transform_cache_write(rbw, (int)ctime);
+    }
     rbw->ltime = ctime;
     return;
   }
@@ -2025,6 +2289,7 @@ void BKE_rigidbody_do_simulation(Depsgraph *depsgraph, Scene *scene, float ctime
     /* write cache for first frame when on second frame */
     if (rbw->ltime == startframe && (cache->flag & PTCACHE_OUTDATED || cache->last_exact == 0)) {
       BKE_ptcache_write(&pid, startframe);
+      rigidbody_transform_cache_write(rbw, startframe);
     }
 
     /* update and validate simulation */
@@ -2044,6 +2309,7 @@ void BKE_rigidbody_do_simulation(Depsgraph *depsgraph, Scene *scene, float ctime
     /* write cache for current frame */
     BKE_ptcache_validate(cache, (int)ctime);
     BKE_ptcache_write(&pid, (unsigned int)ctime);
+    rigidbody_transform_cache_write(rbw, (int)ctime);
 
     rbw->ltime = ctime;
   }
@@ -1402,6 +1402,17 @@ void BKE_scene_graph_evaluated_ensure(Depsgraph *depsgraph, Main *bmain)
 
 /* applies changes right away, does all sets too */
 void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph, Main *bmain)
+{
+  BKE_scene_graph_update_for_newframe_ex(depsgraph, bmain, true);
+}
+
+/**
+ * \param clear_recalc: When false, recalc flags are kept so the caller can query what was
+ * updated, and is responsible for clearing them (used by renders with persistent data).
+ */
+void BKE_scene_graph_update_for_newframe_ex(Depsgraph *depsgraph,
+                                            Main *bmain,
+                                            const bool clear_recalc)
 {
   Scene *scene = DEG_get_input_scene(depsgraph);
   ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
@@ -1447,7 +1458,9 @@ void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph, Main *bmain)
     /* Inform editors about possible changes. */
     DEG_ids_check_recalc(bmain, depsgraph, scene, view_layer, true);
     /* clear recalc flags */
-    DEG_ids_clear_recalc(bmain, depsgraph);
+    if (clear_recalc) {
+      DEG_ids_clear_recalc(bmain, depsgraph);
+    }
 
     /* If user callback did not tag anything for update we can skip second iteration.
      * Otherwise we update scene once again, but without running callbacks to bring
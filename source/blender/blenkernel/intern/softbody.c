@@ -59,7 +59,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
-#include "BLI_threads.h"
+#include "BLI_task.h"
 
 #include "BKE_collection.h"
 #include "BKE_collision.h"
@@ -72,7 +72,6 @@
 #include "BKE_pointcache.h"
 #include "BKE_deform.h"
 #include "BKE_mesh.h"
-#include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
@@ -123,20 +122,21 @@ typedef struct SBScratch {
   ReferenceState Ref;
 } SBScratch;
 
-typedef struct SB_thread_context {
+typedef struct SB_task_context {
   Scene *scene;
   Object *ob;
   float forcetime;
   float timenow;
-  int ifirst;
-  int ilast;
   ListBase *effectors;
   int do_deflector;
   float fieldfactor;
   float windfactor;
-  int nr;
+  /* Number of points or springs to process. */
   int tot;
-} SB_thread_context;
+} SB_task_context;
+
+/* Number of points or springs handled by a single task. */
+#define SB_TASK_CHUNK_SIZE 64
 
 #define MID_PRESERVE 1
 
@@ -264,6 +264,19 @@ typedef struct ccdf_minmax {
   float minx, miny, minz, maxx, maxy, maxz;
 } ccdf_minmax;
 
+/* Uniform grid over the AABB of a collider, listing the faces whose padded bounds touch each
+ * cell, so point queries only visit nearby faces. Rebuilt with the bounds on every update. */
+typedef struct ccd_Grid {
+  int dims[3];
+  float inv_cell_size;
+  /* Faces of cell i are cell_tris[cell_offsets[i]] to cell_tris[cell_offsets[i + 1] - 1],
+   * in increasing order. */
+  int *cell_offsets;
+  int *cell_tris;
+} ccd_Grid;
+
+#define CCD_GRID_MAX_DIM 64
+
 typedef struct ccd_Mesh {
   int mvert_num, tri_num;
   const MVert *mvert;
@@ -274,8 +287,109 @@ typedef struct ccd_Mesh {
   /* Axis Aligned Bounding Box AABB */
   float bbmin[3];
   float bbmax[3];
+  ccd_Grid grid;
 } ccd_Mesh;
 
+BLI_INLINE int ccd_grid_cell_coord(const ccd_Mesh *ccdm, const float co, const int axis)
+{
+  const int i = (int)floorf((co - ccdm->bbmin[axis]) * ccdm->grid.inv_cell_size);
+  return clamp_i(i, 0, ccdm->grid.dims[axis] - 1);
+}
+
+BLI_INLINE int ccd_grid_cell_index(const ccd_Mesh *ccdm, const int x, const int y, const int z)
+{
+  return x + ccdm->grid.dims[0] * (y + ccdm->grid.dims[1] * z);
+}
+
+static void ccd_grid_cell_range(const ccd_Mesh *ccdm,
+                                const ccdf_minmax *mima,
+                                int r_min[3],
+                                int r_max[3])
+{
+  r_min[0] = ccd_grid_cell_coord(ccdm, mima->minx, 0);
+  r_min[1] = ccd_grid_cell_coord(ccdm, mima->miny, 1);
+  r_min[2] = ccd_grid_cell_coord(ccdm, mima->minz, 2);
+  r_max[0] = ccd_grid_cell_coord(ccdm, mima->maxx, 0);
+  r_max[1] = ccd_grid_cell_coord(ccdm, mima->maxy, 1);
+  r_max[2] = ccd_grid_cell_coord(ccdm, mima->maxz, 2);
+}
+
+/* Sort faces into the grid cells, needs bbmin, bbmax and mima to be up to date. */
+static void ccd_mesh_grid_build(ccd_Mesh *pccd_M)
+{
+  ccd_Grid *grid = &pccd_M->grid;
+  int cell_min[3], cell_max[3];
+  float size[3];
+  int i, x, y, z, num_cells = 1;
+
+  MEM_SAFE_FREE(grid->cell_offsets);
+  MEM_SAFE_FREE(grid->cell_tris);
+
+  sub_v3_v3v3(size, pccd_M->bbmax, pccd_M->bbmin);
+
+  /* Aim for about one face per cell. */
+  const float volume = max_ff(size[0], FLT_EPSILON) * max_ff(size[1], FLT_EPSILON) *
+                       max_ff(size[2], FLT_EPSILON);
+  float cell_size = cbrtf(volume / (float)pccd_M->tri_num);
+  cell_size = max_ff(cell_size, max_fff(size[0], size[1], size[2]) / (float)CCD_GRID_MAX_DIM);
+  cell_size = max_ff(cell_size, FLT_EPSILON);
+  grid->inv_cell_size = 1.0f / cell_size;
+
+  for (i = 0; i < 3; i++) {
+    grid->dims[i] = clamp_i((int)(size[i] * grid->inv_cell_size) + 1, 1, CCD_GRID_MAX_DIM);
+    num_cells *= grid->dims[i];
+  }
+
+  grid->cell_offsets = MEM_callocN(sizeof(int) * (num_cells + 1), "ccd_Mesh_grid_offsets");
+
+  for (i = 0; i < pccd_M->tri_num; i++) {
+    ccd_grid_cell_range(pccd_M, &pccd_M->mima[i], cell_min, cell_max);
+    for (z = cell_min[2]; z <= cell_max[2]; z++) {
+      for (y = cell_min[1]; y <= cell_max[1]; y++) {
+        for (x = cell_min[0]; x <= cell_max[0]; x++) {
+          grid->cell_offsets[ccd_grid_cell_index(pccd_M, x, y, z) + 1]++;
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < num_cells; i++) {
+    grid->cell_offsets[i + 1] += grid->cell_offsets[i];
+  }
+
+  grid->cell_tris = MEM_mallocN(sizeof(int) * max_ii(grid->cell_offsets[num_cells], 1),
+                                "ccd_Mesh_grid_tris");
+
+  /* Use the cell offsets as cursors, they are shifted back below. */
+  for (i = 0; i < pccd_M->tri_num; i++) {
+    ccd_grid_cell_range(pccd_M, &pccd_M->mima[i], cell_min, cell_max);
+    for (z = cell_min[2]; z <= cell_max[2]; z++) {
+      for (y = cell_min[1]; y <= cell_max[1]; y++) {
+        for (x = cell_min[0]; x <= cell_max[0]; x++) {
+          grid->cell_tris[grid->cell_offsets[ccd_grid_cell_index(pccd_M, x, y, z)]++] = i;
+        }
+      }
+    }
+  }
+
+  for (i = num_cells; i > 0; i--) {
+    grid->cell_offsets[i] = grid->cell_offsets[i - 1];
+  }
+  grid->cell_offsets[0] = 0;
+}
+
+/* Faces which may contain the point, the point must be inside the collider AABB. */
+static int ccd_mesh_grid_lookup(const ccd_Mesh *ccdm, const float co[3], const int **r_tris)
+{
+  const int cell = ccd_grid_cell_index(ccdm,
+                                       ccd_grid_cell_coord(ccdm, co[0], 0),
+                                       ccd_grid_cell_coord(ccdm, co[1], 1),
+                                       ccd_grid_cell_coord(ccdm, co[2], 2));
+
+  *r_tris = &ccdm->grid.cell_tris[ccdm->grid.cell_offsets[cell]];
+  return ccdm->grid.cell_offsets[cell + 1] - ccdm->grid.cell_offsets[cell];
+}
+
 static ccd_Mesh *ccd_mesh_make(Object *ob)
 {
   CollisionModifierData *cmd;
@@ -302,6 +416,8 @@ static ccd_Mesh *ccd_mesh_make(Object *ob)
   pccd_M->bbmin[0] = pccd_M->bbmin[1] = pccd_M->bbmin[2] = 1e30f;
   pccd_M->bbmax[0] = pccd_M->bbmax[1] = pccd_M->bbmax[2] = -1e30f;
   pccd_M->mprevvert = NULL;
+  pccd_M->grid.cell_offsets = NULL;
+  pccd_M->grid.cell_tris = NULL;
 
   /* blow it up with forcefield ranges */
   hull = max_ff(ob->pd->pdef_sbift, ob->pd->pdef_sboft);
@@ -361,6 +477,8 @@ static ccd_Mesh *ccd_mesh_make(Object *ob)
     mima->maxz = max_ff(mima->maxz, v[2] + hull);
   }
 
+  ccd_mesh_grid_build(pccd_M);
+
   return pccd_M;
 }
 static void ccd_mesh_update(Object *ob, ccd_Mesh *pccd_M)
@@ -481,7 +599,8 @@ static void ccd_mesh_update(Object *ob, ccd_Mesh *pccd_M)
     mima->maxy = max_ff(mima->maxy, v[1] + hull);
     mima->maxz = max_ff(mima->maxz, v[2] + hull);
   }
-  return;
+
+  ccd_mesh_grid_build(pccd_M);
 }
 
 static void ccd_mesh_free(ccd_Mesh *ccdm)
@@ -494,6 +613,8 @@ static void ccd_mesh_free(ccd_Mesh *ccdm)
       MEM_freeN((void *)ccdm->mprevvert);
     }
     MEM_freeN(ccdm->mima);
+    MEM_SAFE_FREE(ccdm->grid.cell_offsets);
+    MEM_SAFE_FREE(ccdm->grid.cell_tris);
     MEM_freeN(ccdm);
     ccdm = NULL;
   }
@@ -1511,76 +1632,41 @@ static void _scan_for_ext_spring_forces(
   }
 }
 
-static void *exec_scan_for_ext_spring_forces(void *data)
+static void sb_sfesf_task_cb(void *__restrict userdata,
+                             const int chunk,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  SB_thread_context *pctx = (SB_thread_context *)data;
-  _scan_for_ext_spring_forces(
-      pctx->scene, pctx->ob, pctx->timenow, pctx->ifirst, pctx->ilast, pctx->effectors);
-  return NULL;
+  SB_task_context *pctx = (SB_task_context *)userdata;
+  const int ifirst = chunk * SB_TASK_CHUNK_SIZE;
+  const int ilast = min_ii(ifirst + SB_TASK_CHUNK_SIZE, pctx->tot);
+
+  _scan_for_ext_spring_forces(pctx->scene, pctx->ob, pctx->timenow, ifirst, ilast, pctx->effectors);
 }
 
-static void sb_sfesf_threads_run(struct Depsgraph *depsgraph,
-                                 Scene *scene,
-                                 struct Object *ob,
-                                 float timenow,
-                                 int totsprings,
-                                 int *UNUSED(ptr_to_break_func(void)))
+static void sb_sfesf_tasks_run(struct Depsgraph *depsgraph,
+                               Scene *scene,
+                               struct Object *ob,
+                               float timenow,
+                               int totsprings)
 {
-  ListBase threads;
-  SB_thread_context *sb_threads;
-  int i, totthread, left, dec;
-
-  /* wild guess .. may increase with better thread management 'above'
-   * or even be UI option sb->spawn_cf_threads_nopts */
-  int lowsprings = 100;
-
   ListBase *effectors = BKE_effectors_create(depsgraph, ob, NULL, ob->soft->effector_weights);
 
-  /* figure the number of threads while preventing pretty pointless threading overhead */
-  totthread = BKE_scene_num_threads(scene);
-  /* what if we got zillions of CPUs running but less to spread*/
-  while ((totsprings / totthread < lowsprings) && (totthread > 1)) {
-    totthread--;
-  }
-
-  sb_threads = MEM_callocN(sizeof(SB_thread_context) * totthread, "SBSpringsThread");
-  memset(sb_threads, 0, sizeof(SB_thread_context) * totthread);
-  left = totsprings;
-  dec = totsprings / totthread + 1;
-  for (i = 0; i < totthread; i++) {
-    sb_threads[i].scene = scene;
-    sb_threads[i].ob = ob;
-    sb_threads[i].forcetime = 0.0;  // not used here
-    sb_threads[i].timenow = timenow;
-    sb_threads[i].ilast = left;
-    left = left - dec;
-    if (left > 0) {
-      sb_threads[i].ifirst = left;
-    }
-    else {
-      sb_threads[i].ifirst = 0;
-    }
-    sb_threads[i].effectors = effectors;
-    sb_threads[i].do_deflector = false;  // not used here
-    sb_threads[i].fieldfactor = 0.0f;    // not used here
-    sb_threads[i].windfactor = 0.0f;     // not used here
-    sb_threads[i].nr = i;
-    sb_threads[i].tot = totthread;
-  }
-  if (totthread > 1) {
-    BLI_threadpool_init(&threads, exec_scan_for_ext_spring_forces, totthread);
-
-    for (i = 0; i < totthread; i++) {
-      BLI_threadpool_insert(&threads, &sb_threads[i]);
-    }
-
-    BLI_threadpool_end(&threads);
-  }
-  else {
-    exec_scan_for_ext_spring_forces(&sb_threads[0]);
-  }
-  /* clean up */
-  MEM_freeN(sb_threads);
+  SB_task_context ctx = {
+      .scene = scene,
+      .ob = ob,
+      .timenow = timenow,
+      .effectors = effectors,
+      .tot = totsprings,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totsprings > SB_TASK_CHUNK_SIZE);
+  BLI_task_parallel_range(0,
+                          (totsprings + SB_TASK_CHUNK_SIZE - 1) / SB_TASK_CHUNK_SIZE,
+                          &ctx,
+                          sb_sfesf_task_cb,
+                          &settings);
 
   BKE_effectors_free(effectors);
 }
@@ -1652,15 +1738,11 @@ static int sb_detect_vertex_collisionCached(float opco[3],
       if (ob->pd && ob->pd->deflect) {
         const MVert *mvert = NULL;
         const MVert *mprevvert = NULL;
-        const MVertTri *vt = NULL;
-        const ccdf_minmax *mima = NULL;
+        const int *cell_tris = NULL;
 
         if (ccdm) {
           mvert = ccdm->mvert;
           mprevvert = ccdm->mprevvert;
-          vt = ccdm->tri;
-          mima = ccdm->mima;
-          a = ccdm->tri_num;
 
           minx = ccdm->bbmin[0];
           miny = ccdm->bbmin[1];
@@ -1676,6 +1758,9 @@ static int sb_detect_vertex_collisionCached(float opco[3],
             BLI_ghashIterator_step(ihash);
             continue;
           }
+
+          /* Only visit the faces near the point. */
+          a = ccd_mesh_grid_lookup(ccdm, opco, &cell_tris);
         }
         else {
           /*aye that should be cached*/
@@ -1694,10 +1779,12 @@ static int sb_detect_vertex_collisionCached(float opco[3],
         avel[0] = avel[1] = avel[2] = 0.0f;
         /* use mesh*/
         while (a--) {
+          const int tri_index = *(cell_tris++);
+          const ccdf_minmax *mima = &ccdm->mima[tri_index];
+          const MVertTri *vt = &ccdm->tri[tri_index];
+
           if ((opco[0] < mima->minx) || (opco[0] > mima->maxx) || (opco[1] < mima->miny) ||
               (opco[1] > mima->maxy) || (opco[2] < mima->minz) || (opco[2] > mima->maxz)) {
-            mima++;
-            vt++;
             continue;
           }
 
@@ -1768,9 +1855,6 @@ static int sb_detect_vertex_collisionCached(float opco[3],
               ci++;
             }
           }
-
-          mima++;
-          vt++;
         } /* while a */
       }   /* if (ob->pd && ob->pd->deflect) */
       BLI_ghashIterator_step(ihash);
@@ -2178,90 +2262,54 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
   return 0; /*done fine*/
 }
 
-static void *exec_softbody_calc_forces(void *data)
+static void sb_cf_task_cb(void *__restrict userdata,
+                          const int chunk,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  SB_thread_context *pctx = (SB_thread_context *)data;
+  SB_task_context *pctx = (SB_task_context *)userdata;
+  const int ifirst = chunk * SB_TASK_CHUNK_SIZE;
+  const int ilast = min_ii(ifirst + SB_TASK_CHUNK_SIZE, pctx->tot);
+
   _softbody_calc_forces_slice_in_a_thread(pctx->scene,
                                           pctx->ob,
                                           pctx->forcetime,
                                           pctx->timenow,
-                                          pctx->ifirst,
-                                          pctx->ilast,
+                                          ifirst,
+                                          ilast,
                                           NULL,
                                           pctx->effectors,
                                           pctx->do_deflector,
                                           pctx->fieldfactor,
                                           pctx->windfactor);
-  return NULL;
-}
-
-static void sb_cf_threads_run(Scene *scene,
-                              Object *ob,
-                              float forcetime,
-                              float timenow,
-                              int totpoint,
-                              int *UNUSED(ptr_to_break_func(void)),
-                              struct ListBase *effectors,
-                              int do_deflector,
-                              float fieldfactor,
-                              float windfactor)
-{
-  ListBase threads;
-  SB_thread_context *sb_threads;
-  int i, totthread, left, dec;
-
-  /* wild guess .. may increase with better thread management 'above'
-   * or even be UI option sb->spawn_cf_threads_nopts. */
-  int lowpoints = 100;
-
-  /* figure the number of threads while preventing pretty pointless threading overhead */
-  totthread = BKE_scene_num_threads(scene);
-  /* what if we got zillions of CPUs running but less to spread*/
-  while ((totpoint / totthread < lowpoints) && (totthread > 1)) {
-    totthread--;
-  }
-
-  /* printf("sb_cf_threads_run spawning %d threads\n", totthread); */
-
-  sb_threads = MEM_callocN(sizeof(SB_thread_context) * totthread, "SBThread");
-  memset(sb_threads, 0, sizeof(SB_thread_context) * totthread);
-  left = totpoint;
-  dec = totpoint / totthread + 1;
-  for (i = 0; i < totthread; i++) {
-    sb_threads[i].scene = scene;
-    sb_threads[i].ob = ob;
-    sb_threads[i].forcetime = forcetime;
-    sb_threads[i].timenow = timenow;
-    sb_threads[i].ilast = left;
-    left = left - dec;
-    if (left > 0) {
-      sb_threads[i].ifirst = left;
-    }
-    else {
-      sb_threads[i].ifirst = 0;
-    }
-    sb_threads[i].effectors = effectors;
-    sb_threads[i].do_deflector = do_deflector;
-    sb_threads[i].fieldfactor = fieldfactor;
-    sb_threads[i].windfactor = windfactor;
-    sb_threads[i].nr = i;
-    sb_threads[i].tot = totthread;
-  }
-
-  if (totthread > 1) {
-    BLI_threadpool_init(&threads, exec_softbody_calc_forces, totthread);
-
-    for (i = 0; i < totthread; i++) {
-      BLI_threadpool_insert(&threads, &sb_threads[i]);
-    }
+}
 
-    BLI_threadpool_end(&threads);
-  }
-  else {
-    exec_softbody_calc_forces(&sb_threads[0]);
-  }
-  /* clean up */
-  MEM_freeN(sb_threads);
+static void sb_cf_tasks_run(Scene *scene,
+                            Object *ob,
+                            float forcetime,
+                            float timenow,
+                            int totpoint,
+                            struct ListBase *effectors,
+                            int do_deflector,
+                            float fieldfactor,
+                            float windfactor)
+{
+  SB_task_context ctx = {
+      .scene = scene,
+      .ob = ob,
+      .forcetime = forcetime,
+      .timenow = timenow,
+      .effectors = effectors,
+      .do_deflector = do_deflector,
+      .fieldfactor = fieldfactor,
+      .windfactor = windfactor,
+      .tot = totpoint,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totpoint > SB_TASK_CHUNK_SIZE);
+  BLI_task_parallel_range(
+      0, (totpoint + SB_TASK_CHUNK_SIZE - 1) / SB_TASK_CHUNK_SIZE, &ctx, sb_cf_task_cb, &settings);
 }
 
 static void softbody_calc_forces(
@@ -2292,7 +2340,7 @@ static void softbody_calc_forces(
   /* bproot= sb->bpoint; */ /* need this for proper spring addressing */            /* UNUSED */
 
   if (do_springcollision || do_aero) {
-    sb_sfesf_threads_run(depsgraph, scene, ob, timenow, sb->totspring, NULL);
+    sb_sfesf_tasks_run(depsgraph, scene, ob, timenow, sb->totspring);
   }
 
   /* after spring scan because it uses Effoctors too */
@@ -2303,16 +2351,15 @@ static void softbody_calc_forces(
     do_deflector = sb_detect_aabb_collisionCached(defforce, ob, timenow);
   }
 
-  sb_cf_threads_run(scene,
-                    ob,
-                    forcetime,
-                    timenow,
-                    sb->totpoint,
-                    NULL,
-                    effectors,
-                    do_deflector,
-                    fieldfactor,
-                    windfactor);
+  sb_cf_tasks_run(scene,
+                  ob,
+                  forcetime,
+                  timenow,
+                  sb->totpoint,
+                  effectors,
+                  do_deflector,
+                  fieldfactor,
+                  windfactor);
 
   /* finally add forces caused by face collision */
   if (ob->softflag & OB_SB_FACECOLL) {
@@ -2323,160 +2370,217 @@ static void softbody_calc_forces(
   BKE_effectors_free(effectors);
 }
 
-static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
-{
-  /* time evolution */
-  /* actually does an explicit euler step mode == 0 */
-  /* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
-  SoftBody *sb = ob->soft; /* is supposed to be there */
-  BodyPoint *bp;
-  float dx[3] = {0}, dv[3], aabbmin[3], aabbmax[3], cm[3] = {0.0f, 0.0f, 0.0f};
-  float timeovermass /*, freezeloc=0.00001f, freezeforce=0.00000000001f*/;
-  float maxerrpos = 0.0f, maxerrvel = 0.0f;
-  int a, fuzzy = 0;
-
-  forcetime *= sb_time_scale(ob);
+/* Statistics gathered while stepping the points, reduced over all tasks. */
+typedef struct SBApplyForcesTLS {
+  float aabbmin[3], aabbmax[3];
+  float maxerrpos, maxerrvel;
+  bool fuzzy;
+} SBApplyForcesTLS;
 
-  aabbmin[0] = aabbmin[1] = aabbmin[2] = 1e20f;
-  aabbmax[0] = aabbmax[1] = aabbmax[2] = -1e20f;
+typedef struct SBApplyForcesData {
+  Object *ob;
+  float forcetime;
+  int mode;
+  int mid_flags;
+  SBApplyForcesTLS *stats;
+} SBApplyForcesData;
+
+static void softbody_apply_forces_cb(void *__restrict userdata,
+                                     const int index,
+                                     const TaskParallelTLS *__restrict tls)
+{
+  SBApplyForcesData *data = (SBApplyForcesData *)userdata;
+  SBApplyForcesTLS *stats = (SBApplyForcesTLS *)tls->userdata_chunk;
+  Object *ob = data->ob;
+  SoftBody *sb = ob->soft;
+  BodyPoint *bp = &sb->bpoint[index];
+  const float forcetime = data->forcetime;
+  const int mode = data->mode;
+  float dx[3] = {0}, dv[3];
+  float timeovermass /*, freezeloc=0.00001f, freezeforce=0.00000000001f*/;
 
-  /* old one with homogeneous masses  */
+  /* Now we have individual masses. */
   /* claim a minimum mass for vertex */
-#if 0
-  if (sb->nodemass > 0.009999f) {
-    timeovermass = forcetime / sb->nodemass;
+  if (_final_mass(ob, bp) > 0.009999f) {
+    timeovermass = forcetime / _final_mass(ob, bp);
   }
   else {
     timeovermass = forcetime / 0.009999f;
   }
-#endif
 
-  for (a = sb->totpoint, bp = sb->bpoint; a > 0; a--, bp++) {
-    /* Now we have individual masses. */
-    /* claim a minimum mass for vertex */
-    if (_final_mass(ob, bp) > 0.009999f) {
-      timeovermass = forcetime / _final_mass(ob, bp);
+  if (_final_goal(ob, bp) < SOFTGOALSNAP) {
+    /* this makes t~ = t */
+    if (data->mid_flags & MID_PRESERVE) {
+      copy_v3_v3(dx, bp->vec);
+    }
+
+    /**
+     * So here is:
+     * <pre>
+     * (v)' = a(cceleration) =
+     *     sum(F_springs)/m + gravitation + some friction forces + more forces.
+     * </pre>
+     *
+     * The ( ... )' operator denotes derivate respective time.
+     *
+     * The euler step for velocity then becomes:
+     * <pre>
+     * v(t + dt) = v(t) + a(t) * dt
+     * </pre>
+     */
+    mul_v3_fl(bp->force, timeovermass); /* individual mass of node here */
+    /* some nasty if's to have heun in here too */
+    copy_v3_v3(dv, bp->force);
+
+    if (mode == 1) {
+      copy_v3_v3(bp->prevvec, bp->vec);
+      copy_v3_v3(bp->prevdv, dv);
+    }
+
+    if (mode == 2) {
+      /* be optimistic and execute step */
+      bp->vec[0] = bp->prevvec[0] + 0.5f * (dv[0] + bp->prevdv[0]);
+      bp->vec[1] = bp->prevvec[1] + 0.5f * (dv[1] + bp->prevdv[1]);
+      bp->vec[2] = bp->prevvec[2] + 0.5f * (dv[2] + bp->prevdv[2]);
+      /* compare euler to heun to estimate error for step sizing */
+      stats->maxerrvel = max_ff(stats->maxerrvel, fabsf(dv[0] - bp->prevdv[0]));
+      stats->maxerrvel = max_ff(stats->maxerrvel, fabsf(dv[1] - bp->prevdv[1]));
+      stats->maxerrvel = max_ff(stats->maxerrvel, fabsf(dv[2] - bp->prevdv[2]));
     }
     else {
-      timeovermass = forcetime / 0.009999f;
+      add_v3_v3(bp->vec, bp->force);
     }
 
-    if (_final_goal(ob, bp) < SOFTGOALSNAP) {
-      /* this makes t~ = t */
-      if (mid_flags & MID_PRESERVE) {
-        copy_v3_v3(dx, bp->vec);
-      }
+    /* this makes t~ = t+dt */
+    if (!(data->mid_flags & MID_PRESERVE)) {
+      copy_v3_v3(dx, bp->vec);
+    }
 
-      /**
-       * So here is:
-       * <pre>
-       * (v)' = a(cceleration) =
-       *     sum(F_springs)/m + gravitation + some friction forces + more forces.
-       * </pre>
-       *
-       * The ( ... )' operator denotes derivate respective time.
-       *
-       * The euler step for velocity then becomes:
-       * <pre>
-       * v(t + dt) = v(t) + a(t) * dt
-       * </pre>
-       */
-      mul_v3_fl(bp->force, timeovermass); /* individual mass of node here */
-      /* some nasty if's to have heun in here too */
-      copy_v3_v3(dv, bp->force);
-
-      if (mode == 1) {
-        copy_v3_v3(bp->prevvec, bp->vec);
-        copy_v3_v3(bp->prevdv, dv);
-      }
+    /* so here is (x)'= v(elocity) */
+    /* the euler step for location then becomes */
+    /* x(t + dt) = x(t) + v(t~) * dt */
+    mul_v3_fl(dx, forcetime);
 
-      if (mode == 2) {
-        /* be optimistic and execute step */
-        bp->vec[0] = bp->prevvec[0] + 0.5f * (dv[0] + bp->prevdv[0]);
-        bp->vec[1] = bp->prevvec[1] + 0.5f * (dv[1] + bp->prevdv[1]);
-        bp->vec[2] = bp->prevvec[2] + 0.5f * (dv[2] + bp->prevdv[2]);
-        /* compare euler to heun to estimate error for step sizing */
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[0] - bp->prevdv[0]));
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[1] - bp->prevdv[1]));
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[2] - bp->prevdv[2]));
+    /* the freezer coming sooner or later */
+#if 0
+    if ((dot_v3v3(dx, dx) < freezeloc) && (dot_v3v3(bp->force, bp->force) < freezeforce)) {
+      bp->frozen /= 2;
+    }
+    else {
+      bp->frozen = min_ff(bp->frozen * 1.05f, 1.0f);
+    }
+    mul_v3_fl(dx, bp->frozen);
+#endif
+    /* again some nasty if's to have heun in here too */
+    if (mode == 1) {
+      copy_v3_v3(bp->prevpos, bp->pos);
+      copy_v3_v3(bp->prevdx, dx);
+    }
+
+    if (mode == 2) {
+      bp->pos[0] = bp->prevpos[0] + 0.5f * (dx[0] + bp->prevdx[0]);
+      bp->pos[1] = bp->prevpos[1] + 0.5f * (dx[1] + bp->prevdx[1]);
+      bp->pos[2] = bp->prevpos[2] + 0.5f * (dx[2] + bp->prevdx[2]);
+      stats->maxerrpos = max_ff(stats->maxerrpos, fabsf(dx[0] - bp->prevdx[0]));
+      stats->maxerrpos = max_ff(stats->maxerrpos, fabsf(dx[1] - bp->prevdx[1]));
+      stats->maxerrpos = max_ff(stats->maxerrpos, fabsf(dx[2] - bp->prevdx[2]));
+
+      /* bp->choke is set when we need to pull a vertex or edge out of the collider.
+       * the collider object signals to get out by pushing hard. on the other hand
+       * we don't want to end up in deep space so we add some <viscosity>
+       * to balance that out */
+      if (bp->choke2 > 0.0f) {
+        mul_v3_fl(bp->vec, (1.0f - bp->choke2));
       }
-      else {
-        add_v3_v3(bp->vec, bp->force);
+      if (bp->choke > 0.0f) {
+        mul_v3_fl(bp->vec, (1.0f - bp->choke));
       }
+    }
+    else {
+      add_v3_v3(bp->pos, dx);
+    }
+  } /*snap*/
+  /* so while we are looping BPs anyway do statistics on the fly */
+  minmax_v3v3_v3(stats->aabbmin, stats->aabbmax, bp->pos);
+  if (bp->loc_flag & SBF_DOFUZZY) {
+    stats->fuzzy = true;
+  }
+}
 
-      /* this makes t~ = t+dt */
-      if (!(mid_flags & MID_PRESERVE)) {
-        copy_v3_v3(dx, bp->vec);
-      }
+static void softbody_apply_forces_finalize(void *__restrict userdata,
+                                           void *__restrict userdata_chunk)
+{
+  SBApplyForcesData *data = (SBApplyForcesData *)userdata;
+  SBApplyForcesTLS *stats = data->stats;
+  const SBApplyForcesTLS *stats_chunk = (const SBApplyForcesTLS *)userdata_chunk;
 
-      /* so here is (x)'= v(elocity) */
-      /* the euler step for location then becomes */
-      /* x(t + dt) = x(t) + v(t~) * dt */
-      mul_v3_fl(dx, forcetime);
+  /* Chunks without points keep their initial (inverted) bounds, which leave these unchanged. */
+  min_v3_v3v3(stats->aabbmin, stats->aabbmin, stats_chunk->aabbmin);
+  max_v3_v3v3(stats->aabbmax, stats->aabbmax, stats_chunk->aabbmax);
+  stats->maxerrpos = max_ff(stats->maxerrpos, stats_chunk->maxerrpos);
+  stats->maxerrvel = max_ff(stats->maxerrvel, stats_chunk->maxerrvel);
+  stats->fuzzy |= stats_chunk->fuzzy;
+}
 
-      /* the freezer coming sooner or later */
+static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
+{
+  /* time evolution */
+  /* actually does an explicit euler step mode == 0 */
+  /* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
+  SoftBody *sb = ob->soft; /* is supposed to be there */
+
+  /* old one with homogeneous masses  */
+  /* claim a minimum mass for vertex */
 #if 0
-      if ((dot_v3v3(dx, dx) < freezeloc) && (dot_v3v3(bp->force, bp->force) < freezeforce)) {
-        bp->frozen /= 2;
-      }
-      else {
-        bp->frozen = min_ff(bp->frozen * 1.05f, 1.0f);
-      }
-      mul_v3_fl(dx, bp->frozen);
+  if (sb->nodemass > 0.009999f) {
+    timeovermass = forcetime / sb->nodemass;
+  }
+  else {
+    timeovermass = forcetime / 0.009999f;
+  }
 #endif
-      /* again some nasty if's to have heun in here too */
-      if (mode == 1) {
-        copy_v3_v3(bp->prevpos, bp->pos);
-        copy_v3_v3(bp->prevdx, dx);
-      }
 
-      if (mode == 2) {
-        bp->pos[0] = bp->prevpos[0] + 0.5f * (dx[0] + bp->prevdx[0]);
-        bp->pos[1] = bp->prevpos[1] + 0.5f * (dx[1] + bp->prevdx[1]);
-        bp->pos[2] = bp->prevpos[2] + 0.5f * (dx[2] + bp->prevdx[2]);
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[0] - bp->prevdx[0]));
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[1] - bp->prevdx[1]));
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[2] - bp->prevdx[2]));
-
-        /* bp->choke is set when we need to pull a vertex or edge out of the collider.
-         * the collider object signals to get out by pushing hard. on the other hand
-         * we don't want to end up in deep space so we add some <viscosity>
-         * to balance that out */
-        if (bp->choke2 > 0.0f) {
-          mul_v3_fl(bp->vec, (1.0f - bp->choke2));
-        }
-        if (bp->choke > 0.0f) {
-          mul_v3_fl(bp->vec, (1.0f - bp->choke));
-        }
-      }
-      else {
-        add_v3_v3(bp->pos, dx);
-      }
-    } /*snap*/
-    /* so while we are looping BPs anyway do statistics on the fly */
-    minmax_v3v3_v3(aabbmin, aabbmax, bp->pos);
-    if (bp->loc_flag & SBF_DOFUZZY) {
-      fuzzy = 1;
-    }
-  } /*for*/
+  SBApplyForcesTLS stats_chunk = {
+      .aabbmin = {1e20f, 1e20f, 1e20f},
+      .aabbmax = {-1e20f, -1e20f, -1e20f},
+      .maxerrpos = 0.0f,
+      .maxerrvel = 0.0f,
+      .fuzzy = false,
+  };
+  /* Chunks are merged into this, the same initial values keep the reduction neutral. */
+  SBApplyForcesTLS stats = stats_chunk;
+
+  SBApplyForcesData data = {
+      .ob = ob,
+      .forcetime = forcetime * sb_time_scale(ob),
+      .mode = mode,
+      .mid_flags = mid_flags,
+      .stats = &stats,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (sb->totpoint > 1024);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = &stats_chunk;
+  settings.userdata_chunk_size = sizeof(stats_chunk);
+  settings.func_finalize = softbody_apply_forces_finalize;
+  BLI_task_parallel_range(0, sb->totpoint, &data, softbody_apply_forces_cb, &settings);
 
-  if (sb->totpoint) {
-    mul_v3_fl(cm, 1.0f / sb->totpoint);
-  }
   if (sb->scratch) {
-    copy_v3_v3(sb->scratch->aabbmin, aabbmin);
-    copy_v3_v3(sb->scratch->aabbmax, aabbmax);
+    copy_v3_v3(sb->scratch->aabbmin, stats.aabbmin);
+    copy_v3_v3(sb->scratch->aabbmax, stats.aabbmax);
   }
 
   if (err) { /* so step size will be controlled by biggest difference in slope */
     if (sb->solverflags & SBSO_OLDERR) {
-      *err = max_ff(maxerrpos, maxerrvel);
+      *err = max_ff(stats.maxerrpos, stats.maxerrvel);
     }
     else {
-      *err = maxerrpos;
+      *err = stats.maxerrpos;
     }
     // printf("EP %f EV %f\n", maxerrpos, maxerrvel);
-    if (fuzzy) {
+    if (stats.fuzzy) {
       *err /= sb->fuzzyness;
     }
   }
@@ -244,6 +244,36 @@ void BKE_subdiv_eval_final_point(
   }
 }
 
+/* ============================ Batched queries ============================= */
+
+void BKE_subdiv_eval_limit_points_and_derivatives(Subdiv *subdiv,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3])
+{
+  subdiv->evaluator->evaluatePatchesLimit(subdiv->evaluator,
+                                          patch_coords,
+                                          num_patch_coords,
+                                          (float *)r_P,
+                                          (float *)r_dPdu,
+                                          (float *)r_dPdv);
+}
+
+void BKE_subdiv_eval_face_varying_points(Subdiv *subdiv,
+                                         const int face_varying_channel,
+                                         const OpenSubdiv_PatchCoord *patch_coords,
+                                         const int num_patch_coords,
+                                         float (*r_face_varying)[2])
+{
+  subdiv->evaluator->evaluatePatchesFaceVarying(subdiv->evaluator,
+                                                face_varying_channel,
+                                                patch_coords,
+                                                num_patch_coords,
+                                                (float *)r_face_varying);
+}
+
 /* ===================  Patch queries at given resolution =================== */
 
 /* Move buffer forward by a given number of bytes. */
@@ -31,6 +31,7 @@
 
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -41,6 +42,11 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
+
+/* Number of points passed to the evaluator at once by the batched evaluation. */
+#define SUBDIV_MESH_EVAL_BATCH_SIZE 256
+
 /* =============================================================================
  * Subdivision context.
  */
@@ -76,6 +82,14 @@ typedef struct SubdivMeshContext {
    * when it's not possible is when displacement is used. */
   bool can_evaluate_normals;
   bool have_displacement;
+  /* Limit surface coordinates of vertices and loops which evaluation is postponed until the
+   * traversal is done, so that they are evaluated in batches. Indexed by subdivided element
+   * index, ptex_face of -1 means the element is evaluated during the traversal.
+   *
+   * Positions and normals of inner vertices are postponed when there is no displacement,
+   * UVs of all loops are postponed. */
+  OpenSubdiv_PatchCoord *vertex_patch_coords;
+  OpenSubdiv_PatchCoord *loop_patch_coords;
 } SubdivMeshContext;
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -113,10 +127,36 @@ static void subdiv_mesh_prepare_accumulator(SubdivMeshContext *ctx, int num_vert
       sizeof(*ctx->accumulated_counters), num_vertices, "subdiv accumulated counters");
 }
 
+static OpenSubdiv_PatchCoord *subdiv_mesh_patch_coords_alloc(const int num_elements,
+                                                             const char *name)
+{
+  OpenSubdiv_PatchCoord *patch_coords = MEM_malloc_arrayN(
+      num_elements, sizeof(*patch_coords), name);
+  for (int i = 0; i < num_elements; i++) {
+    patch_coords[i].ptex_face = -1;
+  }
+  return patch_coords;
+}
+
+static void subdiv_mesh_prepare_batch_eval(SubdivMeshContext *ctx,
+                                           const int num_vertices,
+                                           const int num_loops)
+{
+  if (!ctx->have_displacement) {
+    ctx->vertex_patch_coords = subdiv_mesh_patch_coords_alloc(num_vertices,
+                                                              "subdiv vertex patch coords");
+  }
+  if (ctx->num_uv_layers != 0) {
+    ctx->loop_patch_coords = subdiv_mesh_patch_coords_alloc(num_loops, "subdiv loop patch coords");
+  }
+}
+
 static void subdiv_mesh_context_free(SubdivMeshContext *ctx)
 {
   MEM_SAFE_FREE(ctx->accumulated_normals);
   MEM_SAFE_FREE(ctx->accumulated_counters);
+  MEM_SAFE_FREE(ctx->vertex_patch_coords);
+  MEM_SAFE_FREE(ctx->loop_patch_coords);
 }
 
 /* =============================================================================
@@ -510,6 +550,7 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
       subdiv_context->coarse_mesh, num_vertices, num_edges, 0, num_loops, num_polygons, mask);
   subdiv_mesh_ctx_cache_custom_data_layers(subdiv_context);
   subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  subdiv_mesh_prepare_batch_eval(subdiv_context, num_vertices, num_loops);
   return true;
 }
 
@@ -773,8 +814,16 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
-  eval_final_point_and_vertex_normal(
-      subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+  if (ctx->vertex_patch_coords != NULL) {
+    OpenSubdiv_PatchCoord *patch_coord = &ctx->vertex_patch_coords[subdiv_vertex_index];
+    patch_coord->ptex_face = ptex_face_index;
+    patch_coord->u = u;
+    patch_coord->v = v;
+  }
+  else {
+    eval_final_point_and_vertex_normal(
+        subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+  }
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
 }
 
@@ -858,12 +907,12 @@ static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
   if (ctx->num_uv_layers == 0) {
     return;
   }
-  Subdiv *subdiv = ctx->subdiv;
+  /* Actual evaluation happens in subdiv_mesh_eval_loops_batched(). */
   const int mloop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
-  for (int layer_index = 0; layer_index < ctx->num_uv_layers; layer_index++) {
-    MLoopUV *subdiv_loopuv = &ctx->uv_layers[layer_index][mloop_index];
-    BKE_subdiv_eval_face_varying(subdiv, layer_index, ptex_face_index, u, v, subdiv_loopuv->uv);
-  }
+  OpenSubdiv_PatchCoord *patch_coord = &ctx->loop_patch_coords[mloop_index];
+  patch_coord->ptex_face = ptex_face_index;
+  patch_coord->u = u;
+  patch_coord->v = v;
 }
 
 static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
@@ -1124,6 +1173,111 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
   normal_float_to_short_v3(subdiv_vertex->no, subdiv_vertex->co);
 }
 
+/* =============================================================================
+ * Batched evaluation.
+ *
+ * Elements are split into chunks of SUBDIV_MESH_EVAL_BATCH_SIZE, every chunk is evaluated with a
+ * single call to the evaluator. Chunks are handled from multiple threads.
+ */
+
+/* Gather postponed coordinates of the given range of elements.
+ * Returns number of gathered coordinates. */
+static int subdiv_mesh_batch_gather(const OpenSubdiv_PatchCoord *all_patch_coords,
+                                    const int chunk_index,
+                                    const int num_elements,
+                                    OpenSubdiv_PatchCoord *r_patch_coords,
+                                    int *r_indices)
+{
+  const int start = chunk_index * SUBDIV_MESH_EVAL_BATCH_SIZE;
+  const int end = min_ii(start + SUBDIV_MESH_EVAL_BATCH_SIZE, num_elements);
+  int num_patch_coords = 0;
+  for (int i = start; i < end; i++) {
+    if (all_patch_coords[i].ptex_face == -1) {
+      continue;
+    }
+    r_patch_coords[num_patch_coords] = all_patch_coords[i];
+    r_indices[num_patch_coords] = i;
+    num_patch_coords++;
+  }
+  return num_patch_coords;
+}
+
+static void subdiv_mesh_eval_vertices_batch_cb(void *__restrict userdata,
+                                               const int chunk_index,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SubdivMeshContext *ctx = userdata;
+  Mesh *subdiv_mesh = ctx->subdiv_mesh;
+  OpenSubdiv_PatchCoord patch_coords[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  int vertex_indices[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  const int num_patch_coords = subdiv_mesh_batch_gather(ctx->vertex_patch_coords,
+                                                        chunk_index,
+                                                        subdiv_mesh->totvert,
+                                                        patch_coords,
+                                                        vertex_indices);
+  if (num_patch_coords == 0) {
+    return;
+  }
+  float P[SUBDIV_MESH_EVAL_BATCH_SIZE][3];
+  float dPdu[SUBDIV_MESH_EVAL_BATCH_SIZE][3], dPdv[SUBDIV_MESH_EVAL_BATCH_SIZE][3];
+  BKE_subdiv_eval_limit_points_and_derivatives(
+      ctx->subdiv, patch_coords, num_patch_coords, P, dPdu, dPdv);
+  for (int i = 0; i < num_patch_coords; i++) {
+    MVert *subdiv_vert = &subdiv_mesh->mvert[vertex_indices[i]];
+    float N[3];
+    cross_v3_v3v3(N, dPdu[i], dPdv[i]);
+    normalize_v3(N);
+    copy_v3_v3(subdiv_vert->co, P[i]);
+    normal_float_to_short_v3(subdiv_vert->no, N);
+  }
+}
+
+static void subdiv_mesh_eval_loops_batch_cb(void *__restrict userdata,
+                                            const int chunk_index,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SubdivMeshContext *ctx = userdata;
+  OpenSubdiv_PatchCoord patch_coords[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  int loop_indices[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  const int num_patch_coords = subdiv_mesh_batch_gather(ctx->loop_patch_coords,
+                                                        chunk_index,
+                                                        ctx->subdiv_mesh->totloop,
+                                                        patch_coords,
+                                                        loop_indices);
+  if (num_patch_coords == 0) {
+    return;
+  }
+  float uv[SUBDIV_MESH_EVAL_BATCH_SIZE][2];
+  for (int layer_index = 0; layer_index < ctx->num_uv_layers; layer_index++) {
+    BKE_subdiv_eval_face_varying_points(
+        ctx->subdiv, layer_index, patch_coords, num_patch_coords, uv);
+    MLoopUV *subdiv_mloopuv = ctx->uv_layers[layer_index];
+    for (int i = 0; i < num_patch_coords; i++) {
+      copy_v2_v2(subdiv_mloopuv[loop_indices[i]].uv, uv[i]);
+    }
+  }
+}
+
+static void subdiv_mesh_eval_batched(SubdivMeshContext *ctx)
+{
+  const Mesh *subdiv_mesh = ctx->subdiv_mesh;
+  TaskParallelSettings parallel_range_settings;
+  BLI_parallel_range_settings_defaults(&parallel_range_settings);
+  parallel_range_settings.min_iter_per_thread = 1;
+  if (ctx->vertex_patch_coords != NULL) {
+    const int num_chunks = (subdiv_mesh->totvert + SUBDIV_MESH_EVAL_BATCH_SIZE - 1) /
+                           SUBDIV_MESH_EVAL_BATCH_SIZE;
+    BLI_task_parallel_range(
+        0, num_chunks, ctx, subdiv_mesh_eval_vertices_batch_cb, &parallel_range_settings);
+  }
+  if (ctx->loop_patch_coords != NULL) {
+    const int num_chunks = (subdiv_mesh->totloop + SUBDIV_MESH_EVAL_BATCH_SIZE - 1) /
+                           SUBDIV_MESH_EVAL_BATCH_SIZE;
+    BLI_task_parallel_range(
+        0, num_chunks, ctx, subdiv_mesh_eval_loops_batch_cb, &parallel_range_settings);
+  }
+}
+
 /* =============================================================================
  * Initialization.
  */
@@ -1192,6 +1346,7 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
   BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, settings, coarse_mesh);
+  subdiv_mesh_eval_batched(&subdiv_context);
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   Mesh *result = subdiv_context.subdiv_mesh;
   // BKE_mesh_validate(result, true, true);
@@ -185,6 +185,9 @@ MINLINE void abs_v3_v3(float r[3], const float a[3]);
 MINLINE void abs_v4(float r[4]);
 MINLINE void abs_v4_v4(float r[4], const float a[4]);
 
+MINLINE void min_v3_v3v3(float r[3], const float a[3], const float b[3]);
+MINLINE void max_v3_v3v3(float r[3], const float a[3], const float b[3]);
+
 MINLINE float dot_v2v2(const float a[2], const float b[2]) ATTR_WARN_UNUSED_RESULT;
 MINLINE double dot_v2v2_db(const double a[2], const double b[2]) ATTR_WARN_UNUSED_RESULT;
 MINLINE float dot_v3v3(const float a[3], const float b[3]) ATTR_WARN_UNUSED_RESULT;
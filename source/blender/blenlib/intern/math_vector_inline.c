@@ -843,6 +843,20 @@ MINLINE void abs_v4_v4(float r[4], const float a[4])
   r[3] = fabsf(a[3]);
 }
 
+MINLINE void min_v3_v3v3(float r[3], const float a[3], const float b[3])
+{
+  r[0] = min_ff(a[0], b[0]);
+  r[1] = min_ff(a[1], b[1]);
+  r[2] = min_ff(a[2], b[2]);
+}
+
+MINLINE void max_v3_v3v3(float r[3], const float a[3], const float b[3])
+{
+  r[0] = max_ff(a[0], b[0]);
+  r[1] = max_ff(a[1], b[1]);
+  r[2] = max_ff(a[2], b[2]);
+}
+
 MINLINE float dot_v2v2(const float a[2], const float b[2])
 {
   return a[0] * b[0] + a[1] * b[1];
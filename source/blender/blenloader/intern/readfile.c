@@ -4828,6 +4828,7 @@ static void direct_link_customdata(FileData *fd, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->shared = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       layer->data = newdataadr(fd, layer->data);
@@ -6841,6 +6842,7 @@ static void direct_link_scene(FileData *fd, Scene *sce)
        * (and will need to be recalculated)
        */
       rbw->shared->physics_world = NULL;
+      rbw->shared->transform_cache = NULL;
 
       /* link caches */
       direct_link_pointcache_list(fd, &rbw->shared->ptcaches, &rbw->shared->pointcache, false);
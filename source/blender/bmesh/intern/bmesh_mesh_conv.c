@@ -81,6 +81,7 @@
 #include "BLI_listbase.h"
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
@@ -174,6 +175,130 @@ static BMFace *bm_face_create_from_mpoly(
   return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh -> BMesh Threaded Element Data
+ *
+ * Elements are created in a single thread (memory pools and connectivity aren't thread-safe),
+ * along with their custom-data blocks. Everything else only touches the element its self,
+ * so it's filled in afterwards from multiple threads.
+ * \{ */
+
+typedef struct BMFromMeData {
+  BMesh *bm;
+  const Mesh *me;
+  BMVert **vtable;
+  BMEdge **etable;
+  BMFace **ftable;
+
+  const float (**shape_key_table)[3];
+  int tot_shape_keys;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  int cd_shape_key_offset;
+  int cd_shape_keyindex_offset;
+
+  bool calc_face_normal;
+} BMFromMeData;
+
+static void bm_from_me_verts_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MVert *mvert = &me->mvert[i];
+  BMVert *v = data->vtable[i];
+
+  /* Transfer flag, selection is set afterwards so selection counts are correct. */
+  v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
+
+  normal_short_to_float_v3(v->no, mvert->no);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+  }
+
+  /* Set shape key original index. */
+  if (data->cd_shape_keyindex_offset != -1) {
+    BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+  }
+
+  /* Set shape-key data. */
+  if (data->tot_shape_keys) {
+    float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_key_offset);
+    for (int j = 0; j < data->tot_shape_keys; j++, co_dst++) {
+      copy_v3_v3(*co_dst, data->shape_key_table[j][i]);
+    }
+  }
+}
+
+static void bm_from_me_edges_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MEdge *medge = &me->medge[i];
+  BMEdge *e = data->etable[i];
+
+  /* Transfer flags, selection is set afterwards so selection counts are correct. */
+  e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+
+  if (data->cd_edge_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+  }
+  if (data->cd_edge_crease_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+  }
+}
+
+static void bm_from_me_faces_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MPoly *mp = &me->mpoly[i];
+  BMFace *f = data->ftable[i];
+
+  if (UNLIKELY(f == NULL)) {
+    /* Skipped bad face. */
+    return;
+  }
+
+  /* Transfer flag, selection is set afterwards so selection counts are correct. */
+  f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
+
+  f->mat_nr = mp->mat_nr;
+
+  int j = mp->loopstart;
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+
+  if (data->calc_face_normal) {
+    BM_face_normal_update(f);
+  }
+}
+
+/** \} */
+
 /**
  * \brief Mesh -> BMesh
  * \param bm: The mesh to write into, while this is typically a newly created BMesh,
@@ -295,99 +420,82 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
     BM_mesh_cd_flag_apply(bm, me->cd_flag);
   }
 
-  const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-  const int cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-  const int cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE);
-  const int cd_shape_key_offset = me->key ? CustomData_get_offset(&bm->vdata, CD_SHAPEKEY) : -1;
-  const int cd_shape_keyindex_offset = is_new && (tot_shape_keys || params->add_key_index) ?
-                                           CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX) :
-                                           -1;
+  BMFromMeData data = {
+      .bm = bm,
+      .me = me,
+      .shape_key_table = shape_key_table,
+      .tot_shape_keys = tot_shape_keys,
+      .cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT),
+      .cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT),
+      .cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE),
+      .cd_shape_key_offset = me->key ? CustomData_get_offset(&bm->vdata, CD_SHAPEKEY) : -1,
+      .cd_shape_keyindex_offset = is_new && (tot_shape_keys || params->add_key_index) ?
+                                      CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX) :
+                                      -1,
+      .calc_face_normal = params->calc_face_normal,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
 
   vtable = MEM_mallocN(sizeof(BMVert **) * me->totvert, __func__);
+  data.vtable = vtable;
 
   for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
     v = vtable[i] = BM_vert_create(bm, keyco ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
     BM_elem_index_set(v, i); /* set_ok */
+    CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
+  }
+  if (is_new) {
+    bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
+  }
 
-    /* Transfer flag. */
-    v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
+  settings.use_threading = (me->totvert >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, me->totvert, &data, bm_from_me_verts_cb, &settings);
 
-    /* This is necessary for selection counts to work properly. */
+  /* This is necessary for selection counts to work properly. */
+  for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
     if (mvert->flag & SELECT) {
-      BM_vert_select_set(bm, v, true);
-    }
-
-    normal_short_to_float_v3(v->no, mvert->no);
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-    }
-
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
-
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
-      }
+      BM_vert_select_set(bm, vtable[i], true);
     }
   }
-  if (is_new) {
-    bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
-  }
 
   etable = MEM_mallocN(sizeof(BMEdge **) * me->totedge, __func__);
+  data.etable = etable;
 
   medge = me->medge;
   for (i = 0; i < me->totedge; i++, medge++) {
     e = etable[i] = BM_edge_create(
         bm, vtable[medge->v1], vtable[medge->v2], NULL, BM_CREATE_SKIP_CD);
     BM_elem_index_set(e, i); /* set_ok */
-
-    /* Transfer flags. */
-    e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
-
-    /* This is necessary for selection counts to work properly. */
-    if (medge->flag & SELECT) {
-      BM_edge_select_set(bm, e, true);
-    }
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-    }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
-    }
+    CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
   }
 
-  /* Only needed for selection. */
-  if (me->mselect && me->totselect != 0) {
-    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+  settings.use_threading = (me->totedge >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, me->totedge, &data, bm_from_me_edges_cb, &settings);
+
+  /* This is necessary for selection counts to work properly. */
+  medge = me->medge;
+  for (i = 0; i < me->totedge; i++, medge++) {
+    if (medge->flag & SELECT) {
+      BM_edge_select_set(bm, etable[i], true);
+    }
   }
 
+  /* Also used for selection. */
+  ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+  data.ftable = ftable;
+
   mloop = me->mloop;
   mp = me->mpoly;
   for (i = 0, totloops = 0; i < me->totpoly; i++, mp++) {
     BMLoop *l_iter;
     BMLoop *l_first;
 
-    f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
-    if (ftable != NULL) {
-      ftable[i] = f;
-    }
+    f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
 
     if (UNLIKELY(f == NULL)) {
       printf(
@@ -401,39 +509,37 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
     /* Don't use 'i' since we may have skipped the face. */
     BM_elem_index_set(f, bm->totface - 1); /* set_ok */
+    CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
 
-    /* Transfer flag. */
-    f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+    do {
+      /* Don't use 'j' since we may have skipped some faces, hence some loops. */
+      BM_elem_index_set(l_iter, totloops++); /* set_ok */
+      CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
+    } while ((l_iter = l_iter->next) != l_first);
+  }
+  if (is_new) {
+    bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
+  }
+
+  settings.use_threading = (me->totpoly >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, me->totpoly, &data, bm_from_me_faces_cb, &settings);
+
+  mp = me->mpoly;
+  for (i = 0; i < me->totpoly; i++, mp++) {
+    f = ftable[i];
+    if (UNLIKELY(f == NULL)) {
+      continue;
+    }
 
     /* This is necessary for selection counts to work properly. */
     if (mp->flag & ME_FACE_SEL) {
       BM_face_select_set(bm, f, true);
     }
 
-    f->mat_nr = mp->mat_nr;
     if (i == me->act_face) {
       bm->act_face = f;
     }
-
-    int j = mp->loopstart;
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      /* Don't use 'j' since we may have skipped some faces, hence some loops. */
-      BM_elem_index_set(l_iter, totloops++); /* set_ok */
-
-      /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
-    } while ((l_iter = l_iter->next) != l_first);
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
-
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
-    }
-  }
-  if (is_new) {
-    bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
   }
 
   /* -------------------------------------------------------------------- */
@@ -472,9 +578,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
   MEM_freeN(vtable);
   MEM_freeN(etable);
-  if (ftable) {
-    MEM_freeN(ftable);
-  }
+  MEM_freeN(ftable);
 }
 
 /**
@@ -555,15 +659,118 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BMesh -> Mesh Threaded Element Data
+ *
+ * Element indices are ensured beforehand, each element only writes to its own index.
+ * \{ */
+
+typedef struct BMToMeData {
+  BMesh *bm;
+  Mesh *me;
+  MVert *mvert;
+  MEdge *medge;
+  MLoop *mloop;
+  MPoly *mpoly;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+} BMToMeData;
+
+static void bm_to_me_verts_cb(void *userdata, MempoolIterData *mp_v)
+{
+  const BMToMeData *data = userdata;
+  BMVert *v = (BMVert *)mp_v;
+  const int i = BM_elem_index_get(v);
+  MVert *mvert = &data->mvert[i];
+
+  copy_v3_v3(mvert->co, v->co);
+  normal_float_to_short_v3(mvert->no, v->no);
+
+  mvert->flag = BM_vert_flag_to_mflag(v);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&data->bm->vdata, &data->me->vdata, v->head.data, i);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(v);
+}
+
+static void bm_to_me_edges_cb(void *userdata, MempoolIterData *mp_e)
+{
+  const BMToMeData *data = userdata;
+  BMEdge *e = (BMEdge *)mp_e;
+  const int i = BM_elem_index_get(e);
+  MEdge *med = &data->medge[i];
+
+  med->v1 = BM_elem_index_get(e->v1);
+  med->v2 = BM_elem_index_get(e->v2);
+
+  med->flag = BM_edge_flag_to_mflag(e);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&data->bm->edata, &data->me->edata, e->head.data, i);
+
+  bmesh_quick_edgedraw_flag(med, e);
+
+  if (data->cd_edge_crease_offset != -1) {
+    med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+  }
+  if (data->cd_edge_bweight_offset != -1) {
+    med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(e);
+}
+
+static void bm_to_me_faces_cb(void *userdata, MempoolIterData *mp_f)
+{
+  const BMToMeData *data = userdata;
+  BMFace *f = (BMFace *)mp_f;
+  const int i = BM_elem_index_get(f);
+  MPoly *mpoly = &data->mpoly[i];
+
+  /* The loop-start is set beforehand. */
+  int j = mpoly->loopstart;
+  mpoly->totloop = f->len;
+  mpoly->mat_nr = f->mat_nr;
+  mpoly->flag = BM_face_flag_to_mflag(f);
+
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    MLoop *mloop = &data->mloop[j];
+    mloop->e = BM_elem_index_get(l_iter->e);
+    mloop->v = BM_elem_index_get(l_iter->v);
+
+    /* Copy over custom-data. */
+    CustomData_from_bmesh_block(&data->bm->ldata, &data->me->ldata, l_iter->head.data, j);
+
+    j++;
+    BM_CHECK_ELEMENT(l_iter);
+    BM_CHECK_ELEMENT(l_iter->e);
+    BM_CHECK_ELEMENT(l_iter->v);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&data->bm->pdata, &data->me->pdata, f->head.data, i);
+
+  BM_CHECK_ELEMENT(f);
+}
+
+/** \} */
+
 /**
  *
  * \param bmain: May be NULL in case \a calc_object_remap parameter option is not set.
  */
 void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
+  BMVert *eve;
   BMFace *f;
   BMIter iter;
   int i, j;
@@ -631,93 +838,37 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, 0);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
-    normal_float_to_short_v3(mvert->no, v->no);
-
-    mvert->flag = BM_vert_flag_to_mflag(v);
-
-    BM_elem_index_set(v, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
-
-    i++;
-    mvert++;
-
-    BM_CHECK_ELEMENT(v);
-  }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
-
-    med->flag = BM_edge_flag_to_mflag(e);
-
-    BM_elem_index_set(e, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-    bmesh_quick_edgedraw_flag(med, e);
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-    }
-
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
+  /* Loops are stored in face order, find where each face starts. */
   i = 0;
   j = 0;
   BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
-
-      /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
+    mpoly[i].loopstart = j;
+    j += f->len;
 
     if (f == bm->act_face) {
       me->act_face = i;
     }
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
     i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
   }
 
+  BMToMeData data = {
+      .bm = bm,
+      .me = me,
+      .mvert = mvert,
+      .medge = medge,
+      .mloop = mloop,
+      .mpoly = mpoly,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+  };
+
+  BM_iter_parallel(bm, BM_VERTS_OF_MESH, bm_to_me_verts_cb, &data, bm->totvert >= BM_OMP_LIMIT);
+  BM_iter_parallel(bm, BM_EDGES_OF_MESH, bm_to_me_edges_cb, &data, bm->totedge >= BM_OMP_LIMIT);
+  BM_iter_parallel(bm, BM_FACES_OF_MESH, bm_to_me_faces_cb, &data, bm->totface >= BM_OMP_LIMIT);
+
   /* Patch hook indices and vertex parents. */
   if (params->calc_object_remap && (ototvert > 0)) {
     BLI_assert(bmain != NULL);
@@ -28,8 +28,10 @@
 
 #include "BLI_array.h"
 #include "BLI_alloca.h"
+#include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
@@ -58,6 +60,8 @@
 #define BEVEL_MAX_ADJUST_PCT 10.0f
 #define BEVEL_MAX_AUTO_ADJUST_PCT 300.0f
 #define BEVEL_MATCH_SPEC_WEIGHT 0.2
+/* Minimum number of beveled vertices to build their boundaries and vertex meshes in parallel. */
+#define BEVEL_PARALLEL_MIN_ITER 64
 
 //#define DEBUG_CUSTOM_PROFILE_CUTOFF
 /* Happens far too often, uncomment for development. */
@@ -253,13 +257,17 @@ typedef struct BevVert {
   bool any_seam;
   /** Used in graph traversal for adjusting offsets. */
   bool visited;
+  /** The #vmesh_adj is a cube corner for #PRO_SQUARE_IN_R, see #build_square_in_vmesh. */
+  bool vmesh_adj_square_in;
   /** Array of size edgecount; CCW order from vertex normal side. */
-  char _pad[6];
+  char _pad[5];
   EdgeHalf *edges;
   /** Array of size wirecount of wire edges. */
   BMEdge **wire_edges;
   /** Mesh structure for replacing vertex. */
   VMesh *vmesh;
+  /** Positions of the "Adjacent edges" pattern, calculated before creating BMesh elements. */
+  VMesh *vmesh_adj;
 } BevVert;
 
 /* Face classification. Note: depends on F_RECON > F_EDGE > F_VERT .*/
@@ -294,6 +302,8 @@ typedef struct BevelParams {
   GHash *face_hash;
   /** Use for all allocs while bevel runs. Note: If we need to free we can switch to mempool. */
   MemArena *mem_arena;
+  /** The arenas used by threads instead of #mem_arena, see #bevel_verts_parallel. */
+  LinkNode *mem_arenas_thread;
   /** Profile vertex location and spacings. */
   ProfileSpacing pro_spacing;
   /** Parameter values for evenly spaced profile points for the miter profiles. */
@@ -1701,6 +1711,24 @@ static void get_profile_point(BevelParams *bp, const Profile *pro, int i, int ns
   }
 }
 
+/**
+ * Allocate the space for the coordinate values of profile \a pro.
+ * Code running in parallel allocates the profiles from its own memory arena first,
+ * so #calculate_profile doesn't allocate from the shared one.
+ */
+static void profile_alloc(BevelParams *bp, MemArena *mem_arena, Profile *pro)
+{
+  pro->prof_co = (float *)BLI_memarena_alloc(mem_arena,
+                                             ((size_t)bp->seg + 1) * 3 * sizeof(float));
+  if (bp->seg != bp->pro_spacing.seg_2) {
+    pro->prof_co_2 = (float *)BLI_memarena_alloc(
+        mem_arena, ((size_t)bp->pro_spacing.seg_2 + 1) * 3 * sizeof(float));
+  }
+  else {
+    pro->prof_co_2 = pro->prof_co;
+  }
+}
+
 /**
  * Calculate the actual coordinate values for bndv's profile.
  * This is only needed if bp->seg > 1.
@@ -1726,15 +1754,7 @@ static void calculate_profile(BevelParams *bp, BoundVert *bndv, bool reversed, b
 
   need_2 = bp->seg != bp->pro_spacing.seg_2;
   if (!pro->prof_co) {
-    pro->prof_co = (float *)BLI_memarena_alloc(bp->mem_arena,
-                                               ((size_t)bp->seg + 1) * 3 * sizeof(float));
-    if (need_2) {
-      pro->prof_co_2 = (float *)BLI_memarena_alloc(
-          bp->mem_arena, ((size_t)bp->pro_spacing.seg_2 + 1) * 3 * sizeof(float));
-    }
-    else {
-      pro->prof_co_2 = pro->prof_co;
-    }
+    profile_alloc(bp, bp->mem_arena, pro);
   }
   r = pro->super_r;
   if (!bp->use_custom_profile && r == PRO_LINE_R) {
@@ -2344,7 +2364,10 @@ static void calculate_vm_profiles(BevelParams *bp, BevVert *bv, VMesh *vm)
 }
 
 /* Implements build_boundary for the vertex-only case. */
-static void build_boundary_vertex_only(BevelParams *bp, BevVert *bv, bool construct)
+static void build_boundary_vertex_only(BevelParams *bp,
+                                       MemArena *mem_arena,
+                                       BevVert *bv,
+                                       bool construct)
 {
   VMesh *vm = bv->vmesh;
   EdgeHalf *efirst, *e;
@@ -2357,7 +2380,7 @@ static void build_boundary_vertex_only(BevelParams *bp, BevVert *bv, bool constr
   do {
     slide_dist(e, bv->v, e->offset_l, co);
     if (construct) {
-      v = add_new_bound_vert(bp->mem_arena, vm, co);
+      v = add_new_bound_vert(mem_arena, vm, co);
       v->efirst = v->elast = e;
       e->leftv = e->rightv = v;
     }
@@ -2386,11 +2409,11 @@ static void build_boundary_vertex_only(BevelParams *bp, BevVert *bv, bool constr
  * and \a efirst is the first beveled edge at vertex \a bv.
  */
 static void build_boundary_terminal_edge(BevelParams *bp,
+                                         MemArena *mem_arena,
                                          BevVert *bv,
                                          EdgeHalf *efirst,
                                          const bool construct)
 {
-  MemArena *mem_arena = bp->mem_arena;
   VMesh *vm = bv->vmesh;
   BoundVert *bndv;
   EdgeHalf *e;
@@ -2608,10 +2631,11 @@ static void adjust_miter_inner_coords(BevelParams *bp, BevVert *bv, EdgeHalf *em
  * \param construct The first time through, construct will be true and we are making the BoundVerts
  * and setting up the BoundVert and EdgeHalf pointers appropriately. Also, if construct, decide on
  * the mesh pattern that will be used inside the boundary.
+ * \param mem_arena: Where the BoundVerts are allocated. Nothing but bv is modified otherwise,
+ * so with a memory arena per thread the boundaries of all BevVerts can be built in parallel.
  */
-static void build_boundary(BevelParams *bp, BevVert *bv, bool construct)
+static void build_boundary(BevelParams *bp, MemArena *mem_arena, BevVert *bv, bool construct)
 {
-  MemArena *mem_arena = bp->mem_arena;
   EdgeHalf *efirst, *e, *e2, *e3, *enip, *eip, *eon, *emiter;
   BoundVert *v, *v1, *v2, *v3;
   VMesh *vm;
@@ -2625,7 +2649,7 @@ static void build_boundary(BevelParams *bp, BevVert *bv, bool construct)
   }
 
   if (bp->vertex_only) {
-    build_boundary_vertex_only(bp, bv, construct);
+    build_boundary_vertex_only(bp, mem_arena, bv, construct);
     return;
   }
 
@@ -2637,7 +2661,7 @@ static void build_boundary(BevelParams *bp, BevVert *bv, bool construct)
 
   if (bv->selcount == 1) {
     /* Special case: only one beveled edge in. */
-    build_boundary_terminal_edge(bp, bv, efirst, construct);
+    build_boundary_terminal_edge(bp, mem_arena, bv, efirst, construct);
     return;
   }
 
@@ -3445,7 +3469,7 @@ static void adjust_offsets(BevelParams *bp, BMesh *bm)
     if (BM_elem_flag_test(bmv, BM_ELEM_TAG)) {
       bv = find_bevvert(bp, bmv);
       if (bv) {
-        build_boundary(bp, bv, false);
+        build_boundary(bp, bp->mem_arena, bv, false);
       }
     }
   }
@@ -3733,7 +3757,7 @@ static int interp_range(const float *frac, int n, const float f, float *r_rest)
  * TODO(Hans): This puts the center mesh vert at a slightly off location sometimes, which seems to
  * be associated with the rest of that ring being shifted or connected slightly incorrectly to its
  * neighbors. */
-static VMesh *interp_vmesh(BevelParams *bp, VMesh *vm_in, int nseg)
+static VMesh *interp_vmesh(BevelParams *bp, MemArena *mem_arena, VMesh *vm_in, int nseg)
 {
   int n_bndv, ns_in, nseg2, odd, i, j, k, j_in, k_in, k_in_prev, j0inc, k0inc;
   float *prev_frac, *frac, *new_frac, *prev_new_frac;
@@ -3746,7 +3770,7 @@ static VMesh *interp_vmesh(BevelParams *bp, VMesh *vm_in, int nseg)
   ns_in = vm_in->seg;
   nseg2 = nseg / 2;
   odd = nseg % 2;
-  vm_out = new_adj_vmesh(bp->mem_arena, n_bndv, nseg, vm_in->boundstart);
+  vm_out = new_adj_vmesh(mem_arena, n_bndv, nseg, vm_in->boundstart);
 
   prev_frac = BLI_array_alloca(prev_frac, (ns_in + 1));
   frac = BLI_array_alloca(frac, (ns_in + 1));
@@ -3807,7 +3831,7 @@ static VMesh *interp_vmesh(BevelParams *bp, VMesh *vm_in, int nseg)
  * For now, this is written assuming vm0->nseg is even and > 0.
  * We are allowed to modify vm_in, as it will not be used after this call.
  * See Levin 1999 paper: "Filling an N-sided hole using combined subdivision schemes". */
-static VMesh *cubic_subdiv(BevelParams *bp, VMesh *vm_in)
+static VMesh *cubic_subdiv(BevelParams *bp, MemArena *mem_arena, VMesh *vm_in)
 {
   int n_boundary, ns_in, ns_in2, ns_out;
   int i, j, k, inext;
@@ -3821,7 +3845,7 @@ static VMesh *cubic_subdiv(BevelParams *bp, VMesh *vm_in)
   ns_in2 = ns_in / 2;
   BLI_assert(ns_in % 2 == 0);
   ns_out = 2 * ns_in;
-  vm_out = new_adj_vmesh(bp->mem_arena, n_boundary, ns_out, vm_in->boundstart);
+  vm_out = new_adj_vmesh(mem_arena, n_boundary, ns_out, vm_in->boundstart);
 
   /* First we adjust the boundary vertices of the input mesh, storing in output mesh. */
   for (i = 0; i < n_boundary; i++) {
@@ -4067,9 +4091,8 @@ static VMesh *make_cube_corner_square_in(MemArena *mem_arena, int nseg)
  * This has BoundVerts at (1,0,0), (0,1,0) and (0,0,1), with quarter circle arcs
  * on the faces for the orthogonal planes through the origin.
  */
-static VMesh *make_cube_corner_adj_vmesh(BevelParams *bp)
+static VMesh *make_cube_corner_adj_vmesh(BevelParams *bp, MemArena *mem_arena)
 {
-  MemArena *mem_arena = bp->mem_arena;
   int nseg = bp->seg;
   float r = bp->pro_super_r;
   VMesh *vm0, *vm1;
@@ -4109,6 +4132,7 @@ static VMesh *make_cube_corner_adj_vmesh(BevelParams *bp)
     cross_v3_v3v3(bndv->profile.plane_no, bndv->profile.start, bndv->profile.end);
     copy_v3_v3(bndv->profile.proj_dir, bndv->profile.plane_no);
     /* Calculate profiles again because we started over with new boundverts. */
+    profile_alloc(bp, mem_arena, &bndv->profile);
     calculate_profile(bp, bndv, false, false); /* No custom profiles in this case. */
 
     /* Just building the boundaries here, so sample the profile halfway through. */
@@ -4133,10 +4157,10 @@ static VMesh *make_cube_corner_adj_vmesh(BevelParams *bp)
 
   vm1 = vm0;
   while (vm1->seg < nseg) {
-    vm1 = cubic_subdiv(bp, vm1);
+    vm1 = cubic_subdiv(bp, mem_arena, vm1);
   }
   if (vm1->seg != nseg) {
-    vm1 = interp_vmesh(bp, vm1, nseg);
+    vm1 = interp_vmesh(bp, mem_arena, vm1, nseg);
   }
 
   /* Now snap each vertex to the superellipsoid. */
@@ -4194,7 +4218,7 @@ static int tri_corner_test(BevelParams *bp, BevVert *bv)
   return 1;
 }
 
-static VMesh *tri_corner_adj_vmesh(BevelParams *bp, BevVert *bv)
+static VMesh *tri_corner_adj_vmesh(BevelParams *bp, MemArena *mem_arena, BevVert *bv)
 {
   int i, j, k, ns, ns2;
   float co0[3], co1[3], co2[3];
@@ -4211,7 +4235,7 @@ static VMesh *tri_corner_adj_vmesh(BevelParams *bp, BevVert *bv)
   make_unit_cube_map(co0, co1, co2, bv->v->co, mat);
   ns = bp->seg;
   ns2 = ns / 2;
-  vm = make_cube_corner_adj_vmesh(bp);
+  vm = make_cube_corner_adj_vmesh(bp, mem_arena);
   for (i = 0; i < 3; i++) {
     for (j = 0; j <= ns2; j++) {
       for (k = 0; k <= ns; k++) {
@@ -4227,20 +4251,19 @@ static VMesh *tri_corner_adj_vmesh(BevelParams *bp, BevVert *bv)
 }
 
 /* Makes the mesh that replaces the original vertex, bounded by the profiles on the sides. */
-static VMesh *adj_vmesh(BevelParams *bp, BevVert *bv)
+static VMesh *adj_vmesh(BevelParams *bp, MemArena *mem_arena, BevVert *bv)
 {
   int n_bndv, nseg, i;
   VMesh *vm0, *vm1;
   float boundverts_center[3], original_vertex[3], negative_fullest[3], center_direction[3];
   BoundVert *bndv;
-  MemArena *mem_arena = bp->mem_arena;
   float fullness;
 
   n_bndv = bv->vmesh->count;
 
   /* Same bevel as that of 3 edges of vert in a cube. */
   if (n_bndv == 3 && tri_corner_test(bp, bv) != -1 && bp->pro_super_r != PRO_SQUARE_IN_R) {
-    return tri_corner_adj_vmesh(bp, bv);
+    return tri_corner_adj_vmesh(bp, mem_arena, bv);
   }
 
   /* First construct an initial control mesh, with nseg == 2. */
@@ -4287,10 +4310,10 @@ static VMesh *adj_vmesh(BevelParams *bp, BevVert *bv)
   /* Do the subdivision process to go from the two segment start mesh to the final vertex mesh. */
   vm1 = vm0;
   do {
-    vm1 = cubic_subdiv(bp, vm1);
+    vm1 = cubic_subdiv(bp, mem_arena, vm1);
   } while (vm1->seg < nseg);
   if (vm1->seg != nseg) {
-    vm1 = interp_vmesh(bp, vm1, nseg);
+    vm1 = interp_vmesh(bp, mem_arena, vm1, nseg);
   }
   return vm1;
 }
@@ -4342,7 +4365,7 @@ static void snap_to_pipe_profile(BoundVert *vpipe, bool midline, float co[3])
  * We want to make an ADJ mesh but then snap the vertices to the profile in a plane
  * perpendicular to the pipes.
  */
-static VMesh *pipe_adj_vmesh(BevelParams *bp, BevVert *bv, BoundVert *vpipe)
+static VMesh *pipe_adj_vmesh(BevelParams *bp, MemArena *mem_arena, BevVert *bv, BoundVert *vpipe)
 {
   int i, j, k, n_bndv, ns, half_ns, ipipe1, ipipe2, ring;
   VMesh *vm;
@@ -4350,7 +4373,7 @@ static VMesh *pipe_adj_vmesh(BevelParams *bp, BevVert *bv, BoundVert *vpipe)
   float *profile_point_pipe1, *profile_point_pipe2, f;
 
   /* Some unecessary overhead running this subdivision with custom profile snapping later on. */
-  vm = adj_vmesh(bp, bv);
+  vm = adj_vmesh(bp, mem_arena, bv);
 
   /* Now snap all interior coordinates to be on the epipe profile. */
   n_bndv = bv->vmesh->count;
@@ -4575,7 +4598,7 @@ static void closer_v3_v3v3v3(float r[3], float a[3], float b[3], float v[3])
  * At the moment, this is not called for odd number of segments, though code does something if it
  * is.
  */
-static VMesh *square_out_adj_vmesh(BevelParams *bp, BevVert *bv)
+static VMesh *square_out_adj_vmesh(MemArena *mem_arena, BevVert *bv)
 {
   int n_bndv, ns, ns2, odd, i, j, k, ikind, im1, clstride, iprev, ang_kind;
   float bndco[3], dir1[3], dir2[3], co1[3], co2[3], meet1[3], meet2[3], v1co[3], v2co[3];
@@ -4592,7 +4615,7 @@ static VMesh *square_out_adj_vmesh(BevelParams *bp, BevVert *bv)
   ns2 = ns / 2;
   odd = ns % 2;
   ns2inv = 1.0f / (float)ns2;
-  vm = new_adj_vmesh(bp->mem_arena, n_bndv, ns, bv->vmesh->boundstart);
+  vm = new_adj_vmesh(mem_arena, n_bndv, ns, bv->vmesh->boundstart);
   clstride = 3 * (ns2 + 1);
   centerline = MEM_mallocN((size_t)(clstride * n_bndv) * sizeof(float), "bevel");
   cset = MEM_callocN((size_t)n_bndv * sizeof(bool), "bevel");
@@ -4800,12 +4823,44 @@ static VMesh *square_out_adj_vmesh(BevelParams *bp, BevVert *bv)
   return vm;
 }
 
+/**
+ * Calculate the positions of the interior mesh points for the M_ADJ pattern of bv,
+ * using cubic subdivision, without creating BMesh elements (see #bevel_build_rings for that).
+ * This only allocates from \a mem_arena and doesn't modify bv,
+ * so it runs for all BevVerts in parallel (see #build_vmesh_adj).
+ *
+ * \param r_square_in: Set when the result is the #PRO_SQUARE_IN_R cube corner,
+ * which is built by #build_square_in_vmesh instead.
+ */
+static VMesh *build_rings_adj_vmesh(
+    BevelParams *bp, MemArena *mem_arena, BevVert *bv, BoundVert *vpipe, bool *r_square_in)
+{
+  const bool odd = (bv->vmesh->seg % 2) != 0;
+
+  *r_square_in = false;
+  if (bp->pro_super_r == PRO_SQUARE_R && bv->selcount >= 3 && !odd && !bp->use_custom_profile) {
+    return square_out_adj_vmesh(mem_arena, bv);
+  }
+  else if (vpipe) {
+    return pipe_adj_vmesh(bp, mem_arena, bv, vpipe);
+  }
+  else if (tri_corner_test(bp, bv) == 1) {
+    /* The PRO_SQUARE_IN_R profile has boundary edges that merge
+     * and no internal ring polys except possibly center ngon. */
+    *r_square_in = (bp->pro_super_r == PRO_SQUARE_IN_R && !bp->use_custom_profile);
+    return tri_corner_adj_vmesh(bp, mem_arena, bv);
+  }
+  else {
+    return adj_vmesh(bp, mem_arena, bv);
+  }
+}
+
 /**
  * Given that the boundary is built and the boundary BMVerts have been made,
- * calculate the positions of the interior mesh points for the M_ADJ pattern,
- * using cubic subdivision, then make the BMVerts and the new faces.
+ * make the BMVerts and the new faces for the M_ADJ pattern, at the positions
+ * calculated by #build_rings_adj_vmesh.
  */
-static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv, BoundVert *vpipe)
+static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
 {
   int n_bndv, ns, ns2, odd, i, j, k, ring;
   VMesh *vm1, *vm;
@@ -4822,23 +4877,11 @@ static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv, BoundVert
   odd = ns % 2;
   BLI_assert(n_bndv >= 3 && ns > 1);
 
-  if (bp->pro_super_r == PRO_SQUARE_R && bv->selcount >= 3 && !odd && !bp->use_custom_profile) {
-    vm1 = square_out_adj_vmesh(bp, bv);
-  }
-  else if (vpipe) {
-    vm1 = pipe_adj_vmesh(bp, bv, vpipe);
-  }
-  else if (tri_corner_test(bp, bv) == 1) {
-    vm1 = tri_corner_adj_vmesh(bp, bv);
-    /* The PRO_SQUARE_IN_R profile has boundary edges that merge
-     * and no internal ring polys except possibly center ngon. */
-    if (bp->pro_super_r == PRO_SQUARE_IN_R && !bp->use_custom_profile) {
-      build_square_in_vmesh(bp, bm, bv, vm1);
-      return;
-    }
-  }
-  else {
-    vm1 = adj_vmesh(bp, bv);
+  vm1 = bv->vmesh_adj;
+  BLI_assert(vm1 != NULL);
+  if (bv->vmesh_adj_square_in) {
+    build_square_in_vmesh(bp, bm, bv, vm1);
+    return;
   }
 
   /* Copy final vmesh into bv->vmesh, make BMVerts and BMFaces. */
@@ -5357,21 +5400,173 @@ static void bevel_vert_two_edges(BevelParams *bp, BMesh *bm, BevVert *bv)
   }
 }
 
-/* Given that the boundary is built, now make the actual BMVerts
- * for the boundary and the interior of the vertex mesh. */
+/**
+ * Calculate the profiles of bv's BoundVerts, moving the profile planes first in the weld case.
+ * The profile coordinates are allocated from \a mem_arena.
+ */
+static void build_vmesh_profiles(BevelParams *bp, MemArena *mem_arena, BevVert *bv)
+{
+  VMesh *vm = bv->vmesh;
+  BoundVert *bndv, *weld1;
+
+  if (bp->seg > 1) {
+    bndv = vm->boundstart;
+    do {
+      if (!bndv->profile.prof_co) {
+        profile_alloc(bp, mem_arena, &bndv->profile);
+      }
+    } while ((bndv = bndv->next) != vm->boundstart);
+  }
+
+  /* Special case: just two beveled edges welded together, move their profile planes. */
+  if ((bv->selcount == 2) && (vm->count == 2)) {
+    weld1 = NULL;
+    bndv = vm->boundstart;
+    do {
+      if (bndv->ebev) {
+        if (!weld1) {
+          weld1 = bndv;
+        }
+        else {
+          set_profile_params(bp, bv, weld1);
+          set_profile_params(bp, bv, bndv);
+          move_weld_profile_planes(bv, weld1, bndv);
+          break;
+        }
+      }
+    } while ((bndv = bndv->next) != vm->boundstart);
+  }
+
+  /* It's simpler to calculate all profiles only once at a single moment, so keep just a single
+   * profile calculation here, the last point before actual mesh verts are created. */
+  calculate_vm_profiles(bp, bv, vm);
+}
+
+/**
+ * Calculate the "Adjacent edges" pattern positions when #build_vmesh will use that pattern,
+ * the profiles must be calculated already.
+ */
+static void build_vmesh_adj(BevelParams *bp, MemArena *mem_arena, BevVert *bv)
+{
+  VMesh *vm = bv->vmesh;
+  BoundVert *vpipe = NULL;
+
+  /* Same cases as in #build_vmesh: the weld case doesn't need a vertex mesh,
+   * the pipe case uses the ADJ pattern for both the "Grid Fill" (ADJ) and cutoff options. */
+  if ((bv->selcount == 2) && (vm->count == 2)) {
+    return;
+  }
+  if ((vm->count == 3 || vm->count == 4) && bp->seg > 1) {
+    vpipe = pipe_test(bv);
+  }
+  if (vm->mesh_kind == M_ADJ || vpipe) {
+    bv->vmesh_adj = build_rings_adj_vmesh(bp, mem_arena, bv, vpipe, &bv->vmesh_adj_square_in);
+  }
+}
+
+/**
+ * Everything of bv's vertex mesh that doesn't need BMesh elements: the mesh array,
+ * the profiles and the positions of the "Adjacent edges" pattern.
+ * This only modifies bv and only allocates from \a mem_arena,
+ * so it runs for all BevVerts in parallel before #build_vmesh.
+ */
+static void build_vmesh_positions(BevelParams *bp, MemArena *mem_arena, BevVert *bv)
+{
+  VMesh *vm = bv->vmesh;
+  const int ns2 = vm->seg / 2;
+
+  vm->mesh = (NewVert *)BLI_memarena_alloc(
+      mem_arena, (size_t)(vm->count * (ns2 + 1) * (vm->seg + 1)) * sizeof(NewVert));
+
+  build_vmesh_profiles(bp, mem_arena, bv);
+  build_vmesh_adj(bp, mem_arena, bv);
+}
+
+/* Running per BevVert functions in parallel
+ * ***************************************** */
+
+typedef struct BevelVertsData {
+  BevelParams *bp;
+  BevVert **bevverts;
+} BevelVertsData;
+
+typedef struct BevelVertsTLS {
+  /** Created on first use, since not every thread may get to run. */
+  MemArena *mem_arena;
+} BevelVertsTLS;
+
+static MemArena *bevel_verts_tls_mem_arena(const TaskParallelTLS *__restrict tls)
+{
+  BevelVertsTLS *tls_data = tls->userdata_chunk;
+  if (tls_data->mem_arena == NULL) {
+    tls_data->mem_arena = BLI_memarena_new(MEM_SIZE_OPTIMAL(1 << 16), __func__);
+    BLI_memarena_use_calloc(tls_data->mem_arena);
+  }
+  return tls_data->mem_arena;
+}
+
+static void bevel_verts_finalize(void *__restrict userdata, void *__restrict userdata_chunk)
+{
+  BevelVertsData *data = userdata;
+  BevelVertsTLS *tls_data = userdata_chunk;
+  if (tls_data->mem_arena) {
+    /* The allocations are used until the end of the bevel, free with the main arena. */
+    BLI_linklist_prepend(&data->bp->mem_arenas_thread, tls_data->mem_arena);
+  }
+}
+
+static void bevel_vert_boundary_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict tls)
+{
+  BevelVertsData *data = userdata;
+  build_boundary(data->bp, bevel_verts_tls_mem_arena(tls), data->bevverts[i], true);
+}
+
+static void bevel_vert_vmesh_positions_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict tls)
+{
+  BevelVertsData *data = userdata;
+  build_vmesh_positions(data->bp, bevel_verts_tls_mem_arena(tls), data->bevverts[i]);
+}
+
+/**
+ * Run \a func for all \a bevverts in parallel. Each thread allocates from its own memory arena,
+ * since #BevelParams.mem_arena isn't thread-safe.
+ */
+static void bevel_verts_parallel(BevelParams *bp,
+                                 BevVert **bevverts,
+                                 const int bevverts_len,
+                                 TaskParallelRangeFunc func)
+{
+  BevelVertsData data = {
+      .bp = bp,
+      .bevverts = bevverts,
+  };
+  BevelVertsTLS tls_data = {NULL};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = BEVEL_PARALLEL_MIN_ITER;
+  settings.use_threading = (bevverts_len > BEVEL_PARALLEL_MIN_ITER);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_finalize = bevel_verts_finalize;
+  BLI_task_parallel_range(0, bevverts_len, &data, func, &settings);
+}
+
+/* Given that the boundary is built and the positions are calculated (see #build_vmesh_positions),
+ * now make the actual BMVerts for the boundary and the interior of the vertex mesh. */
 static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
 {
   VMesh *vm = bv->vmesh;
-  BoundVert *bndv, *weld1, *weld2, *vpipe;
-  int n, ns, ns2, i, k, weld;
+  BoundVert *bndv, *weld1, *weld2;
+  int n, ns, i, k, weld;
   float *v_weld1, *v_weld2, co[3];
 
   n = vm->count;
   ns = vm->seg;
-  ns2 = ns / 2;
-
-  vm->mesh = (NewVert *)BLI_memarena_alloc(bp->mem_arena,
-                                           (size_t)(n * (ns2 + 1) * (ns + 1)) * sizeof(NewVert));
 
   /* Special case: just two beveled edges welded together. */
   weld = (bv->selcount == 2) && (vm->count == 2);
@@ -5385,24 +5580,17 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
     create_mesh_bmvert(bm, vm, i, 0, 0, bv->v);          /* Create BMVert for that NewVert. */
     bndv->nv.v = mesh_vert(vm, i, 0, 0)->v; /* Use the BMVert for the BoundVert's NewVert. */
 
-    /* Find boundverts and move profile planes if this is a weld case. */
+    /* Find boundverts if this is a weld case, their profiles are already calculated. */
     if (weld && bndv->ebev) {
       if (!weld1) {
         weld1 = bndv;
       }
       else { /* Get the last of the two BoundVerts. */
         weld2 = bndv;
-        set_profile_params(bp, bv, weld1);
-        set_profile_params(bp, bv, weld2);
-        move_weld_profile_planes(bv, weld1, weld2);
       }
     }
   } while ((bndv = bndv->next) != vm->boundstart);
 
-  /* It's simpler to calculate all profiles only once at a single moment, so keep just a single
-   * profile calculation here, the last point before actual mesh verts are created. */
-  calculate_vm_profiles(bp, bv, vm);
-
   /* Create new vertices and place them based on the profiles. */
   /* Copy other ends to (i, 0, ns) for all i, and fill in profiles for edges. */
   bndv = vm->boundstart;
@@ -5462,11 +5650,8 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
   }
 
   /* Make sure the pipe case ADJ mesh is used for both the "Grid Fill" (ADJ) and cutoff options. */
-  vpipe = NULL;
   if ((vm->count == 3 || vm->count == 4) && bp->seg > 1) {
-    /* Result is passed to bevel_build_rings to avoid overhead. */
-    vpipe = pipe_test(bv);
-    if (vpipe) {
+    if (pipe_test(bv)) {
       vm->mesh_kind = M_ADJ;
     }
   }
@@ -5481,7 +5666,7 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
       bevel_build_poly(bp, bm, bv);
       break;
     case M_ADJ:
-      bevel_build_rings(bp, bm, bv, vpipe);
+      bevel_build_rings(bp, bm, bv);
       break;
     case M_TRI_FAN:
       bevel_build_trifan(bp, bm, bv);
@@ -7171,7 +7356,8 @@ void BM_mesh_bevel(BMesh *bm,
   BMEdge *e;
   BMFace *f;
   BMLoop *l;
-  BevVert *bv;
+  BevVert *bv, **bevverts;
+  int i, bevverts_len;
   BevelParams bp = {NULL};
 
   bp.offset = offset;
@@ -7241,12 +7427,22 @@ void BM_mesh_bevel(BMesh *bm,
     bp.face_hash = BLI_ghash_ptr_new(__func__);
     BLI_ghash_flag_set(bp.face_hash, GHASH_FLAG_ALLOW_DUPES);
 
-    /* Analyze input vertices, sorting edges and assigning initial new vertex positions. */
+    /* Analyze input vertices, sorting edges. */
     BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
       if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-        bv = bevel_vert_construct(bm, &bp, v);
-        if (!limit_offset && bv) {
-          build_boundary(&bp, bv, true);
+        bevel_vert_construct(bm, &bp, v);
+      }
+    }
+
+    /* Collect the BevVerts, the per-vertex work that doesn't create BMesh elements
+     * is done in parallel, the rest is done afterwards in the original order. */
+    bevverts = MEM_mallocN(sizeof(*bevverts) * BLI_ghash_len(bp.vert_hash), __func__);
+    bevverts_len = 0;
+    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+      if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
+        bv = find_bevvert(&bp, v);
+        if (bv) {
+          bevverts[bevverts_len++] = bv;
         }
       }
     }
@@ -7254,18 +7450,11 @@ void BM_mesh_bevel(BMesh *bm,
     /* Perhaps clamp offset to avoid geometry colliisions. */
     if (limit_offset) {
       bevel_limit_offset(&bp, bm);
-
-      /* Assign initial new vertex positions. */
-      BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-        if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-          bv = find_bevvert(&bp, v);
-          if (bv) {
-            build_boundary(&bp, bv, true);
-          }
-        }
-      }
     }
 
+    /* Assign initial new vertex positions. */
+    bevel_verts_parallel(&bp, bevverts, bevverts_len, bevel_vert_boundary_cb);
+
     /* Perhaps do a pass to try to even out widths. */
     if (!bp.vertex_only && bp.offset_adjust && bp.offset_type != BEVEL_AMT_PERCENT) {
       adjust_offsets(&bp, bm);
@@ -7280,15 +7469,14 @@ void BM_mesh_bevel(BMesh *bm,
       }
     }
 
-    /* Build the meshes around vertices, now that positions are final. */
-    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-      if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-        bv = find_bevvert(&bp, v);
-        if (bv) {
-          build_vmesh(&bp, bm, bv);
-        }
-      }
+    /* Calculate the profiles and vertex mesh positions, now that boundaries are final. */
+    bevel_verts_parallel(&bp, bevverts, bevverts_len, bevel_vert_vmesh_positions_cb);
+
+    /* Build the meshes around vertices. */
+    for (i = 0; i < bevverts_len; i++) {
+      build_vmesh(&bp, bm, bevverts[i]);
     }
+    MEM_freeN(bevverts);
 
     /* Build polygons for edges. */
     if (!bp.vertex_only) {
@@ -7360,5 +7548,6 @@ void BM_mesh_bevel(BMesh *bm,
     BLI_ghash_free(bp.vert_hash, NULL, NULL);
     BLI_ghash_free(bp.face_hash, NULL, NULL);
     BLI_memarena_free(bp.mem_arena);
+    BLI_linklist_free(bp.mem_arenas_thread, (LinkNodeFreeFP)BLI_memarena_free);
   }
 }
@@ -32,6 +32,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "BKE_customdata.h"
@@ -67,6 +68,16 @@
 #define OPTIMIZE_EPS 1e-8
 #define COST_INVALID FLT_MAX
 
+/* Initial quadrics and edge costs are calculated in parallel above this size. */
+#define DECIM_PARALLEL_MIN_ITER 1024
+/**
+ * Meshes above #DECIM_PARALLEL_MIN_ITER edges collapse up to this many edges at once,
+ * from regions which don't touch each other.
+ */
+#define DECIM_COLLAPSE_BATCH 512
+/* Collapse checks and cost updates of a batch are calculated in parallel above this size. */
+#define DECIM_COLLAPSE_PARALLEL_MIN_ITER 64
+
 typedef enum CD_UseFlag {
   CD_DO_VERT = (1 << 0),
   CD_DO_EDGE = (1 << 1),
@@ -76,6 +87,31 @@ typedef enum CD_UseFlag {
 /* BMesh Helper Functions
  * ********************** */
 
+static void bm_decim_face_quadric(BMFace *f, Quadric *r_q)
+{
+  float center[3];
+  double plane_db[4];
+
+  BM_face_calc_center_median(f, center);
+  copy_v3db_v3fl(plane_db, f->no);
+  plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+
+  BLI_quadric_from_plane(r_q, plane_db);
+}
+
+struct FaceQuadricData {
+  BMesh *bm;
+  Quadric *r_fquadrics;
+};
+
+static void bm_decim_face_quadric_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct FaceQuadricData *data = userdata;
+  bm_decim_face_quadric(BM_face_at_index(data->bm, i), &data->r_fquadrics[i]);
+}
+
 /**
  * \param vquadrics: must be calloc'd
  */
@@ -84,27 +120,34 @@ static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
   BMIter iter;
   BMFace *f;
   BMEdge *e;
+  uint i;
 
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+  /* Face planes are calculated in parallel, then accumulated in the vertices in the order of the
+   * faces, which gives the same result as a single threaded accumulation. */
+  Quadric *fquadrics = MEM_mallocN(sizeof(*fquadrics) * (size_t)bm->totface, __func__);
+  {
+    BM_mesh_elem_table_ensure(bm, BM_FACE);
+    struct FaceQuadricData data = {bm, fquadrics};
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (bm->totface > DECIM_PARALLEL_MIN_ITER);
+    settings.min_iter_per_thread = DECIM_PARALLEL_MIN_ITER;
+    BLI_task_parallel_range(0, bm->totface, &data, bm_decim_face_quadric_cb, &settings);
+  }
+
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
     BMLoop *l_first;
     BMLoop *l_iter;
 
-    float center[3];
-    double plane_db[4];
-    Quadric q;
-
-    BM_face_calc_center_median(f, center);
-    copy_v3db_v3fl(plane_db, f->no);
-    plane_db[3] = -dot_v3db_v3fl(plane_db, center);
-
-    BLI_quadric_from_plane(&q, plane_db);
-
     l_iter = l_first = BM_FACE_FIRST_LOOP(f);
     do {
-      BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(l_iter->v)], &q);
+      BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(l_iter->v)], &fquadrics[i]);
     } while ((l_iter = l_iter->next) != l_first);
   }
 
+  MEM_freeN(fquadrics);
+
   /* boundary edges */
   BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
     if (UNLIKELY(BM_edge_is_boundary(e))) {
@@ -237,18 +280,21 @@ static float bm_decim_build_edge_cost_single__topology(BMEdge *e)
 
 #endif /* USE_TOPOLOGY_FALLBACK */
 
-static void bm_decim_build_edge_cost_single(BMEdge *e,
-                                            const Quadric *vquadrics,
-                                            const float *vweights,
-                                            const float vweight_factor,
-                                            Heap *eheap,
-                                            HeapNode **eheap_table)
+/**
+ * Calculate the cost of collapsing the edge, without modifying any data.
+ * \return false when the edge can't be collapsed.
+ */
+static bool bm_decim_calc_edge_cost_single(BMEdge *e,
+                                           const Quadric *vquadrics,
+                                           const float *vweights,
+                                           const float vweight_factor,
+                                           float *r_cost)
 {
   float cost;
 
   if (UNLIKELY(vweights && ((vweights[BM_elem_index_get(e->v1)] == 0.0f) ||
                             (vweights[BM_elem_index_get(e->v2)] == 0.0f)))) {
-    goto clear;
+    return false;
   }
 
   /* check we can collapse, some edges we better not touch */
@@ -258,7 +304,7 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
     else {
       /* only collapse tri's */
-      goto clear;
+      return false;
     }
   }
   else if (BM_edge_is_manifold(e)) {
@@ -267,11 +313,11 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
     else {
       /* only collapse tri's */
-      goto clear;
+      return false;
     }
   }
   else {
-    goto clear;
+    return false;
   }
   /* end sanity check */
 
@@ -324,10 +370,18 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
   }
 
-  BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
-  return;
+  *r_cost = cost;
+  return true;
+}
+
+static void bm_decim_edge_cost_heap_update(
+    BMEdge *e, const bool is_valid, const float cost, Heap *eheap, HeapNode **eheap_table)
+{
+  if (is_valid) {
+    BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
+    return;
+  }
 
-clear:
   if (eheap_table[BM_elem_index_get(e)]) {
     BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
   }
@@ -342,6 +396,27 @@ static void bm_decim_invalid_edge_cost_single(BMEdge *e, Heap *eheap, HeapNode *
   eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, COST_INVALID, e);
 }
 
+struct EdgeCostData {
+  BMEdge **edges;
+  const Quadric *vquadrics;
+  const float *vweights;
+  float vweight_factor;
+  float *r_costs;
+  bool *r_is_valid;
+};
+
+static void bm_decim_build_edge_cost_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct EdgeCostData *data = userdata;
+  data->r_is_valid[i] = bm_decim_calc_edge_cost_single(data->edges[i],
+                                                       data->vquadrics,
+                                                       data->vweights,
+                                                       data->vweight_factor,
+                                                       &data->r_costs[i]);
+}
+
 static void bm_decim_build_edge_cost(BMesh *bm,
                                      const Quadric *vquadrics,
                                      const float *vweights,
@@ -353,11 +428,147 @@ static void bm_decim_build_edge_cost(BMesh *bm,
   BMEdge *e;
   uint i;
 
+  /* Costs are calculated in parallel (optimizing the quadrics is the expensive part),
+   * the heap is filled in the order of the edges afterwards. */
+  BM_mesh_elem_table_ensure(bm, BM_EDGE);
+  struct EdgeCostData data = {
+      .edges = bm->etable,
+      .vquadrics = vquadrics,
+      .vweights = vweights,
+      .vweight_factor = vweight_factor,
+      .r_costs = MEM_mallocN(sizeof(*data.r_costs) * (size_t)bm->totedge, __func__),
+      .r_is_valid = MEM_mallocN(sizeof(*data.r_is_valid) * (size_t)bm->totedge, __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (bm->totedge > DECIM_PARALLEL_MIN_ITER);
+  settings.min_iter_per_thread = DECIM_PARALLEL_MIN_ITER;
+  BLI_task_parallel_range(0, bm->totedge, &data, bm_decim_build_edge_cost_cb, &settings);
+
   BM_ITER_MESH_INDEX (e, &iter, bm, BM_EDGES_OF_MESH, i) {
     /* keep sanity check happy */
     eheap_table[i] = NULL;
-    bm_decim_build_edge_cost_single(e, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+    bm_decim_edge_cost_heap_update(e, data.r_is_valid[i], data.r_costs[i], eheap, eheap_table);
+  }
+
+  MEM_freeN(data.r_costs);
+  MEM_freeN(data.r_is_valid);
+}
+
+/**
+ * Edges which need their cost updated after collapsing into \a v:
+ * the edges using \a v and the outer edges of its triangle fan.
+ *
+ * \param r_edges: When NULL, only count the edges.
+ * \return the number of edges.
+ */
+static int bm_decim_vert_cost_edges(BMVert *v, BMEdge **r_edges)
+{
+  int edges_len = 0;
+
+  if (LIKELY(v->e)) {
+    BMEdge *e_iter;
+    BMEdge *e_first;
+    e_iter = e_first = v->e;
+    do {
+      BLI_assert(BM_edge_find_double(e_iter) == NULL);
+      if (r_edges) {
+        r_edges[edges_len] = e_iter;
+      }
+      edges_len++;
+    } while ((e_iter = bmesh_disk_edge_next(e_iter, v)) != e_first);
   }
+
+  /* this block used to be disabled,
+   * but enable now since surrounding faces may have been
+   * set to COST_INVALID because of a face overlap that no longer occurs */
+  {
+    BMIter liter;
+    BMLoop *l;
+    BM_ITER_ELEM (l, &liter, v, BM_LOOPS_OF_VERT) {
+      if (l->f->len == 3) {
+        BMEdge *e_outer;
+        if (BM_vert_in_edge(l->prev->e, l->v)) {
+          e_outer = l->next->e;
+        }
+        else {
+          e_outer = l->prev->e;
+        }
+
+        BLI_assert(BM_vert_in_edge(e_outer, l->v) == false);
+
+        if (r_edges) {
+          r_edges[edges_len] = e_outer;
+        }
+        edges_len++;
+      }
+    }
+  }
+
+  return edges_len;
+}
+
+/**
+ * Edges collected after one or more collapses, their costs are calculated in parallel
+ * then the heap is updated in the order the edges were added.
+ */
+struct EdgeCostUpdate {
+  BMEdge **edges;
+  float *costs;
+  bool *is_valid;
+  int edges_len;
+  int edges_len_alloc;
+};
+
+static void bm_decim_cost_update_add_vert(struct EdgeCostUpdate *update, BMVert *v)
+{
+  const int edges_len_next = update->edges_len + bm_decim_vert_cost_edges(v, NULL);
+  if (edges_len_next > update->edges_len_alloc) {
+    update->edges_len_alloc = max_ii(update->edges_len_alloc * 2, edges_len_next);
+    const size_t alloc_len = (size_t)update->edges_len_alloc;
+    update->edges = MEM_reallocN(update->edges, sizeof(*update->edges) * alloc_len);
+    update->costs = MEM_reallocN(update->costs, sizeof(*update->costs) * alloc_len);
+    update->is_valid = MEM_reallocN(update->is_valid, sizeof(*update->is_valid) * alloc_len);
+  }
+  update->edges_len += bm_decim_vert_cost_edges(v, &update->edges[update->edges_len]);
+  BLI_assert(update->edges_len == edges_len_next);
+}
+
+static void bm_decim_cost_update_flush(struct EdgeCostUpdate *update,
+                                       const Quadric *vquadrics,
+                                       const float *vweights,
+                                       const float vweight_factor,
+                                       Heap *eheap,
+                                       HeapNode **eheap_table)
+{
+  struct EdgeCostData data = {
+      .edges = update->edges,
+      .vquadrics = vquadrics,
+      .vweights = vweights,
+      .vweight_factor = vweight_factor,
+      .r_costs = update->costs,
+      .r_is_valid = update->is_valid,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (update->edges_len > DECIM_COLLAPSE_PARALLEL_MIN_ITER);
+  settings.min_iter_per_thread = DECIM_COLLAPSE_PARALLEL_MIN_ITER;
+  BLI_task_parallel_range(0, update->edges_len, &data, bm_decim_build_edge_cost_cb, &settings);
+
+  for (int i = 0; i < update->edges_len; i++) {
+    bm_decim_edge_cost_heap_update(
+        update->edges[i], update->is_valid[i], update->costs[i], eheap, eheap_table);
+  }
+  update->edges_len = 0;
+}
+
+static void bm_decim_cost_update_free(struct EdgeCostUpdate *update)
+{
+  MEM_SAFE_FREE(update->edges);
+  MEM_SAFE_FREE(update->costs);
+  MEM_SAFE_FREE(update->is_valid);
 }
 
 #ifdef USE_SYMMETRY
@@ -1120,24 +1331,49 @@ static bool bm_edge_collapse(BMesh *bm,
   }
 }
 
+/**
+ * Check the edge can be collapsed without giving degenerate geometry.
+ *
+ * Only the elements around the edge are accessed (tagging the vertices and faces around it),
+ * so edges with disjoint regions (see #bm_decim_edge_region_claim) can be checked in parallel.
+ */
+static bool bm_decim_edge_collapse_check(BMEdge *e,
+                                         const Quadric *vquadrics,
+                                         float r_optimize_co[3])
+{
+  /* disallow collapsing which results in degenerate cases */
+  if (UNLIKELY(bm_edge_collapse_is_degenerate_topology(e))) {
+    return false;
+  }
+
+  bm_decim_calc_target_co_fl(e, r_optimize_co, vquadrics);
+
+  /* check if this would result in an overlapping face */
+  if (UNLIKELY(bm_edge_collapse_is_degenerate_flip(e, r_optimize_co))) {
+    return false;
+  }
+
+  return true;
+}
+
 /**
  * Collapse e the edge, removing e->v2
  *
- * \return true when the edge was collapsed.
+ * \note Edge costs are not updated here, see #bm_decim_cost_update_add_vert.
+ *
+ * \return the vertex the edge collapsed into, NULL when the edge wasn't collapsed.
  */
-static bool bm_decim_edge_collapse(BMesh *bm,
-                                   BMEdge *e,
-                                   Quadric *vquadrics,
-                                   float *vweights,
-                                   const float vweight_factor,
-                                   Heap *eheap,
-                                   HeapNode **eheap_table,
+static BMVert *bm_decim_edge_collapse(BMesh *bm,
+                                      BMEdge *e,
+                                      Quadric *vquadrics,
+                                      float *vweights,
+                                      Heap *eheap,
+                                      HeapNode **eheap_table,
 #ifdef USE_SYMMETRY
-                                   int *edge_symmetry_map,
+                                      int *edge_symmetry_map,
 #endif
-                                   const CD_UseFlag customdata_flag,
-                                   float optimize_co[3],
-                                   bool optimize_co_calc)
+                                      const CD_UseFlag customdata_flag,
+                                      const float optimize_co[3])
 {
   int e_clear_other[2];
   BMVert *v_other = e->v1;
@@ -1151,32 +1387,13 @@ static bool bm_decim_edge_collapse(BMesh *bm,
   copy_v3_v3(v_clear_no, e->v2->no);
 #endif
 
-  /* when false, use without degenerate checks */
-  if (optimize_co_calc) {
-    /* disallow collapsing which results in degenerate cases */
-    if (UNLIKELY(bm_edge_collapse_is_degenerate_topology(e))) {
-      /* add back with a high cost */
-      bm_decim_invalid_edge_cost_single(e, eheap, eheap_table);
-      return false;
-    }
-
-    bm_decim_calc_target_co_fl(e, optimize_co, vquadrics);
-
-    /* check if this would result in an overlapping face */
-    if (UNLIKELY(bm_edge_collapse_is_degenerate_flip(e, optimize_co))) {
-      /* add back with a high cost */
-      bm_decim_invalid_edge_cost_single(e, eheap, eheap_table);
-      return false;
-    }
-  }
-
   /* use for customdata merging */
   if (LIKELY(compare_v3v3(e->v1->co, e->v2->co, FLT_EPSILON) == false)) {
     customdata_fac = line_point_factor_v3(optimize_co, e->v1->co, e->v2->co);
 #if 0
     /* simple test for stupid collapse */
     if (customdata_fac < 0.0 - FLT_EPSILON || customdata_fac > 1.0f + FLT_EPSILON) {
-      return false;
+      return NULL;
     }
 #endif
   }
@@ -1232,52 +1449,95 @@ static bool bm_decim_edge_collapse(BMesh *bm,
     BM_vert_normal_update(v_other);
 #endif
 
-    /* update error costs and the eheap */
-    if (LIKELY(v_other->e)) {
-      BMEdge *e_iter;
-      BMEdge *e_first;
-      e_iter = e_first = v_other->e;
-      do {
-        BLI_assert(BM_edge_find_double(e_iter) == NULL);
-        bm_decim_build_edge_cost_single(
-            e_iter, vquadrics, vweights, vweight_factor, eheap, eheap_table);
-      } while ((e_iter = bmesh_disk_edge_next(e_iter, v_other)) != e_first);
-    }
-
-    /* this block used to be disabled,
-     * but enable now since surrounding faces may have been
-     * set to COST_INVALID because of a face overlap that no longer occurs */
-#if 1
-    /* optional, update edges around the vertex face fan */
-    {
-      BMIter liter;
-      BMLoop *l;
-      BM_ITER_ELEM (l, &liter, v_other, BM_LOOPS_OF_VERT) {
-        if (l->f->len == 3) {
-          BMEdge *e_outer;
-          if (BM_vert_in_edge(l->prev->e, l->v)) {
-            e_outer = l->next->e;
-          }
-          else {
-            e_outer = l->prev->e;
-          }
-
-          BLI_assert(BM_vert_in_edge(e_outer, l->v) == false);
-
-          bm_decim_build_edge_cost_single(
-              e_outer, vquadrics, vweights, vweight_factor, eheap, eheap_table);
-        }
-      }
-    }
-    /* end optional update */
-    return true;
-#endif
+    return v_other;
   }
   else {
     /* add back with a high cost */
     bm_decim_invalid_edge_cost_single(e, eheap, eheap_table);
+    return NULL;
+  }
+}
+
+/* Region Parallel Collapse
+ * ************************
+ *
+ * Edges are collapsed in batches, taken from the heap in order of their cost.
+ * An edge is only added to a batch when the vertices of its faces and edges don't overlap
+ * the ones of edges already in the batch, other edges are added back to the heap
+ * and collapsed in a later batch.
+ *
+ * Collapsing an edge only changes these vertices and the elements using them,
+ * so the collapse checks and the costs of the edges around each collapsed edge
+ * are calculated in parallel. The collapse its self stays single threaded
+ * since it frees elements from the (shared) BMesh memory pools. */
+
+static bool bm_decim_edge_region_test_or_claim(BMEdge *e,
+                                               uint *vert_claim,
+                                               const uint claim_id,
+                                               const bool do_claim)
+{
+  for (int i = 0; i < 2; i++) {
+    BMVert *v = *((&e->v1) + i);
+    BMEdge *e_iter, *e_first;
+    e_iter = e_first = v->e;
+    do {
+      BMVert *v_other = BM_edge_other_vert(e_iter, v);
+      if (do_claim) {
+        vert_claim[BM_elem_index_get(v_other)] = claim_id;
+      }
+      else if (vert_claim[BM_elem_index_get(v_other)] == claim_id) {
+        return false;
+      }
+
+      if (e_iter->l) {
+        /* Faces may be ngons, which aren't collapsed but still tagged by the checks. */
+        BMLoop *l_radial_iter = e_iter->l;
+        do {
+          BMLoop *l_iter, *l_first;
+          l_iter = l_first = l_radial_iter;
+          do {
+            if (do_claim) {
+              vert_claim[BM_elem_index_get(l_iter->v)] = claim_id;
+            }
+            else if (vert_claim[BM_elem_index_get(l_iter->v)] == claim_id) {
+              return false;
+            }
+          } while ((l_iter = l_iter->next) != l_first);
+        } while ((l_radial_iter = l_radial_iter->radial_next) != e_iter->l);
+      }
+    } while ((e_iter = bmesh_disk_edge_next(e_iter, v)) != e_first);
+  }
+  return true;
+}
+
+/**
+ * Claim the vertices around \a e for the current batch.
+ *
+ * \return false (claiming nothing) when they overlap vertices claimed by another edge.
+ */
+static bool bm_decim_edge_region_claim(BMEdge *e, uint *vert_claim, const uint claim_id)
+{
+  if (!bm_decim_edge_region_test_or_claim(e, vert_claim, claim_id, false)) {
     return false;
   }
+  bm_decim_edge_region_test_or_claim(e, vert_claim, claim_id, true);
+  return true;
+}
+
+struct EdgeCollapseCheckData {
+  BMEdge **edges;
+  const Quadric *vquadrics;
+  float (*r_optimize_co)[3];
+  bool *r_is_valid;
+};
+
+static void bm_decim_edge_collapse_check_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct EdgeCollapseCheckData *data = userdata;
+  data->r_is_valid[i] = bm_decim_edge_collapse_check(
+      data->edges[i], data->vquadrics, data->r_optimize_co[i]);
 }
 
 /* Main Decimate Function
@@ -1360,37 +1620,108 @@ void BM_mesh_decimate_collapse(BMesh *bm,
 #endif
 
   /* iterative edge collapse and maintain the eheap */
+  struct EdgeCostUpdate cost_update = {NULL};
+
 #ifdef USE_SYMMETRY
   if (use_symmetry == false)
 #endif
   {
     /* simple non-mirror case */
+    const int batch_len_max = (tot_edge_orig > DECIM_PARALLEL_MIN_ITER) ? DECIM_COLLAPSE_BATCH : 1;
+    BMEdge **batch_edges = MEM_mallocN(sizeof(*batch_edges) * (size_t)batch_len_max, __func__);
+    float(*batch_optimize_co)[3] = MEM_mallocN(sizeof(*batch_optimize_co) * (size_t)batch_len_max,
+                                               __func__);
+    bool *batch_is_valid = MEM_mallocN(sizeof(*batch_is_valid) * (size_t)batch_len_max, __func__);
+    BMEdge **defer_edges = MEM_mallocN(sizeof(*defer_edges) * (size_t)batch_len_max, __func__);
+    float *defer_costs = MEM_mallocN(sizeof(*defer_costs) * (size_t)batch_len_max, __func__);
+    uint *vert_claim = MEM_callocN(sizeof(*vert_claim) * (size_t)bm->totvert, __func__);
+    uint claim_id = 0;
+
     while ((bm->totface > face_tot_target) && (BLI_heap_is_empty(eheap) == false) &&
            (BLI_heap_top_value(eheap) != COST_INVALID)) {
-      // const float value = BLI_heap_node_value(BLI_heap_top(eheap));
-      BMEdge *e = BLI_heap_pop_min(eheap);
-      float optimize_co[3];
-      /* handy to detect corruptions elsewhere */
-      BLI_assert(BM_elem_index_get(e) < tot_edge_orig);
-
-      /* Under normal conditions wont be accessed again,
-       * but NULL just in case so we don't use freed node. */
-      eheap_table[BM_elem_index_get(e)] = NULL;
-
-      bm_decim_edge_collapse(bm,
-                             e,
-                             vquadrics,
-                             vweights,
-                             vweight_factor,
-                             eheap,
-                             eheap_table,
+      /* Each collapse removes up to 2 faces, don't take more edges than needed to reach the
+       * target, so the result doesn't end up with fewer faces than collapsing one at a time. */
+      const int batch_len_limit = max_ii(
+          1, min_ii(batch_len_max, (bm->totface - face_tot_target + 1) / 2));
+      int batch_len = 0;
+      int defer_len = 0;
+
+      claim_id++;
+      while ((batch_len < batch_len_limit) && (defer_len < batch_len_limit) &&
+             (BLI_heap_is_empty(eheap) == false) &&
+             (BLI_heap_top_value(eheap) != COST_INVALID)) {
+        const float cost = BLI_heap_top_value(eheap);
+        BMEdge *e = BLI_heap_pop_min(eheap);
+        /* handy to detect corruptions elsewhere */
+        BLI_assert(BM_elem_index_get(e) < tot_edge_orig);
+
+        /* Under normal conditions wont be accessed again,
+         * but NULL just in case so we don't use freed node. */
+        eheap_table[BM_elem_index_get(e)] = NULL;
+
+        if (bm_decim_edge_region_claim(e, vert_claim, claim_id)) {
+          batch_edges[batch_len++] = e;
+        }
+        else {
+          defer_edges[defer_len] = e;
+          defer_costs[defer_len++] = cost;
+        }
+      }
+
+      /* Add back before collapsing, edges removed by a collapse are removed from the heap. */
+      for (int i = 0; i < defer_len; i++) {
+        BMEdge *e = defer_edges[i];
+        eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, defer_costs[i], e);
+      }
+
+      {
+        struct EdgeCollapseCheckData data = {
+            .edges = batch_edges,
+            .vquadrics = vquadrics,
+            .r_optimize_co = batch_optimize_co,
+            .r_is_valid = batch_is_valid,
+        };
+        TaskParallelSettings settings;
+        BLI_parallel_range_settings_defaults(&settings);
+        settings.use_threading = (batch_len > DECIM_COLLAPSE_PARALLEL_MIN_ITER);
+        settings.min_iter_per_thread = DECIM_COLLAPSE_PARALLEL_MIN_ITER;
+        BLI_task_parallel_range(0, batch_len, &data, bm_decim_edge_collapse_check_cb, &settings);
+      }
+
+      for (int i = 0; i < batch_len; i++) {
+        BMEdge *e = batch_edges[i];
+        if (UNLIKELY(!batch_is_valid[i])) {
+          /* add back with a high cost */
+          bm_decim_invalid_edge_cost_single(e, eheap, eheap_table);
+          continue;
+        }
+
+        BMVert *v_other = bm_decim_edge_collapse(bm,
+                                                 e,
+                                                 vquadrics,
+                                                 vweights,
+                                                 eheap,
+                                                 eheap_table,
 #ifdef USE_SYMMETRY
-                             edge_symmetry_map,
+                                                 NULL,
 #endif
-                             customdata_flag,
-                             optimize_co,
-                             true);
+                                                 customdata_flag,
+                                                 batch_optimize_co[i]);
+        if (v_other) {
+          bm_decim_cost_update_add_vert(&cost_update, v_other);
+        }
+      }
+
+      bm_decim_cost_update_flush(
+          &cost_update, vquadrics, vweights, vweight_factor, eheap, eheap_table);
     }
+
+    MEM_freeN(batch_edges);
+    MEM_freeN(batch_optimize_co);
+    MEM_freeN(batch_is_valid);
+    MEM_freeN(defer_edges);
+    MEM_freeN(defer_costs);
+    MEM_freeN(vert_claim);
   }
 #ifdef USE_SYMMETRY
   else {
@@ -1435,7 +1766,6 @@ void BM_mesh_decimate_collapse(BMesh *bm,
         }
       }
 
-      /* when false, use without degenerate checks */
       {
         /* run both before checking (since they invalidate surrounding geometry) */
         bool ok_a, ok_b;
@@ -1463,33 +1793,39 @@ void BM_mesh_decimate_collapse(BMesh *bm,
         }
       }
 
-      if (bm_decim_edge_collapse(bm,
-                                 e,
-                                 vquadrics,
-                                 vweights,
-                                 vweight_factor,
-                                 eheap,
-                                 eheap_table,
-                                 edge_symmetry_map,
-                                 customdata_flag,
-                                 optimize_co,
-                                 false)) {
+      BMVert *v_other = bm_decim_edge_collapse(bm,
+                                               e,
+                                               vquadrics,
+                                               vweights,
+                                               eheap,
+                                               eheap_table,
+                                               edge_symmetry_map,
+                                               customdata_flag,
+                                               optimize_co);
+      if (v_other) {
+        bm_decim_cost_update_add_vert(&cost_update, v_other);
+        bm_decim_cost_update_flush(
+            &cost_update, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+
         if (e_mirr && (eheap_table[e_index_mirr])) {
           BLI_assert(e_index_mirr != e_index);
           BLI_heap_remove(eheap, eheap_table[e_index_mirr]);
           eheap_table[e_index_mirr] = NULL;
           optimize_co[symmetry_axis] *= -1.0f;
-          bm_decim_edge_collapse(bm,
-                                 e_mirr,
-                                 vquadrics,
-                                 vweights,
-                                 vweight_factor,
-                                 eheap,
-                                 eheap_table,
-                                 edge_symmetry_map,
-                                 customdata_flag,
-                                 optimize_co,
-                                 false);
+          v_other = bm_decim_edge_collapse(bm,
+                                           e_mirr,
+                                           vquadrics,
+                                           vweights,
+                                           eheap,
+                                           eheap_table,
+                                           edge_symmetry_map,
+                                           customdata_flag,
+                                           optimize_co);
+          if (v_other) {
+            bm_decim_cost_update_add_vert(&cost_update, v_other);
+            bm_decim_cost_update_flush(
+                &cost_update, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+          }
         }
       }
       else {
@@ -1530,6 +1866,7 @@ void BM_mesh_decimate_collapse(BMesh *bm,
 #endif
 
   /* free vars */
+  bm_decim_cost_update_free(&cost_update);
   MEM_freeN(vquadrics);
   MEM_freeN(eheap_table);
   BLI_heap_free(eheap, NULL);
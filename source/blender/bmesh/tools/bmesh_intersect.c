@@ -46,6 +46,7 @@
 
 #include "BLI_kdopbvh.h"
 #include "BLI_buffer.h"
+#include "BLI_task.h"
 
 #include "bmesh.h"
 #include "intern/bmesh_private.h"
@@ -75,6 +76,9 @@
 // #define USE_PARANOID
 /* use accelerated overlap check */
 #define USE_BVH
+/* reject overlapping triangles which can't intersect, calculate the intersections of the others
+ * before cutting (multi-threaded) */
+#define USE_BVH_PRECALC
 
 // #define USE_DUMP
 
@@ -142,6 +146,24 @@ struct LinkBase {
   uint list_len;
 };
 
+/**
+ * Intersection of a triangle edge with another triangle, see #intersect_line_tri.
+ */
+struct ISectEdgeTri {
+  float ix[3];
+  enum ISectType side;
+};
+
+/**
+ * Geometry of an overlapping triangle pair, which only depends on the coordinates of the
+ * original vertices. Calculated in parallel, before #bm_isect_tri_tri changes the mesh.
+ */
+struct ISectTriTriPrecalc {
+  float nor_a[3], nor_b[3];
+  /** Edges of triangle A with triangle B, then edges of B with A. */
+  struct ISectEdgeTri edge_tri[6];
+};
+
 static bool ghash_insert_link(GHash *gh, void *key, void *val, bool use_test, MemArena *mem_arena)
 {
   void **ls_base_p;
@@ -351,6 +373,7 @@ static BMVert *bm_isect_edge_tri(struct ISectState *s,
                                  const int t_index,
                                  const float *t_cos[3],
                                  const float t_nor[3],
+                                 const struct ISectEdgeTri *precalc,
                                  enum ISectType *r_side)
 {
   BMesh *bm = s->bm;
@@ -424,7 +447,15 @@ static BMVert *bm_isect_edge_tri(struct ISectState *s,
     }
   }
 
-  *r_side = intersect_line_tri(e_v0->co, e_v1->co, t_cos, t_nor, ix, &s->epsilon);
+  if (precalc != NULL) {
+    *r_side = precalc->side;
+    if (*r_side != IX_NONE) {
+      copy_v3_v3(ix, precalc->ix);
+    }
+  }
+  else {
+    *r_side = intersect_line_tri(e_v0->co, e_v1->co, t_cos, t_nor, ix, &s->epsilon);
+  }
   if (*r_side != IX_NONE) {
     BMVert *iv;
     BMEdge *e;
@@ -507,9 +538,15 @@ static bool bm_loop_filter_fn(const BMLoop *l, void *user_data)
 
 /**
  * Return true if we have any intersections.
+ *
+ * \param precalc: Geometry calculated in advance, may be NULL.
  */
-static void bm_isect_tri_tri(
-    struct ISectState *s, int a_index, int b_index, BMLoop **a, BMLoop **b)
+static void bm_isect_tri_tri(struct ISectState *s,
+                             int a_index,
+                             int b_index,
+                             BMLoop **a,
+                             BMLoop **b,
+                             const struct ISectTriTriPrecalc *precalc)
 {
   BMFace *f_a = (*a)->f;
   BMFace *f_b = (*b)->f;
@@ -729,8 +766,14 @@ static void bm_isect_tri_tri(
     goto finally;
   }
 
-  normal_tri_v3(f_a_nor, UNPACK3(f_a_cos));
-  normal_tri_v3(f_b_nor, UNPACK3(f_b_cos));
+  if (precalc != NULL) {
+    copy_v3_v3(f_a_nor, precalc->nor_a);
+    copy_v3_v3(f_b_nor, precalc->nor_b);
+  }
+  else {
+    normal_tri_v3(f_a_nor, UNPACK3(f_a_cos));
+    normal_tri_v3(f_b_nor, UNPACK3(f_b_cos));
+  }
 
   /* edge-tri & edge-edge
    * -------------------- */
@@ -745,8 +788,15 @@ static void bm_isect_tri_tri(
         continue;
       }
 
-      iv = bm_isect_edge_tri(
-          s, fv_a[i_a_e0], fv_a[i_a_e1], fv_b, b_index, f_b_cos, f_b_nor, &side);
+      iv = bm_isect_edge_tri(s,
+                             fv_a[i_a_e0],
+                             fv_a[i_a_e1],
+                             fv_b,
+                             b_index,
+                             f_b_cos,
+                             f_b_nor,
+                             precalc ? &precalc->edge_tri[i_a_e0] : NULL,
+                             &side);
       if (iv) {
         STACK_PUSH_TEST_A(iv);
         STACK_PUSH_TEST_B(iv);
@@ -766,8 +816,15 @@ static void bm_isect_tri_tri(
         continue;
       }
 
-      iv = bm_isect_edge_tri(
-          s, fv_b[i_b_e0], fv_b[i_b_e1], fv_a, a_index, f_a_cos, f_a_nor, &side);
+      iv = bm_isect_edge_tri(s,
+                             fv_b[i_b_e0],
+                             fv_b[i_b_e1],
+                             fv_a,
+                             a_index,
+                             f_a_cos,
+                             f_a_nor,
+                             precalc ? &precalc->edge_tri[3 + i_b_e0] : NULL,
+                             &side);
       if (iv) {
         STACK_PUSH_TEST_A(iv);
         STACK_PUSH_TEST_B(iv);
@@ -940,6 +997,193 @@ static int isect_bvhtree_point_v3(BVHTree *tree, const float **looptris, const f
   return num_isect;
 }
 
+#  ifdef USE_BVH_PRECALC
+
+/* Only calculate in parallel when there are enough pairs to make it worth it. */
+#    define BVH_PRECALC_PARALLEL_MIN_ITER 1024
+
+/**
+ * Return true when all corners of the triangle lie on the same side of the plane,
+ * further from it than \a margin.
+ *
+ * Calculated in double precision, with a bound of the rounding error: coordinates far from
+ * the origin compared to the margin must not reject triangles which touch.
+ */
+static bool isect_tri_plane_side_test(const float *t_cos[3],
+                                      const float *plane_cos[3],
+                                      const float margin)
+{
+  double p_cos[3][3], nor[3];
+  for (int i = 0; i < 3; i++) {
+    copy_v3db_v3fl(p_cos[i], plane_cos[i]);
+  }
+
+  double e0[3], e1[3];
+  sub_v3_v3v3_db(e0, p_cos[1], p_cos[0]);
+  sub_v3_v3v3_db(e1, p_cos[2], p_cos[0]);
+  cross_v3_v3v3_db(nor, e0, e1);
+  const double nor_len = sqrt(dot_v3v3_db(nor, nor));
+  if (nor_len == 0.0) {
+    /* Degenerate, can't tell. */
+    return false;
+  }
+
+  int side_pos = 0, side_neg = 0;
+  for (int i = 0; i < 3; i++) {
+    double co[3], d[3];
+    copy_v3db_v3fl(co, t_cos[i]);
+    sub_v3_v3v3_db(d, co, p_cos[0]);
+    const double dist = dot_v3v3_db(nor, d) / nor_len;
+    /* A few ulp of the magnitude of each term, more than the rounding of the subtractions,
+     * cross and dot products. */
+    const double err = 16.0 * DBL_EPSILON *
+                       (fabs(nor[0] * d[0]) + fabs(nor[1] * d[1]) + fabs(nor[2] * d[2])) /
+                       nor_len;
+    if (dist > (double)margin + err) {
+      side_pos++;
+    }
+    else if (dist < -((double)margin + err)) {
+      side_neg++;
+    }
+  }
+  return (side_pos == 3) || (side_neg == 3);
+}
+
+/* Same as the calculation in #bm_isect_edge_tri, which orders the edge vertices first. */
+static void isect_edge_tri_precalc(BMVert *e_v0,
+                                   BMVert *e_v1,
+                                   const float *t_cos[3],
+                                   const float t_nor[3],
+                                   const struct ISectEpsilon *e,
+                                   struct ISectEdgeTri *r_edge_tri)
+{
+  if (BM_elem_index_get(e_v0) > BM_elem_index_get(e_v1)) {
+    SWAP(BMVert *, e_v0, e_v1);
+  }
+  r_edge_tri->side = intersect_line_tri(e_v0->co, e_v1->co, t_cos, t_nor, r_edge_tri->ix, e);
+}
+
+static void isect_tri_tri_precalc(BMLoop **a,
+                                  BMLoop **b,
+                                  const struct ISectEpsilon *e,
+                                  struct ISectTriTriPrecalc *r_precalc)
+{
+  BMVert *fv_a[3] = {UNPACK3_EX(, a, ->v)};
+  BMVert *fv_b[3] = {UNPACK3_EX(, b, ->v)};
+  const float *f_a_cos[3] = {UNPACK3_EX(, fv_a, ->co)};
+  const float *f_b_cos[3] = {UNPACK3_EX(, fv_b, ->co)};
+
+  normal_tri_v3(r_precalc->nor_a, UNPACK3(f_a_cos));
+  normal_tri_v3(r_precalc->nor_b, UNPACK3(f_b_cos));
+
+  for (uint i = 0; i < 3; i++) {
+    const uint i_next = (i + 1) % 3;
+    isect_edge_tri_precalc(
+        fv_a[i], fv_a[i_next], f_b_cos, r_precalc->nor_b, e, &r_precalc->edge_tri[i]);
+    isect_edge_tri_precalc(
+        fv_b[i], fv_b[i_next], f_a_cos, r_precalc->nor_a, e, &r_precalc->edge_tri[3 + i]);
+  }
+}
+
+struct OverlapPrecalcData {
+  BMLoop *(*looptris)[3];
+  const BVHTreeOverlap *overlap;
+  const struct ISectEpsilon *epsilon;
+  /* Filter. */
+  float margin;
+  bool *r_overlap_isect;
+  /* Pairs which may intersect. */
+  const uint *isect_overlap_index;
+  struct ISectTriTriPrecalc *r_isect_precalc;
+};
+
+static void overlap_filter_cb(void *__restrict userdata,
+                              const int i,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct OverlapPrecalcData *data = userdata;
+  BMLoop **a = data->looptris[data->overlap[i].indexA];
+  BMLoop **b = data->looptris[data->overlap[i].indexB];
+  const float *f_a_cos[3] = {UNPACK3_EX(, a, ->v->co)};
+  const float *f_b_cos[3] = {UNPACK3_EX(, b, ->v->co)};
+
+  /* When either triangle is on one side of the plane of the other one, none of the vertex, edge
+   * or face contacts checked by #bm_isect_tri_tri can happen. */
+  data->r_overlap_isect[i] = !(isect_tri_plane_side_test(f_a_cos, f_b_cos, data->margin) ||
+                               isect_tri_plane_side_test(f_b_cos, f_a_cos, data->margin));
+}
+
+static void overlap_precalc_cb(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct OverlapPrecalcData *data = userdata;
+  const BVHTreeOverlap *overlap = &data->overlap[data->isect_overlap_index[i]];
+  isect_tri_tri_precalc(data->looptris[overlap->indexA],
+                        data->looptris[overlap->indexB],
+                        data->epsilon,
+                        &data->r_isect_precalc[i]);
+}
+
+/**
+ * Find the overlapping triangle pairs which may intersect, and calculate their intersections.
+ * Triangles are only read, so unlike cutting, this can run in parallel.
+ *
+ * \param r_isect_overlap_index: Index in \a overlap of each pair which may intersect,
+ * in the order of the overlap.
+ * \return The intersections of each pair which may intersect.
+ */
+static struct ISectTriTriPrecalc *overlap_precalc(BMLoop *(*looptris)[3],
+                                                  const BVHTreeOverlap *overlap,
+                                                  const uint overlap_tot,
+                                                  const struct ISectEpsilon *e,
+                                                  uint **r_isect_overlap_index,
+                                                  uint *r_isect_tot)
+{
+  bool *overlap_isect = MEM_mallocN(sizeof(*overlap_isect) * overlap_tot, __func__);
+
+  struct OverlapPrecalcData data = {
+      .looptris = looptris,
+      .overlap = overlap,
+      .epsilon = e,
+      /* Larger than any distance considered as a contact, with some room for precision loss. */
+      .margin = e->eps_margin * 2.0f,
+      .r_overlap_isect = overlap_isect,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (overlap_tot > BVH_PRECALC_PARALLEL_MIN_ITER);
+  settings.min_iter_per_thread = BVH_PRECALC_PARALLEL_MIN_ITER;
+  BLI_task_parallel_range(0, (int)overlap_tot, &data, overlap_filter_cb, &settings);
+
+  uint isect_tot = 0;
+  for (uint i = 0; i < overlap_tot; i++) {
+    isect_tot += overlap_isect[i];
+  }
+  uint *isect_overlap_index = MEM_mallocN(sizeof(*isect_overlap_index) * isect_tot, __func__);
+  for (uint i = 0, i_isect = 0; i < overlap_tot; i++) {
+    if (overlap_isect[i]) {
+      isect_overlap_index[i_isect++] = i;
+    }
+  }
+  MEM_freeN(overlap_isect);
+
+  struct ISectTriTriPrecalc *isect_precalc = MEM_mallocN(sizeof(*isect_precalc) * isect_tot,
+                                                         __func__);
+  data.isect_overlap_index = isect_overlap_index;
+  data.r_isect_precalc = isect_precalc;
+
+  settings.use_threading = (isect_tot > BVH_PRECALC_PARALLEL_MIN_ITER);
+  BLI_task_parallel_range(0, (int)isect_tot, &data, overlap_precalc_cb, &settings);
+
+  *r_isect_overlap_index = isect_overlap_index;
+  *r_isect_tot = isect_tot;
+  return isect_precalc;
+}
+
+#  endif /* USE_BVH_PRECALC */
+
 #endif /* USE_BVH */
 
 /**
@@ -1095,7 +1339,22 @@ bool BM_mesh_intersect(BMesh *bm,
   if (overlap) {
     uint i;
 
+    const struct ISectTriTriPrecalc *precalc = NULL;
+#  ifdef USE_BVH_PRECALC
+    uint *isect_overlap_index;
+    uint isect_tot, i_isect = 0;
+    struct ISectTriTriPrecalc *isect_precalc = overlap_precalc(
+        looptris, overlap, tree_overlap_tot, &s.epsilon, &isect_overlap_index, &isect_tot);
+#  endif
+
+    /* Cutting modifies the mesh, keep it single threaded and in the order of the overlap. */
     for (i = 0; i < tree_overlap_tot; i++) {
+#  ifdef USE_BVH_PRECALC
+      if ((i_isect == isect_tot) || (isect_overlap_index[i_isect] != i)) {
+        continue;
+      }
+      precalc = &isect_precalc[i_isect++];
+#  endif
 #  ifdef USE_DUMP
       printf("  ((%d, %d), (\n", overlap[i].indexA, overlap[i].indexB);
 #  endif
@@ -1103,11 +1362,16 @@ bool BM_mesh_intersect(BMesh *bm,
                        overlap[i].indexA,
                        overlap[i].indexB,
                        looptris[overlap[i].indexA],
-                       looptris[overlap[i].indexB]);
+                       looptris[overlap[i].indexB],
+                       precalc);
 #  ifdef USE_DUMP
       printf(")),\n");
 #  endif
     }
+#  ifdef USE_BVH_PRECALC
+    MEM_freeN(isect_overlap_index);
+    MEM_freeN(isect_precalc);
+#  endif
     MEM_freeN(overlap);
   }
 
@@ -1140,7 +1404,7 @@ bool BM_mesh_intersect(BMesh *bm,
 #  ifdef USE_DUMP
         printf("  ((%d, %d), (", i_a, i_b);
 #  endif
-        bm_isect_tri_tri(&s, i_a, i_b, looptris[i_a], looptris[i_b]);
+        bm_isect_tri_tri(&s, i_a, i_b, looptris[i_a], looptris[i_b], NULL);
 #  ifdef USE_DUMP
         printf(")),\n");
 #  endif
@@ -62,6 +62,9 @@ eEvaluationMode DEG_get_mode(const Depsgraph *graph);
 /* Get time that depsgraph is being evaluated or was last evaluated at. */
 float DEG_get_ctime(const Depsgraph *graph);
 
+/* Get counter which is changed every time evaluated data of the depsgraph might have changed. */
+int DEG_get_update_count(const Depsgraph *graph);
+
 /* ********************* DEG evaluated data ******************* */
 
 /* Check if given ID type was tagged for update. */
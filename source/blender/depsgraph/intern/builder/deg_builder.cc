@@ -25,6 +25,8 @@
 
 #include <cstring>
 
+#include "MEM_guardedalloc.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_armature_types.h"
 #include "DNA_layer_types.h"
@@ -226,7 +228,8 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
     if (id_node->customdata_masks != id_node->previous_customdata_masks) {
       flag |= ID_RECALC_GEOMETRY;
     }
-    if (!deg_copy_on_write_is_expanded(id_node->id_cow)) {
+    const bool is_new_id = !deg_copy_on_write_is_expanded(id_node->id_cow);
+    if (is_new_id) {
       flag |= ID_RECALC_COPY_ON_WRITE;
       /* This means ID is being added to the dependency graph first
        * time, which is similar to "ob-visible-change" */
@@ -240,6 +243,24 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
     if (flag != 0) {
       graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_RELATIONS);
     }
+    /* Re-evaluate IDs which existed before and whose operations or incoming
+     * relations changed. Everything else keeps its evaluated state from the
+     * previous graph. */
+    if (id_node->previous_relations_signature != nullptr) {
+      if (!is_new_id) {
+        vector<string> relations_signature;
+        id_node->get_relations_signature(&relations_signature);
+        if (relations_signature != *id_node->previous_relations_signature) {
+          id_node->tag_update(graph, DEG_UPDATE_SOURCE_RELATIONS);
+        }
+      }
+      OBJECT_GUARDED_DELETE(id_node->previous_relations_signature, vector<string>);
+      id_node->previous_relations_signature = nullptr;
+    }
+    else if (!is_new_id) {
+      /* No previous state to compare against. */
+      id_node->tag_update(graph, DEG_UPDATE_SOURCE_RELATIONS);
+    }
   }
 }
 
@@ -126,6 +126,9 @@ void free_copy_on_write_datablock(void *id_info_v)
     deg_free_copy_on_write_datablock(id_info->id_cow);
     MEM_freeN(id_info->id_cow);
   }
+  if (id_info->previous_relations_signature != nullptr) {
+    OBJECT_GUARDED_DELETE(id_info->previous_relations_signature, vector<string>);
+  }
   MEM_freeN(id_info);
 }
 
@@ -163,19 +166,23 @@ IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
   IDComponentsMask previously_visible_components_mask = 0;
   uint32_t previous_eval_flags = 0;
   DEGCustomDataMeshMasks previous_customdata_masks;
+  vector<string> *previous_relations_signature = nullptr;
   IDInfo *id_info = (IDInfo *)BLI_ghash_lookup(id_info_hash_, id);
   if (id_info != nullptr) {
     id_cow = id_info->id_cow;
     previously_visible_components_mask = id_info->previously_visible_components_mask;
     previous_eval_flags = id_info->previous_eval_flags;
     previous_customdata_masks = id_info->previous_customdata_masks;
-    /* Tag ID info to not free the CoW ID pointer. */
+    previous_relations_signature = id_info->previous_relations_signature;
+    /* Tag ID info to not free the CoW ID pointer and the signature. */
     id_info->id_cow = nullptr;
+    id_info->previous_relations_signature = nullptr;
   }
   id_node = graph_->add_id_node(id, id_cow);
   id_node->previously_visible_components_mask = previously_visible_components_mask;
   id_node->previous_eval_flags = previous_eval_flags;
   id_node->previous_customdata_masks = previous_customdata_masks;
+  id_node->previous_relations_signature = previous_relations_signature;
   /* Currently all ID nodes are supposed to have copy-on-write logic.
    *
    * NOTE: Zero number of components indicates that ID node was just created. */
@@ -329,6 +336,8 @@ void DepsgraphNodeBuilder::begin_build()
     id_info->previously_visible_components_mask = id_node->visible_components_mask;
     id_info->previous_eval_flags = id_node->eval_flags;
     id_info->previous_customdata_masks = id_node->customdata_masks;
+    id_info->previous_relations_signature = OBJECT_GUARDED_NEW(vector<string>);
+    id_node->get_relations_signature(id_info->previous_relations_signature);
     BLI_ghash_insert(id_info_hash_, id_node->id_orig, id_info);
     id_node->id_cow = nullptr;
   }
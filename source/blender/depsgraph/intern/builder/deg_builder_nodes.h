@@ -231,6 +231,8 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
     uint32_t previous_eval_flags;
     /* Mesh CustomData mask from the previous depsgraph. */
     DEGCustomDataMeshMasks previous_customdata_masks;
+    /* Operations and relations from the previous depsgraph. */
+    vector<string> *previous_relations_signature;
   };
 
  protected:
@@ -78,6 +78,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       scene_cow(nullptr),
       is_active(false),
       is_evaluating(false),
+      update_count(0),
       is_render_pipeline_depsgraph(false)
 {
   BLI_spin_init(&lock);
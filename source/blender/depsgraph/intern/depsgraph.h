@@ -161,6 +161,11 @@ struct Depsgraph {
 
   bool is_evaluating;
 
+  /* Incremented every time evaluated data might have changed (after evaluation and relations
+   * rebuild). Used by caches of evaluated data which live outside of the graph to detect that
+   * they are outdated. */
+  int update_count;
+
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
    * sequencer).
    * Such dependency graph needs all view layers (so render pipeline can access names), but it
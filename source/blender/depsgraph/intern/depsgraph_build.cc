@@ -223,6 +223,8 @@ static void graph_build_finalize_common(DEG::Depsgraph *deg_graph, Main *bmain)
 #endif
   /* Relations are up to date. */
   deg_graph->need_update = false;
+  /* Evaluated datablocks might have been added or removed. */
+  deg_graph->update_count++;
 }
 
 /* Build depsgraph for the given scene layer, and dump results in given graph container. */
@@ -476,11 +478,15 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
    *
-   * TODO(sergey): Try to make it so we don't flush updates
-   * to the whole depsgraph. */
+   * Only the view layer is tagged here: IDs whose operations or relations
+   * are changed by the rebuild are tagged when the build is finalized, so
+   * the rest of the graph keeps its evaluated state. */
   DEG::IDNode *id_node = deg_graph->find_id_node(&deg_graph->scene->id);
   if (id_node != nullptr) {
-    id_node->tag_update(deg_graph, DEG::DEG_UPDATE_SOURCE_RELATIONS);
+    DEG::ComponentNode *comp_node = id_node->find_component(DEG::NodeType::LAYER_COLLECTIONS);
+    if (comp_node != nullptr) {
+      comp_node->tag_update(deg_graph, DEG::DEG_UPDATE_SOURCE_RELATIONS);
+    }
   }
 }
 
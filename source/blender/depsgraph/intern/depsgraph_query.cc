@@ -75,6 +75,12 @@ float DEG_get_ctime(const Depsgraph *graph)
   return deg_graph->ctime;
 }
 
+int DEG_get_update_count(const Depsgraph *graph)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  return deg_graph->update_count;
+}
+
 bool DEG_id_type_updated(const Depsgraph *graph, short id_type)
 {
   const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
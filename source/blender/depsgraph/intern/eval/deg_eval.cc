@@ -419,6 +419,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   if (need_free_scheduler) {
     BLI_task_scheduler_free(task_scheduler);
   }
+  graph->update_count++;
   graph->is_evaluating = false;
 
   graph->debug.end_graph_evaluation();
@@ -24,6 +24,7 @@
 #include "intern/node/deg_node_id.h"
 
 #include <stdio.h>
+#include <algorithm>
 #include <cstring> /* required for STREQ later on. */
 
 #include "BLI_utildefines.h"
@@ -43,7 +44,9 @@ extern "C" {
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node_factory.h"
 #include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
+#include "intern/depsgraph_relation.h"
 
 namespace DEG {
 
@@ -116,6 +119,7 @@ void IDNode::init(const ID *id, const char *UNUSED(subdata))
 
   visible_components_mask = 0;
   previously_visible_components_mask = 0;
+  previous_relations_signature = nullptr;
 
   components = BLI_ghash_new(
       id_deps_node_hash_key, id_deps_node_hash_key_cmp, "Depsgraph id components hash");
@@ -160,6 +164,11 @@ void IDNode::destroy()
 
   BLI_ghash_free(components, id_deps_node_hash_key_free, id_deps_node_hash_value_free);
 
+  if (previous_relations_signature != nullptr) {
+    OBJECT_GUARDED_DELETE(previous_relations_signature, vector<string>);
+    previous_relations_signature = nullptr;
+  }
+
   /* Free memory used by this CoW ID. */
   if (id_cow != id_orig && id_cow != nullptr) {
     deg_free_copy_on_write_datablock(id_cow);
@@ -226,6 +235,45 @@ void IDNode::finalize_build(Depsgraph *graph)
   visible_components_mask = get_visible_components_mask();
 }
 
+/* Identity of the node which stays the same across graph rebuilds. */
+static string id_node_relations_node_key(const Node *node)
+{
+  switch (node->get_class()) {
+    case NodeClass::OPERATION: {
+      const OperationNode *op_node = (const OperationNode *)node;
+      return id_node_relations_node_key(op_node->owner) + "/" +
+             to_string(static_cast<int>(op_node->opcode)) + "/" + op_node->name + "/" +
+             to_string(op_node->name_tag);
+    }
+    case NodeClass::COMPONENT: {
+      const ComponentNode *comp_node = (const ComponentNode *)node;
+      /* The original ID pointer, names are not unique across libraries. */
+      return to_string((uintptr_t)comp_node->owner->id_orig) + "/" +
+             to_string(static_cast<int>(comp_node->type)) + "/" + comp_node->name;
+    }
+    case NodeClass::GENERIC:
+      break;
+  }
+  return node->identifier();
+}
+
+void IDNode::get_relations_signature(vector<string> *r_signature) const
+{
+  r_signature->clear();
+  GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, components) {
+    for (OperationNode *op_node : comp_node->operations) {
+      const string op_key = id_node_relations_node_key(op_node);
+      r_signature->push_back(op_key);
+      for (Relation *rel : op_node->inlinks) {
+        r_signature->push_back(op_key + " <- " + id_node_relations_node_key(rel->from));
+      }
+    }
+  }
+  GHASH_FOREACH_END();
+  /* Components and relations are not stored in a stable order. */
+  std::sort(r_signature->begin(), r_signature->end());
+}
+
 IDComponentsMask IDNode::get_visible_components_mask() const
 {
   IDComponentsMask result = 0;
@@ -72,6 +72,11 @@ struct IDNode : public Node {
 
   IDComponentsMask get_visible_components_mask() const;
 
+  /* Sorted description of all operations of this ID and of the relations
+   * coming into them, which stays the same across graph rebuilds. Used to
+   * detect which IDs were affected by a relations rebuild. */
+  void get_relations_signature(vector<string> *r_signature) const;
+
   /* ID Block referenced. */
   ID *id_orig;
   ID *id_cow;
@@ -107,6 +112,10 @@ struct IDNode : public Node {
   IDComponentsMask visible_components_mask;
   IDComponentsMask previously_visible_components_mask;
 
+  /* Relations signature from the previous state of the dependency graph,
+   * only set while the graph is being built. */
+  vector<string> *previous_relations_signature;
+
   DEG_DEPSNODE_DECLARE;
 };
 
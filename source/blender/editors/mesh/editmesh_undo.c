@@ -30,6 +30,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_array_utils.h"
+#include "BLI_math_vector.h"
 
 #include "BKE_context.h"
 #include "BKE_key.h"
@@ -66,7 +67,13 @@
 #  define USE_ARRAY_STORE_THREAD
 #endif
 
-#ifdef USE_ARRAY_STORE_THREAD
+/**
+ * Store undo steps which don't change topology as differences to the last full state,
+ * see #undomesh_delta_from_editmesh.
+ */
+#define USE_DELTA_UNDO
+
+#if defined(USE_ARRAY_STORE_THREAD) || defined(USE_DELTA_UNDO)
 #  include "BLI_task.h"
 #endif
 
@@ -89,6 +96,11 @@ typedef struct BArrayCustomData {
 
 #endif
 
+#ifdef USE_DELTA_UNDO
+struct UndoMeshBase;
+struct UndoMeshDelta;
+#endif
+
 typedef struct UndoMesh {
   Mesh me;
   int selectmode;
@@ -112,6 +124,13 @@ typedef struct UndoMesh {
   } store;
 #endif /* USE_ARRAY_STORE */
 
+#ifdef USE_DELTA_UNDO
+  /** Full states which delta states can be based on (otherwise NULL). */
+  struct UndoMeshBase *base;
+  /** Delta states only, #me is unused for these. */
+  struct UndoMeshDelta *delta;
+#endif
+
   size_t undo_size;
 } UndoMesh;
 
@@ -498,6 +517,867 @@ static void um_arraystore_free(UndoMesh *um)
 
 #endif /* USE_ARRAY_STORE */
 
+#ifdef USE_DELTA_UNDO
+
+/* -------------------------------------------------------------------- */
+/** \name Delta Undo
+ *
+ * Most undo pushes in edit-mode come from tools which don't change topology
+ * (transform, selection, hiding, marking seams, editing UV's... etc).
+ * Converting the whole mesh for each of these makes every tool slower as the mesh gets bigger.
+ *
+ * Instead, a compact copy of the per-element data of the last full state is kept,
+ * each push compares the edit-mesh against it and only stores the elements that differ.
+ * Any change in topology or custom-data layout falls back to storing a full state.
+ *
+ * Differences are always relative to the full state (not to the previous delta),
+ * so reading a delta state never needs more than the full state and the delta itself.
+ *
+ * Changes are found by comparison instead of being recorded by the tools making them,
+ * since tools (and scripts using the BMesh API) write coordinates, flags and custom-data
+ * directly, there is no single place such changes pass through.
+ * Comparing is a threaded #memcmp per element, cheaper than the #Mesh conversion it replaces,
+ * and the copy compared against is only kept for the most recent full state of each mesh.
+ * \{ */
+
+/** Element flags which are stored in #Mesh data. */
+#  define UM_DELTA_HFLAG_MASK \
+    (BM_ELEM_SELECT | BM_ELEM_HIDDEN | BM_ELEM_SEAM | BM_ELEM_SMOOTH | BM_ELEM_DRAW)
+
+/**
+ * When the differences grow larger than this fraction of the full state,
+ * store a new full state instead.
+ */
+#  define UM_DELTA_SIZE_FACTOR 0.25f
+
+/* Fixed size part of each element record, followed by the element's custom-data block.
+ * Records are compared with #memcmp, so the padding must always be cleared. */
+
+typedef struct UMRecordVert {
+  float co[3];
+  char hflag;
+  char _pad[3];
+} UMRecordVert;
+
+typedef struct UMRecordEdge {
+  int v1, v2;
+  char hflag;
+  char _pad[3];
+} UMRecordEdge;
+
+typedef struct UMRecordLoop {
+  int v;
+} UMRecordLoop;
+
+typedef struct UMRecordFace {
+  int len;
+  short mat_nr;
+  char hflag;
+  char _pad;
+} UMRecordFace;
+
+typedef struct UndoMeshRecords {
+  int len;
+  /** Size of the fixed header of a record. */
+  int header_size;
+  /** Size of the custom-data block of a record. */
+  int cd_size;
+  /** Size of a record, aligned to 4 bytes. */
+  int stride;
+  char *data;
+  /** Element index of each record, only used by delta states. */
+  int *index;
+} UndoMeshRecords;
+
+/** Element data of a full state, only kept for the most recent full state of each mesh. */
+typedef struct UndoMeshShadow {
+  UndoMeshRecords verts, edges, loops, faces;
+  /** Index of the first loop record of each face. */
+  int *face_loop_start;
+  /** Layout of the custom-data (layers only, no data). */
+  CustomData vdata, edata, ldata, pdata;
+} UndoMeshShadow;
+
+/**
+ * A full state which delta states are relative to.
+ *
+ * This is shared between the full state and all delta states based on it,
+ * when the full state is freed first, its data is moved here.
+ */
+typedef struct UndoMeshBase {
+  UndoMesh *um;
+  bool um_is_owned;
+  int users;
+  /** The mesh this state was made from, used to find the base for new undo pushes. */
+  const Mesh *mesh;
+  UndoMeshShadow *shadow;
+} UndoMeshBase;
+
+typedef struct UndoMeshDelta {
+  UndoMeshBase *base;
+  UndoMeshRecords verts, edges, loops, faces;
+  /** The selection history isn't stored per element, it's always stored in full. */
+  MSelect *mselect;
+  int totselect;
+  int act_face;
+} UndoMeshDelta;
+
+static struct {
+  /** #LinkData of #UndoMeshBase, for bases which have a shadow. */
+  ListBase bases;
+} um_delta = {{NULL}};
+
+static void undomesh_free_data(UndoMesh *um);
+
+static void um_records_init(UndoMeshRecords *records, int len, int header_size, int cd_size)
+{
+  records->len = len;
+  records->header_size = header_size;
+  records->cd_size = cd_size;
+  records->stride = header_size + ((cd_size + 3) & ~3);
+  records->data = NULL;
+  records->index = NULL;
+}
+
+static void um_records_free(UndoMeshRecords *records)
+{
+  MEM_SAFE_FREE(records->data);
+  MEM_SAFE_FREE(records->index);
+}
+
+BLI_INLINE char *um_records_elem(const UndoMeshRecords *records, int index)
+{
+  return records->data + ((size_t)index * (size_t)records->stride);
+}
+
+static size_t um_records_size(const UndoMeshRecords *records)
+{
+  return (size_t)records->len * (size_t)records->stride;
+}
+
+/* Record read/write, the header is filled in by the caller. */
+
+BLI_INLINE void um_record_write(const UndoMeshRecords *records,
+                                char *rec,
+                                const void *header,
+                                const void *cd_block)
+{
+  memcpy(rec, header, records->header_size);
+  if (records->cd_size) {
+    memcpy(rec + records->header_size, cd_block, records->cd_size);
+  }
+}
+
+BLI_INLINE bool um_record_equals(const UndoMeshRecords *records,
+                                 const char *rec,
+                                 const void *header,
+                                 const void *cd_block)
+{
+  return (memcmp(rec, header, records->header_size) == 0) &&
+         ((records->cd_size == 0) ||
+          (memcmp(rec + records->header_size, cd_block, records->cd_size) == 0));
+}
+
+BLI_INLINE void um_record_vert_header(UMRecordVert *r, const BMVert *v)
+{
+  memset(r, 0, sizeof(*r));
+  copy_v3_v3(r->co, v->co);
+  r->hflag = v->head.hflag & UM_DELTA_HFLAG_MASK;
+}
+
+BLI_INLINE void um_record_edge_header(UMRecordEdge *r, const BMEdge *e)
+{
+  memset(r, 0, sizeof(*r));
+  r->v1 = BM_elem_index_get(e->v1);
+  r->v2 = BM_elem_index_get(e->v2);
+  r->hflag = e->head.hflag & UM_DELTA_HFLAG_MASK;
+}
+
+BLI_INLINE void um_record_loop_header(UMRecordLoop *r, const BMLoop *l)
+{
+  r->v = BM_elem_index_get(l->v);
+}
+
+BLI_INLINE void um_record_face_header(UMRecordFace *r, const BMFace *f)
+{
+  memset(r, 0, sizeof(*r));
+  r->len = f->len;
+  r->mat_nr = f->mat_nr;
+  r->hflag = f->head.hflag & UM_DELTA_HFLAG_MASK;
+}
+
+static void um_cd_layout_copy(CustomData *dst, const CustomData *src)
+{
+  *dst = *src;
+  dst->layers = src->layers ? MEM_dupallocN(src->layers) : NULL;
+  dst->pool = NULL;
+  dst->external = NULL;
+}
+
+static bool um_cd_layout_equals(const CustomData *a, const CustomData *b)
+{
+  if ((a->totlayer != b->totlayer) || (a->totsize != b->totsize) ||
+      (memcmp(a->typemap, b->typemap, sizeof(a->typemap)) != 0)) {
+    return false;
+  }
+  for (int i = 0; i < a->totlayer; i++) {
+    const CustomDataLayer *layer_a = &a->layers[i], *layer_b = &b->layers[i];
+    if ((layer_a->type != layer_b->type) || (layer_a->offset != layer_b->offset) ||
+        (layer_a->flag != layer_b->flag) || (layer_a->active != layer_b->active) ||
+        (layer_a->active_rnd != layer_b->active_rnd) ||
+        (layer_a->active_clone != layer_b->active_clone) ||
+        (layer_a->active_mask != layer_b->active_mask) || (layer_a->uid != layer_b->uid) ||
+        !STREQ(layer_a->name, layer_b->name)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Custom-data with allocated members (deform-verts, multi-res displacements... etc)
+ * can't be compared or copied as plain memory.
+ */
+static bool um_delta_supported(BMesh *bm, Key *key)
+{
+  /* The active shape-key is restored from the #Mesh data of the full state,
+   * see #undomesh_to_editmesh. */
+  if (key != NULL) {
+    return false;
+  }
+  return !(CustomData_bmesh_has_free(&bm->vdata) || CustomData_bmesh_has_free(&bm->edata) ||
+           CustomData_bmesh_has_free(&bm->ldata) || CustomData_bmesh_has_free(&bm->pdata));
+}
+
+/* -------------------------------------------------------------------- */
+/* Shadow Creation */
+
+typedef struct UMShadowFillData {
+  BMesh *bm;
+  UndoMeshShadow *shadow;
+} UMShadowFillData;
+
+static void um_shadow_fill_verts_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UMShadowFillData *data = userdata;
+  const UndoMeshRecords *records = &data->shadow->verts;
+  const BMVert *v = data->bm->vtable[i];
+  UMRecordVert header;
+  um_record_vert_header(&header, v);
+  um_record_write(records, um_records_elem(records, i), &header, v->head.data);
+}
+
+static void um_shadow_fill_edges_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UMShadowFillData *data = userdata;
+  const UndoMeshRecords *records = &data->shadow->edges;
+  const BMEdge *e = data->bm->etable[i];
+  UMRecordEdge header;
+  um_record_edge_header(&header, e);
+  um_record_write(records, um_records_elem(records, i), &header, e->head.data);
+}
+
+static void um_shadow_fill_faces_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UMShadowFillData *data = userdata;
+  const UndoMeshRecords *records = &data->shadow->faces;
+  const UndoMeshRecords *records_loop = &data->shadow->loops;
+  const BMFace *f = data->bm->ftable[i];
+  UMRecordFace header;
+  um_record_face_header(&header, f);
+  um_record_write(records, um_records_elem(records, i), &header, f->head.data);
+
+  /* Loops are stored in the same order as #BM_mesh_bm_to_me writes them. */
+  int loop_index = data->shadow->face_loop_start[i];
+  const BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    UMRecordLoop header_loop;
+    um_record_loop_header(&header_loop, l_iter);
+    um_record_write(
+        records_loop, um_records_elem(records_loop, loop_index), &header_loop, l_iter->head.data);
+    loop_index++;
+  } while ((l_iter = l_iter->next) != l_first);
+}
+
+static UndoMeshShadow *um_shadow_create(BMesh *bm)
+{
+  UndoMeshShadow *shadow = MEM_callocN(sizeof(*shadow), __func__);
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  um_records_init(&shadow->verts, bm->totvert, sizeof(UMRecordVert), bm->vdata.totsize);
+  um_records_init(&shadow->edges, bm->totedge, sizeof(UMRecordEdge), bm->edata.totsize);
+  um_records_init(&shadow->loops, bm->totloop, sizeof(UMRecordLoop), bm->ldata.totsize);
+  um_records_init(&shadow->faces, bm->totface, sizeof(UMRecordFace), bm->pdata.totsize);
+
+  shadow->verts.data = MEM_mallocN(um_records_size(&shadow->verts), __func__);
+  shadow->edges.data = MEM_mallocN(um_records_size(&shadow->edges), __func__);
+  shadow->loops.data = MEM_mallocN(um_records_size(&shadow->loops), __func__);
+  shadow->faces.data = MEM_mallocN(um_records_size(&shadow->faces), __func__);
+
+  shadow->face_loop_start = MEM_mallocN(sizeof(int) * (size_t)bm->totface, __func__);
+  for (int i = 0, loop_start = 0; i < bm->totface; i++) {
+    shadow->face_loop_start[i] = loop_start;
+    loop_start += bm->ftable[i]->len;
+  }
+
+  um_cd_layout_copy(&shadow->vdata, &bm->vdata);
+  um_cd_layout_copy(&shadow->edata, &bm->edata);
+  um_cd_layout_copy(&shadow->ldata, &bm->ldata);
+  um_cd_layout_copy(&shadow->pdata, &bm->pdata);
+
+  UMShadowFillData data = {
+      .bm = bm,
+      .shadow = shadow,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  BLI_task_parallel_range(0, bm->totvert, &data, um_shadow_fill_verts_cb, &settings);
+  BLI_task_parallel_range(0, bm->totedge, &data, um_shadow_fill_edges_cb, &settings);
+  BLI_task_parallel_range(0, bm->totface, &data, um_shadow_fill_faces_cb, &settings);
+
+  return shadow;
+}
+
+static size_t um_shadow_size(const UndoMeshShadow *shadow)
+{
+  return um_records_size(&shadow->verts) + um_records_size(&shadow->edges) +
+         um_records_size(&shadow->loops) + um_records_size(&shadow->faces);
+}
+
+static void um_shadow_free(UndoMeshShadow *shadow)
+{
+  um_records_free(&shadow->verts);
+  um_records_free(&shadow->edges);
+  um_records_free(&shadow->loops);
+  um_records_free(&shadow->faces);
+  MEM_freeN(shadow->face_loop_start);
+  MEM_SAFE_FREE(shadow->vdata.layers);
+  MEM_SAFE_FREE(shadow->edata.layers);
+  MEM_SAFE_FREE(shadow->ldata.layers);
+  MEM_SAFE_FREE(shadow->pdata.layers);
+  MEM_freeN(shadow);
+}
+
+/* -------------------------------------------------------------------- */
+/* Base Management */
+
+static UndoMeshBase *um_delta_base_find(const Mesh *mesh)
+{
+  LISTBASE_FOREACH (LinkData *, link, &um_delta.bases) {
+    UndoMeshBase *base = link->data;
+    if (base->mesh == mesh) {
+      return base;
+    }
+  }
+  return NULL;
+}
+
+/** Stop using this base for new delta states, existing ones keep using it. */
+static void um_delta_base_shadow_clear(UndoMeshBase *base)
+{
+  if (base->shadow == NULL) {
+    return;
+  }
+  LinkData *link = BLI_findptr(&um_delta.bases, base, offsetof(LinkData, data));
+  BLI_remlink(&um_delta.bases, link);
+  MEM_freeN(link);
+
+  um_shadow_free(base->shadow);
+  base->shadow = NULL;
+}
+
+/**
+ * Make the full state \a um the base for new delta states of \a mesh.
+ */
+static void um_delta_base_add(UndoMesh *um, BMEditMesh *em, Key *key, const Mesh *mesh)
+{
+  UndoMeshBase *base_prev = um_delta_base_find(mesh);
+  if (base_prev) {
+    um_delta_base_shadow_clear(base_prev);
+  }
+
+  if (!um_delta_supported(em->bm, key)) {
+    return;
+  }
+
+  UndoMeshBase *base = MEM_callocN(sizeof(*base), __func__);
+  base->um = um;
+  base->users = 1;
+  base->mesh = mesh;
+  base->shadow = um_shadow_create(em->bm);
+  BLI_addtail(&um_delta.bases, BLI_genericNodeN(base));
+
+  um->base = base;
+}
+
+/**
+ * Release a user of \a base.
+ *
+ * \param um: The full state when it's being freed, NULL when a delta state is freed.
+ * \return true when \a um is still in use, its data now belongs to the base.
+ */
+static bool um_delta_base_release(UndoMeshBase *base, UndoMesh *um)
+{
+  if (um) {
+    um_delta_base_shadow_clear(base);
+  }
+
+  base->users -= 1;
+  BLI_assert(base->users >= 0);
+
+  if (base->users == 0) {
+    if (base->um_is_owned) {
+      UndoMesh *um_owned = base->um;
+      um_owned->base = NULL;
+      undomesh_free_data(um_owned);
+      MEM_freeN(um_owned);
+    }
+    MEM_freeN(base);
+    return false;
+  }
+
+  if (um) {
+    /* Delta states still need the full state, which is freed along with its undo step,
+     * take ownership of its data. */
+    BLI_assert(base->um == um && !base->um_is_owned);
+#  ifdef USE_ARRAY_STORE
+#    ifdef USE_ARRAY_STORE_THREAD
+    /* The array store may still be compacting this state. */
+    BLI_task_pool_work_and_wait(um_arraystore.task_pool);
+#    endif
+#  endif
+    UndoMesh *um_owned = MEM_mallocN(sizeof(*um_owned), __func__);
+    *um_owned = *um;
+#  ifdef USE_ARRAY_STORE
+    LinkData *link = BLI_findptr(&um_arraystore.local_links, um, offsetof(LinkData, data));
+    link->data = um_owned;
+#  endif
+    base->um = um_owned;
+    base->um_is_owned = true;
+    return true;
+  }
+
+  return false;
+}
+
+/* -------------------------------------------------------------------- */
+/* Delta Creation */
+
+typedef struct UMDeltaCompareData {
+  BMesh *bm;
+  const UndoMeshShadow *shadow;
+  char *vert_changed, *edge_changed, *loop_changed, *face_changed;
+  bool topology_changed;
+} UMDeltaCompareData;
+
+/** Per thread, merged into #UMDeltaCompareData.topology_changed by #um_delta_compare_finalize. */
+typedef struct UMDeltaCompareTLS {
+  bool topology_changed;
+} UMDeltaCompareTLS;
+
+static void um_delta_compare_finalize(void *__restrict userdata, void *__restrict userdata_chunk)
+{
+  UMDeltaCompareData *data = userdata;
+  const UMDeltaCompareTLS *data_tls = userdata_chunk;
+  if (data_tls->topology_changed) {
+    data->topology_changed = true;
+  }
+}
+
+static void um_delta_compare_verts_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UMDeltaCompareData *data = userdata;
+  const UndoMeshRecords *records = &data->shadow->verts;
+  const BMVert *v = data->bm->vtable[i];
+  UMRecordVert header;
+  um_record_vert_header(&header, v);
+  data->vert_changed[i] = !um_record_equals(
+      records, um_records_elem(records, i), &header, v->head.data);
+}
+
+static void um_delta_compare_edges_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict tls)
+{
+  UMDeltaCompareData *data = userdata;
+  UMDeltaCompareTLS *data_tls = tls->userdata_chunk;
+  if (data_tls->topology_changed) {
+    return;
+  }
+  const UndoMeshRecords *records = &data->shadow->edges;
+  const BMEdge *e = data->bm->etable[i];
+  const char *rec = um_records_elem(records, i);
+  UMRecordEdge header;
+  um_record_edge_header(&header, e);
+  if ((header.v1 != ((const UMRecordEdge *)rec)->v1) ||
+      (header.v2 != ((const UMRecordEdge *)rec)->v2)) {
+    data_tls->topology_changed = true;
+    return;
+  }
+  data->edge_changed[i] = !um_record_equals(records, rec, &header, e->head.data);
+}
+
+static void um_delta_compare_faces_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict tls)
+{
+  UMDeltaCompareData *data = userdata;
+  UMDeltaCompareTLS *data_tls = tls->userdata_chunk;
+  if (data_tls->topology_changed) {
+    return;
+  }
+  const UndoMeshRecords *records = &data->shadow->faces;
+  const UndoMeshRecords *records_loop = &data->shadow->loops;
+  const BMFace *f = data->bm->ftable[i];
+  const char *rec = um_records_elem(records, i);
+  UMRecordFace header;
+  um_record_face_header(&header, f);
+  if (header.len != ((const UMRecordFace *)rec)->len) {
+    data_tls->topology_changed = true;
+    return;
+  }
+  data->face_changed[i] = !um_record_equals(records, rec, &header, f->head.data);
+
+  int loop_index = data->shadow->face_loop_start[i];
+  const BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    const char *rec_loop = um_records_elem(records_loop, loop_index);
+    UMRecordLoop header_loop;
+    um_record_loop_header(&header_loop, l_iter);
+    if (header_loop.v != ((const UMRecordLoop *)rec_loop)->v) {
+      data_tls->topology_changed = true;
+      return;
+    }
+    data->loop_changed[loop_index] = !um_record_equals(
+        records_loop, rec_loop, &header_loop, l_iter->head.data);
+    loop_index++;
+  } while ((l_iter = l_iter->next) != l_first);
+}
+
+static int um_delta_count_changed(const char *changed, int len)
+{
+  int count = 0;
+  for (int i = 0; i < len; i++) {
+    count += (changed[i] != 0);
+  }
+  return count;
+}
+
+/**
+ * Copy records for changed elements, these are copied from the shadow layout
+ * but filled in with the current data.
+ */
+static void um_delta_records_from_changed(UndoMeshRecords *records,
+                                          const UndoMeshRecords *records_shadow,
+                                          const char *changed,
+                                          int changed_len)
+{
+  um_records_init(records, changed_len, records_shadow->header_size, records_shadow->cd_size);
+  if (changed_len == 0) {
+    return;
+  }
+  records->data = MEM_mallocN(um_records_size(records), __func__);
+  records->index = MEM_mallocN(sizeof(int) * (size_t)changed_len, __func__);
+  for (int i = 0, i_dst = 0; i_dst < changed_len; i++) {
+    if (changed[i]) {
+      records->index[i_dst++] = i;
+    }
+  }
+}
+
+/**
+ * Store \a em as differences to the last full state of \a mesh.
+ *
+ * \return false when this isn't possible (or not worth it), a full state must be stored instead.
+ */
+static bool undomesh_delta_from_editmesh(UndoMesh *um, BMEditMesh *em, Key *key, const Mesh *mesh)
+{
+  BLI_assert(BLI_array_is_zeroed(um, 1));
+  BMesh *bm = em->bm;
+
+  UndoMeshBase *base = um_delta_base_find(mesh);
+  if (base == NULL || !um_delta_supported(bm, key)) {
+    return false;
+  }
+
+  const UndoMeshShadow *shadow = base->shadow;
+  if ((bm->totvert != shadow->verts.len) || (bm->totedge != shadow->edges.len) ||
+      (bm->totloop != shadow->loops.len) || (bm->totface != shadow->faces.len) ||
+      !um_cd_layout_equals(&bm->vdata, &shadow->vdata) ||
+      !um_cd_layout_equals(&bm->edata, &shadow->edata) ||
+      !um_cd_layout_equals(&bm->ldata, &shadow->ldata) ||
+      !um_cd_layout_equals(&bm->pdata, &shadow->pdata)) {
+    return false;
+  }
+
+#  ifdef DEBUG_TIME
+  TIMEIT_START(mesh_undo_delta);
+#  endif
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  UMDeltaCompareData data = {
+      .bm = bm,
+      .shadow = shadow,
+      .vert_changed = MEM_callocN((size_t)bm->totvert, __func__),
+      .edge_changed = MEM_callocN((size_t)bm->totedge, __func__),
+      .loop_changed = MEM_callocN((size_t)bm->totloop, __func__),
+      .face_changed = MEM_callocN((size_t)bm->totface, __func__),
+      .topology_changed = false,
+  };
+
+  UMDeltaCompareTLS data_tls = {.topology_changed = false};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = &data_tls;
+  settings.userdata_chunk_size = sizeof(data_tls);
+  settings.func_finalize = um_delta_compare_finalize;
+
+  BLI_task_parallel_range(0, bm->totedge, &data, um_delta_compare_edges_cb, &settings);
+  if (!data.topology_changed) {
+    BLI_task_parallel_range(0, bm->totface, &data, um_delta_compare_faces_cb, &settings);
+  }
+  if (!data.topology_changed) {
+    BLI_task_parallel_range(0, bm->totvert, &data, um_delta_compare_verts_cb, &settings);
+  }
+
+  bool use_delta = !data.topology_changed;
+  UndoMeshDelta *delta = NULL;
+
+  if (use_delta) {
+    const int vert_changed_len = um_delta_count_changed(data.vert_changed, bm->totvert);
+    const int edge_changed_len = um_delta_count_changed(data.edge_changed, bm->totedge);
+    const int loop_changed_len = um_delta_count_changed(data.loop_changed, bm->totloop);
+    const int face_changed_len = um_delta_count_changed(data.face_changed, bm->totface);
+
+    const size_t delta_size = (size_t)vert_changed_len * shadow->verts.stride +
+                              (size_t)edge_changed_len * shadow->edges.stride +
+                              (size_t)loop_changed_len * shadow->loops.stride +
+                              (size_t)face_changed_len * shadow->faces.stride;
+    use_delta = delta_size <= (size_t)(um_shadow_size(shadow) * UM_DELTA_SIZE_FACTOR);
+
+    if (use_delta) {
+      delta = MEM_callocN(sizeof(*delta), __func__);
+      um_delta_records_from_changed(
+          &delta->verts, &shadow->verts, data.vert_changed, vert_changed_len);
+      um_delta_records_from_changed(
+          &delta->edges, &shadow->edges, data.edge_changed, edge_changed_len);
+      um_delta_records_from_changed(
+          &delta->loops, &shadow->loops, data.loop_changed, loop_changed_len);
+      um_delta_records_from_changed(
+          &delta->faces, &shadow->faces, data.face_changed, face_changed_len);
+    }
+  }
+
+  MEM_freeN(data.vert_changed);
+  MEM_freeN(data.edge_changed);
+  MEM_freeN(data.loop_changed);
+  MEM_freeN(data.face_changed);
+
+  if (!use_delta) {
+#  ifdef DEBUG_TIME
+    TIMEIT_END(mesh_undo_delta);
+#  endif
+    return false;
+  }
+
+  for (int i = 0; i < delta->verts.len; i++) {
+    const BMVert *v = bm->vtable[delta->verts.index[i]];
+    UMRecordVert header;
+    um_record_vert_header(&header, v);
+    um_record_write(&delta->verts, um_records_elem(&delta->verts, i), &header, v->head.data);
+  }
+  for (int i = 0; i < delta->edges.len; i++) {
+    const BMEdge *e = bm->etable[delta->edges.index[i]];
+    UMRecordEdge header;
+    um_record_edge_header(&header, e);
+    um_record_write(&delta->edges, um_records_elem(&delta->edges, i), &header, e->head.data);
+  }
+  for (int i = 0; i < delta->faces.len; i++) {
+    const BMFace *f = bm->ftable[delta->faces.index[i]];
+    UMRecordFace header;
+    um_record_face_header(&header, f);
+    um_record_write(&delta->faces, um_records_elem(&delta->faces, i), &header, f->head.data);
+  }
+  if (delta->loops.len) {
+    /* Loops have no table, walk over faces in order to find the changed ones. */
+    int loop_index = 0, i_loop = 0;
+    for (int i = 0; i < bm->totface && i_loop < delta->loops.len; i++) {
+      const BMFace *f = bm->ftable[i];
+      const BMLoop *l_iter, *l_first;
+      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+      do {
+        if (loop_index == delta->loops.index[i_loop]) {
+          UMRecordLoop header;
+          um_record_loop_header(&header, l_iter);
+          um_record_write(&delta->loops,
+                          um_records_elem(&delta->loops, i_loop),
+                          &header,
+                          l_iter->head.data);
+          i_loop++;
+        }
+        loop_index++;
+      } while (((l_iter = l_iter->next) != l_first) && (i_loop < delta->loops.len));
+    }
+  }
+
+  delta->totselect = BLI_listbase_count(&bm->selected);
+  if (delta->totselect) {
+    delta->mselect = MEM_mallocN(sizeof(*delta->mselect) * (size_t)delta->totselect, __func__);
+    MSelect *msel = delta->mselect;
+    LISTBASE_FOREACH (BMEditSelection *, ese, &bm->selected) {
+      msel->index = BM_elem_index_get(ese->ele);
+      msel->type = ese->htype;
+      msel++;
+    }
+  }
+  delta->act_face = bm->act_face ? BM_elem_index_get(bm->act_face) : -1;
+
+  delta->base = base;
+  base->users += 1;
+
+  um->delta = delta;
+  um->selectmode = em->selectmode;
+  um->shapenr = bm->shapenr;
+  um->undo_size = sizeof(*delta) + um_records_size(&delta->verts) +
+                  um_records_size(&delta->edges) + um_records_size(&delta->loops) +
+                  um_records_size(&delta->faces);
+
+#  ifdef DEBUG_TIME
+  TIMEIT_END(mesh_undo_delta);
+#  endif
+
+  return true;
+}
+
+/* -------------------------------------------------------------------- */
+/* Delta Loading */
+
+BLI_INLINE void um_delta_hflag_apply(BMHeader *head, const char hflag, int *totsel)
+{
+  if ((head->hflag & BM_ELEM_SELECT) != (hflag & BM_ELEM_SELECT)) {
+    *totsel += (hflag & BM_ELEM_SELECT) ? 1 : -1;
+  }
+  head->hflag = (head->hflag & ~UM_DELTA_HFLAG_MASK) | hflag;
+}
+
+/**
+ * Apply the differences stored in \a delta to \a bm, loaded from the delta's full state.
+ */
+static void undomesh_delta_apply(const UndoMeshDelta *delta, BMesh *bm)
+{
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  for (int i = 0; i < delta->verts.len; i++) {
+    BMVert *v = bm->vtable[delta->verts.index[i]];
+    const char *rec = um_records_elem(&delta->verts, i);
+    const UMRecordVert *header = (const UMRecordVert *)rec;
+    copy_v3_v3(v->co, header->co);
+    um_delta_hflag_apply(&v->head, header->hflag, &bm->totvertsel);
+    if (delta->verts.cd_size) {
+      memcpy(v->head.data, rec + delta->verts.header_size, delta->verts.cd_size);
+    }
+  }
+
+  for (int i = 0; i < delta->edges.len; i++) {
+    BMEdge *e = bm->etable[delta->edges.index[i]];
+    const char *rec = um_records_elem(&delta->edges, i);
+    const UMRecordEdge *header = (const UMRecordEdge *)rec;
+    um_delta_hflag_apply(&e->head, header->hflag, &bm->totedgesel);
+    if (delta->edges.cd_size) {
+      memcpy(e->head.data, rec + delta->edges.header_size, delta->edges.cd_size);
+    }
+  }
+
+  for (int i = 0; i < delta->faces.len; i++) {
+    BMFace *f = bm->ftable[delta->faces.index[i]];
+    const char *rec = um_records_elem(&delta->faces, i);
+    const UMRecordFace *header = (const UMRecordFace *)rec;
+    f->mat_nr = header->mat_nr;
+    um_delta_hflag_apply(&f->head, header->hflag, &bm->totfacesel);
+    if (delta->faces.cd_size) {
+      memcpy(f->head.data, rec + delta->faces.header_size, delta->faces.cd_size);
+    }
+  }
+
+  if (delta->loops.len && delta->loops.cd_size) {
+    int loop_index = 0, i_loop = 0;
+    for (int i = 0; i < bm->totface && i_loop < delta->loops.len; i++) {
+      BMFace *f = bm->ftable[i];
+      BMLoop *l_iter, *l_first;
+      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+      do {
+        if (loop_index == delta->loops.index[i_loop]) {
+          const char *rec = um_records_elem(&delta->loops, i_loop);
+          memcpy(l_iter->head.data, rec + delta->loops.header_size, delta->loops.cd_size);
+          i_loop++;
+        }
+        loop_index++;
+      } while (((l_iter = l_iter->next) != l_first) && (i_loop < delta->loops.len));
+    }
+  }
+
+  BM_select_history_clear(bm);
+  for (int i = 0; i < delta->totselect; i++) {
+    const MSelect *msel = &delta->mselect[i];
+    BMElem *ele = NULL;
+    switch (msel->type) {
+      case BM_VERT:
+        ele = (BMElem *)bm->vtable[msel->index];
+        break;
+      case BM_EDGE:
+        ele = (BMElem *)bm->etable[msel->index];
+        break;
+      case BM_FACE:
+        ele = (BMElem *)bm->ftable[msel->index];
+        break;
+    }
+    if (ele) {
+      BM_select_history_store_notest(bm, ele);
+    }
+  }
+
+  bm->act_face = (delta->act_face != -1) ? bm->ftable[delta->act_face] : NULL;
+
+  if (delta->verts.len) {
+    BM_mesh_normals_update(bm);
+  }
+}
+
+static void undomesh_delta_free(UndoMesh *um)
+{
+  UndoMeshDelta *delta = um->delta;
+  um_records_free(&delta->verts);
+  um_records_free(&delta->edges);
+  um_records_free(&delta->loops);
+  um_records_free(&delta->faces);
+  MEM_SAFE_FREE(delta->mselect);
+  um_delta_base_release(delta->base, NULL);
+  MEM_freeN(delta);
+  um->delta = NULL;
+}
+
+/** \} */
+
+#endif /* USE_DELTA_UNDO */
+
 /* for callbacks */
 /* undo simply makes copies of a bmesh */
 static void *undomesh_from_editmesh(UndoMesh *um, BMEditMesh *em, Key *key)
@@ -565,6 +1445,14 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
   BMEditMesh *em_tmp;
   BMesh *bm;
 
+  /* The state holding the mesh data, for delta states this is the state they're based on. */
+  UndoMesh *um_full = um;
+#ifdef USE_DELTA_UNDO
+  if (um->delta) {
+    um_full = um->delta->base->um;
+  }
+#endif
+
 #ifdef USE_ARRAY_STORE
 #  ifdef USE_ARRAY_STORE_THREAD
   /* changes this waits is low, but must have finished */
@@ -575,14 +1463,14 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
   TIMEIT_START(mesh_undo_expand);
 #  endif
 
-  um_arraystore_expand(um);
+  um_arraystore_expand(um_full);
 
 #  ifdef DEBUG_TIME
   TIMEIT_END(mesh_undo_expand);
 #  endif
 #endif /* USE_ARRAY_STORE */
 
-  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(&um->me);
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(&um_full->me);
 
   em->bm->shapenr = um->shapenr;
 
@@ -594,12 +1482,18 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
                       }));
 
   BM_mesh_bm_from_me(bm,
-                     &um->me,
+                     &um_full->me,
                      (&(struct BMeshFromMeshParams){
                          .calc_face_normal = true,
                          .active_shapekey = um->shapenr,
                      }));
 
+#ifdef USE_DELTA_UNDO
+  if (um->delta) {
+    undomesh_delta_apply(um->delta, bm);
+  }
+#endif
+
   em_tmp = BKE_editmesh_create(bm, true);
   *em = *em_tmp;
 
@@ -620,14 +1514,14 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
     if (BKE_keyblock_is_basis(key, kb_act_idx)) {
       KeyBlock *kb_act = BLI_findlink(&key->block, kb_act_idx);
 
-      if (kb_act->totelem != um->me.totvert) {
+      if (kb_act->totelem != um_full->me.totvert) {
         /* The current mesh has some extra/missing verts compared to the undo, adjust. */
         MEM_SAFE_FREE(kb_act->data);
         kb_act->data = MEM_mallocN((size_t)(key->elemsize * bm->totvert), __func__);
-        kb_act->totelem = um->me.totvert;
+        kb_act->totelem = um_full->me.totvert;
       }
 
-      BKE_keyblock_update_from_mesh(&um->me, kb_act);
+      BKE_keyblock_update_from_mesh(&um_full->me, kb_act);
     }
   }
 
@@ -636,7 +1530,7 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
   MEM_freeN(em_tmp);
 
 #ifdef USE_ARRAY_STORE
-  um_arraystore_expand_clear(um);
+  um_arraystore_expand_clear(um_full);
 #endif
 }
 
@@ -644,6 +1538,20 @@ static void undomesh_free_data(UndoMesh *um)
 {
   Mesh *me = &um->me;
 
+#ifdef USE_DELTA_UNDO
+  if (um->delta) {
+    undomesh_delta_free(um);
+    return;
+  }
+  if (um->base) {
+    if (um_delta_base_release(um->base, um)) {
+      /* Delta states still use this data, it's freed along with the last of them. */
+      return;
+    }
+    um->base = NULL;
+  }
+#endif
+
 #ifdef USE_ARRAY_STORE
 
 #  ifdef USE_ARRAY_STORE_THREAD
@@ -728,7 +1636,14 @@ static bool mesh_undosys_step_encode(struct bContext *C, struct Main *bmain, Und
     elem->obedit_ref.ptr = ob;
     Mesh *me = elem->obedit_ref.ptr->data;
     BMEditMesh *em = me->edit_mesh;
+#ifdef USE_DELTA_UNDO
+    if (!undomesh_delta_from_editmesh(&elem->data, em, me->key, me)) {
+      undomesh_from_editmesh(&elem->data, em, me->key);
+      um_delta_base_add(&elem->data, em, me->key, me);
+    }
+#else
     undomesh_from_editmesh(&elem->data, me->edit_mesh, me->key);
+#endif
     em->needs_flush_to_id = 1;
     us->step.data_size += elem->data.undo_size;
   }
@@ -196,7 +196,9 @@ typedef struct ClothCollSettings {
   short self_loop_count DNA_DEPRECATED;
   /** How many iterations for the collision loop. */
   short loop_count;
-  char _pad[4];
+  /** Method to find colliding pairs, see #CLOTH_COLLISION_BROADPHASE. */
+  char broadphase;
+  char _pad[3];
   /** Only use colliders from this group of objects. */
   struct Collection *group;
   /** Vgroup to paint which vertices are used for self collisions. */
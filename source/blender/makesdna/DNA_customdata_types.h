@@ -54,6 +54,8 @@ typedef struct CustomDataLayer {
   char name[64];
   /** Layer data. */
   void *data;
+  /** Runtime: storage of data which is used by multiple layers, freed by the last user. */
+  struct CustomDataShared *shared;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -83,6 +83,8 @@ typedef struct Mesh_Runtime {
    * Since modifier stack evaluation is threaded on object level we need some synchronization. */
   struct Mesh *mesh_eval;
   void *eval_mutex;
+  /* Results of modifier stacks shared by objects using this mesh, see #MeshSharedEval. */
+  ListBase shared_evals;
 
   struct EditMeshData *edit_data;
   void *batch_cache;
@@ -500,6 +500,8 @@ typedef struct SoftBody {
 #define PTCACHE_IGNORE_CLEAR (1 << 13)
 
 #define PTCACHE_FLAG_INFO_DIRTY (1 << 14)
+/** Baked disk cache frames are stored in packs of multiple frames. */
+#define PTCACHE_PACKED (1 << 15)
 
 /* PTCACHE_OUTDATED + PTCACHE_FRAMES_SKIPPED */
 #define PTCACHE_REDO_NEEDED 258
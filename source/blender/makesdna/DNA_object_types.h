@@ -185,6 +185,20 @@ typedef struct Object_Runtime {
 
   unsigned short local_collections_bits;
   short _pad2[3];
+
+  /**
+   * Instances generated by this object (list of DupliObject), kept around between redraws
+   * and shared by all the consumers iterating over the same evaluated object.
+   * Rebuilt when the dependency graph was updated since it was generated.
+   */
+  struct ListBase *duplilist_cache;
+  /** Dependency graph update counter #duplilist_cache was generated for. */
+  int duplilist_cache_update_count;
+  char _pad5[4];
+
+  /** Results of modifiers kept around to skip their evaluation when their input did not change,
+   * see modifier_cache.c. */
+  struct ModifierResultCache *modifier_cache;
 } Object_Runtime;
 
 typedef struct Object {
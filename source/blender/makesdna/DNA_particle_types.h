@@ -629,6 +629,7 @@ typedef enum eParticleShapeFlag {
 #define PARS_NO_DISP 2
 //#define PARS_STICKY           4 /* deprecated */
 #define PARS_REKEY 8
+#define PARS_PATH_CHANGED 16 /* runtime flag, path changed in the last path cache update */
 
 /* pars->alive */
 //#define PARS_KILLED           0 /* deprecated */
@@ -30,6 +30,7 @@
 struct Collection;
 
 struct EffectorWeights;
+struct RigidBodyTransformCache;
 
 /* ******************************** */
 /* RigidBody World */
@@ -43,6 +44,8 @@ typedef struct RigidBodyWorld_Shared {
   /* References to Physics Sim objects. Exist at runtime only ---------------------- */
   /** Physics sim world (i.e. btDiscreteDynamicsWorld). */
   void *physics_world;
+  /** Simulated transforms of all bodies per frame, for fast playback. */
+  struct RigidBodyTransformCache *transform_cache;
 } RigidBodyWorld_Shared;
 
 /* RigidBodyWorld (rbw)
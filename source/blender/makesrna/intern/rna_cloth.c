@@ -1056,6 +1056,20 @@ static void rna_def_cloth_collision_settings(BlenderRNA *brna)
   StructRNA *srna;
   PropertyRNA *prop;
 
+  static const EnumPropertyItem prop_broadphase_items[] = {
+      {CLOTH_COLLISION_BROADPHASE_BVH,
+       "BVH",
+       0,
+       "BVH Tree",
+       "Find colliding faces using bounding volume hierarchies"},
+      {CLOTH_COLLISION_BROADPHASE_GRID,
+       "GRID",
+       0,
+       "Spatial Hash",
+       "Find colliding faces using a uniform grid, faster for dense self colliding cloth"},
+      {0, NULL, 0, NULL, NULL},
+  };
+
   srna = RNA_def_struct(brna, "ClothCollisionSettings", NULL);
   RNA_def_struct_ui_text(
       srna,
@@ -1103,6 +1117,22 @@ static void rna_def_cloth_collision_settings(BlenderRNA *brna)
       "How many collision iterations should be done. (higher is better quality but slower)");
   RNA_def_property_update(prop, 0, "rna_cloth_update");
 
+  prop = RNA_def_property(srna, "collision_broadphase", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "broadphase");
+  RNA_def_property_enum_items(prop, prop_broadphase_items);
+  RNA_def_property_ui_text(
+      prop, "Broadphase", "Method used to find faces which may collide with each other");
+  RNA_def_property_update(prop, 0, "rna_cloth_update");
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+
+  prop = RNA_def_property(srna, "use_continuous_collision", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flags", CLOTH_COLLSETTINGS_FLAG_CONTINUOUS);
+  RNA_def_property_ui_text(prop,
+                           "Continuous",
+                           "Detect faces passing through each other during a collision step "
+                           "(slower, avoids tunneling of fast moving cloth)");
+  RNA_def_property_update(prop, 0, "rna_cloth_update");
+
   prop = RNA_def_property(srna, "impulse_clamp", PROP_FLOAT, PROP_NONE);
   RNA_def_property_float_sdna(prop, NULL, "clamp");
   RNA_def_property_range(prop, 0.0f, 100.0f);
@@ -792,6 +792,14 @@ static void rna_def_render_engine(BlenderRNA *brna)
   prop = RNA_def_property(srna, "is_preview", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", RE_ENGINE_PREVIEW);
 
+  prop = RNA_def_property(srna, "is_depsgraph_reused", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", RE_ENGINE_DEPSGRAPH_REUSED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Depsgraph Reused",
+                           "The dependency graph was kept from the previous render with "
+                           "persistent data, and only reports changes made since then");
+
   prop = RNA_def_property(srna, "camera_override", PROP_POINTER, PROP_NONE);
   RNA_def_property_pointer_funcs(prop, "rna_RenderEngine_camera_override_get", NULL, NULL, NULL);
   RNA_def_property_struct_type(prop, "Object");
@@ -259,7 +259,8 @@ ModifierTypeInfo modifierType_Bevel = {
     /* structSize */ sizeof(BevelModifierData),
     /* type */ eModifierTypeType_Constructive,
     /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode |
-        eModifierTypeFlag_EnableInEditmode | eModifierTypeFlag_AcceptsCVs,
+        eModifierTypeFlag_EnableInEditmode | eModifierTypeFlag_AcceptsCVs |
+        eModifierTypeFlag_SupportsResultCache,
     /* copyData */ copyData,
     /* deformVerts */ NULL,
     /* deformMatrices */ NULL,
@@ -134,7 +134,7 @@ ModifierTypeInfo modifierType_EdgeSplit = {
     /* type */ eModifierTypeType_Constructive,
     /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_AcceptsCVs |
         eModifierTypeFlag_SupportsMapping | eModifierTypeFlag_SupportsEditmode |
-        eModifierTypeFlag_EnableInEditmode,
+        eModifierTypeFlag_EnableInEditmode | eModifierTypeFlag_SupportsResultCache,
 
     /* copyData */ modifier_copyData_generic,
 
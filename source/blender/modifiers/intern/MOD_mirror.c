@@ -120,7 +120,7 @@ ModifierTypeInfo modifierType_Mirror = {
     /* type */ eModifierTypeType_Constructive,
     /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsMapping |
         eModifierTypeFlag_SupportsEditmode | eModifierTypeFlag_EnableInEditmode |
-        eModifierTypeFlag_AcceptsCVs |
+        eModifierTypeFlag_AcceptsCVs | eModifierTypeFlag_SupportsResultCache |
         /* this is only the case when 'MOD_MIR_VGROUP' is used */
         eModifierTypeFlag_UsesPreview,
 
@@ -1933,7 +1933,8 @@ ModifierTypeInfo modifierType_Skin = {
     /* structName */ "SkinModifierData",
     /* structSize */ sizeof(SkinModifierData),
     /* type */ eModifierTypeType_Constructive,
-    /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode,
+    /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode |
+        eModifierTypeFlag_SupportsResultCache,
 
     /* copyData */ modifier_copyData_generic,
 
@@ -282,7 +282,7 @@ ModifierTypeInfo modifierType_Subsurf = {
     /* type */ eModifierTypeType_Constructive,
     /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsMapping |
         eModifierTypeFlag_SupportsEditmode | eModifierTypeFlag_EnableInEditmode |
-        eModifierTypeFlag_AcceptsCVs,
+        eModifierTypeFlag_AcceptsCVs | eModifierTypeFlag_SupportsResultCache,
 
     /* copyData */ copyData,
 
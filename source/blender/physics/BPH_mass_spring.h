@@ -53,6 +53,10 @@ int BPH_cloth_solve(struct Depsgraph *depsgraph,
                     struct ClothModifierData *clmd,
                     struct ListBase *effectors);
 void BKE_cloth_solver_set_positions(struct ClothModifierData *clmd);
+/* Accumulate the forces of all active springs into the solver data.
+ * Without use_groups all springs are computed from a single thread in their original order,
+ * which is the reference for the grouped multi-threaded path. */
+void BPH_cloth_calc_spring_forces(struct ClothModifierData *clmd, bool use_groups);
 void BKE_cloth_solver_set_volume(ClothModifierData *clmd);
 
 #ifdef __cplusplus
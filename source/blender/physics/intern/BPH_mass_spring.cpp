@@ -32,7 +32,9 @@ extern "C" {
 #include "DNA_modifier_types.h"
 
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -48,6 +50,31 @@ extern "C" {
 
 static float I3[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
 
+/* Spring count of a group from which its forces are computed from multiple threads. */
+#define CLOTH_PARALLEL_SPRINGS_LIMIT 1024
+
+/* Springs between two vertices, split into groups of springs which don't share any vertex.
+ * Forces of all springs of a group can be computed at the same time from multiple threads.
+ *
+ * Remaining springs (the ones acting on more than two vertices, or which don't fit into any
+ * group) are computed from a single thread afterwards. */
+typedef struct ClothSpringGroups {
+  /* Grouped springs, ordered by group. */
+  ClothSpring **springs;
+  /* Matrix block of every grouped spring, added at every step before computing the forces. */
+  int *blocks;
+  int num_springs;
+  /* Offset of every group in the springs array, num_groups + 1 items. */
+  int *group_offsets;
+  int num_groups;
+
+  ClothSpring **serial_springs;
+  int num_serial_springs;
+
+  /* Angular bending springs act on polygons, so grouping depends on the bending model. */
+  bool using_angular;
+} ClothSpringGroups;
+
 /* Number of off-diagonal non-zero matrix blocks.
  * Basically there is one of these for each vertex-vertex interaction.
  */
@@ -141,6 +168,15 @@ int BPH_cloth_solver_init(Object *UNUSED(ob), ClothModifierData *clmd)
   return 1;
 }
 
+static void cloth_spring_groups_free(ClothSpringGroups *groups)
+{
+  MEM_freeN(groups->springs);
+  MEM_freeN(groups->blocks);
+  MEM_freeN(groups->group_offsets);
+  MEM_freeN(groups->serial_springs);
+  MEM_freeN(groups);
+}
+
 void BPH_cloth_solver_free(ClothModifierData *clmd)
 {
   Cloth *cloth = clmd->clothObject;
@@ -149,6 +185,10 @@ void BPH_cloth_solver_free(ClothModifierData *clmd)
     BPH_mass_spring_solver_free(cloth->implicit);
     cloth->implicit = NULL;
   }
+  if (cloth->spring_groups) {
+    cloth_spring_groups_free(cloth->spring_groups);
+    cloth->spring_groups = NULL;
+  }
 }
 
 void BKE_cloth_solver_set_positions(ClothModifierData *clmd)
@@ -294,7 +334,8 @@ static int UNUSED_FUNCTION(cloth_calc_helper_forces)(Object *UNUSED(ob),
   return 1;
 }
 
-BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
+/* The block is the matrix block added for the spring beforehand, or -1. */
+BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s, int block)
 {
   Cloth *cloth = clmd->clothObject;
   ClothSimSettings *parms = clmd->sim_parms;
@@ -340,6 +381,7 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
       BPH_mass_spring_force_spring_linear(data,
                                           s->ij,
                                           s->kl,
+                                          block,
                                           s->restlen,
                                           k_tension,
                                           parms->tension_damp,
@@ -358,6 +400,7 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
       BPH_mass_spring_force_spring_linear(data,
                                           s->ij,
                                           s->kl,
+                                          block,
                                           s->restlen,
                                           k_tension,
                                           parms->tension_damp,
@@ -396,6 +439,7 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
       BPH_mass_spring_force_spring_linear(data,
                                           s->ij,
                                           s->kl,
+                                          block,
                                           s->restlen,
                                           k_tension,
                                           k_tension_damp,
@@ -419,6 +463,7 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
     BPH_mass_spring_force_spring_linear(data,
                                         s->ij,
                                         s->kl,
+                                        block,
                                         s->restlen,
                                         k,
                                         parms->shear_damp,
@@ -441,7 +486,7 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
     // Fix for [#45084] for cloth stiffness must have cb proportional to kb
     cb = kb * parms->bending_damping;
 
-    BPH_mass_spring_force_spring_bending(data, s->ij, s->kl, s->restlen, kb, cb);
+    BPH_mass_spring_force_spring_bending(data, s->ij, s->kl, block, s->restlen, kb, cb);
 #endif
   }
   else if (s->type & CLOTH_SPRING_TYPE_BENDING_HAIR) {
@@ -487,6 +532,169 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
   }
 }
 
+/* Whether the force of the spring only acts on its two end points. */
+static bool cloth_spring_is_two_point(const ClothSpring *spring, bool using_angular)
+{
+  if (spring->type & CLOTH_SPRING_TYPE_BENDING_HAIR) {
+    return false;
+  }
+  if ((spring->type & CLOTH_SPRING_TYPE_BENDING) && using_angular) {
+    return false;
+  }
+  return true;
+}
+
+static ClothSpringGroups *cloth_spring_groups_create(Cloth *cloth, bool using_angular)
+{
+  /* Group assignment is greedy, every spring goes into the first group which doesn't contain
+   * any of its vertices yet. Bits of vert_groups store which groups use the vertex. */
+  const int max_groups = sizeof(unsigned int) * 8;
+  const int num_springs = BLI_linklist_count(cloth->springs);
+  unsigned int *vert_groups = (unsigned int *)MEM_calloc_arrayN(
+      cloth->mvert_num, sizeof(unsigned int), __func__);
+  int *spring_group = (int *)MEM_malloc_arrayN(max_ii(num_springs, 1), sizeof(int), __func__);
+  int group_sizes[sizeof(unsigned int) * 8] = {0};
+  int num_serial_springs = 0;
+
+  int spring_index = 0;
+  for (LinkNode *link = cloth->springs; link; link = link->next, spring_index++) {
+    ClothSpring *spring = (ClothSpring *)link->link;
+    spring_group[spring_index] = -1;
+    if (!cloth_spring_is_two_point(spring, using_angular)) {
+      num_serial_springs++;
+      continue;
+    }
+    const unsigned int used = vert_groups[spring->ij] | vert_groups[spring->kl];
+    if (used == ~0u) {
+      num_serial_springs++;
+      continue;
+    }
+    const int group = (int)bitscan_forward_uint(~used);
+    vert_groups[spring->ij] |= (1u << group);
+    vert_groups[spring->kl] |= (1u << group);
+    spring_group[spring_index] = group;
+    group_sizes[group]++;
+  }
+
+  ClothSpringGroups *groups = (ClothSpringGroups *)MEM_callocN(sizeof(*groups), __func__);
+  groups->using_angular = using_angular;
+  groups->num_springs = spring_index - num_serial_springs;
+  groups->springs = (ClothSpring **)MEM_malloc_arrayN(
+      max_ii(groups->num_springs, 1), sizeof(ClothSpring *), __func__);
+  groups->blocks = (int *)MEM_malloc_arrayN(max_ii(groups->num_springs, 1), sizeof(int), __func__);
+  groups->serial_springs = (ClothSpring **)MEM_malloc_arrayN(
+      max_ii(num_serial_springs, 1), sizeof(ClothSpring *), __func__);
+
+  for (int group = 0; group < max_groups && group_sizes[group] != 0; group++) {
+    groups->num_groups++;
+  }
+  groups->group_offsets = (int *)MEM_calloc_arrayN(
+      groups->num_groups + 1, sizeof(int), __func__);
+  for (int group = 0; group < groups->num_groups; group++) {
+    groups->group_offsets[group + 1] = groups->group_offsets[group] + group_sizes[group];
+    /* Use as insertion cursor. */
+    group_sizes[group] = groups->group_offsets[group];
+  }
+
+  /* Keep original spring order within groups, so results are deterministic. */
+  spring_index = 0;
+  for (LinkNode *link = cloth->springs; link; link = link->next, spring_index++) {
+    ClothSpring *spring = (ClothSpring *)link->link;
+    const int group = spring_group[spring_index];
+    if (group == -1) {
+      groups->serial_springs[groups->num_serial_springs++] = spring;
+    }
+    else {
+      groups->springs[group_sizes[group]++] = spring;
+    }
+  }
+
+  MEM_freeN(vert_groups);
+  MEM_freeN(spring_group);
+
+  return groups;
+}
+
+typedef struct ClothSpringForceData {
+  ClothModifierData *clmd;
+  ClothSpringGroups *groups;
+} ClothSpringForceData;
+
+static void cloth_calc_spring_force_cb(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ClothSpringForceData *data = (ClothSpringForceData *)userdata;
+  ClothSpring *spring = data->groups->springs[index];
+
+  if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+    cloth_calc_spring_force(data->clmd, spring, data->groups->blocks[index]);
+  }
+}
+
+/* Spring forces in the original spring order from a single thread, without groups. */
+static void cloth_calc_spring_forces_serial(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+
+  for (LinkNode *link = cloth->springs; link; link = link->next) {
+    ClothSpring *spring = (ClothSpring *)link->link;
+    // only handle active springs
+    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+      cloth_calc_spring_force(clmd, spring, -1);
+    }
+  }
+}
+
+void BPH_cloth_calc_spring_forces(ClothModifierData *clmd, bool use_groups)
+{
+  Cloth *cloth = clmd->clothObject;
+  Implicit_Data *data = cloth->implicit;
+  const bool using_angular = clmd->sim_parms->bending_model == CLOTH_BENDING_ANGULAR;
+
+  if (!use_groups) {
+    cloth_calc_spring_forces_serial(clmd);
+    return;
+  }
+
+  if (cloth->spring_groups && cloth->spring_groups->using_angular != using_angular) {
+    cloth_spring_groups_free(cloth->spring_groups);
+    cloth->spring_groups = NULL;
+  }
+  if (cloth->spring_groups == NULL) {
+    cloth->spring_groups = cloth_spring_groups_create(cloth, using_angular);
+  }
+  ClothSpringGroups *groups = cloth->spring_groups;
+
+  /* Add matrix blocks up-front, so their order does not depend on threading. */
+  for (int i = 0; i < groups->num_springs; i++) {
+    ClothSpring *spring = groups->springs[i];
+    groups->blocks[i] = (spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE) ?
+                            -1 :
+                            BPH_mass_spring_add_block(data, spring->ij, spring->kl);
+  }
+
+  ClothSpringForceData force_data = {clmd, groups};
+  for (int group = 0; group < groups->num_groups; group++) {
+    const int start = groups->group_offsets[group];
+    const int end = groups->group_offsets[group + 1];
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (end - start > CLOTH_PARALLEL_SPRINGS_LIMIT);
+    settings.min_iter_per_thread = 256;
+    BLI_task_parallel_range(start, end, &force_data, cloth_calc_spring_force_cb, &settings);
+  }
+
+  for (int i = 0; i < groups->num_serial_springs; i++) {
+    ClothSpring *spring = groups->serial_springs[i];
+    // only handle active springs
+    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+      cloth_calc_spring_force(clmd, spring, -1);
+    }
+  }
+}
+
 static void hair_get_boundbox(ClothModifierData *clmd, float gmin[3], float gmax[3])
 {
   Cloth *cloth = clmd->clothObject;
@@ -629,16 +837,29 @@ static void cloth_calc_force(
   if (effectors) {
     /* cache per-vertex forces to avoid redundant calculation */
     float(*winvec)[3] = (float(*)[3])MEM_callocN(sizeof(float[3]) * mvert_num, "effector forces");
-    for (i = 0; i < cloth->mvert_num; i++) {
-      float x[3], v[3];
-      EffectedPoint epoint;
+    float(*effector_x)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * mvert_num, __func__);
+    float(*effector_v)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * mvert_num, __func__);
+    EffectedPoint epoint;
 
-      BPH_mass_spring_get_motion_state(data, i, x, v);
-      pd_point_from_loc(scene, x, v, i, &epoint);
-      BKE_effectors_apply(
-          effectors, NULL, clmd->sim_parms->effector_weights, &epoint, winvec[i], NULL);
+    for (i = 0; i < cloth->mvert_num; i++) {
+      BPH_mass_spring_get_motion_state(data, i, effector_x[i], effector_v[i]);
     }
 
+    /* Location, velocity and index are set per vertex by the batch evaluation. */
+    pd_point_from_loc(scene, effector_x[0], effector_v[0], 0, &epoint);
+    BKE_effectors_apply_array(effectors,
+                              NULL,
+                              clmd->sim_parms->effector_weights,
+                              &epoint,
+                              effector_x,
+                              effector_v,
+                              mvert_num,
+                              winvec,
+                              NULL);
+
+    MEM_freeN(effector_x);
+    MEM_freeN(effector_v);
+
     /* Hair has only edges. */
     if ((clmd->hairdata == NULL) && (cloth->primitive_num > 0)) {
       for (i = 0; i < cloth->primitive_num; i++) {
@@ -685,13 +906,7 @@ static void cloth_calc_force(
   }
 
   // calculate spring forces
-  for (LinkNode *link = cloth->springs; link; link = link->next) {
-    ClothSpring *spring = (ClothSpring *)link->link;
-    // only handle active springs
-    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
-      cloth_calc_spring_force(clmd, spring);
-    }
-  }
+  BPH_cloth_calc_spring_forces(clmd, true);
 }
 
 /* returns vertexes' motion state */
@@ -108,6 +108,16 @@ void BPH_mass_spring_apply_result(struct Implicit_Data *data);
 
 /* Clear the force vector at the beginning of the time step */
 void BPH_mass_spring_clear_forces(struct Implicit_Data *data);
+/* Accumulated force on a vertex. */
+void BPH_mass_spring_get_force(struct Implicit_Data *data, int index, float r_f[3]);
+/* Number of matrix blocks of the force jacobians: one per vertex, then the added blocks. */
+int BPH_mass_spring_get_num_blocks(struct Implicit_Data *data);
+void BPH_mass_spring_get_block(struct Implicit_Data *data,
+                               int block,
+                               int *r_row,
+                               int *r_col,
+                               float r_dfdx[3][3],
+                               float r_dfdv[3][3]);
 /* Fictitious forces introduced by moving coordinate systems */
 void BPH_mass_spring_force_reference_frame(struct Implicit_Data *data,
                                            int index,
@@ -140,10 +150,16 @@ void BPH_mass_spring_force_vertex_wind(struct Implicit_Data *data,
                                        int v,
                                        float radius,
                                        const float (*winvec)[3]);
+/* Add the off-diagonal matrix block for the interaction of two vertices ahead of time.
+ * Springs between two points get the block passed in, otherwise (block = -1) they add it
+ * themselves. With blocks added beforehand the forces of springs which don't share vertices
+ * can be computed from multiple threads. */
+int BPH_mass_spring_add_block(struct Implicit_Data *data, int v1, int v2);
 /* Linear spring force between two points */
 bool BPH_mass_spring_force_spring_linear(struct Implicit_Data *data,
                                          int i,
                                          int j,
+                                         int block,
                                          float restlen,
                                          float stiffness_tension,
                                          float damping_tension,
@@ -165,7 +181,7 @@ bool BPH_mass_spring_force_spring_angular(struct Implicit_Data *data,
                                           float damping);
 /* Bending force, forming a triangle at the base of two structural springs */
 bool BPH_mass_spring_force_spring_bending(
-    struct Implicit_Data *data, int i, int j, float restlen, float kb, float cb);
+    struct Implicit_Data *data, int i, int j, int block, float restlen, float kb, float cb);
 /* Angular bending force based on local target vectors */
 bool BPH_mass_spring_force_spring_bending_hair(struct Implicit_Data *data,
                                                int i,
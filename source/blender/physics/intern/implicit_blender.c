@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -46,9 +47,11 @@
 #    pragma GCC diagnostic ignored "-Wtype-limits"
 #  endif
 
-#  ifdef _OPENMP
-#    define CLOTH_OPENMP_LIMIT 512
-#  endif
+/* Vertex count from which big vector and matrix operations are multi-threaded. */
+#  define CLOTH_PARALLEL_LIMIT 1024
+/* Big vectors are processed in chunks of this many vertices. Reductions sum the partial results of
+ * chunks in order, which keeps results independent of the number of threads. */
+#  define CLOTH_CHUNK_SIZE 256
 
 //#define DEBUG_TIME
 
@@ -192,21 +195,73 @@ DO_INLINE void submul_lfvectorS(float (*to)[3],
     VECSUBMUL(to[i], fLongVector[i], scalar);
   }
 }
+/* Multi-threading over chunks of big vectors. */
+BLI_INLINE int lfvector_num_chunks(unsigned int verts)
+{
+  return (int)((verts + CLOTH_CHUNK_SIZE - 1) / CLOTH_CHUNK_SIZE);
+}
+BLI_INLINE void lfvector_chunk_range(unsigned int verts,
+                                     int chunk,
+                                     unsigned int *r_start,
+                                     unsigned int *r_end)
+{
+  *r_start = (unsigned int)chunk * CLOTH_CHUNK_SIZE;
+  *r_end = min_ii(*r_start + CLOTH_CHUNK_SIZE, verts);
+}
+static void lfvector_parallel_chunks(unsigned int verts, void *userdata, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (verts > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, lfvector_num_chunks(verts), userdata, func, &settings);
+}
+/* Sum of partial results of all chunks, always in the same order
+ * (floating point addition is not associative, results must not depend on threading). */
+BLI_INLINE float lfvector_chunks_sum(const float *chunk_sums, unsigned int verts)
+{
+  const int num_chunks = lfvector_num_chunks(verts);
+  float sum = 0.0f;
+  for (int chunk = 0; chunk < num_chunks; chunk++) {
+    sum += chunk_sums[chunk];
+  }
+  return sum;
+}
+
+typedef struct DotLFVectorData {
+  float (*a)[3], (*b)[3];
+  unsigned int verts;
+  float *chunk_sums;
+} DotLFVectorData;
+
+static void dot_lfvector_cb(void *__restrict userdata,
+                            const int chunk,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DotLFVectorData *data = userdata;
+  unsigned int start, end;
+  lfvector_chunk_range(data->verts, chunk, &start, &end);
+  float temp = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    temp += dot_v3v3(data->a[i], data->b[i]);
+  }
+  data->chunk_sums[chunk] = temp;
+}
+
 /* dot product for big vector */
 DO_INLINE float dot_lfvector(float (*fLongVectorA)[3],
                              float (*fLongVectorB)[3],
                              unsigned int verts)
 {
-  long i = 0;
-  float temp = 0.0;
-  // XXX brecht, disabled this for now (first schedule line was already disabled),
-  // due to non-commutative nature of floating point ops this makes the sim give
-  // different results each time you run it!
-  // schedule(guided, 2)
-  //#pragma omp parallel for reduction(+: temp) if (verts > CLOTH_OPENMP_LIMIT)
-  for (i = 0; i < (long)verts; i++) {
-    temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
-  }
+  DotLFVectorData data = {
+      .a = fLongVectorA,
+      .b = fLongVectorB,
+      .verts = verts,
+      .chunk_sums = MEM_malloc_arrayN(lfvector_num_chunks(verts), sizeof(float), __func__),
+  };
+  lfvector_parallel_chunks(verts, &data, dot_lfvector_cb);
+  const float temp = lfvector_chunks_sum(data.chunk_sums, verts);
+  MEM_freeN(data.chunk_sums);
   return temp;
 }
 /* A = B + C  --> for big vector */
@@ -607,35 +662,128 @@ DO_INLINE void initdiag_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
   }
 }
 
-/* SPARSE SYMMETRIC multiply big matrix with long vector*/
-/* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+/* Row-wise index of the off-diagonal blocks of a big matrix (similar to CSR storage),
+ * so products can be computed for every row independently, from multiple threads.
+ * Blocks of a row are stored in block order, transposed blocks (where the row is the
+ * column of the block) are stored as ~index. */
+typedef struct fmatrixRows {
+  int *offsets; /* vcount + 1 */
+  int *blocks;  /* 2 * scount */
+} fmatrixRows;
+
+DO_INLINE void create_bfmatrix_rows(fmatrixRows *rows, unsigned int verts, unsigned int springs)
 {
-  unsigned int vcount = from[0].vcount;
-  lfVector *temp = create_lfvector(vcount);
+  rows->offsets = MEM_calloc_arrayN(verts + 1, sizeof(int), "cloth_implicit_matrix_rows");
+  rows->blocks = MEM_malloc_arrayN(
+      max_ii(2 * springs, 1), sizeof(int), "cloth_implicit_matrix_row_blocks");
+}
 
-  zero_lfvector(to, vcount);
+DO_INLINE void del_bfmatrix_rows(fmatrixRows *rows)
+{
+  MEM_SAFE_FREE(rows->offsets);
+  MEM_SAFE_FREE(rows->blocks);
+}
 
-#  pragma omp parallel sections if (vcount > CLOTH_OPENMP_LIMIT)
-  {
-#  pragma omp section
-    {
-      for (unsigned int i = from[0].vcount; i < from[0].vcount + from[0].scount; i++) {
-        /* This is the lower triangle of the sparse matrix,
-         * therefore multiplication occurs with transposed submatrices. */
-        muladd_fmatrixT_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-      }
+/* Build row index from the first num_blocks off-diagonal blocks of the matrix. */
+static void build_bfmatrix_rows(fmatrixRows *rows, fmatrix3x3 *matrix, unsigned int num_blocks)
+{
+  const unsigned int vcount = matrix[0].vcount;
+  int *offsets = rows->offsets;
+
+  memset(offsets, 0, sizeof(int) * (vcount + 1));
+  for (unsigned int i = vcount; i < vcount + num_blocks; i++) {
+    offsets[matrix[i].r + 1]++;
+    offsets[matrix[i].c + 1]++;
+  }
+  for (unsigned int i = 0; i < vcount; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  /* Fill rows, using the offsets as insertion cursors.
+   * Afterwards every offset points to the start of the next row, so shift them back. */
+  for (unsigned int i = vcount; i < vcount + num_blocks; i++) {
+    rows->blocks[offsets[matrix[i].r]++] = (int)i;
+    rows->blocks[offsets[matrix[i].c]++] = ~(int)i;
+  }
+  for (unsigned int i = vcount; i > 0; i--) {
+    offsets[i] = offsets[i - 1];
+  }
+  offsets[0] = 0;
+}
+
+/* One row of the SPARSE SYMMETRIC big matrix multiplied with a long vector. */
+BLI_INLINE void mul_bfmatrix_row_lfvector(float to[3],
+                                          fmatrix3x3 *from,
+                                          const fmatrixRows *rows,
+                                          lfVector *fLongVector,
+                                          unsigned int row)
+{
+  zero_v3(to);
+  muladd_fmatrix_fvector(to, from[row].m, fLongVector[row]);
+  for (int k = rows->offsets[row]; k < rows->offsets[row + 1]; k++) {
+    const int block = rows->blocks[k];
+    if (block >= 0) {
+      muladd_fmatrix_fvector(to, from[block].m, fLongVector[from[block].c]);
     }
-#  pragma omp section
-    {
-      for (unsigned int i = 0; i < from[0].vcount + from[0].scount; i++) {
-        muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
-      }
+    else {
+      /* This is the lower triangle of the sparse matrix,
+       * therefore multiplication occurs with transposed submatrices. */
+      muladd_fmatrixT_fvector(to, from[~block].m, fLongVector[from[~block].r]);
+    }
+  }
+}
+
+typedef struct MulBFMatrixData {
+  float (*to)[3];
+  fmatrix3x3 *from;
+  const fmatrixRows *rows;
+  lfVector *fLongVector;
+  unsigned int verts;
+
+  /* Optional: constraint filter applied to the result. */
+  fmatrix3x3 *S;
+  /* Optional: dot product of the result with this vector, per chunk. */
+  lfVector *dot_vector;
+  float *chunk_sums;
+} MulBFMatrixData;
+
+static void mul_bfmatrix_lfvector_cb(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MulBFMatrixData *data = userdata;
+  unsigned int start, end;
+  float temp = 0.0f;
+  lfvector_chunk_range(data->verts, chunk, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    mul_bfmatrix_row_lfvector(data->to[i], data->from, data->rows, data->fLongVector, i);
+    if (data->S) {
+      mul_m3_v3(data->S[i].m, data->to[i]);
+    }
+    if (data->dot_vector) {
+      temp += dot_v3v3(data->to[i], data->dot_vector[i]);
     }
   }
-  add_lfvector_lfvector(to, to, temp, from[0].vcount);
+  if (data->chunk_sums) {
+    data->chunk_sums[chunk] = temp;
+  }
+}
 
-  del_lfvector(temp);
+/* SPARSE SYMMETRIC multiply big matrix with long vector*/
+/* STATUS: verified */
+DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3],
+                                     fmatrix3x3 *from,
+                                     const fmatrixRows *rows,
+                                     lfVector *fLongVector)
+{
+  MulBFMatrixData data = {
+      .to = to,
+      .from = from,
+      .rows = rows,
+      .fLongVector = fLongVector,
+      .verts = from[0].vcount,
+  };
+  lfvector_parallel_chunks(data.verts, &data, mul_bfmatrix_lfvector_cb);
 }
 
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
@@ -677,6 +825,7 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+  fmatrixRows rows;     /* row index of A and the force jacobians (same block layout) */
 } Implicit_Data;
 
 Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
@@ -701,6 +850,7 @@ Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
   id->B = create_lfvector(numverts);
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
+  create_bfmatrix_rows(&id->rows, numverts, numsprings);
 
   initdiag_bfmatrix(id->bigI, I);
 
@@ -727,6 +877,7 @@ void BPH_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->B);
   del_lfvector(id->dV);
   del_lfvector(id->z);
+  del_bfmatrix_rows(&id->rows);
 
   MEM_freeN(id);
 }
@@ -838,8 +989,49 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 }
 #  endif
 
+typedef struct CGStepData {
+  lfVector *ldV, *r, *c, *q;
+  fmatrix3x3 *S;
+  unsigned int verts;
+  float alpha, beta;
+  float *chunk_sums;
+} CGStepData;
+
+/* dV += alpha * c, r -= alpha * q, returns r^T * r per chunk. */
+static void cg_filtered_update_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGStepData *data = userdata;
+  unsigned int start, end;
+  float temp = 0.0f;
+  lfvector_chunk_range(data->verts, chunk, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    madd_v3_v3fl(data->ldV[i], data->c[i], data->alpha);
+    madd_v3_v3fl(data->r[i], data->q[i], -data->alpha);
+    temp += dot_v3v3(data->r[i], data->r[i]);
+  }
+  data->chunk_sums[chunk] = temp;
+}
+
+/* c = filter(r + beta * c) */
+static void cg_filtered_direction_cb(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGStepData *data = userdata;
+  unsigned int start, end;
+  lfvector_chunk_range(data->verts, chunk, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    float tmp[3];
+    madd_v3_v3v3fl(tmp, data->r[i], data->c[i], data->beta);
+    mul_v3_m3v3(data->c[i], data->S[i].m, tmp);
+  }
+}
+
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const fmatrixRows *rows,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
@@ -855,8 +1047,8 @@ static int cg_filtered(lfVector *ldV,
   lfVector *r = create_lfvector(numverts);
   lfVector *c = create_lfvector(numverts);
   lfVector *q = create_lfvector(numverts);
-  lfVector *s = create_lfvector(numverts);
-  float bnorm2, delta_new, delta_old, delta_target, alpha;
+  float *chunk_sums = MEM_malloc_arrayN(lfvector_num_chunks(numverts), sizeof(float), __func__);
+  float bnorm2, delta_new, delta_old, delta_target;
 
   cp_lfvector(ldV, z, numverts);
 
@@ -867,7 +1059,7 @@ static int cg_filtered(lfVector *ldV,
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector(AdV, lA, rows, ldV);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
@@ -889,23 +1081,41 @@ static int cg_filtered(lfVector *ldV,
   print_bfmatrix(S);
 #  endif
 
-  while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
-    filter(q, S);
-
-    alpha = delta_new / dot_lfvector(c, q, numverts);
-
-    add_lfvector_lfvectorS(ldV, ldV, c, alpha, numverts);
+  /* Steps of the iteration are fused into multi-threaded passes over the vectors.
+   * There is no pre-conditioning (P^-1 = I), so s = P^-1 * r is r itself. */
+  MulBFMatrixData mul_data = {
+      .to = q,
+      .from = lA,
+      .rows = rows,
+      .fLongVector = c,
+      .verts = numverts,
+      .S = S,
+      .dot_vector = c,
+      .chunk_sums = chunk_sums,
+  };
+  CGStepData step_data = {
+      .ldV = ldV,
+      .r = r,
+      .c = c,
+      .q = q,
+      .S = S,
+      .verts = numverts,
+      .chunk_sums = chunk_sums,
+  };
 
-    add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
+  while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
+    /* q = filter(A * c), alpha = delta / (c^T * q) */
+    lfvector_parallel_chunks(numverts, &mul_data, mul_bfmatrix_lfvector_cb);
+    step_data.alpha = delta_new / lfvector_chunks_sum(chunk_sums, numverts);
 
-    /* s = P^-1 * r */
-    cp_lfvector(s, r, numverts);
+    /* dV += alpha * c, r -= alpha * q, delta = r^T * P^-1 * r */
+    lfvector_parallel_chunks(numverts, &step_data, cg_filtered_update_cb);
     delta_old = delta_new;
-    delta_new = dot_lfvector(r, s, numverts);
+    delta_new = lfvector_chunks_sum(chunk_sums, numverts);
 
-    add_lfvector_lfvectorS(c, s, c, delta_new / delta_old, numverts);
-    filter(c, S);
+    /* c = filter(P^-1 * r + c * delta_new / delta_old) */
+    step_data.beta = delta_new / delta_old;
+    lfvector_parallel_chunks(numverts, &step_data, cg_filtered_direction_cb);
 
     conjgrad_loopcount++;
   }
@@ -921,7 +1131,7 @@ static int cg_filtered(lfVector *ldV,
   del_lfvector(r);
   del_lfvector(c);
   del_lfvector(q);
-  del_lfvector(s);
+  MEM_freeN(chunk_sums);
   // printf("W/O conjgrad_loopcount: %d\n", conjgrad_loopcount);
 
   result->status = conjgrad_loopcount < conjgrad_looplimit ? BPH_SOLVER_SUCCESS :
@@ -1150,7 +1360,10 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* A and the force jacobians share the same block layout. */
+  build_bfmatrix_rows(&data->rows, data->A, data->num_blocks);
+
+  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, &data->rows, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1159,7 +1372,7 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, &data->rows, data->B, data->z, data->S, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
@@ -1268,7 +1481,7 @@ void BPH_mass_spring_set_new_velocity(struct Implicit_Data *data, int index, con
 
 /* -------------------------------- */
 
-static int BPH_mass_spring_add_block(Implicit_Data *data, int v1, int v2)
+int BPH_mass_spring_add_block(Implicit_Data *data, int v1, int v2)
 {
   int s = data->M[0].vcount + data->num_blocks; /* index from array start */
   BLI_assert(s < data->M[0].vcount + data->M[0].scount);
@@ -1351,6 +1564,30 @@ void BPH_mass_spring_clear_forces(Implicit_Data *data)
   data->num_blocks = 0;
 }
 
+void BPH_mass_spring_get_force(Implicit_Data *data, int index, float r_f[3])
+{
+  copy_v3_v3(r_f, data->F[index]);
+}
+
+int BPH_mass_spring_get_num_blocks(Implicit_Data *data)
+{
+  return data->M[0].vcount + data->num_blocks;
+}
+
+void BPH_mass_spring_get_block(Implicit_Data *data,
+                               int block,
+                               int *r_row,
+                               int *r_col,
+                               float r_dfdx[3][3],
+                               float r_dfdv[3][3])
+{
+  BLI_assert(block < BPH_mass_spring_get_num_blocks(data));
+  *r_row = data->dFdX[block].r;
+  *r_col = data->dFdX[block].c;
+  copy_m3_m3(r_dfdx, data->dFdX[block].m);
+  copy_m3_m3(r_dfdv, data->dFdV[block].m);
+}
+
 void BPH_mass_spring_force_reference_frame(Implicit_Data *data,
                                            int index,
                                            const float acceleration[3],
@@ -1676,10 +1913,15 @@ BLI_INLINE bool spring_length(Implicit_Data *data,
   return true;
 }
 
-BLI_INLINE void apply_spring(
-    Implicit_Data *data, int i, int j, const float f[3], float dfdx[3][3], float dfdv[3][3])
+BLI_INLINE void apply_spring(Implicit_Data *data,
+                             int i,
+                             int j,
+                             int block,
+                             const float f[3],
+                             float dfdx[3][3],
+                             float dfdv[3][3])
 {
-  int block_ij = BPH_mass_spring_add_block(data, i, j);
+  int block_ij = (block != -1) ? block : BPH_mass_spring_add_block(data, i, j);
 
   add_v3_v3(data->F[i], f);
   sub_v3_v3(data->F[j], f);
@@ -1696,6 +1938,7 @@ BLI_INLINE void apply_spring(
 bool BPH_mass_spring_force_spring_linear(Implicit_Data *data,
                                          int i,
                                          int j,
+                                         int block,
                                          float restlen,
                                          float stiffness_tension,
                                          float damping_tension,
@@ -1748,14 +1991,14 @@ bool BPH_mass_spring_force_spring_linear(Implicit_Data *data,
   madd_v3_v3fl(f, dir, damping * dot_v3v3(vel, dir));
   dfdv_damp(dfdv, dir, damping);
 
-  apply_spring(data, i, j, f, dfdx, dfdv);
+  apply_spring(data, i, j, block, f, dfdx, dfdv);
 
   return true;
 }
 
 /* See "Stable but Responsive Cloth" (Choi, Ko 2005) */
 bool BPH_mass_spring_force_spring_bending(
-    Implicit_Data *data, int i, int j, float restlen, float kb, float cb)
+    Implicit_Data *data, int i, int j, int block, float restlen, float kb, float cb)
 {
   float extent[3], length, dir[3], vel[3];
 
@@ -1773,7 +2016,7 @@ bool BPH_mass_spring_force_spring_bending(
     /* XXX damping not supported */
     zero_m3(dfdv);
 
-    apply_spring(data, i, j, f, dfdx, dfdv);
+    apply_spring(data, i, j, block, f, dfdx, dfdv);
 
     return true;
   }
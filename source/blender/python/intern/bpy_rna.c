@@ -5424,6 +5424,346 @@ static PyObject *pyrna_prop_collection_foreach_set(BPy_PropertyRNA *self, PyObje
   return foreach_getset(self, args, 1);
 }
 
+/* --- collection buffer: start --- */
+/* Zero-copy access to collection items stored as a contiguous array,
+ * see #BPy_PropertyCollectionBufferRNA. */
+
+static const char *foreach_buffer_format(RawPropertyType raw_type, bool attr_signed)
+{
+  switch (raw_type) {
+    case PROP_RAW_CHAR:
+      return attr_signed ? "b" : "B";
+    case PROP_RAW_SHORT:
+      return attr_signed ? "h" : "H";
+    case PROP_RAW_INT:
+      return attr_signed ? "i" : "I";
+    case PROP_RAW_BOOLEAN:
+      return "?";
+    case PROP_RAW_FLOAT:
+      return "f";
+    case PROP_RAW_DOUBLE:
+      return "d";
+    case PROP_RAW_UNSET:
+      break;
+  }
+  return NULL;
+}
+
+static int pyrna_prop_collection_buffer_getbuffer(BPy_PropertyCollectionBufferRNA *self,
+                                                  Py_buffer *view,
+                                                  int flags)
+{
+  BPy_PropertyRNA *py_prop = self->py_prop;
+  RawArray raw;
+  Py_ssize_t *shape_strides;
+  const int itemsize = RNA_raw_type_sizeof(self->raw_type);
+  const int ndim = (self->itemprop_len != 0) ? 2 : 1;
+  bool is_contiguous;
+
+  view->obj = NULL;
+
+  if (pyrna_prop_validity_check(py_prop) == -1) {
+    return -1;
+  }
+
+  if ((flags & PyBUF_WRITABLE) && !self->is_writable) {
+    PyErr_SetString(PyExc_BufferError,
+                    "bpy_prop_collection_buffer: read-only, use as_buffer(attr, writable=True)");
+    return -1;
+  }
+
+  /* Look up the array again, the collection may have been resized since the last request. */
+  if (!RNA_property_collection_raw_array(&py_prop->ptr, py_prop->prop, self->itemprop, &raw)) {
+    PyErr_Format(PyExc_BufferError,
+                 "bpy_prop_collection_buffer: '%.200s' is no longer stored as an array",
+                 RNA_property_identifier(self->itemprop));
+    return -1;
+  }
+
+  if (raw.len != 0 && raw.type != self->raw_type) {
+    PyErr_SetString(PyExc_BufferError, "bpy_prop_collection_buffer: internal type mismatch");
+    return -1;
+  }
+
+  is_contiguous = (raw.len <= 1) || (raw.stride == itemsize * MAX2(self->itemprop_len, 1));
+
+  if (!is_contiguous) {
+    if (((flags & PyBUF_STRIDES) != PyBUF_STRIDES) ||
+        ((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS) ||
+        ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS) ||
+        ((flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS)) {
+      PyErr_SetString(PyExc_BufferError,
+                      "bpy_prop_collection_buffer: items are interleaved, "
+                      "a strided buffer must be requested");
+      return -1;
+    }
+  }
+
+  /* Each export owns its shape/strides so a resized collection can't change existing views. */
+  shape_strides = PyMem_Malloc(sizeof(*shape_strides) * 4);
+  if (shape_strides == NULL) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  shape_strides[0] = raw.len;
+  shape_strides[1] = self->itemprop_len;
+  shape_strides[2] = raw.stride;
+  shape_strides[3] = itemsize;
+
+  view->buf = raw.array;
+  view->len = (Py_ssize_t)raw.len * MAX2(self->itemprop_len, 1) * itemsize;
+  view->readonly = !self->is_writable;
+  view->itemsize = itemsize;
+  view->format = (flags & PyBUF_FORMAT) ?
+                     (char *)foreach_buffer_format(self->raw_type, self->is_signed) :
+                     NULL;
+  view->ndim = ndim;
+  view->shape = (flags & PyBUF_ND) ? &shape_strides[0] : NULL;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &shape_strides[2] : NULL;
+  view->suboffsets = NULL;
+  view->internal = shape_strides;
+
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+
+  return 0;
+}
+
+static void pyrna_prop_collection_buffer_releasebuffer(
+    BPy_PropertyCollectionBufferRNA *UNUSED(self), Py_buffer *view)
+{
+  PyMem_Free(view->internal);
+}
+
+static PyBufferProcs pyrna_prop_collection_buffer_as_buffer = {
+    (getbufferproc)pyrna_prop_collection_buffer_getbuffer,
+    (releasebufferproc)pyrna_prop_collection_buffer_releasebuffer,
+};
+
+PyDoc_STRVAR(pyrna_prop_collection_buffer_update_doc,
+             ".. method:: update()\n"
+             "\n"
+             "   Run the update callback of the attribute,\n"
+             "   call after writing to a writable buffer so dependent data is refreshed.\n");
+static PyObject *pyrna_prop_collection_buffer_update(BPy_PropertyCollectionBufferRNA *self)
+{
+  BPy_PropertyRNA *py_prop = self->py_prop;
+  CollectionPropertyIterator iter;
+
+  PYRNA_PROP_CHECK_OBJ(py_prop);
+
+  /* Updates are per struct, any item of the collection will do. */
+  RNA_property_collection_begin(&py_prop->ptr, py_prop->prop, &iter);
+  if (iter.valid) {
+    RNA_property_update(BPy_GetContext(), &iter.ptr, self->itemprop);
+  }
+  RNA_property_collection_end(&iter);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *pyrna_prop_collection_buffer_repr(BPy_PropertyCollectionBufferRNA *self)
+{
+  BPy_PropertyRNA *py_prop = self->py_prop;
+  return PyUnicode_FromFormat("<bpy_prop_collection_buffer %.200s.%.200s, \"%.200s\"%s>",
+                              RNA_struct_identifier(py_prop->ptr.type),
+                              RNA_property_identifier(py_prop->prop),
+                              RNA_property_identifier(self->itemprop),
+                              self->is_writable ? "" : " (read-only)");
+}
+
+static void pyrna_prop_collection_buffer_dealloc(BPy_PropertyCollectionBufferRNA *self)
+{
+#ifdef USE_WEAKREFS
+  if (self->in_weakreflist != NULL) {
+    PyObject_ClearWeakRefs((PyObject *)self);
+  }
+#endif
+
+  Py_DECREF(self->py_prop);
+
+  PyObject_DEL(self);
+}
+
+static struct PyMethodDef pyrna_prop_collection_buffer_methods[] = {
+    {"update",
+     (PyCFunction)pyrna_prop_collection_buffer_update,
+     METH_NOARGS,
+     pyrna_prop_collection_buffer_update_doc},
+    {NULL, NULL, 0, NULL},
+};
+
+static PyTypeObject pyrna_prop_collection_buffer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "bpy_prop_collection_buffer", /* tp_name */
+    sizeof(BPy_PropertyCollectionBufferRNA),                     /* tp_basicsize */
+    0,                                                           /* tp_itemsize */
+    /* methods */
+    (destructor)pyrna_prop_collection_buffer_dealloc, /* tp_dealloc */
+    (printfunc)NULL,                                  /* printfunc tp_print; */
+    NULL,                                             /* getattrfunc tp_getattr; */
+    NULL,                                             /* setattrfunc tp_setattr; */
+    NULL,
+    /* tp_compare */ /* DEPRECATED in Python 3.0! */
+    (reprfunc)pyrna_prop_collection_buffer_repr, /* tp_repr */
+
+    /* Method suites for standard classes */
+
+    NULL, /* PyNumberMethods *tp_as_number; */
+    NULL, /* PySequenceMethods *tp_as_sequence; */
+    NULL, /* PyMappingMethods *tp_as_mapping; */
+
+    /* More standard operations (here for binary compatibility) */
+
+    NULL, /* hashfunc tp_hash; */
+    NULL, /* ternaryfunc tp_call; */
+    NULL, /* reprfunc tp_str; */
+    NULL, /* getattrofunc tp_getattro; */
+    NULL, /* setattrofunc tp_setattro; */
+
+    /* Functions to access object as input/output buffer */
+    &pyrna_prop_collection_buffer_as_buffer, /* PyBufferProcs *tp_as_buffer; */
+
+    /*** Flags to define presence of optional/expanded features ***/
+    Py_TPFLAGS_DEFAULT, /* long tp_flags; */
+
+    NULL, /*  char *tp_doc;  Documentation string */
+    /*** Assigned meaning in release 2.0 ***/
+    /* call function for all accessible objects */
+    NULL, /* traverseproc tp_traverse; */
+
+    /* delete references to contained objects */
+    NULL, /* inquiry tp_clear; */
+
+    /***  Assigned meaning in release 2.1 ***/
+    /*** rich comparisons ***/
+    NULL, /* richcmpfunc tp_richcompare; */
+
+/***  weak reference enabler ***/
+#ifdef USE_WEAKREFS
+    offsetof(BPy_PropertyCollectionBufferRNA, in_weakreflist), /* long tp_weaklistoffset; */
+#else
+    0,
+#endif
+    /*** Added in release 2.2 ***/
+    /*   Iterators */
+    NULL, /* getiterfunc tp_iter; */
+    NULL, /* iternextfunc tp_iternext; */
+
+    /*** Attribute descriptor and subclassing stuff ***/
+    pyrna_prop_collection_buffer_methods, /* struct PyMethodDef *tp_methods; */
+    NULL,                                 /* struct PyMemberDef *tp_members; */
+    NULL,                                 /* struct PyGetSetDef *tp_getset; */
+    NULL,                                 /* struct _typeobject *tp_base; */
+    NULL,                                 /* PyObject *tp_dict; */
+    NULL,                                 /* descrgetfunc tp_descr_get; */
+    NULL,                                 /* descrsetfunc tp_descr_set; */
+    0,                                    /* long tp_dictoffset; */
+    NULL,                                 /* initproc tp_init; */
+    NULL,                                 /* allocfunc tp_alloc; */
+    NULL,                                 /* newfunc tp_new; */
+    /*  Low-level free-memory routine */
+    NULL, /* freefunc tp_free;  */
+    /* For PyObject_IS_GC */
+    NULL, /* inquiry tp_is_gc;  */
+    NULL, /* PyObject *tp_bases; */
+    /* method resolution order */
+    NULL, /* PyObject *tp_mro;  */
+    NULL, /* PyObject *tp_cache; */
+    NULL, /* PyObject *tp_subclasses; */
+    NULL, /* PyObject *tp_weaklist; */
+    NULL,
+};
+
+PyDoc_STRVAR(
+    pyrna_prop_collection_as_buffer_doc,
+    ".. method:: as_buffer(attr, writable=False)\n"
+    "\n"
+    "   Return an object supporting the buffer protocol which gives direct access to an\n"
+    "   attribute of all items in this collection, without copying.\n"
+    "   Only collections stored as arrays are supported (mesh vertices, edges, loops,\n"
+    "   polygons and their custom-data layers for example).\n"
+    "\n"
+    "   .. code-block:: python\n"
+    "\n"
+    "      import numpy\n"
+    "      co = numpy.asarray(mesh.vertices.as_buffer(\"co\", writable=True))\n"
+    "      co[:, 2] += 1.0\n"
+    "      mesh.vertices.as_buffer(\"co\").update()\n"
+    "\n"
+    "   :arg attr: Name of the item attribute.\n"
+    "   :type attr: string\n"
+    "   :arg writable: Allow writing through the buffer, call ``update()`` after writing.\n"
+    "   :type writable: bool\n"
+    "   :return: A buffer with one row per item, "
+    "items are interleaved so the buffer is generally strided.\n"
+    "   :rtype: :class:`bpy_prop_collection_buffer`\n"
+    "\n"
+    "   .. warning::\n"
+    "\n"
+    "      Views created from the buffer become invalid once the collection is resized.\n");
+static PyObject *pyrna_prop_collection_as_buffer(BPy_PropertyRNA *self,
+                                                 PyObject *args,
+                                                 PyObject *kw)
+{
+  BPy_PropertyCollectionBufferRNA *ret;
+  PointerRNA itemptr_base;
+  PropertyRNA *itemprop;
+  RawArray raw;
+  const char *attr;
+  bool writable = false;
+
+  PYRNA_PROP_CHECK_OBJ(self);
+
+  static const char *_keywords[] = {"attr", "writable", NULL};
+  static _PyArg_Parser _parser = {"s|$O&:as_buffer", _keywords, 0};
+  if (!_PyArg_ParseTupleAndKeywordsFast(args, kw, &_parser, &attr, PyC_ParseBool, &writable)) {
+    return NULL;
+  }
+
+  RNA_pointer_create(NULL, RNA_property_pointer_type(&self->ptr, self->prop), NULL, &itemptr_base);
+  itemprop = RNA_struct_find_property(&itemptr_base, attr);
+
+  if (itemprop == NULL) {
+    PyErr_Format(PyExc_AttributeError,
+                 "as_buffer: '%.200s.%.200s[...]' elements have no attribute '%.200s'",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  if ((RNA_property_flag(itemprop) & PROP_DYNAMIC) ||
+      !RNA_property_collection_raw_array(&self->ptr, self->prop, itemprop, &raw) ||
+      (raw.len != 0 && foreach_buffer_format(raw.type, true) == NULL)) {
+    PyErr_Format(PyExc_TypeError,
+                 "as_buffer: '%.200s.%.200s[...].%.200s' isn't stored as an array, "
+                 "use foreach_get/set instead",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  ret = PyObject_New(BPy_PropertyCollectionBufferRNA, &pyrna_prop_collection_buffer_Type);
+  if (ret == NULL) {
+    return NULL;
+  }
+#ifdef USE_WEAKREFS
+  ret->in_weakreflist = NULL;
+#endif
+  ret->py_prop = self;
+  Py_INCREF(self);
+  ret->itemprop = itemprop;
+  ret->raw_type = RNA_property_raw_type(itemprop);
+  ret->itemprop_len = RNA_property_array_length(&itemptr_base, itemprop);
+  ret->is_signed = (RNA_property_subtype(itemprop) != PROP_UNSIGNED);
+  ret->is_writable = writable;
+
+  return (PyObject *)ret;
+}
+
+/* --- collection buffer: end --- */
+
 /* A bit of a kludge, make a list out of a collection or array,
  * then return the list's iter function, not especially fast, but convenient for now. */
 static PyObject *pyrna_prop_array_iter(BPy_PropertyArrayRNA *self)
@@ -5584,6 +5924,10 @@ static struct PyMethodDef pyrna_prop_collection_methods[] = {
      (PyCFunction)pyrna_prop_collection_foreach_set,
      METH_VARARGS,
      pyrna_prop_collection_foreach_set_doc},
+    {"as_buffer",
+     (PyCFunction)pyrna_prop_collection_as_buffer,
+     METH_VARARGS | METH_KEYWORDS,
+     pyrna_prop_collection_as_buffer_doc},
 
     {"keys", (PyCFunction)pyrna_prop_collection_keys, METH_NOARGS, pyrna_prop_collection_keys_doc},
     {"items",
@@ -7446,6 +7790,10 @@ void BPY_rna_init(void)
     return;
   }
 
+  if (PyType_Ready(&pyrna_prop_collection_buffer_Type) < 0) {
+    return;
+  }
+
 #ifdef USE_PYRNA_ITER
   if (PyType_Ready(&pyrna_prop_collection_iter_Type) < 0) {
     return;
@@ -165,6 +165,30 @@ typedef struct {
   CollectionPropertyIterator iter;
 } BPy_PropertyCollectionIterRNA;
 
+/**
+ * Buffer protocol view of a single attribute of a collection
+ * which RNA stores as a contiguous array (mesh vertices, loops, custom-data layers...).
+ *
+ * The array is looked up again for every buffer request,
+ * so this stays valid when the collection is resized.
+ */
+typedef struct {
+  PyObject_HEAD /* required python macro   */
+#ifdef USE_WEAKREFS
+      PyObject *in_weakreflist;
+#endif
+
+  /** The collection this buffer reads from (a reference is held). */
+  BPy_PropertyRNA *py_prop;
+  /** The property of each collection item exposed by the buffer. */
+  PropertyRNA *itemprop;
+  RawPropertyType raw_type;
+  /** Number of values per item, zero for non-array properties. */
+  int itemprop_len;
+  bool is_signed;
+  bool is_writable;
+} BPy_PropertyCollectionBufferRNA;
+
 typedef struct {
   PyObject_HEAD /* required python macro   */
 #ifdef USE_WEAKREFS
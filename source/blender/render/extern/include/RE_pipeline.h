@@ -191,6 +191,7 @@ void RE_FreeAllPersistentData(void);
 void RE_FreeAllRenderResults(void);
 /* for external render engines that can keep persistent data */
 void RE_FreePersistentData(void);
+void RE_FreeAllPersistentDepsgraphs(void);
 
 /* get results and statistics */
 void RE_FreeRenderResult(struct RenderResult *rr);
@@ -162,6 +162,9 @@ void RE_engine_free(RenderEngine *engine)
     BLI_threaded_malloc_end();
   }
 
+  /* Dependency graph kept for persistent data. */
+  DEG_graph_free(engine->depsgraph);
+
   BLI_mutex_end(&engine->update_render_passes_mutex);
 
   MEM_freeN(engine);
@@ -504,13 +507,41 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+/* With persistent data the dependency graph is kept between renders, so only data-blocks
+ * which changed since the previous render need to be evaluated and synchronized again. */
+static bool engine_keep_depsgraph(RenderEngine *engine)
+{
+  return (engine->re->r.mode & R_PERSISTENT_DATA) && !(engine->re->r.scemode & R_BUTS_PREVIEW);
+}
+
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+  DEG_graph_free(engine->depsgraph);
+
+  engine->depsgraph = NULL;
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
 
-  engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(engine->depsgraph, "RENDER");
+  engine->flag &= ~RE_ENGINE_DEPSGRAPH_REUSED;
+
+  if (engine->depsgraph) {
+    if (DEG_get_input_scene(engine->depsgraph) == scene &&
+        DEG_get_input_view_layer(engine->depsgraph) == view_layer) {
+      engine->flag |= RE_ENGINE_DEPSGRAPH_REUSED;
+    }
+    else {
+      engine_depsgraph_free(engine);
+    }
+  }
+
+  if (engine->depsgraph == NULL) {
+    engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(engine->depsgraph, "RENDER");
+  }
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
     Depsgraph *depsgraph = engine->depsgraph;
@@ -520,15 +551,31 @@ static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
     DEG_ids_clear_recalc(bmain, depsgraph);
   }
   else {
-    BKE_scene_graph_update_for_newframe(engine->depsgraph, bmain);
+    /* Recalc flags of a kept dependency graph tell the engine what changed,
+     * they are cleared once it is done rendering. */
+    BKE_scene_graph_update_for_newframe_ex(
+        engine->depsgraph, bmain, !engine_keep_depsgraph(engine));
   }
 }
 
-static void engine_depsgraph_free(RenderEngine *engine)
+static void engine_depsgraph_exit(RenderEngine *engine)
 {
-  DEG_graph_free(engine->depsgraph);
+  if (engine->depsgraph == NULL) {
+    return;
+  }
 
-  engine->depsgraph = NULL;
+  if (engine_keep_depsgraph(engine)) {
+    DEG_ids_clear_recalc(engine->re->main, engine->depsgraph);
+  }
+  else {
+    engine_depsgraph_free(engine);
+  }
+}
+
+void RE_engine_free_persistent_depsgraph(RenderEngine *engine)
+{
+  engine_depsgraph_free(engine);
+  engine->flag &= ~RE_ENGINE_DEPSGRAPH_REUSED;
 }
 
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
@@ -610,6 +657,8 @@ bool RE_bake_engine(Render *re,
   engine->tile_y = re->r.tiley;
 
   if (type->bake) {
+    /* Baking uses the dependency graph of the caller. */
+    engine_depsgraph_free(engine);
     engine->depsgraph = depsgraph;
 
     /* update is only called so we create the engine.session */
@@ -787,7 +836,7 @@ int RE_engine_render(Render *re, int do_all)
         DRW_render_gpencil(engine, engine->depsgraph);
       }
 
-      engine_depsgraph_free(engine);
+      engine_depsgraph_exit(engine);
 
       if (RE_engine_test_break(engine)) {
         break;
@@ -875,6 +924,10 @@ void RE_engine_register_pass(struct RenderEngine *engine,
 
 void RE_engine_free_blender_memory(RenderEngine *engine)
 {
+  /* The dependency graph is reused by the next render. */
+  if (engine_keep_depsgraph(engine)) {
+    return;
+  }
   /* Weak way to save memory, but not crash grease pencil.
    *
    * TODO(sergey): Find better solution for this.
@@ -697,6 +697,18 @@ void RE_FreeAllPersistentData(void)
   }
 }
 
+/* Dependency graphs kept for persistent data reference data-blocks of the current main
+ * database, free them when it gets replaced while keeping the rest of the engine data. */
+void RE_FreeAllPersistentDepsgraphs(void)
+{
+  Render *re;
+  for (re = RenderGlobal.renderlist.first; re != NULL; re = re->next) {
+    if (re->engine != NULL && !(re->engine->flag & RE_ENGINE_RENDERING)) {
+      RE_engine_free_persistent_depsgraph(re->engine);
+    }
+  }
+}
+
 /* on file load, free all re */
 void RE_FreeAllRenderResults(void)
 {
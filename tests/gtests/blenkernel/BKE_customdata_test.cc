@@ -0,0 +1,194 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+}
+
+#define TOTVERT 16
+
+static void customdata_verts_create(CustomData *data)
+{
+  CustomData_reset(data);
+  MVert *mvert = (MVert *)CustomData_add_layer(data, CD_MVERT, CD_CALLOC, NULL, TOTVERT);
+  for (int i = 0; i < TOTVERT; i++) {
+    mvert[i].co[0] = (float)i;
+  }
+}
+
+class CustomDataShareTest : public testing::Test {
+ protected:
+  size_t blocks_in_use;
+
+  virtual void SetUp()
+  {
+    blocks_in_use = MEM_get_memory_blocks_in_use();
+  }
+
+  virtual void TearDown()
+  {
+    EXPECT_EQ(blocks_in_use, MEM_get_memory_blocks_in_use());
+  }
+};
+
+TEST_F(CustomDataShareTest, Share)
+{
+  CustomData src, dst;
+  customdata_verts_create(&src);
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+
+  EXPECT_EQ(CustomData_get_layer(&src, CD_MVERT), CustomData_get_layer(&dst, CD_MVERT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&src, CD_MVERT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&dst, CD_MVERT));
+
+  CustomData_free(&dst, TOTVERT);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&src, CD_MVERT));
+  CustomData_free(&src, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, NoStorageDuplicates)
+{
+  CustomData src, dst;
+  customdata_verts_create(&src);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+
+  EXPECT_NE(CustomData_get_layer(&src, CD_MVERT), CustomData_get_layer(&dst, CD_MVERT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&dst, CD_MVERT));
+
+  CustomData_free(&dst, TOTVERT);
+  CustomData_free(&src, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, CopyOnWrite)
+{
+  CustomData src, dst;
+  customdata_verts_create(&src);
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+
+  MVert *mvert_src = (MVert *)CustomData_get_layer(&src, CD_MVERT);
+  MVert *mvert_dst = (MVert *)CustomData_duplicate_referenced_layer(&dst, CD_MVERT, TOTVERT);
+  EXPECT_NE(mvert_src, mvert_dst);
+  EXPECT_EQ(mvert_dst, CustomData_get_layer(&dst, CD_MVERT));
+
+  mvert_dst[3].co[0] = -1.0f;
+  EXPECT_EQ(mvert_src[3].co[0], 3.0f);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&src, CD_MVERT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&dst, CD_MVERT));
+
+  /* The last user keeps the array when writing. */
+  EXPECT_EQ(mvert_src, CustomData_duplicate_referenced_layer(&src, CD_MVERT, TOTVERT));
+
+  CustomData_free(&src, TOTVERT);
+  CustomData_free(&dst, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, FreeSourceFirst)
+{
+  CustomData src, dst;
+  customdata_verts_create(&src);
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+  CustomData_free(&src, TOTVERT);
+
+  MVert *mvert_dst = (MVert *)CustomData_get_layer(&dst, CD_MVERT);
+  EXPECT_EQ(mvert_dst[5].co[0], 5.0f);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&dst, CD_MVERT));
+  EXPECT_EQ(mvert_dst, CustomData_duplicate_referenced_layer(&dst, CD_MVERT, TOTVERT));
+
+  CustomData_free(&dst, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, Unshare)
+{
+  CustomData src, dst, ref;
+  customdata_verts_create(&src);
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+  CustomData_copy(&src, &ref, CD_MASK_MVERT, CD_REFERENCE, TOTVERT);
+
+  MVert *mvert_src = (MVert *)CustomData_get_layer(&src, CD_MVERT);
+  EXPECT_NE(mvert_src, CustomData_unshare_layer(&dst, CD_MVERT, TOTVERT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&dst, CD_MVERT));
+
+  /* Referenced data is written in place. */
+  EXPECT_EQ(mvert_src, CustomData_unshare_layer(&ref, CD_MVERT, TOTVERT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&ref, CD_MVERT));
+
+  CustomData_free(&ref, TOTVERT);
+  CustomData_free(&dst, TOTVERT);
+  CustomData_free(&src, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, Realloc)
+{
+  CustomData src, dst;
+  customdata_verts_create(&src);
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+
+  CustomData_realloc(&dst, TOTVERT * 2);
+  MVert *mvert_src = (MVert *)CustomData_get_layer(&src, CD_MVERT);
+  MVert *mvert_dst = (MVert *)CustomData_get_layer(&dst, CD_MVERT);
+  EXPECT_NE(mvert_src, mvert_dst);
+  EXPECT_EQ(MEM_allocN_len(mvert_src), sizeof(MVert) * TOTVERT);
+  EXPECT_EQ(MEM_allocN_len(mvert_dst), sizeof(MVert) * TOTVERT * 2);
+  EXPECT_EQ(mvert_dst[TOTVERT - 1].co[0], (float)(TOTVERT - 1));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&src, CD_MVERT));
+
+  CustomData_free(&dst, TOTVERT * 2);
+  CustomData_free(&src, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, SetLayer)
+{
+  CustomData src, dst;
+  customdata_verts_create(&src);
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MVERT, CD_SHARE, TOTVERT);
+
+  CustomData_free(&dst, TOTVERT);
+
+  /* Replacing the data of the last user ends its use of the shared storage, the caller
+   * owns the previous array then. */
+  MVert *mvert_old = (MVert *)CustomData_get_layer(&src, CD_MVERT);
+  MVert *mvert_new = (MVert *)MEM_dupallocN(mvert_old);
+  CustomData_set_layer(&src, CD_MVERT, mvert_new);
+  MEM_freeN(mvert_old);
+  EXPECT_EQ(mvert_new, CustomData_duplicate_referenced_layer(&src, CD_MVERT, TOTVERT));
+
+  CustomData_free(&src, TOTVERT);
+}
+
+TEST_F(CustomDataShareTest, DeformVerts)
+{
+  CustomData src, dst;
+  CustomData_reset(&src);
+  MDeformVert *dvert = (MDeformVert *)CustomData_add_layer(
+      &src, CD_MDEFORMVERT, CD_CALLOC, NULL, TOTVERT);
+  for (int i = 0; i < TOTVERT; i++) {
+    dvert[i].dw = (MDeformWeight *)MEM_callocN(sizeof(MDeformWeight), __func__);
+    dvert[i].dw->weight = 0.5f;
+    dvert[i].totweight = 1;
+  }
+  CustomData_ensure_shared(&src, TOTVERT);
+  CustomData_copy(&src, &dst, CD_MASK_MDEFORMVERT, CD_SHARE, TOTVERT);
+
+  /* Nested weight arrays are copied as well. */
+  MDeformVert *dvert_dst = (MDeformVert *)CustomData_duplicate_referenced_layer(
+      &dst, CD_MDEFORMVERT, TOTVERT);
+  EXPECT_NE(dvert[0].dw, dvert_dst[0].dw);
+  EXPECT_EQ(dvert_dst[0].dw->weight, 0.5f);
+
+  CustomData_free(&src, TOTVERT);
+  CustomData_free(&dst, TOTVERT);
+}
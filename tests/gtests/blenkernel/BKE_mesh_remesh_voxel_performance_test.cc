@@ -0,0 +1,121 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_remesh_voxel.h"
+
+#include "PIL_time.h"
+}
+
+#define TORUS_MAJOR_RADIUS 1.0f
+#define TORUS_MINOR_RADIUS 0.4f
+
+/* Index of the vertex at grid coordinates (u, v), wrapping around in both directions. */
+#define TORUS_INDEX(res_u, res_v, u, v) (((v) % (res_v)) * (res_u) + ((u) % (res_u)))
+
+/* Closed quad mesh of a torus with a random paint mask, dense enough to stand for a sculpt. */
+static Mesh *torus_mesh_create(const int res_u, const int res_v)
+{
+  const int num_verts = res_u * res_v;
+  Mesh *mesh = BKE_mesh_new_nomain(num_verts, 0, 0, num_verts * 4, num_verts);
+  float *mask = (float *)CustomData_add_layer(
+      &mesh->vdata, CD_PAINT_MASK, CD_CALLOC, NULL, num_verts);
+  RNG *rng = BLI_rng_new(0);
+
+  for (int v = 0; v < res_v; v++) {
+    const float angle_v = 2.0f * (float)M_PI * (float)v / (float)res_v;
+    for (int u = 0; u < res_u; u++) {
+      const float angle_u = 2.0f * (float)M_PI * (float)u / (float)res_u;
+      const float radius = TORUS_MAJOR_RADIUS + TORUS_MINOR_RADIUS * cosf(angle_v);
+      const int i = TORUS_INDEX(res_u, res_v, u, v);
+      mesh->mvert[i].co[0] = radius * cosf(angle_u);
+      mesh->mvert[i].co[1] = radius * sinf(angle_u);
+      mesh->mvert[i].co[2] = TORUS_MINOR_RADIUS * sinf(angle_v);
+      mask[i] = BLI_rng_get_float(rng);
+    }
+  }
+
+  for (int v = 0; v < res_v; v++) {
+    for (int u = 0; u < res_u; u++) {
+      const int i = TORUS_INDEX(res_u, res_v, u, v);
+      MLoop *ml = &mesh->mloop[i * 4];
+      ml[0].v = TORUS_INDEX(res_u, res_v, u, v);
+      ml[1].v = TORUS_INDEX(res_u, res_v, u + 1, v);
+      ml[2].v = TORUS_INDEX(res_u, res_v, u + 1, v + 1);
+      ml[3].v = TORUS_INDEX(res_u, res_v, u, v + 1);
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+    }
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  BLI_rng_free(rng);
+  return mesh;
+}
+
+static void remesh_voxel_test_do(const int res_u, const int res_v, const float voxel_size)
+{
+  BLI_threadapi_init();
+
+  Mesh *mesh = torus_mesh_create(res_u, res_v);
+
+  const double time_start = PIL_check_seconds_timer();
+
+  Mesh *mesh_remesh = BKE_mesh_remesh_voxel_to_mesh_nomain(mesh, voxel_size, 0.0f, 0.0f);
+  ASSERT_TRUE(mesh_remesh != NULL);
+  const double time_remesh = PIL_check_seconds_timer();
+
+  mesh_remesh = BKE_mesh_remesh_voxel_fix_poles(mesh_remesh);
+  BKE_mesh_calc_normals(mesh_remesh);
+  const double time_fix_poles = PIL_check_seconds_timer();
+
+  BKE_mesh_remesh_reproject_paint_mask(mesh_remesh, mesh);
+  const double time_end = PIL_check_seconds_timer();
+
+  EXPECT_GT(mesh_remesh->totpoly, 0);
+
+  printf("%s: %d -> %d vertices: remesh %fs, fix poles %fs, reproject mask %fs\n",
+         __func__,
+         mesh->totvert,
+         mesh_remesh->totvert,
+         time_remesh - time_start,
+         time_fix_poles - time_remesh,
+         time_end - time_fix_poles);
+
+  BKE_id_free(NULL, mesh_remesh);
+  BKE_id_free(NULL, mesh);
+
+  BLI_threadapi_exit();
+}
+
+TEST(mesh_remesh_voxel, Torus_256)
+{
+  remesh_voxel_test_do(256, 128, 0.02f);
+}
+
+TEST(mesh_remesh_voxel, Torus_1024)
+{
+  remesh_voxel_test_do(1024, 512, 0.005f);
+}
+
+TEST(mesh_remesh_voxel, Torus_2048)
+{
+  remesh_voxel_test_do(2048, 1024, 0.0025f);
+}
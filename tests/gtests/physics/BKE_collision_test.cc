@@ -0,0 +1,93 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_math.h"
+
+#include "BKE_collision.h"
+}
+
+#define EPSILON 0.015f
+
+/* Triangle at \a offset, spanning the XY plane (\a vertical false) or the YZ plane. */
+static void tri_create(float r_tri[3][3], const float offset[3], const bool vertical)
+{
+  const float tri[3][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+  for (int i = 0; i < 3; i++) {
+    if (vertical) {
+      const float co[3] = {0.0f, tri[i][1], tri[i][0] - 0.5f};
+      add_v3_v3v3(r_tri[i], co, offset);
+    }
+    else {
+      add_v3_v3v3(r_tri[i], tri[i], offset);
+    }
+  }
+}
+
+/* Triangle B moving from \a b_offset_prev to \a b_offset_next, triangle A doesn't move. */
+static bool tri_tri_crossed(const float b_offset_prev[3],
+                            const float b_offset_next[3],
+                            const bool b_vertical,
+                            float r_vec[3])
+{
+  const float a_offset[3] = {0.0f, 0.0f, 0.0f};
+  float a[3][3], b_prev[3][3], b_next[3][3];
+  tri_create(a, a_offset, false);
+  tri_create(b_prev, b_offset_prev, b_vertical);
+  tri_create(b_next, b_offset_next, b_vertical);
+
+  const float *a_co[3] = {a[0], a[1], a[2]};
+  const float *b_prev_co[3] = {b_prev[0], b_prev[1], b_prev[2]};
+  const float *b_next_co[3] = {b_next[0], b_next[1], b_next[2]};
+  return BKE_collision_tri_tri_crossed(a_co, b_prev_co, a_co, b_next_co, EPSILON, r_vec);
+}
+
+TEST(collision_tri_tri_crossed, PassThrough)
+{
+  const float b_prev[3] = {0.1f, 0.1f, 0.2f};
+  const float b_next[3] = {0.1f, 0.1f, -0.2f};
+  float vec[3];
+  EXPECT_TRUE(tri_tri_crossed(b_prev, b_next, false, vec));
+
+  /* The direction at the start of the step, from B above down to A. */
+  normalize_v3(vec);
+  EXPECT_NEAR(vec[0], 0.0f, 1e-5f);
+  EXPECT_NEAR(vec[1], 0.0f, 1e-5f);
+  EXPECT_NEAR(vec[2], -1.0f, 1e-5f);
+}
+
+TEST(collision_tri_tri_crossed, PassThroughEdge)
+{
+  const float b_prev[3] = {1.5f, 0.0f, 0.0f};
+  const float b_next[3] = {-0.5f, 0.0f, 0.0f};
+  float vec[3];
+  EXPECT_TRUE(tri_tri_crossed(b_prev, b_next, true, vec));
+}
+
+TEST(collision_tri_tri_crossed, MoveApart)
+{
+  const float b_prev[3] = {0.1f, 0.1f, 0.2f};
+  const float b_next[3] = {0.1f, 0.1f, 0.5f};
+  float vec[3];
+  EXPECT_FALSE(tri_tri_crossed(b_prev, b_next, false, vec));
+}
+
+/* Regression: the direction between the closest points flips, without the triangles meeting. */
+TEST(collision_tri_tri_crossed, SlidePastAbove)
+{
+  const float b_prev[3] = {2.0f, 0.0f, 0.5f};
+  const float b_next[3] = {-2.0f, 0.0f, 0.5f};
+  float vec[3];
+  EXPECT_FALSE(tri_tri_crossed(b_prev, b_next, false, vec));
+}
+
+TEST(collision_tri_tri_crossed, SlidePastBeside)
+{
+  const float b_prev[3] = {1.5f, 0.0f, 1.0f};
+  const float b_next[3] = {-0.5f, 0.0f, 1.0f};
+  float vec[3];
+  EXPECT_FALSE(tri_tri_crossed(b_prev, b_next, true, vec));
+}
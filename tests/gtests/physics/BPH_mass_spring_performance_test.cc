@@ -0,0 +1,173 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_math.h"
+
+#include "PIL_time.h"
+
+#include "BPH_mass_spring.h"
+#include "implicit.h"
+}
+
+#define NUM_FRAMES 20
+
+static float I3[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+
+/* Index of the vertex at grid coordinates (x, y). */
+#define GRID_INDEX(res, x, y) ((y) * (res) + (x))
+
+typedef struct GridSpring {
+  int i, j;
+  float restlen;
+} GridSpring;
+
+static void grid_spring_add(GridSpring *springs, int *num_springs, int i, int j, float restlen)
+{
+  GridSpring *spring = &springs[(*num_springs)++];
+  spring->i = i;
+  spring->j = j;
+  spring->restlen = restlen;
+}
+
+/* Structural, shear and bending springs of a square grid of cloth, similar to what
+ * cloth_build_springs() creates for a subdivided plane. */
+static GridSpring *grid_springs_create(const int res, const float size, int *r_num_springs)
+{
+  const float edge = size / (float)(res - 1);
+  GridSpring *springs = (GridSpring *)MEM_mallocN(sizeof(GridSpring) * 6 * res * res, __func__);
+  int num_springs = 0;
+
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      const int v = GRID_INDEX(res, x, y);
+      if (x + 1 < res) {
+        grid_spring_add(springs, &num_springs, v, GRID_INDEX(res, x + 1, y), edge);
+      }
+      if (y + 1 < res) {
+        grid_spring_add(springs, &num_springs, v, GRID_INDEX(res, x, y + 1), edge);
+      }
+      if (x + 1 < res && y + 1 < res) {
+        grid_spring_add(
+            springs, &num_springs, v, GRID_INDEX(res, x + 1, y + 1), edge * (float)M_SQRT2);
+        grid_spring_add(springs,
+                        &num_springs,
+                        GRID_INDEX(res, x + 1, y),
+                        GRID_INDEX(res, x, y + 1),
+                        edge * (float)M_SQRT2);
+      }
+      if (x + 2 < res) {
+        grid_spring_add(springs, &num_springs, v, GRID_INDEX(res, x + 2, y), edge * 2.0f);
+      }
+      if (y + 2 < res) {
+        grid_spring_add(springs, &num_springs, v, GRID_INDEX(res, x, y + 2), edge * 2.0f);
+      }
+    }
+  }
+
+  *r_num_springs = num_springs;
+  return springs;
+}
+
+static void mass_spring_grid_test_do(const int res)
+{
+  const float size = 2.0f;
+  const float mass = 0.3f;
+  const float dt = 1.0f / 25.0f;
+  const float gravity[3] = {0.0f, 0.0f, -9.81f};
+  const float zero[3] = {0.0f, 0.0f, 0.0f};
+  const int num_verts = res * res;
+
+  int num_springs;
+  GridSpring *springs = grid_springs_create(res, size, &num_springs);
+
+  Implicit_Data *data = BPH_mass_spring_solver_create(num_verts, num_springs);
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      const int v = GRID_INDEX(res, x, y);
+      const float co[3] = {
+          size * (float)x / (float)(res - 1), size * (float)y / (float)(res - 1), 0.0f};
+      BPH_mass_spring_set_vertex_mass(data, v, mass);
+      BPH_mass_spring_set_rest_transform(data, v, I3);
+      BPH_mass_spring_set_motion_state(data, v, co, zero);
+    }
+  }
+
+  double time_forces = 0.0, time_solve = 0.0;
+  int iterations = 0;
+
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    const double time_start = PIL_check_seconds_timer();
+
+    BPH_mass_spring_clear_constraints(data);
+    for (int x = 0; x < res; x++) {
+      BPH_mass_spring_add_constraint_ndof0(data, GRID_INDEX(res, x, res - 1), zero);
+    }
+
+    BPH_mass_spring_clear_forces(data);
+    for (int v = 0; v < num_verts; v++) {
+      BPH_mass_spring_force_gravity(data, v, mass, gravity);
+    }
+    BPH_mass_spring_force_drag(data, 1.0f);
+    for (int s = 0; s < num_springs; s++) {
+      BPH_mass_spring_force_spring_linear(data,
+                                          springs[s].i,
+                                          springs[s].j,
+                                          -1,
+                                          springs[s].restlen,
+                                          15.0f,
+                                          5.0f,
+                                          15.0f,
+                                          5.0f,
+                                          true,
+                                          false,
+                                          0.0f);
+    }
+
+    const double time_forces_end = PIL_check_seconds_timer();
+
+    ImplicitSolverResult result;
+    BPH_mass_spring_solve_velocities(data, dt, &result);
+    BPH_mass_spring_solve_positions(data, dt);
+    BPH_mass_spring_apply_result(data);
+
+    const double time_end = PIL_check_seconds_timer();
+
+    time_forces += time_forces_end - time_start;
+    time_solve += time_end - time_forces_end;
+    iterations += result.iterations;
+
+    EXPECT_EQ(result.status, BPH_SOLVER_SUCCESS);
+  }
+
+  printf("%s: %d vertices, %d springs: forces %fs, solve %fs, %d CG iterations (per frame)\n",
+         __func__,
+         num_verts,
+         num_springs,
+         time_forces / NUM_FRAMES,
+         time_solve / NUM_FRAMES,
+         iterations / NUM_FRAMES);
+
+  BPH_mass_spring_solver_free(data);
+  MEM_freeN(springs);
+}
+
+TEST(mass_spring, Grid_32)
+{
+  mass_spring_grid_test_do(32);
+}
+
+TEST(mass_spring, Grid_128)
+{
+  mass_spring_grid_test_do(128);
+}
+
+TEST(mass_spring, Grid_256)
+{
+  mass_spring_grid_test_do(256);
+}
@@ -0,0 +1,256 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <map>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_linklist.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "DNA_cloth_types.h"
+#include "DNA_modifier_types.h"
+
+#include "BKE_cloth.h"
+
+#include "BPH_mass_spring.h"
+#include "implicit.h"
+}
+
+/* Index of the vertex at grid coordinates (x, y). */
+#define GRID_INDEX(res, x, y) ((y) * (res) + (x))
+
+/* Relative tolerance, forces of springs sharing a vertex are summed in a different order. */
+#define FORCE_EPS 1e-4f
+
+static float I3[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+
+typedef std::pair<int, int> BlockKey;
+
+typedef struct BlockJacobians {
+  float dfdx[3][3];
+  float dfdv[3][3];
+} BlockJacobians;
+
+static void cloth_spring_add(
+    Cloth *cloth, int type, int i, int j, float restlen, float lin_stiffness)
+{
+  ClothSpring *spring = (ClothSpring *)MEM_callocN(sizeof(ClothSpring), __func__);
+  spring->ij = i;
+  spring->kl = j;
+  spring->restlen = restlen;
+  spring->type = type;
+  spring->lin_stiffness = lin_stiffness;
+  BLI_linklist_prepend(&cloth->springs, spring);
+  cloth->numsprings++;
+}
+
+/* Square grid of cloth with structural, shear and (linear) bending springs, similar to what
+ * cloth_build_springs() creates for a subdivided plane, in a randomly perturbed moving state. */
+static ClothModifierData *cloth_grid_create(const int res)
+{
+  const float edge = 1.0f / (float)(res - 1);
+  const float diag = edge * (float)M_SQRT2;
+  RNG *rng = BLI_rng_new(0);
+
+  ClothSimSettings *parms = (ClothSimSettings *)MEM_callocN(sizeof(*parms), __func__);
+  parms->bending_model = CLOTH_BENDING_LINEAR;
+  parms->flags = CLOTH_SIMSETTINGS_FLAG_RESIST_SPRING_COMPRESS;
+  parms->tension = parms->max_tension = 15.0f;
+  parms->compression = parms->max_compression = 15.0f;
+  parms->shear = parms->max_shear = 5.0f;
+  parms->bending = parms->max_bend = 0.5f;
+  parms->tension_damp = 5.0f;
+  parms->compression_damp = 5.0f;
+  parms->shear_damp = 5.0f;
+  parms->bending_damping = 0.5f;
+  parms->avg_spring_len = edge;
+
+  Cloth *cloth = (Cloth *)MEM_callocN(sizeof(*cloth), __func__);
+  cloth->mvert_num = res * res;
+
+  ClothModifierData *clmd = (ClothModifierData *)MEM_callocN(sizeof(*clmd), __func__);
+  clmd->sim_parms = parms;
+  clmd->clothObject = cloth;
+
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      const int v = GRID_INDEX(res, x, y);
+      const float stiffness = BLI_rng_get_float(rng);
+      if (x + 1 < res) {
+        cloth_spring_add(
+            cloth, CLOTH_SPRING_TYPE_STRUCTURAL, v, GRID_INDEX(res, x + 1, y), edge, stiffness);
+      }
+      if (y + 1 < res) {
+        cloth_spring_add(
+            cloth, CLOTH_SPRING_TYPE_STRUCTURAL, v, GRID_INDEX(res, x, y + 1), edge, stiffness);
+      }
+      if (x + 1 < res && y + 1 < res) {
+        cloth_spring_add(
+            cloth, CLOTH_SPRING_TYPE_SHEAR, v, GRID_INDEX(res, x + 1, y + 1), diag, stiffness);
+        cloth_spring_add(cloth,
+                         CLOTH_SPRING_TYPE_SHEAR,
+                         GRID_INDEX(res, x + 1, y),
+                         GRID_INDEX(res, x, y + 1),
+                         diag,
+                         stiffness);
+      }
+      if (x + 2 < res) {
+        cloth_spring_add(cloth,
+                         CLOTH_SPRING_TYPE_BENDING,
+                         v,
+                         GRID_INDEX(res, x + 2, y),
+                         edge * 2.0f,
+                         stiffness);
+      }
+      if (y + 2 < res) {
+        cloth_spring_add(cloth,
+                         CLOTH_SPRING_TYPE_BENDING,
+                         v,
+                         GRID_INDEX(res, x, y + 2),
+                         edge * 2.0f,
+                         stiffness);
+      }
+    }
+  }
+  /* Springs were prepended, restore the creation order. */
+  BLI_linklist_reverse(&cloth->springs);
+
+  cloth->implicit = BPH_mass_spring_solver_create(cloth->mvert_num, cloth->numsprings);
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      float co[3] = {edge * (float)x, edge * (float)y, 0.0f};
+      float vel[3];
+      for (int axis = 0; axis < 3; axis++) {
+        co[axis] += (BLI_rng_get_float(rng) - 0.5f) * edge * 0.5f;
+        vel[axis] = BLI_rng_get_float(rng) - 0.5f;
+      }
+      BPH_mass_spring_set_vertex_mass(cloth->implicit, GRID_INDEX(res, x, y), 0.3f);
+      BPH_mass_spring_set_rest_transform(cloth->implicit, GRID_INDEX(res, x, y), I3);
+      BPH_mass_spring_set_motion_state(cloth->implicit, GRID_INDEX(res, x, y), co, vel);
+    }
+  }
+
+  BLI_rng_free(rng);
+  return clmd;
+}
+
+static void cloth_grid_free(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+  BPH_cloth_solver_free(clmd);
+  BLI_linklist_free(cloth->springs, MEM_freeN);
+  MEM_freeN(cloth);
+  MEM_freeN(clmd->sim_parms);
+  MEM_freeN(clmd);
+}
+
+/* Accumulate spring forces, jacobian blocks are summed per vertex pair because the order
+ * they are added in depends on how the forces were computed. */
+static void cloth_spring_forces_get(ClothModifierData *clmd,
+                                    const bool use_groups,
+                                    float (*r_forces)[3],
+                                    std::map<BlockKey, BlockJacobians> &r_blocks)
+{
+  Implicit_Data *data = clmd->clothObject->implicit;
+
+  BPH_mass_spring_clear_forces(data);
+  BPH_cloth_calc_spring_forces(clmd, use_groups);
+
+  for (int v = 0; v < (int)clmd->clothObject->mvert_num; v++) {
+    BPH_mass_spring_get_force(data, v, r_forces[v]);
+  }
+
+  const int num_blocks = BPH_mass_spring_get_num_blocks(data);
+  for (int block = 0; block < num_blocks; block++) {
+    BlockKey key;
+    float dfdx[3][3], dfdv[3][3];
+    BPH_mass_spring_get_block(data, block, &key.first, &key.second, dfdx, dfdv);
+    /* Value initialized (zeroed) on first use. */
+    BlockJacobians &jac = r_blocks[key];
+    add_m3_m3m3(jac.dfdx, jac.dfdx, dfdx);
+    add_m3_m3m3(jac.dfdv, jac.dfdv, dfdv);
+  }
+}
+
+static void expect_near_v3(const float a[3], const float b[3], const float scale)
+{
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NEAR(a[i], b[i], FORCE_EPS * scale);
+  }
+}
+
+static void expect_near_m3(const float a[3][3], const float b[3][3], const float scale)
+{
+  for (int i = 0; i < 3; i++) {
+    expect_near_v3(a[i], b[i], scale);
+  }
+}
+
+static void cloth_spring_forces_test_do(const int res)
+{
+  BLI_threadapi_init();
+
+  ClothModifierData *clmd = cloth_grid_create(res);
+  const int num_verts = clmd->clothObject->mvert_num;
+
+  float(*forces_serial)[3] = (float(*)[3])MEM_malloc_arrayN(
+      num_verts, sizeof(float[3]), __func__);
+  float(*forces_grouped)[3] = (float(*)[3])MEM_malloc_arrayN(
+      num_verts, sizeof(float[3]), __func__);
+  std::map<BlockKey, BlockJacobians> blocks_serial, blocks_grouped;
+
+  cloth_spring_forces_get(clmd, false, forces_serial, blocks_serial);
+  cloth_spring_forces_get(clmd, true, forces_grouped, blocks_grouped);
+
+  float force_scale = 1.0f;
+  for (int v = 0; v < num_verts; v++) {
+    force_scale = max_ff(force_scale, len_v3(forces_serial[v]));
+  }
+  for (int v = 0; v < num_verts; v++) {
+    expect_near_v3(forces_serial[v], forces_grouped[v], force_scale);
+  }
+
+  float jac_scale = 1.0f;
+  for (const auto &item : blocks_serial) {
+    for (int i = 0; i < 3; i++) {
+      jac_scale = max_fff(
+          jac_scale, len_v3(item.second.dfdx[i]), len_v3(item.second.dfdv[i]));
+    }
+  }
+  for (const auto &item : blocks_serial) {
+    EXPECT_TRUE(blocks_grouped.count(item.first) != 0);
+  }
+  /* Grouped springs get their block up-front, springs which end up applying no force (like
+   * stretched linear bending springs) leave it zeroed instead of not adding one. */
+  const BlockJacobians zero_jac = {{{0.0f}}};
+  for (const auto &item : blocks_grouped) {
+    auto it = blocks_serial.find(item.first);
+    const BlockJacobians &jac_serial = (it != blocks_serial.end()) ? it->second : zero_jac;
+    expect_near_m3(jac_serial.dfdx, item.second.dfdx, jac_scale);
+    expect_near_m3(jac_serial.dfdv, item.second.dfdv, jac_scale);
+  }
+
+  MEM_freeN(forces_serial);
+  MEM_freeN(forces_grouped);
+  cloth_grid_free(clmd);
+
+  BLI_threadapi_exit();
+}
+
+TEST(mass_spring, SpringForcesGrouped_8)
+{
+  cloth_spring_forces_test_do(8);
+}
+
+/* Large enough for the biggest spring groups to be computed from multiple threads. */
+TEST(mass_spring, SpringForcesGrouped_128)
+{
+  cloth_spring_forces_test_do(128);
+}
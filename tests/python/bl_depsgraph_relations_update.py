@@ -0,0 +1,92 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_depsgraph_relations_update.py -- --verbose
+import bpy
+import unittest
+
+
+class TestRelationsUpdate(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        self.collection = bpy.context.view_layer.active_layer_collection.collection
+        self.updates = {}
+        bpy.app.handlers.depsgraph_update_post.append(self.on_update)
+
+    def tearDown(self):
+        bpy.app.handlers.depsgraph_update_post.remove(self.on_update)
+
+    def on_update(self, scene, depsgraph):
+        for update in depsgraph.updates:
+            self.updates[update.id.original.name] = update.is_updated_geometry
+
+    def object_add(self, name, with_mesh=True):
+        data = None
+        if with_mesh:
+            data = bpy.data.meshes.new(name)
+            data.from_pydata([(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0)], [], [(0, 1, 2, 3)])
+        ob = bpy.data.objects.new(name, data)
+        self.collection.objects.link(ob)
+        return ob
+
+    def update(self):
+        self.updates.clear()
+        bpy.context.view_layer.update()
+        return self.updates
+
+    def test_unrelated_object_keeps_geometry(self):
+        ob_a = self.object_add("A")
+        ob_a.modifiers.new("Subsurf", 'SUBSURF')
+        self.update()
+
+        self.object_add("B")
+        updates = self.update()
+
+        self.assertTrue(updates.get("B"))
+        self.assertFalse(updates.get("A", False))
+
+        # The kept evaluated state is still the subdivided one.
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        self.assertEqual(len(ob_a.evaluated_get(depsgraph).data.vertices), 9)
+
+    def test_new_relation_evaluates(self):
+        ob_a = self.object_add("A", with_mesh=False)
+        ob_b = self.object_add("B", with_mesh=False)
+        ob_a.location.x = 3.0
+        self.update()
+
+        # Adding a driver only tags relations for update, the driven object
+        # has to be evaluated because its operations changed.
+        fcurve = ob_b.driver_add("location", 0)
+        driver = fcurve.driver
+        driver.type = 'AVERAGE'
+        var = driver.variables.new()
+        var.type = 'TRANSFORMS'
+        var.targets[0].id = ob_a
+        var.targets[0].transform_type = 'LOC_X'
+        self.update()
+
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        self.assertAlmostEqual(ob_b.evaluated_get(depsgraph).location.x, 3.0)
+
+    def test_removed_relation_evaluates(self):
+        ob_a = self.object_add("A", with_mesh=False)
+        ob_b = self.object_add("B", with_mesh=False)
+        ob_a.location.x = 2.0
+        ob_b.parent = ob_a
+        self.update()
+
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        self.assertAlmostEqual(ob_b.evaluated_get(depsgraph).matrix_world.translation.x, 2.0)
+
+        bpy.data.objects.remove(ob_a)
+        self.update()
+
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        self.assertAlmostEqual(ob_b.evaluated_get(depsgraph).matrix_world.translation.x, 0.0)
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
@@ -0,0 +1,62 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_mesh_deform_looptri.py -- --verbose
+import bpy
+import unittest
+
+
+def loop_triangles_verts(me):
+    me.calc_loop_triangles()
+    return sorted(tuple(sorted(tri.vertices)) for tri in me.loop_triangles)
+
+
+class TestMeshDeformLoopTri(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        self.collection = bpy.context.view_layer.active_layer_collection.collection
+
+    def object_add(self, verts, faces):
+        me = bpy.data.meshes.new("Mesh")
+        me.from_pydata(verts, [], faces)
+        ob = bpy.data.objects.new("Mesh", me)
+        self.collection.objects.link(ob)
+        ob.shape_key_add(name="Basis")
+        return ob
+
+    def check_deformed(self, ob, co_deformed):
+        key = ob.shape_key_add(name="Deform")
+        for i, co in enumerate(co_deformed):
+            key.data[i].co = co
+        key.value = 1.0
+
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        me_eval = ob.evaluated_get(depsgraph).data
+
+        # Triangulation of the deformed coordinates, evaluated from scratch.
+        me_ref = bpy.data.meshes.new("Reference")
+        me_ref.from_pydata(co_deformed, [], [tuple(p.vertices) for p in ob.data.polygons])
+        self.assertEqual(loop_triangles_verts(me_eval), loop_triangles_verts(me_ref))
+
+    def test_ngon(self):
+        # Convex hexagon, made concave by the deformation.
+        verts = [(0, 0, 0), (2, 0, 0), (3, 1, 0), (2, 2, 0), (0, 2, 0), (-1, 1, 0)]
+        ob = self.object_add(verts, [(0, 1, 2, 3, 4, 5)])
+        co_deformed = list(verts)
+        co_deformed[2] = (1, 1, 0)
+        self.check_deformed(ob, co_deformed)
+
+    def test_quad(self):
+        # Square, made concave at its second corner by the deformation, so the default split
+        # along the first diagonal is outside of it.
+        verts = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0)]
+        ob = self.object_add(verts, [(0, 1, 2, 3)])
+        co_deformed = list(verts)
+        co_deformed[1] = (0.3, 0.5, 0)
+        self.check_deformed(ob, co_deformed)
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
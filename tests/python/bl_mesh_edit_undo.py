@@ -0,0 +1,144 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_mesh_edit_undo.py -- --verbose
+import bpy
+import bmesh
+import unittest
+
+
+def context_override():
+    window = bpy.context.window_manager.windows[0]
+    return {"window": window, "screen": window.screen}
+
+
+def undo_push(message):
+    bpy.ops.ed.undo_push(context_override(), message=message)
+
+
+def undo():
+    bpy.ops.ed.undo(context_override())
+
+
+def redo():
+    bpy.ops.ed.redo(context_override())
+
+
+def edit_mesh_state(me):
+    """
+    Data which edit-mode undo stores per element.
+    """
+    bm = bmesh.from_edit_mesh(me)
+    bm.verts.index_update()
+    bm.edges.index_update()
+    bm.faces.index_update()
+    uv = bm.loops.layers.uv.active
+    return {
+        "verts": [(tuple(v.co), v.select, v.hide) for v in bm.verts],
+        "edges": [(e.verts[0].index, e.verts[1].index, e.select, e.seam) for e in bm.edges],
+        "faces": [(len(f.verts), f.select, f.material_index, f.smooth) for f in bm.faces],
+        "loops": [(l.vert.index, tuple(l[uv].uv)) for f in bm.faces for l in f.loops],
+        "select_history": [elem.index for elem in bm.select_history],
+    }
+
+
+class TestMeshEditUndo(unittest.TestCase):
+    def setUp(self):
+        me = bpy.data.meshes.new("Grid")
+        bm = bmesh.new()
+        bmesh.ops.create_grid(bm, x_segments=16, y_segments=16, size=1.0, calc_uvs=True)
+        bm.to_mesh(me)
+        bm.free()
+
+        ob = bpy.data.objects.new("Grid", me)
+        view_layer = bpy.context.view_layer
+        view_layer.active_layer_collection.collection.objects.link(ob)
+        view_layer.objects.active = ob
+        ob.select_set(True)
+
+        bpy.ops.object.mode_set(mode='EDIT')
+        self.ob = ob
+        self.me = me
+        undo_push("Initial")
+
+    def tearDown(self):
+        bpy.ops.object.mode_set(mode='OBJECT')
+        bpy.data.objects.remove(self.ob)
+        bpy.data.meshes.remove(self.me)
+
+    def edit(self, func, message):
+        bm = bmesh.from_edit_mesh(self.me)
+        func(bm)
+        bmesh.update_edit_mesh(self.me)
+        undo_push(message)
+        return edit_mesh_state(self.me)
+
+    def check_undo_redo(self, states):
+        """
+        Step back through all states and forward again, comparing each against its stored state.
+        """
+        for state in reversed(states[:-1]):
+            undo()
+            self.assertEqual(edit_mesh_state(self.me), state)
+        for state in states[1:]:
+            redo()
+            self.assertEqual(edit_mesh_state(self.me), state)
+
+    def test_element_data(self):
+        def move(bm):
+            for v in bm.verts[::3]:
+                v.co.z += 0.5
+
+        def select(bm):
+            bm.verts.ensure_lookup_table()
+            bm.faces.ensure_lookup_table()
+            bm.verts[4].select_set(True)
+            bm.faces[7].select_set(True)
+            bm.select_history.add(bm.faces[7])
+            bm.select_flush_mode()
+
+        def mark(bm):
+            uv = bm.loops.layers.uv.active
+            for e in bm.edges[:20]:
+                e.seam = True
+            for f in bm.faces[::5]:
+                f.material_index = 1
+                f.smooth = True
+                for l in f.loops:
+                    l[uv].uv *= 0.5
+
+        def hide(bm):
+            for v in bm.verts[10:30]:
+                v.hide_set(True)
+
+        states = [edit_mesh_state(self.me)]
+        states.append(self.edit(move, "Move"))
+        states.append(self.edit(select, "Select"))
+        states.append(self.edit(mark, "Mark"))
+        states.append(self.edit(hide, "Hide"))
+        self.check_undo_redo(states)
+
+    def test_topology(self):
+        def move(bm):
+            for v in bm.verts[::2]:
+                v.co.x += 0.25
+
+        def dissolve(bm):
+            bmesh.ops.dissolve_verts(bm, verts=bm.verts[20:24])
+
+        def move_after(bm):
+            for v in bm.verts[::4]:
+                v.co.y -= 0.25
+
+        states = [edit_mesh_state(self.me)]
+        states.append(self.edit(move, "Move"))
+        # Falls back to a full state, following deltas are relative to it.
+        states.append(self.edit(dissolve, "Dissolve"))
+        states.append(self.edit(move_after, "Move"))
+        self.check_undo_redo(states)
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
@@ -0,0 +1,55 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_mesh_shared_eval.py -- --verbose
+import bpy
+import unittest
+
+
+class TestMeshSharedEval(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        self.mesh = bpy.data.meshes.new("Mesh")
+        self.mesh.from_pydata([(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0)], [], [(0, 1, 2, 3)])
+        self.ob_a = self.object_add("A")
+        self.ob_b = self.object_add("B")
+
+    def object_add(self, name):
+        ob = bpy.data.objects.new(name, self.mesh)
+        bpy.context.view_layer.active_layer_collection.collection.objects.link(ob)
+        ob.modifiers.new("Subsurf", 'SUBSURF')
+        ob.modifiers.new("Bevel", 'BEVEL')
+        return ob
+
+    def evaluated_meshes(self):
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        return [ob.evaluated_get(depsgraph).data for ob in (self.ob_a, self.ob_b)]
+
+    def test_identical_stacks(self):
+        me_a, me_b = self.evaluated_meshes()
+        self.assertEqual(len(me_a.vertices), len(me_b.vertices))
+        # Evaluated once, both results use the same arrays.
+        self.assertEqual(me_a.vertices[0].as_pointer(), me_b.vertices[0].as_pointer())
+
+        # Objects are moved independently, the results are still shared.
+        self.ob_b.location.x = 3.0
+        me_a, me_b = self.evaluated_meshes()
+        self.assertEqual(me_a.vertices[0].as_pointer(), me_b.vertices[0].as_pointer())
+
+    def test_different_stacks(self):
+        self.ob_b.modifiers["Bevel"].width = 0.2
+        me_a, me_b = self.evaluated_meshes()
+        self.assertNotEqual(me_a.vertices[0].as_pointer(), me_b.vertices[0].as_pointer())
+
+        # Identical again, shared once both objects are evaluated with the edited mesh.
+        self.ob_b.modifiers["Bevel"].width = self.ob_a.modifiers["Bevel"].width
+        self.mesh.vertices[0].co.z = 0.5
+        self.mesh.update()
+        me_a, me_b = self.evaluated_meshes()
+        self.assertEqual(me_a.vertices[0].as_pointer(), me_b.vertices[0].as_pointer())
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
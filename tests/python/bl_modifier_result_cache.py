@@ -0,0 +1,115 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_modifier_result_cache.py -- --verbose
+import bpy
+import bmesh
+import unittest
+
+
+def mesh_state(ob):
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    me = ob.evaluated_get(depsgraph).data
+    return (len(me.vertices), len(me.polygons), [tuple(v.co) for v in me.vertices])
+
+
+class TestModifierResultCache(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        me = bpy.data.meshes.new("Grid")
+        bm = bmesh.new()
+        bmesh.ops.create_grid(bm, x_segments=4, y_segments=4, size=1.0)
+        bm.to_mesh(me)
+        bm.free()
+
+        self.ob = bpy.data.objects.new("Grid", me)
+        bpy.context.view_layer.active_layer_collection.collection.objects.link(self.ob)
+
+    def assertStateEqual(self, state_a, state_b):
+        self.assertEqual(state_a[:2], state_b[:2])
+        for co_a, co_b in zip(state_a[2], state_b[2]):
+            for a, b in zip(co_a, co_b):
+                self.assertAlmostEqual(a, b, places=5)
+
+    def test_settings_change(self):
+        bevel = self.ob.modifiers.new("Bevel", 'BEVEL')
+        bevel.width = 0.1
+        state_a = mesh_state(self.ob)
+
+        bevel.width = 0.2
+        state_b = mesh_state(self.ob)
+        self.assertNotEqual(state_a[2], state_b[2])
+
+        bevel.segments = 3
+        state_c = mesh_state(self.ob)
+        self.assertNotEqual(state_b[:2], state_c[:2])
+
+        # Going back to previous settings gives the same results again.
+        bevel.segments = 1
+        self.assertStateEqual(mesh_state(self.ob), state_b)
+        bevel.width = 0.1
+        self.assertStateEqual(mesh_state(self.ob), state_a)
+
+    def test_input_change(self):
+        self.ob.modifiers.new("Bevel", 'BEVEL')
+        state_a = mesh_state(self.ob)
+
+        # Same element counts, different coordinates.
+        self.ob.data.vertices[0].co.z = 1.0
+        self.ob.data.update()
+        state_b = mesh_state(self.ob)
+        self.assertNotEqual(state_a[2], state_b[2])
+
+    def test_linked_object_change(self):
+        axis = bpy.data.objects.new("Axis", None)
+        bpy.context.view_layer.active_layer_collection.collection.objects.link(axis)
+        screw = self.ob.modifiers.new("Screw", 'SCREW')
+        screw.object = axis
+        state_a = mesh_state(self.ob)
+
+        axis.location.x = 2.0
+        state_b = mesh_state(self.ob)
+        self.assertNotEqual(state_a[2], state_b[2])
+
+        axis.location.x = 0.0
+        self.assertStateEqual(mesh_state(self.ob), state_a)
+
+    def test_time_dependent(self):
+        # The input of the cached modifier changes with the frame.
+        build = self.ob.modifiers.new("Build", 'BUILD')
+        build.frame_start = 1
+        build.frame_duration = 10
+        self.ob.modifiers.new("Bevel", 'BEVEL')
+        scene = bpy.context.scene
+
+        scene.frame_set(3)
+        state_a = mesh_state(self.ob)
+        scene.frame_set(8)
+        state_b = mesh_state(self.ob)
+        self.assertNotEqual(state_a[:2], state_b[:2])
+
+        scene.frame_set(3)
+        self.assertStateEqual(mesh_state(self.ob), state_a)
+
+    def test_animated_settings(self):
+        bevel = self.ob.modifiers.new("Bevel", 'BEVEL')
+        bevel.width = 0.1
+        bevel.keyframe_insert("width", frame=1)
+        bevel.width = 0.3
+        bevel.keyframe_insert("width", frame=10)
+        scene = bpy.context.scene
+
+        scene.frame_set(1)
+        state_a = mesh_state(self.ob)
+        scene.frame_set(10)
+        state_b = mesh_state(self.ob)
+        self.assertNotEqual(state_a[2], state_b[2])
+
+        scene.frame_set(1)
+        self.assertStateEqual(mesh_state(self.ob), state_a)
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
@@ -0,0 +1,59 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_pyapi_prop_collection_buffer.py -- --verbose
+import bpy
+import unittest
+
+
+class TestPropCollectionBuffer(unittest.TestCase):
+    def setUp(self):
+        self.mesh = bpy.data.meshes.new("TestPropCollectionBuffer")
+        self.mesh.from_pydata(
+            ((0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (1.0, 1.0, 0.0), (0.0, 1.0, 0.0)),
+            (),
+            ((0, 1, 2, 3),),
+        )
+
+    def tearDown(self):
+        bpy.data.meshes.remove(self.mesh)
+
+    def test_read(self):
+        view = memoryview(self.mesh.vertices.as_buffer("co"))
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.format, "f")
+        self.assertEqual(view.shape, (4, 3))
+        self.assertEqual(view.tolist(), [list(v.co) for v in self.mesh.vertices])
+
+        view = memoryview(self.mesh.loops.as_buffer("vertex_index"))
+        self.assertEqual(view.shape, (4,))
+        self.assertEqual(view.tolist(), [0, 1, 2, 3])
+
+    def test_write(self):
+        buf = self.mesh.vertices.as_buffer("co", writable=True)
+        view = memoryview(buf)
+        self.assertFalse(view.readonly)
+        view[2, 2] = 5.0
+        buf.update()
+        self.assertEqual(self.mesh.vertices[2].co.z, 5.0)
+
+        with self.assertRaises(TypeError):
+            memoryview(self.mesh.vertices.as_buffer("co"))[0, 0] = 1.0
+
+    def test_resize(self):
+        buf = self.mesh.vertices.as_buffer("co")
+        self.mesh.vertices.add(2)
+        self.assertEqual(memoryview(buf).shape, (6, 3))
+
+    def test_unsupported(self):
+        with self.assertRaises(AttributeError):
+            self.mesh.vertices.as_buffer("not_a_property")
+        # Stored as a bit-flag, not an array.
+        with self.assertRaises(TypeError):
+            self.mesh.vertices.as_buffer("select")
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()